@@ -585,6 +585,7 @@ Ipv4ClickRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
 } // namespace ns3
 
 using ns3::g_log;
+using ns3::g_logCeiling;
 
 static int simstrlcpy (char *buf, int len, const std::string &s)
 {
@@ -0,0 +1,324 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_LOG_RECORD_H
+#define BINARY_LOG_RECORD_H
+
+#include "log.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::BinaryLogRecord declaration.
+ *
+ * This is the part of the BinaryLogSink used by the NS_LOG macros at
+ * each call site, included by log.h when logging is enabled.  The sink
+ * itself is declared in binary-log-sink.h.
+ */
+
+namespace ns3 {
+
+template <typename T>
+class Ptr;
+class Time;
+
+/**
+ * \ingroup logging
+ *
+ * \brief A record of the BinaryLogSink under construction.
+ *
+ * The NS_LOG macros stream the message into a temporary record, which
+ * is appended to the ring buffer when it is destroyed.
+ */
+class BinaryLogRecord
+{
+public:
+  /** The kind of call site. */
+  enum Kind
+  {
+    MESSAGE,  //!< NS_LOG, NS_LOG_ERROR, ..., NS_LOG_LOGIC.
+    FUNCTION  //!< NS_LOG_FUNCTION and NS_LOG_FUNCTION_NOARGS.
+  };
+  /** The type of a value in a record. */
+  enum Type
+  {
+    INT,       //!< Signed integer.
+    UINT,      //!< Unsigned integer.
+    INT8,      //!< signed char, printed as a number by NS_LOG_FUNCTION.
+    UINT8,     //!< unsigned char, printed as a number by NS_LOG_FUNCTION.
+    CHAR,      //!< char.
+    BOOL,      //!< bool.
+    DOUBLE,    //!< Floating point number.
+    POINTER,   //!< Pointer.
+    STRING,    //!< String, quoted by NS_LOG_FUNCTION.
+    TEXT,      //!< Text of an object or of a manipulator.
+    FLAGS,     //!< Format flags set by a manipulator.
+    TIME       //!< Time, in time steps.
+  };
+
+  /**
+   * Check if the log messages are recorded, as BinaryLogSink::IsEnabled.
+   * \returns \c true if the sink is enabled.
+   */
+  static bool IsEnabled (void);
+  /**
+   * Register a call site.  Called once per call site by the NS_LOG
+   * macros, the first time they record a message.
+   * \param [in] component The log component name.
+   * \param [in] function The function name.
+   * \param [in] file The source file name.
+   * \param [in] line The source line.
+   * \param [in] level The log level of the message.
+   * \param [in] kind The kind of call site.
+   * \returns The format id of the call site.
+   */
+  static uint32_t RegisterFormat (const char *component, const char *function,
+                                  const char *file, int line,
+                                  enum LogLevel level, enum Kind kind);
+
+  /**
+   * Constructor.
+   * \param [in] format The format id of the call site.
+   */
+  BinaryLogRecord (uint32_t format);
+  /** Destructor, appends the record to the ring buffer. */
+  ~BinaryLogRecord ();
+
+  /**
+   * Append a value.
+   * \param [in] value The value.
+   * \returns This record, so it's chainable.
+   */
+  template <typename T>
+  BinaryLogRecord & operator<< (const T &value);
+  /**
+   * Append each element of a vector, as ParameterLogger does.
+   * \param [in] vector The vector.
+   * \returns This record, so it's chainable.
+   */
+  template <typename T>
+  BinaryLogRecord & operator<< (const std::vector<T> &vector);
+  /**
+   * Append a pointer, as its address.
+   * \param [in] value The pointer.
+   * \returns This record, so it's chainable.
+   */
+  template <typename T>
+  BinaryLogRecord & operator<< (T *value);
+  /**
+   * Append the object pointed to by a Ptr, as its address.
+   * \param [in] p The pointer.
+   * \returns This record, so it's chainable.
+   */
+  template <typename T>
+  BinaryLogRecord & operator<< (const Ptr<T> &p);
+  /**
+   * Append a C string.
+   * \param [in] value The string.
+   * \returns This record, so it's chainable.
+   */
+  BinaryLogRecord & operator<< (const char *value);
+  /**
+   * Append a string.
+   * \param [in] value The string.
+   * \returns This record, so it's chainable.
+   */
+  BinaryLogRecord & operator<< (const std::string &value);
+  /**
+   * Append a Time, as its number of time steps.
+   * \param [in] value The time.
+   * \returns This record, so it's chainable.
+   */
+  BinaryLogRecord & operator<< (const Time &value);
+  /**
+   * Apply a stream manipulator, only std::endl is kept.
+   * \param [in] manip The manipulator.
+   * \returns This record, so it's chainable.
+   */
+  BinaryLogRecord & operator<< (std::ostream & (*manip)(std::ostream &));
+  /**
+   * Apply a std::ios_base manipulator, such as std::hex.
+   * \param [in] manip The manipulator.
+   * \returns This record, so it's chainable.
+   */
+  BinaryLogRecord & operator<< (std::ios_base & (*manip)(std::ios_base &));
+
+private:
+  /**
+   * Append a value of a fixed size type.
+   * \param [in] type The value type.
+   * \param [in] bits The value.
+   */
+  void Append (enum Type type, uint64_t bits);
+  /**
+   * Append a string, truncated if the record is full.
+   * \param [in] type The value type, STRING or TEXT.
+   * \param [in] data The characters.
+   * \param [in] size The number of characters.
+   */
+  void Append (enum Type type, const char *data, std::size_t size);
+
+  /** Append an integer, \c true_type overload. */
+  template <typename T>
+  void AppendValue (const T &value, std::true_type, std::false_type);
+  /** Append a floating point number, \c true_type overload. */
+  template <typename T>
+  void AppendValue (const T &value, std::false_type, std::true_type);
+  /** Append any other value. */
+  template <typename T>
+  void AppendValue (const T &value, std::false_type, std::false_type);
+  /** Append a pointer to an object. */
+  template <typename T>
+  void AppendPointer (T *value, std::false_type);
+  /** Append a pointer to a function. */
+  template <typename T>
+  void AppendPointer (T *value, std::true_type);
+
+  /** The maximum size of a record, in bytes. */
+  static const uint32_t MAX_SIZE = 256;
+  /** The record. */
+  uint8_t m_data[MAX_SIZE];
+  /** The current size of the record. */
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+BinaryLogRecord &
+BinaryLogRecord::operator<< (const T &value)
+{
+  AppendValue (value, typename std::is_integral<T>::type (),
+               typename std::is_floating_point<T>::type ());
+  return *this;
+}
+
+template <typename T>
+BinaryLogRecord &
+BinaryLogRecord::operator<< (const std::vector<T> &vector)
+{
+  for (typename std::vector<T>::const_iterator i = vector.begin (); i != vector.end (); ++i)
+    {
+      *this << *i;
+    }
+  return *this;
+}
+
+template <typename T>
+BinaryLogRecord &
+BinaryLogRecord::operator<< (T *value)
+{
+  if (std::is_same<typename std::remove_cv<T>::type, char>::value)
+    {
+      // printed as a string by the output operator
+      return *this << reinterpret_cast<const char *> (value);
+    }
+  AppendPointer (value, typename std::is_function<T>::type ());
+  return *this;
+}
+
+template <typename T>
+BinaryLogRecord &
+BinaryLogRecord::operator<< (const Ptr<T> &p)
+{
+  AppendPointer (PeekPointer (p), std::false_type ());
+  return *this;
+}
+
+template <typename T>
+void
+BinaryLogRecord::AppendValue (const T &value, std::true_type, std::false_type)
+{
+  if (std::is_same<T, bool>::value)
+    {
+      Append (BOOL, value ? 1 : 0);
+    }
+  else if (std::is_same<T, char>::value)
+    {
+      Append (CHAR, static_cast<uint64_t> (value));
+    }
+  else if (std::is_same<T, signed char>::value)
+    {
+      Append (INT8, static_cast<uint64_t> (static_cast<int64_t> (value)));
+    }
+  else if (std::is_same<T, unsigned char>::value)
+    {
+      Append (UINT8, static_cast<uint64_t> (value));
+    }
+  else if (std::is_signed<T>::value)
+    {
+      Append (INT, static_cast<uint64_t> (static_cast<int64_t> (value)));
+    }
+  else
+    {
+      Append (UINT, static_cast<uint64_t> (value));
+    }
+}
+
+template <typename T>
+void
+BinaryLogRecord::AppendValue (const T &value, std::false_type, std::true_type)
+{
+  double d = value;
+  uint64_t bits;
+  std::memcpy (&bits, &d, sizeof (bits));
+  Append (DOUBLE, bits);
+}
+
+template <typename T>
+void
+BinaryLogRecord::AppendValue (const T &value, std::false_type, std::false_type)
+{
+  // not a number: let the output operator of the type format it now.
+  // Some output operators take a non-const reference, as the text
+  // output streams the caller's object directly.
+  std::ostringstream oss;
+  oss << const_cast<T &> (value);
+  std::string text = oss.str ();
+  Append (TEXT, text.data (), text.size ());
+}
+
+template <typename T>
+void
+BinaryLogRecord::AppendPointer (T *value, std::false_type)
+{
+  Append (POINTER, reinterpret_cast<uintptr_t> (static_cast<const volatile void *> (value)));
+}
+
+template <typename T>
+void
+BinaryLogRecord::AppendPointer (T *value, std::true_type)
+{
+  AppendValue (value, std::false_type (), std::false_type ());
+}
+
+} // namespace ns3
+
+#endif /* BINARY_LOG_RECORD_H */
@@ -0,0 +1,680 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-log-sink.h"
+#include "abort.h"
+#include "simulator.h"
+#include "nstime.h"
+
+#include <atomic>
+#include <iomanip>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::BinaryLogSink and ns3::BinaryLogRecord implementations.
+ */
+
+namespace ns3 {
+
+// No NS_LOG_COMPONENT_DEFINE here: logging from the sink would record
+// into the sink.
+
+namespace {
+
+/** A registered call site. */
+struct Format
+{
+  std::string component;  //!< The log component name.
+  std::string function;   //!< The function name.
+  std::string file;       //!< The source file name.
+  int32_t line;           //!< The source line.
+  uint32_t level;         //!< The log level.
+  uint32_t kind;          //!< The BinaryLogRecord::Kind.
+};
+
+/**
+ * The record header, followed by the values, each a one byte
+ * BinaryLogRecord::Type then either eight bytes or, for the strings, a
+ * two bytes length and the characters.
+ */
+struct Header
+{
+  uint32_t size;     //!< The record size, header included.
+  uint32_t format;   //!< The format id.
+  uint64_t ts;       //!< The simulation time, in time steps.
+  uint32_t context;  //!< The simulation context.
+  uint32_t flags;    //!< HAS_TIME if the simulator was running.
+};
+
+/** Header flag: the simulator was running and ts is valid. */
+const uint32_t HAS_TIME = 1;
+/** First bytes of a file written by BinaryLogSink::Write. */
+const char MAGIC[8] = {'n', 's', '3', 'b', 'l', 'o', 'g', '1'};
+
+/** The state of the sink. */
+struct Sink
+{
+  Sink ()
+    : recordCount (0),
+      lostCount (0),
+      head (0),
+      tail (0)
+  {
+    lock.clear ();
+  }
+  std::vector<Format> formats;  //!< The call sites, indexed by format id.
+  std::vector<uint8_t> buffer;  //!< The ring buffer.
+  uint64_t recordCount;         //!< The number of records in the buffer.
+  uint64_t lostCount;           //!< The number of records overwritten.
+  uint64_t head;                //!< Total number of bytes written.
+  uint64_t tail;                //!< Position of the oldest record.
+  std::atomic_flag lock;        //!< Protects all of the above.
+};
+
+/** Flag \c true while the sink is enabled. */
+std::atomic<bool> g_enabled (false);
+
+/**
+ * Get the sink.
+ * \returns The sink.
+ */
+Sink &
+GetSink (void)
+{
+  static Sink sink;
+  return sink;
+}
+
+/** Spin lock on the sink. */
+class SinkLock
+{
+public:
+  /**
+   * Constructor, takes the lock.
+   * \param [in] sink The sink.
+   */
+  SinkLock (Sink &sink)
+    : m_sink (sink)
+  {
+    while (m_sink.lock.test_and_set (std::memory_order_acquire))
+      {
+      }
+  }
+  /** Destructor, releases the lock. */
+  ~SinkLock ()
+  {
+    m_sink.lock.clear (std::memory_order_release);
+  }
+
+private:
+  Sink &m_sink;  //!< The sink.
+};
+
+/**
+ * Copy bytes out of the ring buffer.
+ * \param [in] sink The sink.
+ * \param [in] position The position of the first byte.
+ * \param [out] data The destination.
+ * \param [in] size The number of bytes.
+ */
+void
+ReadRing (const Sink &sink, uint64_t position, uint8_t *data, uint32_t size)
+{
+  uint64_t mask = sink.buffer.size () - 1;
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      data[i] = sink.buffer[(position + i) & mask];
+    }
+}
+
+/**
+ * Write a value in a stream, in the host byte order.
+ * \param [in] os The stream.
+ * \param [in] value The value.
+ */
+template <typename T>
+void
+WriteRaw (std::ostream &os, const T &value)
+{
+  os.write (reinterpret_cast<const char *> (&value), sizeof (value));
+}
+
+/**
+ * Read a value from a stream.
+ * \param [in] is The stream.
+ * \param [out] value The value.
+ * \returns \c true if the value was read.
+ */
+template <typename T>
+bool
+ReadRaw (std::istream &is, T &value)
+{
+  is.read (reinterpret_cast<char *> (&value), sizeof (value));
+  return is.good ();
+}
+
+/**
+ * Write a string preceded by its length.
+ * \param [in] os The stream.
+ * \param [in] s The string.
+ */
+void
+WriteString (std::ostream &os, const std::string &s)
+{
+  WriteRaw (os, static_cast<uint32_t> (s.size ()));
+  os.write (s.data (), s.size ());
+}
+
+/**
+ * Read a string written by WriteString().
+ * \param [in] is The stream.
+ * \param [out] s The string.
+ * \returns \c true if the string was read.
+ */
+bool
+ReadString (std::istream &is, std::string &s)
+{
+  uint32_t size;
+  if (!ReadRaw (is, size) || size > (1 << 20))
+    {
+      return false;
+    }
+  s.resize (size);
+  is.read (&s[0], size);
+  return is.good ();
+}
+
+/**
+ * Print a Time recorded in time steps, as its output operator does
+ * with the resolution of the recording process.
+ * \param [in] steps The number of time steps.
+ * \param [in] stepsPerSecond The number of time steps per second.
+ * \param [in] os The output stream.
+ */
+void
+DecodeTime (int64_t steps, int64_t stepsPerSecond, std::ostream &os)
+{
+  const char *units[] = { "s", "ms", "us", "ns", "ps", "fs" };
+  int64_t perSecond = 1;
+  for (uint32_t i = 0; i < sizeof (units) / sizeof (units[0]); ++i, perSecond *= 1000)
+    {
+      if (perSecond == stepsPerSecond)
+        {
+          os << int64x64_t (steps) << units[i];
+          return;
+        }
+    }
+  os << int64x64_t (steps) / int64x64_t (stepsPerSecond) << "s";
+}
+
+/**
+ * Decode the values of a record, as the NS_LOG macros print them.
+ * \param [in] data The values.
+ * \param [in] size The size of the values.
+ * \param [in] kind The kind of call site.
+ * \param [in] stepsPerSecond The number of time steps per second.
+ * \param [in] os The output stream.
+ */
+void
+DecodeValues (const uint8_t *data, uint32_t size, uint32_t kind,
+              int64_t stepsPerSecond, std::ostream &os)
+{
+  bool function = (kind == BinaryLogRecord::FUNCTION);
+  bool first = true;
+  std::ios_base::fmtflags flags = os.flags ();
+  uint32_t i = 0;
+  while (i < size)
+    {
+      uint8_t type = data[i++];
+      if (type == BinaryLogRecord::FLAGS)
+        {
+          uint64_t bits;
+          std::memcpy (&bits, data + i, sizeof (bits));
+          i += sizeof (bits);
+          os.flags (static_cast<std::ios_base::fmtflags> (bits));
+          continue;
+        }
+      if (function && !first)
+        {
+          os << ", ";
+        }
+      first = false;
+      if (type == BinaryLogRecord::STRING || type == BinaryLogRecord::TEXT)
+        {
+          uint16_t length;
+          std::memcpy (&length, data + i, sizeof (length));
+          i += sizeof (length);
+          std::string s (reinterpret_cast<const char *> (data + i), length);
+          i += length;
+          if (function && type == BinaryLogRecord::STRING)
+            {
+              os << "\"" << s << "\"";
+            }
+          else
+            {
+              os << s;
+            }
+          continue;
+        }
+      uint64_t bits;
+      std::memcpy (&bits, data + i, sizeof (bits));
+      i += sizeof (bits);
+      switch (type)
+        {
+        case BinaryLogRecord::INT:
+          os << static_cast<int64_t> (bits);
+          break;
+        case BinaryLogRecord::UINT:
+          os << bits;
+          break;
+        case BinaryLogRecord::INT8:
+          if (function)
+            {
+              os << static_cast<int16_t> (static_cast<int8_t> (bits));
+            }
+          else
+            {
+              os << static_cast<signed char> (bits);
+            }
+          break;
+        case BinaryLogRecord::UINT8:
+          if (function)
+            {
+              os << static_cast<uint16_t> (static_cast<uint8_t> (bits));
+            }
+          else
+            {
+              os << static_cast<unsigned char> (bits);
+            }
+          break;
+        case BinaryLogRecord::CHAR:
+          os << static_cast<char> (bits);
+          break;
+        case BinaryLogRecord::BOOL:
+          os << (bits != 0);
+          break;
+        case BinaryLogRecord::DOUBLE:
+          {
+            double d;
+            std::memcpy (&d, &bits, sizeof (d));
+            os << d;
+          }
+          break;
+        case BinaryLogRecord::POINTER:
+          os << reinterpret_cast<const void *> (static_cast<uintptr_t> (bits));
+          break;
+        case BinaryLogRecord::TIME:
+          DecodeTime (static_cast<int64_t> (bits), stepsPerSecond, os);
+          break;
+        default:
+          os << "?";
+          break;
+        }
+    }
+  os.flags (flags);
+}
+
+} // unnamed namespace
+
+void
+BinaryLogSink::Enable (uint32_t capacity)
+{
+  NS_ABORT_MSG_IF (capacity > (1u << 31), "BinaryLogSink::Enable(): the capacity " <<
+                  capacity << " is larger than 2^31 bytes");
+  Sink &sink = GetSink ();
+  SinkLock lock (sink);
+  uint32_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  sink.buffer.assign (size, 0);
+  sink.recordCount = 0;
+  sink.lostCount = 0;
+  sink.head = 0;
+  sink.tail = 0;
+  g_enabled.store (true, std::memory_order_release);
+}
+
+void
+BinaryLogSink::Disable (void)
+{
+  Sink &sink = GetSink ();
+  SinkLock lock (sink);
+  g_enabled.store (false, std::memory_order_release);
+  std::vector<uint8_t> empty;
+  sink.buffer.swap (empty);
+  sink.recordCount = 0;
+  sink.head = 0;
+  sink.tail = 0;
+}
+
+bool
+BinaryLogSink::IsEnabled (void)
+{
+  return g_enabled.load (std::memory_order_relaxed);
+}
+
+uint64_t
+BinaryLogSink::GetRecordCount (void)
+{
+  Sink &sink = GetSink ();
+  SinkLock lock (sink);
+  return sink.recordCount;
+}
+
+uint64_t
+BinaryLogSink::GetLostCount (void)
+{
+  Sink &sink = GetSink ();
+  SinkLock lock (sink);
+  return sink.lostCount;
+}
+
+void
+BinaryLogSink::Commit (const uint8_t *data, uint32_t size)
+{
+  Sink &sink = GetSink ();
+  SinkLock lock (sink);
+  uint64_t capacity = sink.buffer.size ();
+  if (size > capacity)
+    {
+      return;
+    }
+  // make room by dropping the oldest records
+  while (sink.head + size - sink.tail > capacity)
+    {
+      uint32_t oldSize;
+      ReadRing (sink, sink.tail, reinterpret_cast<uint8_t *> (&oldSize), sizeof (oldSize));
+      sink.tail += oldSize;
+      sink.recordCount--;
+      sink.lostCount++;
+    }
+  uint64_t mask = capacity - 1;
+  uint64_t start = sink.head & mask;
+  uint64_t first = std::min<uint64_t> (size, capacity - start);
+  std::memcpy (&sink.buffer[start], data, first);
+  std::memcpy (&sink.buffer[0], data + first, size - first);
+  sink.head += size;
+  sink.recordCount++;
+}
+
+void
+BinaryLogSink::Write (std::ostream &os)
+{
+  Sink &sink = GetSink ();
+  SinkLock lock (sink);
+  os.write (MAGIC, sizeof (MAGIC));
+  WriteRaw (os, static_cast<int64_t> (Seconds (1).GetTimeStep ()));
+  WriteRaw (os, static_cast<uint32_t> (sink.formats.size ()));
+  for (std::vector<Format>::const_iterator i = sink.formats.begin (); i != sink.formats.end (); ++i)
+    {
+      WriteString (os, i->component);
+      WriteString (os, i->function);
+      WriteString (os, i->file);
+      WriteRaw (os, i->line);
+      WriteRaw (os, i->level);
+      WriteRaw (os, i->kind);
+    }
+  WriteRaw (os, sink.recordCount);
+  WriteRaw (os, sink.lostCount);
+  std::vector<uint8_t> record;
+  for (uint64_t position = sink.tail; position != sink.head; )
+    {
+      uint32_t size;
+      ReadRing (sink, position, reinterpret_cast<uint8_t *> (&size), sizeof (size));
+      record.resize (size);
+      ReadRing (sink, position, &record[0], size);
+      os.write (reinterpret_cast<const char *> (&record[0]), size);
+      position += size;
+    }
+}
+
+bool
+BinaryLogSink::Decode (std::istream &is, std::ostream &os)
+{
+  char magic[sizeof (MAGIC)];
+  is.read (magic, sizeof (magic));
+  if (!is.good () || std::memcmp (magic, MAGIC, sizeof (MAGIC)) != 0)
+    {
+      return false;
+    }
+  int64_t stepsPerSecond;
+  uint32_t nFormats;
+  if (!ReadRaw (is, stepsPerSecond) || stepsPerSecond <= 0 || !ReadRaw (is, nFormats))
+    {
+      return false;
+    }
+  std::vector<Format> formats (nFormats);
+  for (uint32_t i = 0; i < nFormats; ++i)
+    {
+      Format &f = formats[i];
+      if (!ReadString (is, f.component) || !ReadString (is, f.function)
+          || !ReadString (is, f.file) || !ReadRaw (is, f.line)
+          || !ReadRaw (is, f.level) || !ReadRaw (is, f.kind))
+        {
+          return false;
+        }
+    }
+  uint64_t recordCount;
+  uint64_t lostCount;
+  if (!ReadRaw (is, recordCount) || !ReadRaw (is, lostCount))
+    {
+      return false;
+    }
+  if (lostCount > 0)
+    {
+      os << "(" << lostCount << " earlier records overwritten)" << std::endl;
+    }
+
+  std::vector<uint8_t> values;
+  for (uint64_t r = 0; r < recordCount; ++r)
+    {
+      Header header;
+      if (!ReadRaw (is, header) || header.size < sizeof (header)
+          || header.format >= nFormats)
+        {
+          return false;
+        }
+      values.resize (header.size - sizeof (header));
+      if (!values.empty ())
+        {
+          is.read (reinterpret_cast<char *> (&values[0]), values.size ());
+          if (!is.good ())
+            {
+              return false;
+            }
+        }
+      const Format &f = formats[header.format];
+      // same layout as the text output with all the prefixes enabled
+      if (header.flags & HAS_TIME)
+        {
+          os << "+" << static_cast<double> (header.ts) / stepsPerSecond << "s ";
+          if (header.context == Simulator::NO_CONTEXT)
+            {
+              os << "-1 ";
+            }
+          else
+            {
+              os << header.context << " ";
+            }
+        }
+      os << f.component << ":" << f.function;
+      if (f.kind == BinaryLogRecord::FUNCTION)
+        {
+          os << "(";
+          DecodeValues (values.empty () ? 0 : &values[0], values.size (), f.kind,
+                        stepsPerSecond, os);
+          os << ")";
+        }
+      else
+        {
+          os << "(): [" << LogComponent::GetLevelLabel (static_cast<enum LogLevel> (f.level)) << "] ";
+          DecodeValues (values.empty () ? 0 : &values[0], values.size (), f.kind,
+                        stepsPerSecond, os);
+        }
+      os << std::endl;
+    }
+  return true;
+}
+
+bool
+BinaryLogRecord::IsEnabled (void)
+{
+  return g_enabled.load (std::memory_order_relaxed);
+}
+
+uint32_t
+BinaryLogRecord::RegisterFormat (const char *component, const char *function,
+                                 const char *file, int line,
+                                 enum LogLevel level, enum Kind kind)
+{
+  Sink &sink = GetSink ();
+  SinkLock lock (sink);
+  Format format;
+  format.component = component;
+  format.function = function;
+  format.file = file;
+  format.line = line;
+  format.level = level;
+  format.kind = kind;
+  sink.formats.push_back (format);
+  return sink.formats.size () - 1;
+}
+
+BinaryLogRecord::BinaryLogRecord (uint32_t format)
+  : m_size (sizeof (Header))
+{
+  Header header;
+  header.size = 0;
+  header.format = format;
+  header.ts = 0;
+  header.context = Simulator::NO_CONTEXT;
+  header.flags = 0;
+  // the time printer is only set while a simulator implementation exists,
+  // calling Simulator::Now () otherwise could create one from here
+  if (LogGetTimePrinter () != 0)
+    {
+      header.ts = Simulator::Now ().GetTimeStep ();
+      header.context = Simulator::GetContext ();
+      header.flags = HAS_TIME;
+    }
+  std::memcpy (m_data, &header, sizeof (header));
+}
+
+BinaryLogRecord::~BinaryLogRecord ()
+{
+  std::memcpy (m_data, &m_size, sizeof (m_size));
+  BinaryLogSink::Commit (m_data, m_size);
+}
+
+void
+BinaryLogRecord::Append (enum Type type, uint64_t bits)
+{
+  if (m_size + 1 + sizeof (bits) > MAX_SIZE)
+    {
+      return;
+    }
+  m_data[m_size] = type;
+  std::memcpy (m_data + m_size + 1, &bits, sizeof (bits));
+  m_size += 1 + sizeof (bits);
+}
+
+void
+BinaryLogRecord::Append (enum Type type, const char *data, std::size_t size)
+{
+  uint16_t length;
+  if (m_size + 1 + sizeof (length) > MAX_SIZE)
+    {
+      return;
+    }
+  length = std::min<std::size_t> (size, MAX_SIZE - m_size - 1 - sizeof (length));
+  m_data[m_size] = type;
+  std::memcpy (m_data + m_size + 1, &length, sizeof (length));
+  std::memcpy (m_data + m_size + 1 + sizeof (length), data, length);
+  m_size += 1 + sizeof (length) + length;
+}
+
+BinaryLogRecord &
+BinaryLogRecord::operator<< (const char *value)
+{
+  if (value == 0)
+    {
+      value = "(null)";
+    }
+  Append (STRING, value, std::strlen (value));
+  return *this;
+}
+
+BinaryLogRecord &
+BinaryLogRecord::operator<< (const std::string &value)
+{
+  Append (STRING, value.data (), value.size ());
+  return *this;
+}
+
+BinaryLogRecord &
+BinaryLogRecord::operator<< (const Time &value)
+{
+  Append (TIME, static_cast<uint64_t> (value.GetTimeStep ()));
+  return *this;
+}
+
+BinaryLogRecord &
+BinaryLogRecord::operator<< (std::ostream & (*manip)(std::ostream &))
+{
+  if (manip == static_cast<std::ostream & (*)(std::ostream &)> (&std::endl))
+    {
+      Append (TEXT, "\n", 1);
+    }
+  return *this;
+}
+
+BinaryLogRecord &
+BinaryLogRecord::operator<< (std::ios_base & (*manip)(std::ios_base &))
+{
+  // apply the manipulator to a stream with the default flags, to learn
+  // the flags the decoder should set
+  std::ostringstream oss;
+  // keep the flags set by previous manipulators in this record
+  uint32_t i = sizeof (Header);
+  while (i < m_size)
+    {
+      uint8_t type = m_data[i];
+      if (type == FLAGS)
+        {
+          uint64_t bits;
+          std::memcpy (&bits, m_data + i + 1, sizeof (bits));
+          oss.flags (static_cast<std::ios_base::fmtflags> (bits));
+        }
+      if (type == STRING || type == TEXT)
+        {
+          uint16_t length;
+          std::memcpy (&length, m_data + i + 1, sizeof (length));
+          i += 1 + sizeof (length) + length;
+        }
+      else
+        {
+          i += 1 + sizeof (uint64_t);
+        }
+    }
+  manip (oss);
+  Append (FLAGS, static_cast<uint64_t> (oss.flags ()));
+  return *this;
+}
+
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_LOG_SINK_H
+#define BINARY_LOG_SINK_H
+
+#include "binary-log-record.h"
+
+#include <iostream>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::BinaryLogSink declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup logging
+ *
+ * \brief A ring buffer recording the log messages in binary form.
+ *
+ * While the sink is enabled, the NS_LOG macros of the enabled log
+ * components do not format their message: they append to a ring buffer
+ * the simulation time, the context, a format id identifying the call
+ * site (component, function, file, line and level) and the raw values
+ * streamed in the message.  Numbers, pointers, strings and Time values
+ * are copied as they are.  Other objects, such as addresses, are still
+ * converted to text with their output operator at the call site, which
+ * costs as much as the text output for these values.  When the buffer
+ * is full the oldest records are overwritten, so the buffer holds the
+ * most recent messages.
+ *
+ * The buffer is written to a file with Write(), and decoded offline
+ * with Decode() into the text the NS_LOG macros would have printed:
+ * \code
+ *   BinaryLogSink::Enable (1 << 24);
+ *   LogComponentEnable ("UdpEchoClientApplication", LOG_LEVEL_ALL);
+ *   Simulator::Run ();
+ *   std::ofstream os ("trace.bin", std::ios::binary);
+ *   BinaryLogSink::Write (os);
+ * \endcode
+ *
+ * Unlike the text output, the records do not include the output of
+ * NS_LOG_APPEND_CONTEXT, and stream manipulators other than std::endl
+ * and the std::ios_base ones (such as std::hex) are ignored.
+ */
+class BinaryLogSink
+{
+public:
+  /**
+   * Start recording the log messages in a new ring buffer.
+   * \param [in] capacity The size of the ring buffer, in bytes, rounded
+   *             up to a power of two; at most 2^31.
+   */
+  static void Enable (uint32_t capacity);
+  /** Stop recording and release the ring buffer. */
+  static void Disable (void);
+  /**
+   * Check if the log messages are recorded.
+   * \returns \c true if the sink is enabled.
+   */
+  static bool IsEnabled (void);
+  /**
+   * Get the number of records currently held by the ring buffer.
+   * \returns The number of records.
+   */
+  static uint64_t GetRecordCount (void);
+  /**
+   * Get the number of records overwritten since the sink was enabled.
+   * \returns The number of records lost.
+   */
+  static uint64_t GetLostCount (void);
+  /**
+   * Write the call sites and the records of the ring buffer.
+   * \param [in] os The output stream, opened in binary mode.
+   */
+  static void Write (std::ostream &os);
+  /**
+   * Decode a file written by Write().
+   * \param [in] is The input stream, opened in binary mode.
+   * \param [in] os The output stream for the text messages.
+   * \returns \c false if the input is not a valid binary log.
+   */
+  static bool Decode (std::istream &is, std::ostream &os);
+
+private:
+  friend class BinaryLogRecord;
+
+  /**
+   * Append a record to the ring buffer.
+   * \param [in] data The record.
+   * \param [in] size The record size.
+   */
+  static void Commit (const uint8_t *data, uint32_t size);
+};
+
+} // namespace ns3
+
+#endif /* BINARY_LOG_SINK_H */
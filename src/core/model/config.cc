@@ -26,6 +26,8 @@
 #include "pointer.h"
 #include "log.h"
 
+#include <algorithm>
+#include <map>
 #include <sstream>
 
 /**
@@ -150,10 +152,16 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 /**
  * \ingroup config-impl
  * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once, into the sorted ranges of the
+ * indices which match it.
  */
 class ArrayMatcher
 {
 public:
+  /** The ranges of matching indices, sorted and disjoint. */
+  typedef std::vector<std::pair<uint32_t, uint32_t> > Ranges;
+
   /**
    * Construct from a Config path specification.
    *
@@ -161,14 +169,26 @@ public:
    */
   ArrayMatcher (std::string element);
   /**
-   * Test if a specific index matches the Config Path.
+   * Test if all the indices match the Config Path.
+   *
+   * \returns \c true if the specification contains a "*".
+   */
+  bool MatchesAll (void) const;
+  /**
+   * Get the ranges of the indices which match the Config path,
+   * if not all of them match.
    *
-   * \param [in] i The index.
-   * \returns \c true if the index matches the Config Path.
+   * \returns The ranges of indices.
    */
-  bool Matches (std::size_t i) const;
+  const Ranges & GetRanges (void) const;
 
 private:
+  /**
+   * Add the indices matching a part of the specification.
+   *
+   * \param [in] element The part of the Config path specification.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -179,77 +199,91 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** All the indices match. */
+  bool m_all;
+  /** The ranges of matching indices. */
+  Ranges m_ranges;
 
 };  // class ArrayMatcher
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
+  std::sort (m_ranges.begin (), m_ranges.end ());
+  // merge the overlapping ranges, so that each index matches once
+  Ranges merged;
+  for (Ranges::const_iterator i = m_ranges.begin (); i != m_ranges.end (); ++i)
+    {
+      if (!merged.empty () && i->first <= merged.back ().second)
+        {
+          merged.back ().second = std::max (merged.back ().second, i->second);
+        }
+      else
+        {
+          merged.push_back (*i);
+        }
+    }
+  m_ranges.swap (merged);
 }
 bool
-ArrayMatcher::Matches (std::size_t i) const
+ArrayMatcher::MatchesAll (void) const
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  return m_all;
+}
+const ArrayMatcher::Ranges &
+ArrayMatcher::GetRanges (void) const
+{
+  return m_ranges;
+}
+void
+ArrayMatcher::Parse (std::string element)
+{
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array " << i << " matches *");
-      return true;
+      NS_LOG_DEBUG ("Array matches *");
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp - 0);
-      std::string right = m_element.substr (tmp + 1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array " << i << " does not match " << m_element);
-      return false;
+      std::string left = element.substr (0, tmp - 0);
+      std::string right = element.substr (tmp + 1, element.size () - (tmp + 1));
+      Parse (left);
+      Parse (right);
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1
       && dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min)
           && StringToUint32 (upperBound, &max)
-          && i >= min && i <= max)
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
-          return true;
-        }
-      else
+          && min <= max)
         {
-          NS_LOG_DEBUG ("Array " << i << " does not " << m_element);
-          return false;
+          NS_LOG_DEBUG ("Array [" << min << "-" << max << "] matches " << element);
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value)
-      && i == value)
+  if (StringToUint32 (element, &value))
     {
-      NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
-      return true;
+      NS_LOG_DEBUG ("Array " << value << " matches " << element);
+      m_ranges.push_back (std::make_pair (value, value));
     }
-  NS_LOG_DEBUG ("Array " << i << " does not match " << m_element);
-  return false;
 }
 
 bool
@@ -262,9 +296,275 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * \ingroup config-impl
+ * What the Resolver learns about the objects while resolving Config
+ * paths, to resolve the next paths faster.
+ *
+ * The attributes matching the items of the paths depend only on the
+ * TypeIds of the objects and are kept forever.  The contents of the
+ * containers of objects, and the objects matching whole paths, are
+ * kept until the generation of the graph of objects changes.  They are
+ * kept with plain pointers: the objects are marked, so that their
+ * destruction starts a new generation.  Since some models remove objects from their containers
+ * without starting a new generation, the sizes of the containers are
+ * also checked before their contents, or the objects found through
+ * them, are used again.
+ */
+class ResolverCache
+{
+public:
+  /** An attribute through which a Config path goes. */
+  struct Attribute
+  {
+    std::string name;  //!< The name of the attribute.
+    bool isContainer;  //!< It holds a container of objects, else a pointer to an object.
+    /** The accessor of the container, if any. */
+    Ptr<const ObjectPtrContainerAccessor> accessor;
+  };
+  /** The attributes matching an item of a Config path. */
+  typedef std::vector<Attribute> Attributes;
+  /** The objects of a container, sorted by index. */
+  typedef std::vector<std::pair<std::size_t, Object *> > Container;
+  /** The size of a container of an object. */
+  struct ContainerSize
+  {
+    const Object *object;                            //!< The object.
+    Ptr<const ObjectPtrContainerAccessor> accessor;  //!< The accessor of the container.
+    std::size_t size;                                //!< The number of objects of the container.
+  };
+  /** The objects matching a Config path, and their paths. */
+  struct Matches
+  {
+    std::vector<Object *> objects;      //!< The objects.
+    std::vector<std::string> contexts;  //!< The resolved paths.
+    /** The containers through which the objects were found. */
+    std::vector<ContainerSize> containers;
+  };
+
+  /** Constructor. */
+  ResolverCache ();
+  /** Forget the objects if the graph of objects changed since they were found. */
+  void Update (void);
+  /** Forget the objects. */
+  void Clear (void);
+  /**
+   * Get the attributes of an object matching an item of a Config path.
+   *
+   * \param [in] tid The TypeId of the object.
+   * \param [in] item The item of the Config path, a name or "*".
+   * \returns The pointer and container attributes matching the item,
+   *          those of \p tid first and then those of its parents.
+   */
+  const Attributes & GetAttributes (TypeId tid, const std::string &item);
+  /**
+   * Get the objects of a container attribute.
+   *
+   * \param [in] object The object with the attribute.
+   * \param [in] attribute The container attribute.
+   * \returns The objects of the container.
+   */
+  const Container & GetContainer (Ptr<Object> object, const Attribute &attribute);
+  /**
+   * Find the objects matching a Config path, if the containers through
+   * which they were found kept their sizes.
+   *
+   * \param [in] path The Config path.
+   * \returns The objects, or 0 if they were not stored.
+   */
+  const Matches * FindMatches (const std::string &path);
+  /**
+   * Store the objects matching a Config path, with the containers got
+   * since the last call to FindMatches().
+   *
+   * \param [in] path The Config path.
+   * \param [in] matches The objects matching the path.
+   */
+  void AddMatches (const std::string &path, const Matches &matches);
+
+private:
+  /**
+   * Mark an object kept with a plain pointer, so that its destruction
+   * starts a new generation of the graph of objects.
+   *
+   * \param [in] object The object.
+   * \returns The object.
+   */
+  static Object * Keep (Object *object);
+
+  /** The maximum number of Config paths whose matches are stored. */
+  static const std::size_t MAX_MATCHES = 256;
+
+  /** The attributes by TypeId uid and item. */
+  std::map<std::pair<uint16_t, std::string>, Attributes> m_attributes;
+  /** The containers by object and attribute name. */
+  std::map<std::pair<const Object *, std::string>, Container> m_containers;
+  /** The matching objects by Config path. */
+  std::map<std::string, Matches> m_matches;
+  /** The containers got since the last call to FindMatches(). */
+  std::vector<ContainerSize> m_visited;
+  /** The generation of the graph of objects of the containers and matches. */
+  uint64_t m_generation;
+
+};  // class ResolverCache
+
+ResolverCache::ResolverCache ()
+  : m_generation (Object::GetGraphGeneration ())
+{
+  NS_LOG_FUNCTION (this);
+}
+void
+ResolverCache::Update (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_generation != Object::GetGraphGeneration ())
+    {
+      NS_LOG_LOGIC ("The graph of objects changed");
+      Clear ();
+    }
+}
+void
+ResolverCache::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_containers.clear ();
+  m_matches.clear ();
+  m_visited.clear ();
+  m_generation = Object::GetGraphGeneration ();
+}
+const ResolverCache::Attributes &
+ResolverCache::GetAttributes (TypeId tid, const std::string &item)
+{
+  NS_LOG_FUNCTION (this << tid << item);
+  std::pair<uint16_t, std::string> key (tid.GetUid (), item);
+  std::map<std::pair<uint16_t, std::string>, Attributes>::const_iterator found = m_attributes.find (key);
+  if (found != m_attributes.end ())
+    {
+      return found->second;
+    }
+  Attributes &attributes = m_attributes[key];
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute (i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          // attempt to cast to a pointer checker.
+          Attribute attribute;
+          attribute.name = info.name;
+          if (info.isPointer)
+            {
+              attribute.isContainer = false;
+              attributes.push_back (attribute);
+            }
+          // attempt to cast to an object vector.
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isContainer = true;
+              attribute.accessor = dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (info.accessor));
+              attributes.push_back (attribute);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    }
+  while (nextTid != tid);
+  return attributes;
+}
+Object *
+ResolverCache::Keep (Object *object)
+{
+  if (object != 0)
+    {
+      object->m_resolved = true;
+    }
+  return object;
+}
+const ResolverCache::Container &
+ResolverCache::GetContainer (Ptr<Object> object, const Attribute &attribute)
+{
+  NS_LOG_FUNCTION (this << object << attribute.name);
+  std::size_t size = 0;
+  bool sized = attribute.accessor != 0 && attribute.accessor->GetN (PeekPointer (object), &size);
+  std::pair<const Object *, std::string> key (Keep (PeekPointer (object)), attribute.name);
+  Container &container = m_containers[key];
+  if (!container.empty () && (!sized || container.size () != size))
+    {
+      NS_LOG_LOGIC ("The container " << attribute.name << " changed");
+      container.clear ();
+    }
+  if (container.empty ())
+    {
+      ObjectPtrContainerValue value;
+      object->GetAttribute (attribute.name, value);
+      container.reserve (value.GetN ());
+      for (ObjectPtrContainerValue::Iterator it = value.Begin (); it != value.End (); ++it)
+        {
+          container.push_back (std::make_pair (it->first, Keep (PeekPointer (it->second))));
+        }
+    }
+  if (sized)
+    {
+      ContainerSize visited = { PeekPointer (object), attribute.accessor, container.size () };
+      m_visited.push_back (visited);
+    }
+  return container;
+}
+const ResolverCache::Matches *
+ResolverCache::FindMatches (const std::string &path)
+{
+  NS_LOG_FUNCTION (this << path);
+  // the path is resolved again if its matches are not found
+  m_visited.clear ();
+  std::map<std::string, Matches>::iterator found = m_matches.find (path);
+  if (found == m_matches.end ())
+    {
+      return 0;
+    }
+  const std::vector<ContainerSize> &containers = found->second.containers;
+  for (std::vector<ContainerSize>::const_iterator i = containers.begin (); i != containers.end (); ++i)
+    {
+      std::size_t size;
+      if (!i->accessor->GetN (i->object, &size) || size != i->size)
+        {
+          NS_LOG_LOGIC ("A container of the path " << path << " changed");
+          m_matches.erase (found);
+          return 0;
+        }
+    }
+  return &found->second;
+}
+void
+ResolverCache::AddMatches (const std::string &path, const Matches &matches)
+{
+  NS_LOG_FUNCTION (this << path);
+  if (m_matches.size () >= MAX_MATCHES)
+    {
+      m_matches.clear ();
+    }
+  Matches &stored = m_matches[path];
+  stored = matches;
+  for (std::vector<Object *>::const_iterator i = stored.objects.begin (); i != stored.objects.end (); ++i)
+    {
+      Keep (*i);
+    }
+  stored.containers.swap (m_visited);
+  m_visited.clear ();
+}
+
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
+ *
+ * The path is split once into its items; the array specifications are
+ * parsed when they are first used.
  */
 class Resolver
 {
@@ -273,8 +573,9 @@ public:
    * Construct from a base Config path.
    *
    * \param [in] path The Config path.
+   * \param [in] cache The memory of the previous resolutions.
    */
-  Resolver (std::string path);
+  Resolver (std::string path, ResolverCache *cache);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -288,23 +589,24 @@ public:
   void Resolve (Ptr<Object> root);
 
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
+  /** Ensure the Config path starts and ends with a '/', and split it. */
   void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] next The index of the next item of the Config path.
    * \param [in] root The object corresponding to the current position
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t next, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] next The index of the item of the Config path
+   *                  specifying the array indices.
+   * \param [in] container The objects of the array.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (std::size_t next, const ResolverCache::Container &container);
   /**
    * Handle one object found on the path.
    *
@@ -317,6 +619,13 @@ private:
    * \returns The current Config path.
    */
   std::string GetResolvedPath (void) const;
+  /**
+   * Get the matcher of an item of the Config path.
+   *
+   * \param [in] next The index of the item.
+   * \returns The matcher of the item.
+   */
+  const ArrayMatcher & GetMatcher (std::size_t next);
   /**
    * Handle one found object.
    *
@@ -329,13 +638,20 @@ private:
   std::vector<std::string> m_workStack;
   /** The Config path. */
   std::string m_path;
+  /** The items of the Config path, between its slashes. */
+  std::vector<std::string> m_items;
+  /** The matchers of the items specifying array indices. */
+  std::map<std::size_t, ArrayMatcher> m_matchers;
+  /** The memory of the previous resolutions. */
+  ResolverCache *m_cache;
 
 };  // class Resolver
 
-Resolver::Resolver (std::string path)
-  : m_path (path)
+Resolver::Resolver (std::string path, ResolverCache *cache)
+  : m_path (path),
+    m_cache (cache)
 {
-  NS_LOG_FUNCTION (this << path);
+  NS_LOG_FUNCTION (this << path << cache);
   Canonicalize ();
 }
 Resolver::~Resolver ()
@@ -360,6 +676,14 @@ Resolver::Canonicalize (void)
       // no slash at end
       m_path = m_path + "/";
     }
+
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = m_path.find ("/", start)) != std::string::npos)
+    {
+      m_items.push_back (m_path.substr (start, next - start));
+      start = next + 1;
+    }
 }
 
 void
@@ -367,7 +691,7 @@ Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -383,6 +707,18 @@ Resolver::GetResolvedPath (void) const
   return fullPath;
 }
 
+const ArrayMatcher &
+Resolver::GetMatcher (std::size_t next)
+{
+  NS_LOG_FUNCTION (this << next);
+  std::map<std::size_t, ArrayMatcher>::const_iterator found = m_matchers.find (next);
+  if (found == m_matchers.end ())
+    {
+      found = m_matchers.insert (std::make_pair (next, ArrayMatcher (m_items[next]))).first;
+    }
+  return found->second;
+}
+
 void
 Resolver::DoResolveOne (Ptr<Object> object)
 {
@@ -393,13 +729,11 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (std::size_t next, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << next << root);
 
-  if (next == std::string::npos)
+  if (next == m_items.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name
@@ -415,8 +749,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next - 1);
-  std::string pathLeft = path.substr (next, path.size () - next);
+  const std::string &item = m_items[next];
 
   //
   // If root is zero, we're beginning to see if we can use the object name
@@ -427,11 +760,11 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
+      std::string::size_type offset = item.find ("Names");
       if (offset == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (next + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -448,7 +781,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (next + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -478,68 +811,44 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (next + 1, object);
       m_workStack.pop_back ();
     }
   else
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
       bool foundMatch = false;
-
-      do
+      const ResolverCache::Attributes &attributes = m_cache->GetAttributes (root->GetInstanceTypeId (), item);
+      for (ResolverCache::Attributes::const_iterator i = attributes.begin (); i != attributes.end (); ++i)
         {
-          tid = nextTid;
-
-          for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+          if (!i->isContainer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute (i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)=" << i->name << " on path=" << GetResolvedPath ());
+              PointerValue pValue;
+              root->GetAttribute (i->name, pValue);
+              Ptr<Object> object = pValue.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\"" << item <<
+                                "\" exists on path=\"" << GetResolvedPath () << "\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (pChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)=" << info.name << " on path=" << GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\"" << item <<
-                                    "\" exists on path=\"" << GetResolvedPath () << "\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker =
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)=" << info.name << " on path=" << GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              foundMatch = true;
+              m_workStack.push_back (i->name);
+              DoResolve (next + 1, object);
+              m_workStack.pop_back ();
+            }
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)=" << i->name << " on path=" << GetResolvedPath ());
+              foundMatch = true;
+              const ResolverCache::Container &container = m_cache->GetContainer (root, *i);
+              m_workStack.push_back (i->name);
+              DoArrayResolve (next + 1, container);
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
         }
-      while (nextTid != tid);
 
       if (!foundMatch)
         {
@@ -550,31 +859,45 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (std::size_t next, const ResolverCache::Container &container)
 {
-  NS_LOG_FUNCTION (this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << next << &container);
+  if (next == m_items.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next - 1);
-  std::string pathLeft = path.substr (next, path.size () - next);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
-  ObjectPtrContainerValue::Iterator it;
-  for (it = container.Begin (); it != container.End (); ++it)
+  // visit the matching objects in the order of their indices, looking
+  // up the ranges of indices rather than testing every object
+  const ArrayMatcher &matcher = GetMatcher (next);
+  ResolverCache::Container::const_iterator it = container.begin ();
+  ArrayMatcher::Ranges::const_iterator range = matcher.GetRanges ().begin ();
+  while (it != container.end ())
     {
-      if (matcher.Matches ((*it).first))
+      if (!matcher.MatchesAll ())
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          while (range != matcher.GetRanges ().end () && range->second < it->first)
+            {
+              ++range;
+            }
+          if (range == matcher.GetRanges ().end ())
+            {
+              break;
+            }
+          if (it->first < range->first)
+            {
+              it = std::lower_bound (it, container.end (),
+                                     std::make_pair (static_cast<std::size_t> (range->first),
+                                                     static_cast<Object *> (0)));
+              continue;
+            }
         }
+      std::ostringstream oss;
+      oss << it->first;
+      m_workStack.push_back (oss.str ());
+      DoResolve (next + 1, it->second);
+      m_workStack.pop_back ();
+      ++it;
     }
 }
 
@@ -623,6 +946,8 @@ private:
 
   /** The list of Config path roots. */
   Roots m_roots;
+  /** The memory of the previous resolutions. */
+  ResolverCache m_cache;
 
 };  // class ConfigImpl
 
@@ -719,11 +1044,20 @@ MatchContainer
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  m_cache.Update ();
+  const ResolverCache::Matches *matches = m_cache.FindMatches (path);
+  if (matches != 0)
+    {
+      NS_LOG_LOGIC ("Path " << path << " resolved in the same generation");
+      std::vector<Ptr<Object> > objects (matches->objects.begin (), matches->objects.end ());
+      return MatchContainer (objects, matches->contexts, path);
+    }
+
   class LookupMatchesResolver : public Resolver
   {
   public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
+    LookupMatchesResolver (std::string path, ResolverCache *cache)
+      : Resolver (path, cache)
     {}
     virtual void DoOne (Ptr<Object> object, std::string path)
     {
@@ -732,7 +1066,7 @@ ConfigImpl::LookupMatches (std::string path)
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  } resolver = LookupMatchesResolver (path, &m_cache);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -745,6 +1079,15 @@ ConfigImpl::LookupMatches (std::string path)
   //
   resolver.Resolve (0);
 
+  ResolverCache::Matches found;
+  for (std::vector<Ptr<Object> >::const_iterator i = resolver.m_objects.begin ();
+       i != resolver.m_objects.end (); ++i)
+    {
+      found.objects.push_back (PeekPointer (*i));
+    }
+  found.contexts = resolver.m_contexts;
+  m_cache.AddMatches (path, found);
+
   return MatchContainer (resolver.m_objects, resolver.m_contexts, path);
 }
 
@@ -753,6 +1096,7 @@ ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
   NS_LOG_FUNCTION (this << obj);
   m_roots.push_back (obj);
+  m_cache.Clear ();
 }
 
 void
@@ -765,6 +1109,7 @@ ConfigImpl::UnregisterRootNamespaceObject (Ptr<Object> obj)
       if (*i == obj)
         {
           m_roots.erase (i);
+          m_cache.Clear ();
           return;
         }
     }
@@ -255,6 +255,14 @@ private:
  * \param [in] path The path to perform a match against
  * \returns A container which contains all the objects which match the input
  *          path.
+ *
+ * The objects matching a path, and the contents of the containers of
+ * objects on the way, are remembered until the graph of objects changes
+ * (see Object::GetGraphGeneration()), or until one of these containers
+ * changes its size, so that the lookups of the same
+ * path, and of the paths through the same large containers such as
+ * /NodeList, do not walk the whole graph again.  The functions which
+ * connect and set through paths share these lookups.
  */
 MatchContainer LookupMatches (std::string path);
 
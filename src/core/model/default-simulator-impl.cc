@@ -46,6 +46,88 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+namespace {
+
+/** Capacity of the queue of the events scheduled by other threads. */
+const uint32_t EVENTS_WITH_CONTEXT_CAPACITY = 1024;
+
+} // unnamed namespace
+
+/**
+ * \ingroup simulator
+ *
+ * The events of a batch have consecutive uids and the same timestamp,
+ * so no other event can be ordered between them: the batch is
+ * inserted in the event list as a single event, with the uid of its
+ * first event, which executes them in turn with their own context and
+ * uid.
+ */
+class DefaultSimulatorImpl::BatchEventImpl : public EventImpl
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] impl The simulator implementation.
+   * \param [in] batch The events of the batch.
+   * \param [in] uid The uid of the first event of the batch.
+   */
+  BatchEventImpl (DefaultSimulatorImpl *impl, const Simulator::EventBatch &batch, uint32_t uid)
+    : m_impl (impl),
+      m_batch (batch),
+      m_uid (uid),
+      m_next (0)
+  {}
+  virtual ~BatchEventImpl ()
+  {
+    // the events not executed when the simulator is destroyed
+    for (std::size_t i = m_next; i < m_batch.size (); ++i)
+      {
+        m_batch[i].event->Unref ();
+      }
+  }
+
+protected:
+  virtual void Notify (void)
+  {
+    // ProcessOneEvent already counted the first event
+    bool first = true;
+    while (m_next < m_batch.size ())
+      {
+        Simulator::BatchEvent &ev = m_batch[m_next];
+        if (!first)
+          {
+            m_impl->m_eventCount++;
+          }
+        first = false;
+        m_impl->m_currentContext = ev.context;
+        m_impl->m_currentUid = m_uid + m_next;
+        m_next++;
+        ev.event->Invoke ();
+        ev.event->Unref ();
+        if (m_impl->m_stop && m_next < m_batch.size ())
+          {
+            // Put back the rest of the batch, to resume it if Run is
+            // called again.
+            Scheduler::Event rest;
+            rest.impl = this;
+            rest.key.m_ts = m_impl->m_currentTs;
+            rest.key.m_context = m_batch[m_next].context;
+            rest.key.m_uid = m_uid + m_next;
+            Ref ();
+            m_impl->m_unscheduledEvents++;
+            m_impl->m_events->Insert (rest);
+            return;
+          }
+      }
+  }
+
+private:
+  DefaultSimulatorImpl *m_impl;   //!< The simulator implementation.
+  Simulator::EventBatch m_batch;  //!< The events of the batch.
+  uint32_t m_uid;                 //!< The uid of the first event.
+  std::size_t m_next;             //!< The index of the next event to execute.
+};
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -58,6 +140,8 @@ DefaultSimulatorImpl::GetTypeId (void)
 }
 
 DefaultSimulatorImpl::DefaultSimulatorImpl ()
+  : m_eventsWithContext (EVENTS_WITH_CONTEXT_CAPACITY),
+    m_eventsWithContextOverflowing (false)
 {
   NS_LOG_FUNCTION (this);
   m_stop = false;
@@ -72,7 +156,6 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_eventCount = 0;
-  m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self ();
 }
 
@@ -160,33 +243,52 @@ DefaultSimulatorImpl::IsFinished (void) const
   return m_events->IsEmpty () || m_stop;
 }
 
+void
+DefaultSimulatorImpl::InsertEventWithContext (const EventWithContext &event)
+{
+  Scheduler::Event ev;
+  ev.impl = event.event;
+  ev.key.m_ts = m_currentTs + event.timestamp;
+  ev.key.m_context = event.context;
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext.IsEmpty ()
+      && !m_eventsWithContextOverflowing.load (std::memory_order_acquire))
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap (eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  EventWithContext event;
+  while (m_eventsWithContext.Pop (event))
     {
-      EventWithContext event = eventsWithContext.front ();
-      eventsWithContext.pop_front ();
-      Scheduler::Event ev;
-      ev.impl = event.event;
-      ev.key.m_ts = m_currentTs + event.timestamp;
-      ev.key.m_context = event.context;
-      ev.key.m_uid = m_uid;
-      m_uid++;
-      m_unscheduledEvents++;
-      m_events->Insert (ev);
+      InsertEventWithContext (event);
+    }
+  if (m_eventsWithContextOverflowing.load (std::memory_order_acquire))
+    {
+      EventsWithContext eventsWithContext;
+      {
+        CriticalSection cs (m_eventsWithContextMutex);
+        // The events a thread pushed to the queue before it found the
+        // queue full must come first, including those still being written.
+        while (m_eventsWithContext.PopWait (event))
+          {
+            InsertEventWithContext (event);
+          }
+        m_eventsWithContextOverflow.swap (eventsWithContext);
+        m_eventsWithContextOverflowing.store (false, std::memory_order_release);
+      }
+      for (EventsWithContext::const_iterator i = eventsWithContext.begin ();
+           i != eventsWithContext.end (); ++i)
+        {
+          InsertEventWithContext (*i);
+        }
     }
 }
 
@@ -270,14 +372,37 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back (ev);
-        m_eventsWithContextEmpty = false;
-      }
+      if (m_eventsWithContextOverflowing.load (std::memory_order_acquire)
+          || !m_eventsWithContext.Push (ev))
+        {
+          CriticalSection cs (m_eventsWithContextMutex);
+          m_eventsWithContextOverflow.push_back (ev);
+          m_eventsWithContextOverflowing.store (true, std::memory_order_release);
+        }
     }
 }
 
+void
+DefaultSimulatorImpl::ScheduleWithContextBatch (const Time &delay, const Simulator::EventBatch &batch)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << batch.size ());
+
+  if (!SystemThread::Equals (m_main) || batch.size () < 2)
+    {
+      SimulatorImpl::ScheduleWithContextBatch (delay, batch);
+      return;
+    }
+  Time tAbsolute = delay + TimeStep (m_currentTs);
+  Scheduler::Event ev;
+  ev.impl = new BatchEventImpl (this, batch, m_uid);
+  ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+  ev.key.m_context = batch.front ().context;
+  ev.key.m_uid = m_uid;
+  m_uid += batch.size ();
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
 EventId
 DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
 {
@@ -26,9 +26,11 @@
 #include "event-impl.h"
 #include "system-thread.h"
 #include "system-mutex.h"
+#include "mpsc-queue.h"
 
 #include "ptr.h"
 
+#include <atomic>
 #include <list>
 
 /**
@@ -65,6 +67,7 @@ public:
   virtual void Stop (const Time &delay);
   virtual EventId Schedule (const Time &delay, EventImpl *event);
   virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContextBatch (const Time &delay, const Simulator::EventBatch &batch);
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
   virtual void Remove (const EventId &id);
@@ -82,6 +85,12 @@ public:
 private:
   virtual void DoDispose (void);
 
+  /**
+   * The event which executes a batch of events, inserted once in the
+   * event list for the whole batch.
+   */
+  class BatchEventImpl;
+
   /** Process the next event. */
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
@@ -97,16 +106,27 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
+  /**
+   * Insert an event received from another thread in the main event queue.
+   * \param [in] event The event, with its delay relative to now.
+   */
+  void InsertEventWithContext (const EventWithContext &event);
   /** Container type for the events from a different context. */
   typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The events scheduled by other threads, moved to the primary event
+   * queue by the main thread.
+   */
+  MpscQueue<EventWithContext> m_eventsWithContext;
+  /** The events from other threads which did not fit in m_eventsWithContext. */
+  EventsWithContext m_eventsWithContextOverflow;
+  /**
+   * Flag \c true while m_eventsWithContextOverflow may hold events;
+   * meanwhile the other threads append to it rather than to
+   * m_eventsWithContext, so that the events of each thread stay in order.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
+  std::atomic<bool> m_eventsWithContextOverflowing;
+  /** Mutex to control access to m_eventsWithContextOverflow. */
   SystemMutex m_eventsWithContextMutex;
 
   /** Container type for the events to run at Simulator::Destroy() */
@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-fan-out.h"
+#include "event-impl.h"
+#include "log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventFanOut implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventFanOut");
+
+EventFanOut::~EventFanOut ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Item>::const_iterator i = m_items.begin (); i != m_items.end (); ++i)
+    {
+      i->event.event->Unref ();
+    }
+}
+
+void
+EventFanOut::Add (uint32_t context, const Time &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  Item item;
+  item.delay = delay.GetTimeStep ();
+  item.event.context = context;
+  item.event.event = event;
+  m_items.push_back (item);
+}
+
+bool
+EventFanOut::IsEarlier (const Item &a, const Item &b)
+{
+  return a.delay < b.delay;
+}
+
+void
+EventFanOut::Schedule (void)
+{
+  NS_LOG_FUNCTION (this << m_items.size ());
+  // Events with different delays do not expire at the same time, so
+  // only the order of the events with the same delay matters.
+  std::stable_sort (m_items.begin (), m_items.end (), &IsEarlier);
+  std::vector<Item>::const_iterator i = m_items.begin ();
+  while (i != m_items.end ())
+    {
+      int64_t delay = i->delay;
+      m_batch.clear ();
+      for (; i != m_items.end () && i->delay == delay; ++i)
+        {
+          m_batch.push_back (i->event);
+        }
+      if (m_batch.size () == 1)
+        {
+          Simulator::ScheduleWithContext (m_batch.front ().context, TimeStep (delay),
+                                          m_batch.front ().event);
+        }
+      else
+        {
+          Simulator::ScheduleWithContextBatch (TimeStep (delay), m_batch);
+        }
+    }
+  m_items.clear ();
+  m_batch.clear ();
+}
+
+} // namespace ns3
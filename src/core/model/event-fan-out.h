@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_FAN_OUT_H
+#define EVENT_FAN_OUT_H
+
+#include "simulator.h"
+#include "nstime.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventFanOut declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Schedule events for many receivers with as few event list
+ * operations as possible.
+ *
+ * A channel which delivers a transmission to all its receivers adds
+ * one event per receiver, then calls Schedule(): the events with the
+ * same delay are scheduled together with
+ * Simulator::ScheduleWithContextBatch().  The execution order is the
+ * same as if each event had been scheduled with
+ * Simulator::ScheduleWithContext() when it was added.
+ *
+ * \code
+ *   EventFanOut fanOut;
+ *   for (...)
+ *     {
+ *       fanOut.Add (node->GetId (), delay, MakeEvent (&Phy::Receive, phy, packet));
+ *     }
+ *   fanOut.Schedule ();
+ * \endcode
+ */
+class EventFanOut
+{
+public:
+  /** Destructor, releases the events which were not scheduled. */
+  ~EventFanOut ();
+
+  /**
+   * Add an event.
+   *
+   * \param [in] context The event context.
+   * \param [in] delay Delay until the event expires.
+   * \param [in] event The event; the EventFanOut takes ownership of it.
+   */
+  void Add (uint32_t context, const Time &delay, EventImpl *event);
+  /** Schedule the events added since the last call. */
+  void Schedule (void);
+
+private:
+  /** An event waiting to be scheduled. */
+  struct Item
+  {
+    /** The event delay, in time steps. */
+    int64_t delay;
+    /** The event and its context. */
+    Simulator::BatchEvent event;
+  };
+  /**
+   * Compare (less than) two items by delay.
+   * \param [in] a The first item.
+   * \param [in] b The second item.
+   * \returns \c true if \c a expires before \c b
+   */
+  static bool IsEarlier (const Item &a, const Item &b);
+
+  /** The events waiting to be scheduled. */
+  std::vector<Item> m_items;
+  /** The batch being built, kept to reuse its memory. */
+  Simulator::EventBatch m_batch;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_FAN_OUT_H */
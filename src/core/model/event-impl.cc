@@ -20,6 +20,11 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include "unused.h"
+
+#include <atomic>
+#include <cstring>
+#include <new>
 
 /**
  * \file
@@ -31,6 +36,220 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Granularity of the event pool size classes, in bytes. */
+const std::size_t POOL_GRANULARITY = 16;
+/** Number of size classes; larger events use the system allocator. */
+const std::size_t POOL_CLASSES = 16;
+/** Number of blocks moved at once from a thread cache to the depot. */
+const std::size_t POOL_BATCH = 256;
+
+/**
+ * \ingroup events
+ * A free block of the event pool.
+ */
+struct FreeBlock
+{
+  /** The next block of the free list. */
+  FreeBlock *next;
+  /** In the depot, the first block of the next batch. */
+  FreeBlock *nextBatch;
+};
+
+/**
+ * \ingroup events
+ * The free lists of the event pool owned by one thread.
+ */
+struct PoolCache
+{
+  /** Give the cached blocks to the depot when the thread exits. */
+  ~PoolCache ();
+  /**
+   * Take a batch of blocks from the depot.
+   * \param [in] cls The size class.
+   */
+  void Refill (std::size_t cls);
+  /**
+   * Move a batch of blocks to the depot.
+   * \param [in] cls The size class.
+   */
+  void Release (std::size_t cls);
+
+  /** The free list of each size class. */
+  FreeBlock *head[POOL_CLASSES];
+  /** The length of each free list. */
+  std::size_t count[POOL_CLASSES];
+  /** Number of events allocated by this thread. */
+  uint64_t allocations;
+  /** Number of those allocations served from the pool. */
+  uint64_t pooled;
+};
+
+/** The free lists of the calling thread. */
+thread_local PoolCache g_cache;
+/** Flag \c true once g_cache has been destroyed, at thread exit. */
+thread_local bool g_cacheDestroyed = false;
+
+/** Lock protecting the depot. */
+std::atomic_flag g_depotLock = ATOMIC_FLAG_INIT;
+/** The depot: the batches of free blocks shared by all threads. */
+FreeBlock *g_depot[POOL_CLASSES];
+/** Number of blocks obtained from the system allocator. */
+std::atomic<uint64_t> g_systemAllocations (0);
+/** Number of blocks returned to the system allocator. */
+std::atomic<uint64_t> g_systemFrees (0);
+
+/** Acquire the depot lock. */
+void
+LockDepot (void)
+{
+  while (g_depotLock.test_and_set (std::memory_order_acquire))
+    {
+    }
+}
+
+/** Release the depot lock. */
+void
+UnlockDepot (void)
+{
+  g_depotLock.clear (std::memory_order_release);
+}
+
+/**
+ * Get the size class of an event.
+ * \param [in] size The size of the event object.
+ * \returns The size class, POOL_CLASSES or more if it is not pooled.
+ */
+inline std::size_t
+GetSizeClass (std::size_t size)
+{
+  return (size - 1) / POOL_GRANULARITY;
+}
+
+PoolCache::~PoolCache ()
+{
+  g_cacheDestroyed = true;
+  LockDepot ();
+  for (std::size_t cls = 0; cls < POOL_CLASSES; ++cls)
+    {
+      if (head[cls] != 0)
+        {
+          head[cls]->nextBatch = g_depot[cls];
+          g_depot[cls] = head[cls];
+        }
+    }
+  UnlockDepot ();
+}
+
+void
+PoolCache::Refill (std::size_t cls)
+{
+  LockDepot ();
+  FreeBlock *batch = g_depot[cls];
+  if (batch != 0)
+    {
+      g_depot[cls] = batch->nextBatch;
+    }
+  UnlockDepot ();
+  head[cls] = batch;
+  count[cls] = 0;
+  for (FreeBlock *block = batch; block != 0; block = block->next)
+    {
+      count[cls]++;
+    }
+}
+
+void
+PoolCache::Release (std::size_t cls)
+{
+  FreeBlock *batch = head[cls];
+  FreeBlock *last = batch;
+  for (std::size_t i = 1; i < POOL_BATCH; ++i)
+    {
+      last = last->next;
+    }
+  head[cls] = last->next;
+  count[cls] -= POOL_BATCH;
+  last->next = 0;
+  LockDepot ();
+  batch->nextBatch = g_depot[cls];
+  g_depot[cls] = batch;
+  UnlockDepot ();
+}
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t cls = GetSizeClass (size);
+  if (cls < POOL_CLASSES)
+    {
+      if (!g_cacheDestroyed)
+        {
+          PoolCache &cache = g_cache;
+          cache.allocations++;
+          if (cache.head[cls] == 0)
+            {
+              cache.Refill (cls);
+            }
+          FreeBlock *block = cache.head[cls];
+          if (block != 0)
+            {
+              cache.head[cls] = block->next;
+              cache.count[cls]--;
+              cache.pooled++;
+              return block;
+            }
+        }
+      // Allocate the whole size class, so the block can be reused
+      // by any event of this class, even when it is allocated after
+      // the cache of this thread is gone and freed into another pool.
+      size = (cls + 1) * POOL_GRANULARITY;
+    }
+  g_systemAllocations.fetch_add (1, std::memory_order_relaxed);
+  return ::operator new (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  std::size_t cls = GetSizeClass (size);
+  if (cls < POOL_CLASSES && !g_cacheDestroyed)
+    {
+      PoolCache &cache = g_cache;
+      FreeBlock *block = static_cast<FreeBlock *> (p);
+      block->next = cache.head[cls];
+      cache.head[cls] = block;
+      cache.count[cls]++;
+      if (cache.count[cls] >= 2 * POOL_BATCH)
+        {
+          cache.Release (cls);
+        }
+      return;
+    }
+  g_systemFrees.fetch_add (1, std::memory_order_relaxed);
+  ::operator delete (p);
+}
+
+EventImpl::PoolStats
+EventImpl::GetPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PoolStats stats;
+  stats.allocations = 0;
+  stats.pooled = 0;
+  if (!g_cacheDestroyed)
+    {
+      stats.allocations = g_cache.allocations;
+      stats.pooled = g_cache.pooled;
+    }
+  stats.systemAllocations = g_systemAllocations.load (std::memory_order_relaxed);
+  stats.systemFrees = g_systemFrees.load (std::memory_order_relaxed);
+  return stats;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +285,19 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+EventImpl::Target::Target ()
+  : function (0),
+    object (0),
+    type (0),
+    methodSize (0)
+{
+  std::memset (method, 0, sizeof (method));
+}
+
+void
+EventImpl::GetTarget (Target &target) const
+{
+  NS_UNUSED (target);
+}
+
 } // namespace ns3
@@ -21,6 +21,8 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
+#include <typeinfo>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +42,15 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * The memory of the events is recycled: EventImpl overloads
+ * operator new and operator delete to keep the freed blocks in
+ * per-thread free lists, one per size class, so that the steady state
+ * of a simulation does not call the system allocator.  Blocks freed by
+ * a thread beyond a small per-thread cache are moved, in batches, to a
+ * shared depot from which any thread can take them; this keeps the
+ * pool balanced when events are created by one thread and run by
+ * another, as with the realtime and parallel simulator implementations.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -65,6 +76,64 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * The target of an event: the function, or the class method and the
+   * object, bound by MakeEvent().
+   */
+  struct Target
+  {
+    /** Constructor, for an unknown target. */
+    Target ();
+    const void *function;          //!< The address of the function, or 0.
+    const void *object;            //!< The object, as the class of the method, or 0.
+    const std::type_info *type;    //!< The dynamic type of the object, or 0.
+    /** The representation of the class method pointer. */
+    unsigned char method[2 * sizeof (void *)];
+    std::size_t methodSize;        //!< The size of the representation, or 0.
+  };
+  /**
+   * Get the target of the event, which identifies it in a profile.
+   *
+   * \param [out] target The target, left unchanged if it is not known.
+   */
+  virtual void GetTarget (Target &target) const;
+
+  /**
+   * Allocate the memory of an event from the event pool.
+   *
+   * \param [in] size The size of the event object.
+   * \returns The allocated memory.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return the memory of an event to the event pool.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event object.
+   */
+  static void operator delete (void *p, std::size_t size);
+
+  /** Event pool statistics. */
+  struct PoolStats
+  {
+    /** Number of events allocated by the calling thread. */
+    uint64_t allocations;
+    /** Number of those allocations served from the pool. */
+    uint64_t pooled;
+    /** Number of blocks obtained from the system allocator, by all threads. */
+    uint64_t systemAllocations;
+    /** Number of blocks returned to the system allocator, by all threads. */
+    uint64_t systemFrees;
+  };
+  /**
+   * Get the event pool statistics.
+   *
+   * A simulation has reached an allocation-free steady state when
+   * systemAllocations no longer grows.
+   *
+   * \returns The event pool statistics.
+   */
+  static PoolStats GetPoolStats (void);
 
 protected:
   /**
@@ -0,0 +1,322 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/**
+ * \ingroup scheduler
+ * Compare (greater than) two events, to keep Bottom sorted with the
+ * earliest event last.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a > \c b
+ */
+bool
+IsLater (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key > b.key;
+}
+
+} // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (std::numeric_limits<uint64_t>::max ()),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+  // never reallocated, so that a rung can be spawned while a reference
+  // to a bucket of the rung above it is held.
+  m_rungs.resize (MAX_RUNGS);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung) const
+{
+  return rung.start + rung.current * rung.width;
+}
+
+std::size_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  NS_LOG_FUNCTION (this << ts);
+  std::size_t x = 0;
+  while (x < m_nRungs && ts < CurrentStart (m_rungs[x]))
+    {
+      x++;
+    }
+  return x;
+}
+
+void
+LadderScheduler::InsertBottom (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  Bucket::iterator i = std::upper_bound (m_bottom.begin (), m_bottom.end (), ev, &IsLater);
+  m_bottom.insert (i, ev);
+
+  if (m_bottom.size () > THRESHOLD
+      && m_nRungs < MAX_RUNGS
+      && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      // Too many events were inserted before the lowest rung: spread
+      // them over a new rung, Refill will move back the earliest ones.
+      uint64_t end = m_topStart - 1;
+      if (m_nRungs > 0)
+        {
+          end = CurrentStart (m_rungs[m_nRungs - 1]) - 1;
+        }
+      SpawnRung (m_bottom, end);
+    }
+}
+
+void
+LadderScheduler::SpawnRung (Bucket &events, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << events.size () << end);
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  uint64_t start = std::numeric_limits<uint64_t>::max ();
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      start = std::min (start, i->key.m_ts);
+    }
+  NS_ASSERT (start <= end);
+
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  rung.start = start;
+  rung.width = (end - start) / events.size () + 1;
+  rung.buckets.resize ((end - start) / rung.width + 1);
+  rung.current = 0;
+  rung.count = events.size ();
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      rung.buckets[(i->key.m_ts - start) / rung.width].push_back (*i);
+    }
+  events.clear ();
+}
+
+void
+LadderScheduler::TransferTop (void)
+{
+  NS_LOG_FUNCTION (this << m_top.size ());
+  NS_ASSERT (m_nRungs == 0 && m_bottom.empty ());
+  if (m_top.size () <= THRESHOLD || m_topMin == m_topMax)
+    {
+      m_bottom.swap (m_top);
+      std::sort (m_bottom.begin (), m_bottom.end (), &IsLater);
+      m_topStart = m_topMax + 1;
+    }
+  else
+    {
+      SpawnRung (m_top, m_topMax);
+      const Rung &rung = m_rungs[0];
+      m_topStart = rung.start + rung.buckets.size () * rung.width;
+    }
+  m_topMin = std::numeric_limits<uint64_t>::max ();
+  m_topMax = 0;
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          if (m_top.empty ())
+            {
+              return;
+            }
+          TransferTop ();
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t end = CurrentStart (rung) + rung.width - 1;
+      rung.current++;
+      rung.count -= bucket.size ();
+      if (bucket.size () > THRESHOLD && m_nRungs < MAX_RUNGS && rung.width > 1)
+        {
+          SpawnRung (bucket, end);
+        }
+      else
+        {
+          m_bottom.swap (bucket);
+          std::sort (m_bottom.begin (), m_bottom.end (), &IsLater);
+        }
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  m_size++;
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+    }
+  else
+    {
+      std::size_t x = FindRung (ts);
+      if (x < m_nRungs)
+        {
+          Rung &rung = m_rungs[x];
+          rung.buckets[(ts - rung.start) / rung.width].push_back (ev);
+          rung.count++;
+        }
+      else
+        {
+          InsertBottom (ev);
+        }
+    }
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event next = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_size--;
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+  return next;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket = &m_bottom;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      std::size_t x = FindRung (ts);
+      if (x < m_nRungs)
+        {
+          Rung &rung = m_rungs[x];
+          bucket = &rung.buckets[(ts - rung.start) / rung.width];
+          rung.count--;
+        }
+    }
+
+  for (Bucket::iterator i = bucket->begin (); i != bucket->end (); ++i)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (i->impl == ev.impl);
+          if (bucket == &m_bottom)
+            {
+              m_bottom.erase (i);
+            }
+          else
+            {
+              // Top and the buckets are not sorted
+              *i = bucket->back ();
+              bucket->pop_back ();
+            }
+          m_size--;
+          if (m_bottom.empty ())
+            {
+              Refill ();
+            }
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
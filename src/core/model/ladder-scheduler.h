@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh and
+ * Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * The events are kept in three tiers:
+ *  - Top: an unsorted vector holding the events farther in the future,
+ *  - Ladder: a stack of rungs, each an array of buckets of the same
+ *    width, every rung refining one bucket of the rung above it,
+ *  - Bottom: a short sorted vector holding the earliest events.
+ *
+ * Insert appends to Top or to a bucket in constant time and only the
+ * Bottom, which is kept below a small threshold, is sorted.  When the
+ * Bottom is empty, the first non-empty bucket of the lowest rung is
+ * either moved to the Bottom or, if it is too large, spread over a new
+ * rung.  Unlike the calendar queue, the bucket width is derived from
+ * the events actually present when a rung is created, so no resize
+ * heuristic is needed and bursty event populations do not degrade the
+ * amortized O(1) cost of Insert and RemoveNext.
+ *
+ * Remove has to scan the tier holding the event, which is linear in
+ * the size of Top for events far in the future.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Bucket type: an unsorted vector of events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    /** The buckets of this rung. */
+    std::vector<Bucket> buckets;
+    /** Timestamp of the start of the first bucket. */
+    uint64_t start;
+    /** Width of each bucket. */
+    uint64_t width;
+    /** Index of the current (first possibly non-empty) bucket. */
+    std::size_t current;
+    /** Number of events in this rung. */
+    std::size_t count;
+  };
+
+  /**
+   * Get the start of the current bucket of a rung; the rung holds no
+   * event earlier than this timestamp.
+   *
+   * \param [in] rung The rung.
+   * \returns The start of the current bucket.
+   */
+  inline uint64_t CurrentStart (const Rung &rung) const;
+  /**
+   * Find the rung which holds, or would hold, an event.
+   *
+   * \param [in] ts The event timestamp.
+   * \returns The rung index, or the number of rungs if the event
+   *          belongs to Bottom.
+   */
+  std::size_t FindRung (uint64_t ts) const;
+  /**
+   * Insert an event in the sorted Bottom vector.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /**
+   * Create a new rung below the current lowest one.
+   *
+   * \param [in] events The events to spread over the new rung.
+   * \param [in] end The last timestamp covered by the new rung.
+   */
+  void SpawnRung (Bucket &events, uint64_t end);
+  /** Move the whole Top to the first rung. */
+  void TransferTop (void);
+  /** Refill Bottom from the ladder, or from Top if the ladder is empty. */
+  void Refill (void);
+
+  /** Threshold on the number of events moved to Bottom at once. */
+  static const std::size_t THRESHOLD = 50;
+  /** Maximum number of rungs. */
+  static const std::size_t MAX_RUNGS = 8;
+
+  /** The Top tier. */
+  Bucket m_top;
+  /** Smallest timestamp in Top. */
+  uint64_t m_topMin;
+  /** Largest timestamp in Top. */
+  uint64_t m_topMax;
+  /** Events with a timestamp larger or equal to this one go to Top. */
+  uint64_t m_topStart;
+  /**
+   * The rungs; only the first m_nRungs ones are in use, the others are
+   * kept to reuse the memory of their buckets.
+   */
+  std::vector<Rung> m_rungs;
+  /** The number of rungs in use. */
+  std::size_t m_nRungs;
+  /** The Bottom tier, sorted by decreasing key. */
+  Bucket m_bottom;
+  /** The number of events. */
+  std::size_t m_size;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -112,6 +112,41 @@
 #endif /* NS_LOG_APPEND_CONTEXT */
 
 
+/**
+ * \ingroup logging
+ * Check if a log level is compiled in for the current log component;
+ * constant when the level is, so that the compiler removes the code of
+ * the levels above the ceiling of the component.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ *
+ * \param [in] level The log level.
+ */
+#define NS_LOG_COMPILED(level)                                  \
+  (((level) & g_logCeiling) != 0)
+
+/**
+ * \ingroup logging
+ * Record a message in the ns3::BinaryLogSink rather than formatting it;
+ * the call site is registered the first time.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ *
+ * \param [in] level The log level.
+ * \param [in] kind The ns3::BinaryLogRecord::Kind of the call site.
+ * \param [in] values The values to record.
+ */
+#define NS_LOG_RECORD(level, kind, values)                      \
+  {                                                             \
+    static const uint32_t ns3LogFormat =                        \
+      ns3::BinaryLogRecord::RegisterFormat (g_log.Name (),        \
+                                          __FUNCTION__,         \
+                                          __FILE__, __LINE__,   \
+                                          level, kind);         \
+    ns3::BinaryLogRecord {ns3LogFormat} values;                 \
+  }
+
+
 #ifndef NS_LOG_CONDITION
 /**
  * \ingroup logging
@@ -152,7 +187,15 @@
 #define NS_LOG(level, msg)                                      \
   NS_LOG_CONDITION                                              \
   do {                                                          \
-      if (g_log.IsEnabled (level))                              \
+      if (!NS_LOG_COMPILED (level) || !g_log.IsEnabled (level)) \
+        {                                                       \
+        }                                                       \
+      else if (ns3::BinaryLogRecord::IsEnabled ())                \
+        {                                                       \
+          NS_LOG_RECORD (level, ns3::BinaryLogRecord::MESSAGE,    \
+                         << msg);                               \
+        }                                                       \
+      else                                                      \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -174,7 +217,16 @@
 #define NS_LOG_FUNCTION_NOARGS()                                \
   NS_LOG_CONDITION                                              \
   do {                                                          \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (!NS_LOG_COMPILED (ns3::LOG_FUNCTION)                  \
+          || !g_log.IsEnabled (ns3::LOG_FUNCTION))              \
+        {                                                       \
+        }                                                       \
+      else if (ns3::BinaryLogRecord::IsEnabled ())                \
+        {                                                       \
+          NS_LOG_RECORD (ns3::LOG_FUNCTION,                     \
+                         ns3::BinaryLogRecord::FUNCTION, );       \
+        }                                                       \
+      else                                                      \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -210,7 +262,17 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (!NS_LOG_COMPILED (ns3::LOG_FUNCTION)                  \
+          || !g_log.IsEnabled (ns3::LOG_FUNCTION))              \
+        {                                                       \
+        }                                                       \
+      else if (ns3::BinaryLogRecord::IsEnabled ())                \
+        {                                                       \
+          NS_LOG_RECORD (ns3::LOG_FUNCTION,                     \
+                         ns3::BinaryLogRecord::FUNCTION,          \
+                         << parameters);                        \
+        }                                                       \
+      else                                                      \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
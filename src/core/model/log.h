@@ -29,6 +29,7 @@
 
 #include "node-printer.h"
 #include "time-printer.h"
+#include "unused.h"
 #include "log-macros-enabled.h"
 #include "log-macros-disabled.h"
 
@@ -169,6 +170,16 @@ void LogComponentDisableAll (enum LogLevel level);
 } // namespace ns3
 
 
+#ifndef NS3_LOG_LEVEL_CEILING
+/**
+ * The default compile-time ceiling of the log components: the levels
+ * outside this mask are removed from the code by the compiler, whatever
+ * the levels enabled at run time.  Set with the
+ * `--log-level-ceiling` option of `waf configure`.
+ */
+#define NS3_LOG_LEVEL_CEILING ns3::LOG_LEVEL_ALL
+#endif
+
 /**
  * Define a Log component with a specific name.
  *
@@ -196,6 +207,7 @@ void LogComponentDisableAll (enum LogLevel level);
  *   } // namespace ns3
  *
  *   using ns3::g_log;
+ *   using ns3::g_logCeiling;
  *
  *   // Further definitions outside of the ns3 namespace
  *\endcode
@@ -203,7 +215,28 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param [in] name The log component name.
  */
 #define NS_LOG_COMPONENT_DEFINE(name)                           \
-  static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__)
+  NS_LOG_COMPONENT_DEFINE_CEILING (name, NS3_LOG_LEVEL_CEILING)
+
+/**
+ * Define a logging component with a compile-time ceiling.
+ *
+ * The NS_LOG macros of the levels outside of \p ceiling are compiled
+ * out in this file, so they cost nothing even when logging is built in,
+ * but they cannot be enabled at run time either.  The ceiling is also
+ * limited by the global one, set with the `--log-level-ceiling` option
+ * of `waf configure`.  For example, to keep
+ * only the messages of level LOG_INFO and above in a hot code path:
+ * \code
+ *   NS_LOG_COMPONENT_DEFINE_CEILING ("PointToPointNetDevice", ns3::LOG_LEVEL_INFO);
+ * \endcode
+ *
+ * \param [in] name The log component name.
+ * \param [in] ceiling The mask of the levels compiled in.
+ */
+#define NS_LOG_COMPONENT_DEFINE_CEILING(name, ceiling)          \
+  static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__); \
+  static constexpr int32_t NS_UNUSED_GLOBAL (g_logCeiling) =         \
+    (ceiling) & NS3_LOG_LEVEL_CEILING
 
 /**
  * Define a logging component with a mask.
@@ -214,7 +247,8 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param [in] mask The default mask.
  */
 #define NS_LOG_COMPONENT_DEFINE_MASK(name, mask)                \
-  static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__, mask)
+  static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__, mask); \
+  static constexpr int32_t NS_UNUSED_GLOBAL (g_logCeiling) = NS3_LOG_LEVEL_CEILING
 
 /**
  * Declare a reference to a Log component.
@@ -225,7 +259,8 @@ void LogComponentDisableAll (enum LogLevel level);
  * section to prevent subclasses from using the same log component
  * as the base class.
  */
-#define NS_LOG_TEMPLATE_DECLARE  LogComponent & g_log
+#define NS_LOG_TEMPLATE_DECLARE  LogComponent & g_log; \
+  static constexpr int32_t g_logCeiling = NS3_LOG_LEVEL_CEILING
 
 /**
  * Initialize a reference to a Log component.
@@ -247,7 +282,8 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param [in] name The log component name.
  */
 #define NS_LOG_STATIC_TEMPLATE_DEFINE(name) \
-  static LogComponent & NS_UNUSED_GLOBAL (g_log) = GetLogComponent (name)
+  static LogComponent & NS_UNUSED_GLOBAL (g_log) = GetLogComponent (name); \
+  static constexpr int32_t NS_UNUSED_GLOBAL (g_logCeiling) = NS3_LOG_LEVEL_CEILING
 
 /**
  * Use \ref NS_LOG to output a message of level LOG_ERROR.
@@ -434,6 +470,13 @@ private:
 
 };  // class LogComponent
 
+inline bool
+LogComponent::IsEnabled (const enum LogLevel level) const
+{
+  //  LogComponentEnableEnvVar ();
+  return (level & m_levels) ? 1 : 0;
+}
+
 /**
  * Get the LogComponent registered with the given name.
  *
@@ -546,4 +589,8 @@ ParameterLogger::operator<< <uint8_t> (uint8_t param);
 
 /**@}*/  // \ingroup logging
 
+#ifdef NS3_LOG_ENABLE
+#include "binary-log-record.h"
+#endif
+
 #endif /* NS3_LOG_H */
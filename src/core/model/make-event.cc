@@ -51,6 +51,10 @@ EventImpl * MakeEvent (void (*f)(void))
     {
       (*m_function)();
     }
+    virtual void GetTarget (Target &target) const
+    {
+      target.function = reinterpret_cast<const void *> (m_function);
+    }
 
   private:
     F m_function;
@@ -317,6 +317,9 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5,U6), T1 a1, T2 a2, T3 a3, T4 a4,
 #include "event-impl.h"
 #include "type-traits.h"
 
+#include <cstring>
+#include <typeinfo>
+
 namespace ns3 {
 
 /**
@@ -355,6 +358,97 @@ struct EventMemberImplObjTraits<T *>
   }
 };
 
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * Describe the target of an event, for EventImpl::GetTarget(): the
+ * object, its dynamic type and the representation of the class member
+ * pointer, which is not interpreted here.
+ *
+ * \tparam MEM \deduced The class member pointer type.
+ * \tparam C \deduced The class to which the class member pointer is relative.
+ * \param [in] mem_ptr The class member pointer.
+ * \param [in] obj The object, converted to \p C.
+ * \param [out] target The target of the event.
+ */
+template <typename MEM, typename C>
+void
+SetEventMemberTarget (const MEM &mem_ptr, const C &obj, EventImpl::Target &target)
+{
+  target.object = &obj;
+  target.type = &typeid (obj);
+  if (sizeof (mem_ptr) <= sizeof (target.method))
+    {
+      std::memcpy (target.method, &mem_ptr, sizeof (mem_ptr));
+      target.methodSize = sizeof (mem_ptr);
+    }
+}
+
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This is the generic version, for the pointers to data members of a
+ * callable type.
+ *
+ * \tparam MEM \deduced The class member pointer type.
+ * \tparam OBJ \deduced The class of the object.
+ * \param [in] mem_ptr The class member pointer.
+ * \param [in] obj The object.
+ * \param [out] target The target of the event.
+ */
+template <typename MEM, typename OBJ>
+void
+GetEventMemberTarget (MEM mem_ptr, const OBJ &obj, EventImpl::Target &target)
+{
+  SetEventMemberTarget (mem_ptr, obj, target);
+}
+
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This is the version for the non-const methods: the object is
+ * converted to the class of the method, to which the class member
+ * pointer is relative.
+ *
+ * \tparam R \deduced The return type of the method.
+ * \tparam C \deduced The class of the method.
+ * \tparam A \deduced The types of the arguments of the method.
+ * \tparam OBJ \deduced The class of the object.
+ * \param [in] mem_ptr The class method member function pointer.
+ * \param [in] obj The object.
+ * \param [out] target The target of the event.
+ */
+template <typename R, typename C, typename... A, typename OBJ>
+void
+GetEventMemberTarget (R (C::*mem_ptr)(A...), const OBJ &obj, EventImpl::Target &target)
+{
+  SetEventMemberTarget (mem_ptr, static_cast<const C &> (obj), target);
+}
+
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This is the version for the const methods.
+ *
+ * \tparam R \deduced The return type of the method.
+ * \tparam C \deduced The class of the method.
+ * \tparam A \deduced The types of the arguments of the method.
+ * \tparam OBJ \deduced The class of the object.
+ * \param [in] mem_ptr The class method member function pointer.
+ * \param [in] obj The object.
+ * \param [out] target The target of the event.
+ */
+template <typename R, typename C, typename... A, typename OBJ>
+void
+GetEventMemberTarget (R (C::*mem_ptr)(A...) const, const OBJ &obj, EventImpl::Target &target)
+{
+  SetEventMemberTarget (mem_ptr, static_cast<const C &> (obj), target);
+}
+
 template <typename MEM, typename OBJ>
 EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
 {
@@ -374,6 +468,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+    virtual void GetTarget (Target &target) const
+    {
+      GetEventMemberTarget (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj), target);
+    }
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -404,6 +502,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      GetEventMemberTarget (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj), target);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -435,6 +537,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      GetEventMemberTarget (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj), target);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -468,6 +574,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      GetEventMemberTarget (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj), target);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -503,6 +613,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      GetEventMemberTarget (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj), target);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -541,6 +655,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      GetEventMemberTarget (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj), target);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -581,6 +699,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      GetEventMemberTarget (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj), target);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -616,6 +738,10 @@ EventImpl * MakeEvent (void (*f)(U1), T1 a1)
     {
       (*m_function)(m_a1);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      target.function = reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
@@ -646,6 +772,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2), T1 a1, T2 a2)
     {
       (*m_function)(m_a1, m_a2);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      target.function = reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -679,6 +809,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3), T1 a1, T2 a2, T3 a3)
     {
       (*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      target.function = reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -714,6 +848,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4), T1 a1, T2 a2, T3 a3, T4 a4)
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      target.function = reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -751,6 +889,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5), T1 a1, T2 a2, T3 a3, T4 a4, T5
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      target.function = reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -790,6 +932,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5,U6), T1 a1, T2 a2, T3 a3, T4 a4,
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual void GetTarget (Target &target) const
+    {
+      target.function = reinterpret_cast<const void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include "assert.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup thread
+ * ns3::MpscQueue declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup thread
+ *
+ * \brief A bounded, lock-free, multiple producer single consumer queue.
+ *
+ * Any number of threads can Push() items concurrently, while a single
+ * thread Pop()s them.  The queue is a ring of cells, each tagged with a
+ * sequence number telling whether it is free for the producer which
+ * claimed its position or filled for the consumer (D. Vyukov's bounded
+ * queue): a producer claims a position with a single compare and swap
+ * and the consumer needs no atomic read-modify-write at all.
+ *
+ * The items pushed by one thread are popped in the order they were
+ * pushed.  Push() fails, rather than blocking, when the queue is full,
+ * so the caller can fall back to a slower path.
+ *
+ * \tparam T \explicit The item type, which must be copyable.
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] capacity The maximum number of items, a power of two.
+   */
+  MpscQueue (uint32_t capacity);
+
+  /**
+   * Append an item; can be called by any thread.
+   * \param [in] item The item.
+   * \returns \c false if the queue was full.
+   */
+  bool Push (const T &item);
+  /**
+   * Remove the oldest item; must only be called by the consumer thread.
+   * \param [out] item The item.
+   * \returns \c false if the queue was empty.
+   */
+  bool Pop (T &item);
+  /**
+   * Remove the oldest item, waiting for it if a producer has claimed its
+   * position but is still writing it; must only be called by the
+   * consumer thread.
+   * \param [out] item The item.
+   * \returns \c false if no position was claimed.
+   */
+  bool PopWait (T &item);
+  /**
+   * Check if the queue is empty; must only be called by the consumer
+   * thread.
+   * \returns \c true if no item is ready to be popped.
+   */
+  bool IsEmpty (void) const;
+
+private:
+  /** A cell of the ring. */
+  struct Cell
+  {
+    /**
+     * The cell sequence number: the position of the producer which can
+     * fill it, or this position plus one once it is filled.
+     */
+    std::atomic<uint64_t> sequence;
+    /** The item. */
+    T item;
+  };
+
+  /** The cells. */
+  std::vector<Cell> m_cells;
+  /** The capacity minus one, to compute positions modulo the capacity. */
+  uint64_t m_mask;
+  /** Padding, to keep the producer position in its own cache line. */
+  char m_pad0[64];
+  /** The position of the next item pushed. */
+  std::atomic<uint64_t> m_pushPosition;
+  /** Padding, to keep the consumer position in its own cache line. */
+  char m_pad1[64];
+  /** The position of the next item popped. */
+  uint64_t m_popPosition;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscQueue<T>::MpscQueue (uint32_t capacity)
+  : m_cells (capacity),
+    m_mask (capacity - 1),
+    m_pushPosition (0),
+    m_popPosition (0)
+{
+  NS_ASSERT_MSG (capacity > 0 && (capacity & (capacity - 1)) == 0,
+                 "MpscQueue capacity must be a power of two");
+  for (uint64_t i = 0; i < capacity; ++i)
+    {
+      m_cells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Push (const T &item)
+{
+  uint64_t position = m_pushPosition.load (std::memory_order_relaxed);
+  Cell *cell;
+  while (true)
+    {
+      cell = &m_cells[position & m_mask];
+      uint64_t sequence = cell->sequence.load (std::memory_order_acquire);
+      int64_t diff = static_cast<int64_t> (sequence - position);
+      if (diff == 0)
+        {
+          // the cell is free: try to claim the position
+          if (m_pushPosition.compare_exchange_weak (position, position + 1,
+                                                    std::memory_order_relaxed))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          // the cell still holds the item pushed one lap ago
+          return false;
+        }
+      else
+        {
+          // another producer claimed the position
+          position = m_pushPosition.load (std::memory_order_relaxed);
+        }
+    }
+  cell->item = item;
+  cell->sequence.store (position + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Pop (T &item)
+{
+  Cell &cell = m_cells[m_popPosition & m_mask];
+  if (cell.sequence.load (std::memory_order_acquire) != m_popPosition + 1)
+    {
+      return false;
+    }
+  item = cell.item;
+  // free the cell for the producer one lap ahead
+  cell.sequence.store (m_popPosition + m_mask + 1, std::memory_order_release);
+  m_popPosition++;
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::PopWait (T &item)
+{
+  if (m_popPosition == m_pushPosition.load (std::memory_order_acquire))
+    {
+      return false;
+    }
+  while (!Pop (item))
+    {
+      std::this_thread::yield ();
+    }
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty (void) const
+{
+  const Cell &cell = m_cells[m_popPosition & m_mask];
+  return cell.sequence.load (std::memory_order_acquire) != m_popPosition + 1;
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
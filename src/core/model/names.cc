@@ -310,6 +310,7 @@ NamesPriv::Clear (void)
   m_root.m_name = "Names";
   m_root.m_object = 0;
   m_root.m_nameMap.clear ();
+  Object::NotifyGraphChange ();
 }
 
 bool
@@ -416,6 +417,7 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
   NameNode *newNode = new NameNode (node, name, object);
   node->m_nameMap[name] = newNode;
   m_objectMap[object] = newNode;
+  Object::NotifyGraphChange ();
 
   return true;
 }
@@ -538,6 +540,7 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       node->m_nameMap.erase (i);
       changeNode->m_name = newname;
       node->m_nameMap[newname] = changeNode;
+      Object::NotifyGraphChange ();
       return true;
     }
 }
@@ -22,6 +22,7 @@
 #include "trace-source-accessor.h"
 #include "attribute-construction-list.h"
 #include "string.h"
+#include "object.h"
 #include "ns3/core-config.h"
 #ifdef HAVE_STDLIB_H
 #include <cstdlib>
@@ -79,108 +80,104 @@ ObjectBase::NotifyConstructionCompleted (void)
 void
 ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
 {
-  // loop over the inheritance tree back to the Object base class.
+  // loop over the attributes of the object type and of its parents, back
+  // to the Object base class.
   NS_LOG_FUNCTION (this << &attributes);
   TypeId tid = GetInstanceTypeId ();
-  do
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+#endif /* HAVE_GETENV */
+  NS_LOG_DEBUG ("construct tid=" << tid.GetName () << ", params=" << tid.GetAllAttributeN ());
+  for (std::size_t i = 0; i < tid.GetAllAttributeN (); i++)
     {
-      // loop over all attributes in object type
-      NS_LOG_DEBUG ("construct tid=" << tid.GetName () << ", params=" << tid.GetAttributeN ());
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+      TypeId owner;
+      const struct TypeId::AttributeInformation &info = tid.GetAllAttribute (i, &owner);
+      NS_LOG_DEBUG ("try to construct \"" << owner.GetName () << "::" <<
+                    info.name << "\"");
+      // is this attribute stored in this AttributeConstructionList instance ?
+      Ptr<AttributeValue> value = attributes.Find (info.checker);
+      // See if this attribute should not be set here in the
+      // constructor.
+      if (!(info.flags & TypeId::ATTR_CONSTRUCT))
         {
-          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
-          NS_LOG_DEBUG ("try to construct \"" << tid.GetName () << "::" <<
-                        info.name << "\"");
-          // is this attribute stored in this AttributeConstructionList instance ?
-          Ptr<AttributeValue> value = attributes.Find (info.checker);
-          // See if this attribute should not be set here in the
-          // constructor.
-          if (!(info.flags & TypeId::ATTR_CONSTRUCT))
+          // Handle this attribute if it should not be
+          // set here.
+          if (value == 0)
             {
-              // Handle this attribute if it should not be
-              // set here.
-              if (value == 0)
-                {
-                  // Skip this attribute if it's not in the
-                  // AttributeConstructionList.
-                  continue;
-                }
-              else
-                {
-                  // This is an error because this attribute is not
-                  // settable in its constructor but is present in
-                  // the AttributeConstructionList.
-                  NS_FATAL_ERROR ("Attribute name=" << info.name << " tid=" << tid.GetName () << ": initial value cannot be set using attributes");
-                }
+              // Skip this attribute if it's not in the
+              // AttributeConstructionList.
+              continue;
             }
+          else
+            {
+              // This is an error because this attribute is not
+              // settable in its constructor but is present in
+              // the AttributeConstructionList.
+              NS_FATAL_ERROR ("Attribute name=" << info.name << " tid=" << owner.GetName () << ": initial value cannot be set using attributes");
+            }
+        }
 
-          if (value != 0)
+      if (value != 0)
+        {
+          // We have a matching attribute value.
+          if (DoSet (info, *value))
             {
-              // We have a matching attribute value.
-              if (DoSet (info.accessor, info.checker, *value))
-                {
-                  NS_LOG_DEBUG ("construct \"" << tid.GetName () << "::" <<
-                                info.name << "\"");
-                  continue;
-                }
+              NS_LOG_DEBUG ("construct \"" << owner.GetName () << "::" <<
+                            info.name << "\"");
+              continue;
             }
+        }
 
 #ifdef HAVE_GETENV
-          // No matching attribute value so we try to look at the env var.
-          char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
-          if (envVar != 0)
+      // No matching attribute value so we try to look at the env var.
+      if (envVar != 0)
+        {
+          std::string env = std::string (envVar);
+          std::string::size_type cur = 0;
+          std::string::size_type next = 0;
+          while (next != std::string::npos)
             {
-              std::string env = std::string (envVar);
-              std::string::size_type cur = 0;
-              std::string::size_type next = 0;
-              while (next != std::string::npos)
+              next = env.find (";", cur);
+              std::string tmp = std::string (env, cur, next - cur);
+              std::string::size_type equal = tmp.find ("=");
+              if (equal != std::string::npos)
                 {
-                  next = env.find (";", cur);
-                  std::string tmp = std::string (env, cur, next - cur);
-                  std::string::size_type equal = tmp.find ("=");
-                  if (equal != std::string::npos)
+                  std::string name = tmp.substr (0, equal);
+                  std::string envval = tmp.substr (equal + 1, tmp.size () - equal - 1);
+                  if (name == owner.GetName () + "::" + info.name)
                     {
-                      std::string name = tmp.substr (0, equal);
-                      std::string envval = tmp.substr (equal + 1, tmp.size () - equal - 1);
-                      if (name == tid.GetAttributeFullName (i))
+                      if (DoSet (info, StringValue (envval)))
                         {
-                          if (DoSet (info.accessor, info.checker, StringValue (envval)))
-                            {
-                              NS_LOG_DEBUG ("construct \"" << tid.GetName () << "::" <<
-                                            info.name << "\" from env var");
-                              break;
-                            }
+                          NS_LOG_DEBUG ("construct \"" << owner.GetName () << "::" <<
+                                        info.name << "\" from env var");
+                          break;
                         }
                     }
-                  cur = next + 1;
                 }
+              cur = next + 1;
             }
+        }
 #endif /* HAVE_GETENV */
 
-          // No matching attribute value so we try to set the default value.
-          DoSet (info.accessor, info.checker, *info.initialValue);
-          NS_LOG_DEBUG ("construct \"" << tid.GetName () << "::" <<
-                        info.name << "\" from initial value.");
-        }
-      tid = tid.GetParent ();
+      // No matching attribute value so we try to set the default value.
+      DoSet (info, *info.initialValue);
+      NS_LOG_DEBUG ("construct \"" << owner.GetName () << "::" <<
+                    info.name << "\" from initial value.");
     }
-  while (tid != ObjectBase::GetTypeId ());
   NotifyConstructionCompleted ();
 }
 
 bool
-ObjectBase::DoSet (Ptr<const AttributeAccessor> accessor,
-                   Ptr<const AttributeChecker> checker,
+ObjectBase::DoSet (const struct TypeId::AttributeInformation &info,
                    const AttributeValue &value)
 {
-  NS_LOG_FUNCTION (this << accessor << checker << &value);
-  Ptr<AttributeValue> v = checker->CreateValidValue (value);
+  NS_LOG_FUNCTION (this << info.name << &value);
+  Ptr<AttributeValue> v = info.checker->CreateValidValue (value);
   if (v == 0)
     {
       return false;
     }
-  bool ok = accessor->Set (this, *v);
-  return ok;
+  return info.accessor->Set (this, *v);
 }
 
 void
@@ -198,10 +195,15 @@ ObjectBase::SetAttribute (std::string name, const AttributeValue &value)
     {
       NS_FATAL_ERROR ("Attribute name=" << name << " is not settable for this object: tid=" << tid.GetName ());
     }
-  if (!DoSet (info.accessor, info.checker, value))
+  if (!DoSet (info, value))
     {
       NS_FATAL_ERROR ("Attribute name=" << name << " could not be set for this object: tid=" << tid.GetName ());
     }
+  if (info.isPointer)
+    {
+      // the Config paths through this attribute may match other objects
+      Object::NotifyGraphChange ();
+    }
 }
 bool
 ObjectBase::SetAttributeFailSafe (std::string name, const AttributeValue &value)
@@ -218,7 +220,16 @@ ObjectBase::SetAttributeFailSafe (std::string name, const AttributeValue &value)
     {
       return false;
     }
-  return DoSet (info.accessor, info.checker, value);
+  if (!DoSet (info, value))
+    {
+      return false;
+    }
+  if (info.isPointer)
+    {
+      // the Config paths through this attribute may match other objects
+      Object::NotifyGraphChange ();
+    }
+  return true;
 }
 
 void
@@ -268,17 +268,16 @@ protected:
 
 private:
   /**
-   * Attempt to set the value referenced by the accessor \p spec
-   * to a valid value according to the \c checker, based on \p value.
+   * Attempt to set the value referenced by the accessor of an
+   * attribute to a valid value according to its checker, based on
+   * \p value.
    *
-   * \param [in] spec The accessor for the storage location.
-   * \param [in] checker The checker to use in validating the value.
+   * \param [in] info The attribute, with its accessor and checker.
    * \param [in] value The value to attempt to store.
-   * \returns \c true if the \c value could be validated by the \p checker
+   * \returns \c true if the \c value could be validated by the checker
    *          and written to the storage location.
    */
-  bool DoSet (Ptr<const AttributeAccessor> spec,
-              Ptr<const AttributeChecker> checker,
+  bool DoSet (const struct TypeId::AttributeInformation &info,
               const AttributeValue &value);
 
 };
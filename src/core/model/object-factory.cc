@@ -19,6 +19,7 @@
  */
 #include "object-factory.h"
 #include "log.h"
+#include "pointer.h"
 #include <sstream>
 
 /**
@@ -90,7 +91,17 @@ ObjectFactory::Set (std::string name, const AttributeValue &value)
       NS_FATAL_ERROR ("Invalid value for attribute set (" << name << ") on " << m_tid.GetName ());
       return;
     }
-  m_parameters.Add (name, info.checker, value.Copy ());
+  if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+    {
+      // a string naming a type must create a new object for each Create
+      m_parameters.Add (name, info.checker, value.Copy ());
+    }
+  else
+    {
+      // keep the value converted, so that a StringValue is not parsed
+      // again by each Create
+      m_parameters.Add (name, info.checker, v);
+    }
 }
 
 TypeId
@@ -128,6 +128,12 @@ ObjectPtrContainerAccessor::Get (const ObjectBase * object, AttributeValue &valu
   return true;
 }
 bool
+ObjectPtrContainerAccessor::GetN (const ObjectBase *object, std::size_t *n) const
+{
+  NS_LOG_FUNCTION (this << object << n);
+  return DoGetN (object, n);
+}
+bool
 ObjectPtrContainerAccessor::HasGetter (void) const
 {
   NS_LOG_FUNCTION (this);
@@ -227,6 +227,14 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+  /**
+   * Get the number of instances in the container, without getting them.
+   *
+   * \param [in] object The container object.
+   * \param [out] n The number of instances in the container.
+   * \returns true if the value could be obtained successfully.
+   */
+  bool GetN (const ObjectBase *object, std::size_t *n) const;
 
 private:
   /**
@@ -25,6 +25,7 @@
 #include "attribute.h"
 #include "log.h"
 #include "string.h"
+#include <atomic>
 #include <vector>
 #include <sstream>
 #include <cstdlib>
@@ -46,6 +47,13 @@ NS_LOG_COMPONENT_DEFINE ("Object");
 
 NS_OBJECT_ENSURE_REGISTERED (Object);
 
+/**
+ * \ingroup object
+ * The generation of the graph of Objects, changed by the threads
+ * which create and destroy Objects.
+ */
+static std::atomic<uint64_t> g_graphGeneration (0);
+
 Object::AggregateIterator::AggregateIterator ()
   : m_object (0),
     m_current (0)
@@ -97,17 +105,23 @@ Object::Object ()
   : m_tid (Object::GetTypeId ()),
     m_disposed (false),
     m_initialized (false),
-    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
-    m_getObjectCount (0)
+    m_resolved (false),
+    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates)))
 {
   NS_LOG_FUNCTION (this);
   m_aggregates->n = 1;
+  m_aggregates->table = 0;
   m_aggregates->buffer[0] = this;
 }
 Object::~Object ()
 {
   // remove this object from the aggregate list
   NS_LOG_FUNCTION (this);
+  if (m_resolved)
+    {
+      // the Config path resolver keeps a pointer to this object
+      NotifyGraphChange ();
+    }
   uint32_t n = m_aggregates->n;
   for (uint32_t i = 0; i < n; i++)
     {
@@ -120,11 +134,14 @@ Object::~Object ()
           m_aggregates->n--;
         }
     }
+  // the lookup table may refer to this object
+  std::free (m_aggregates->table);
+  m_aggregates->table = 0;
   // finally, if all objects have been removed from the list,
   // delete the aggregate list
   if (m_aggregates->n == 0)
     {
-      std::free (m_aggregates);
+      FreeAggregates (m_aggregates);
     }
   m_aggregates = 0;
 }
@@ -132,10 +149,11 @@ Object::Object (const Object &o)
   : m_tid (o.m_tid),
     m_disposed (false),
     m_initialized (false),
-    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
-    m_getObjectCount (0)
+    m_resolved (false),
+    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates)))
 {
   m_aggregates->n = 1;
+  m_aggregates->table = 0;
   m_aggregates->buffer[0] = this;
 }
 void
@@ -151,6 +169,12 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
+  Object *found = 0;
+  if (FindLookup (tid, &found))
+    {
+      return found;
+    }
+
   uint32_t n = m_aggregates->n;
   TypeId objectTid = Object::GetTypeId ();
   for (uint32_t i = 0; i < n; i++)
@@ -163,21 +187,14 @@ Object::DoGetObject (TypeId tid) const
         }
       if (cur == tid)
         {
-          // This is an attempt to 'cache' the result of this lookup.
-          // the idea is that if we perform a lookup for a TypeId on this object,
-          // we are likely to perform the same lookup later so, we make sure
-          // that the aggregate array is sorted by the number of accesses
-          // to each object.
-
-          // first, increment the access count
-          current->m_getObjectCount++;
-          // then, update the sort
-          UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
-          return const_cast<Object *> (current);
+          found = current;
+          break;
         }
     }
-  return 0;
+  // The same lookups are likely to be performed again, on the
+  // per-packet paths for instance: remember the result.
+  AddLookup (m_aggregates, tid.GetUid (), found);
+  return found;
 }
 void
 Object::Initialize (void)
@@ -185,9 +202,8 @@ Object::Initialize (void)
   /**
    * Note: the code here is a bit tricky because we need to protect ourselves from
    * modifications in the aggregate array while DoInitialize is called. The user's
-   * implementation of the DoInitialize method could call GetObject (which could
-   * reorder the array) and it could call AggregateObject which would add an
-   * object at the end of the array. To be safe, we restart iteration over the
+   * implementation of the DoInitialize method could call AggregateObject which
+   * would add an object at the end of the array. To be safe, we restart iteration over the
    * array whenever we call some user code, just in case.
    */
   NS_LOG_FUNCTION (this);
@@ -216,12 +232,13 @@ Object::Dispose (void)
   /**
    * Note: the code here is a bit tricky because we need to protect ourselves from
    * modifications in the aggregate array while DoDispose is called. The user's
-   * DoDispose implementation could call GetObject (which could reorder the array)
-   * and it could call AggregateObject which would add an object at the end of the array.
+   * DoDispose implementation could call AggregateObject which would add an object
+   * at the end of the array.
    * So, to be safe, we restart the iteration over the array whenever we call some
    * user code.
    */
   NS_LOG_FUNCTION (this);
+  NotifyGraphChange ();
 restart:
   uint32_t n = m_aggregates->n;
   for (uint32_t i = 0; i < n; i++)
@@ -236,17 +253,46 @@ restart:
     }
 }
 void
-Object::UpdateSortedArray (struct Aggregates *aggregates, uint32_t j) const
+Object::AddLookup (struct Aggregates *aggregates, uint16_t uid, Object *object)
 {
-  NS_LOG_FUNCTION (this << aggregates << j);
-  while (j > 0
-         && aggregates->buffer[j]->m_getObjectCount > aggregates->buffer[j - 1]->m_getObjectCount)
+  NS_LOG_FUNCTION (aggregates << uid << object);
+  struct LookupTable *table = aggregates->table;
+  if (table == 0)
+    {
+      // room for the TypeIds of the aggregates, their parents and a
+      // few misses: the table is emptied when it is three quarters full
+      uint32_t size = 16;
+      while (size < 4 * aggregates->n)
+        {
+          size *= 2;
+        }
+      table = (struct LookupTable *)std::malloc (sizeof (struct LookupTable)
+                                                 + (size - 1) * sizeof (struct LookupTable::Entry));
+      table->mask = size - 1;
+      table->used = 0;
+      std::memset (table->entries, 0, size * sizeof (struct LookupTable::Entry));
+      aggregates->table = table;
+    }
+  else if (4 * (table->used + 1) > 3 * (table->mask + 1))
+    {
+      table->used = 0;
+      std::memset (table->entries, 0, (table->mask + 1) * sizeof (struct LookupTable::Entry));
+    }
+  uint32_t i = uid & table->mask;
+  while (table->entries[i].uid != 0)
     {
-      Object *tmp = aggregates->buffer[j - 1];
-      aggregates->buffer[j - 1] = aggregates->buffer[j];
-      aggregates->buffer[j] = tmp;
-      j--;
+      i = (i + 1) & table->mask;
     }
+  table->entries[i].uid = uid;
+  table->entries[i].object = object;
+  table->used++;
+}
+void
+Object::FreeAggregates (struct Aggregates *aggregates)
+{
+  NS_LOG_FUNCTION (aggregates);
+  std::free (aggregates->table);
+  std::free (aggregates);
 }
 void
 Object::AggregateObject (Ptr<Object> o)
@@ -256,6 +302,7 @@ Object::AggregateObject (Ptr<Object> o)
   NS_ASSERT (!o->m_disposed);
   NS_ASSERT (CheckLoose ());
   NS_ASSERT (o->CheckLoose ());
+  NotifyGraphChange ();
 
   Object *other = PeekPointer (o);
   // first create the new aggregate buffer.
@@ -263,6 +310,7 @@ Object::AggregateObject (Ptr<Object> o)
   struct Aggregates *aggregates =
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates) + (total - 1) * sizeof(Object*));
   aggregates->n = total;
+  aggregates->table = 0;
 
   // copy our buffer to the new buffer
   std::memcpy (&aggregates->buffer[0],
@@ -281,7 +329,6 @@ Object::AggregateObject (Ptr<Object> o)
                           other->GetInstanceTypeId () <<
                           " on objects of type " << typeId);
         }
-      UpdateSortedArray (aggregates, m_aggregates->n + i);
     }
 
   // keep track of the old aggregate buffers for the iteration
@@ -314,8 +361,18 @@ Object::AggregateObject (Ptr<Object> o)
     }
 
   // Now that we are done with them, we can free our old aggregate buffers
-  std::free (a);
-  std::free (b);
+  FreeAggregates (a);
+  FreeAggregates (b);
+}
+uint64_t
+Object::GetGraphGeneration (void)
+{
+  return g_graphGeneration.load (std::memory_order_relaxed);
+}
+void
+Object::NotifyGraphChange (void)
+{
+  g_graphGeneration.fetch_add (1, std::memory_order_relaxed);
 }
 /**
  * This function must be implemented in the stack that needs to notify
@@ -340,6 +397,9 @@ Object::SetTypeId (TypeId tid)
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (Check ());
   m_tid = tid;
+  // the lookups performed by the constructors used the TypeId of Object
+  std::free (m_aggregates->table);
+  m_aggregates->table = 0;
 }
 
 void
@@ -40,6 +40,9 @@
 namespace ns3 {
 
 class Object;
+namespace Config {
+class ResolverCache;
+} // namespace Config
 class AttributeAccessor;
 class AttributeValue;
 class TraceSourceAccessor;
@@ -224,6 +227,29 @@ public:
    */
   bool IsInitialized (void) const;
 
+  /**
+   * Get the generation of the graph of Objects.
+   *
+   * The generation changes whenever an Object is aggregated or
+   * disposed, whenever an Object found by resolving a Config path is
+   * destroyed, whenever an attribute holding a pointer to an Object is
+   * set, and whenever NotifyGraphChange() is called: the Config paths
+   * resolved in the same generation match the same Objects.  The
+   * creation of an Object does not change it, since the new Object is
+   * not reachable by a Config path until it is linked to another one.
+   *
+   * \returns The generation of the graph of Objects.
+   */
+  static uint64_t GetGraphGeneration (void);
+  /**
+   * Start a new generation of the graph of Objects.
+   *
+   * Call it when an Object is added to a container of Objects
+   * reachable by a Config path, e.g., by Node::AddDevice(), or when it
+   * is linked to another Object without setting an attribute.
+   */
+  static void NotifyGraphChange (void);
+
 protected:
   /**
    * Notify all Objects aggregated to this one of a new Object being
@@ -320,7 +346,32 @@ private:
   friend class ObjectFactory;
   friend class AggregateIterator;
   friend struct ObjectDeleter;
+  friend class Config::ResolverCache;
 
+  /**
+   * The results of the lookups of the aggregates by TypeId.
+   *
+   * This is an open addressing hash table, indexed by the TypeId uid,
+   * which also remembers the TypeIds matching none of the aggregates.
+   * Its entries are held with the C-style trick described in Aggregates.
+   */
+  struct LookupTable
+  {
+    /** An entry of the table. */
+    struct Entry
+    {
+      /** The TypeId uid, or 0 if the entry is free. */
+      uint16_t uid;
+      /** The matching Object, or 0 if none matches. */
+      Object *object;
+    };
+    /** The number of entries minus one: the number of entries is a power of two. */
+    uint32_t mask;
+    /** The number of used entries. */
+    uint32_t used;
+    /** The array of entries. */
+    struct Entry entries[1];
+  };
   /**
    * The list of Objects aggregated to this one.
    *
@@ -337,6 +388,8 @@ private:
   {
     /** The number of entries in \c buffer. */
     uint32_t n;
+    /** The results of DoGetObject, allocated by the first lookup. */
+    struct LookupTable *table;
     /** The array of Objects. */
     Object *buffer[1];
   };
@@ -348,6 +401,14 @@ private:
    * \return The matching Object, if it is found
    */
   Ptr<Object> DoGetObject (TypeId tid) const;
+  /**
+   * Find the result of a previous lookup of a TypeId in the aggregates.
+   *
+   * \param [in] tid The TypeId we're looking for
+   * \param [out] object The matching Object, or 0 if none matches
+   * \return \c true if the TypeId was looked up before
+   */
+  inline bool FindLookup (TypeId tid, Object **object) const;
   /**
    * Verify that this Object is still live, by checking it's reference count.
    * \return \c true if the reference count is non zero.
@@ -389,12 +450,19 @@ private:
   void Construct (const AttributeConstructionList &attributes);
 
   /**
-   * Keep the list of aggregates in most-recently-used order
+   * Remember the result of a lookup in the aggregates.
    *
    * \param [in,out] aggregates The list of aggregated Objects.
-   * \param [in] i The most recently used entry in the list.
+   * \param [in] uid The uid of the TypeId looked up.
+   * \param [in] object The matching Object, or 0 if none matches.
    */
-  void UpdateSortedArray (struct Aggregates *aggregates, uint32_t i) const;
+  static void AddLookup (struct Aggregates *aggregates, uint16_t uid, Object *object);
+  /**
+   * Free a list of aggregated Objects and its lookup table.
+   *
+   * \param [in] aggregates The list of aggregated Objects.
+   */
+  static void FreeAggregates (struct Aggregates *aggregates);
   /**
    * Attempt to delete this Object.
    *
@@ -418,6 +486,12 @@ private:
    * \c false otherwise
    */
   bool m_initialized;
+  /**
+   * Set to \c true when a pointer to this Object is kept by the
+   * Config path resolver, so that its destruction changes the
+   * generation of the graph of Objects.
+   */
+  bool m_resolved;
   /**
    * A pointer to an array of 'aggregates'.
    *
@@ -426,14 +500,6 @@ private:
    * so the size of the array is indirectly a reference count.
    */
   struct Aggregates * m_aggregates;
-  /**
-   * The number of times the Object was accessed with a
-   * call to GetObject().
-   *
-   * This integer is used to implement a heuristic to sort
-   * the array of aggregates in most-frequently accessed order.
-   */
-  uint32_t m_getObjectCount;
 };
 
 template <typename T>
@@ -456,22 +522,53 @@ ObjectDeleter::Delete (Object *object)
   object->DoDelete ();
 }
 
+bool
+Object::FindLookup (TypeId tid, Object **object) const
+{
+  const struct LookupTable *table = m_aggregates->table;
+  if (table == 0)
+    {
+      return false;
+    }
+  uint16_t uid = tid.GetUid ();
+  for (uint32_t i = uid & table->mask; table->entries[i].uid != 0; i = (i + 1) & table->mask)
+    {
+      if (table->entries[i].uid == uid)
+        {
+          *object = table->entries[i].object;
+          return true;
+        }
+    }
+  return false;
+}
+
 template <typename T>
 Ptr<T>
 Object::GetObject () const
 {
-  // This is an optimization: if the cast works (which is likely),
-  // things will be pretty fast.
-  T *result = dynamic_cast<T *> (m_aggregates->buffer[0]);
-  if (result != 0)
+  // This is an optimization: once the TypeId was looked up, finding
+  // it again is a hash table access, inlined here.
+  Object *object;
+  if (FindLookup (T::GetTypeId (), &object))
     {
-      return Ptr<T> (result);
+      if (object != 0)
+        {
+          return Ptr<T> (static_cast<T *> (object));
+        }
     }
-  // if the cast does not work, we try to do a full type check.
-  Ptr<Object> found = DoGetObject (T::GetTypeId ());
-  if (found != 0)
+  else
     {
-      return Ptr<T> (static_cast<T *> (PeekPointer (found)));
+      Ptr<Object> found = DoGetObject (T::GetTypeId ());
+      if (found != 0)
+        {
+          return Ptr<T> (static_cast<T *> (PeekPointer (found)));
+        }
+    }
+  // The objects created without CreateObject do not know their
+  // TypeId: try a cast of the first object.
+  if (m_aggregates->buffer[0]->GetInstanceTypeId () == Object::GetTypeId ())
+    {
+      return Ptr<T> (dynamic_cast<T *> (m_aggregates->buffer[0]));
     }
   return 0;
 }
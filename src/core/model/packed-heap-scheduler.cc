@@ -0,0 +1,276 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packed-heap-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::PackedHeapScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PackedHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (PackedHeapScheduler);
+
+TypeId
+PackedHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PackedHeapScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<PackedHeapScheduler> ()
+  ;
+  return tid;
+}
+
+PackedHeapScheduler::PackedHeapScheduler ()
+  : m_keys (0),
+    m_size (0),
+    m_capacity (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PackedHeapScheduler::~PackedHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+PackedHeapScheduler::IsLess (const Key &a, const Key &b)
+{
+  // the uids are unique, so the payload index never decides
+  return a.ts < b.ts || (a.ts == b.ts && a.uidSlot < b.uidSlot);
+}
+
+Scheduler::Event
+PackedHeapScheduler::GetEvent (const Key &key) const
+{
+  const Payload &payload = m_payloads[static_cast<uint32_t> (key.uidSlot)];
+  Event ev;
+  ev.impl = payload.impl;
+  ev.key.m_ts = key.ts;
+  ev.key.m_uid = static_cast<uint32_t> (key.uidSlot >> 32);
+  ev.key.m_context = payload.context;
+  return ev;
+}
+
+void
+PackedHeapScheduler::Grow (void)
+{
+  NS_LOG_FUNCTION (this << m_capacity);
+  // room for the alignment of m_keys + 1 on a cache line
+  std::size_t slack = CACHE_LINE / sizeof (Key);
+  std::vector<Key> storage (std::max<std::size_t> (2 * m_capacity, 1024) + slack);
+  uintptr_t first = reinterpret_cast<uintptr_t> (&storage[1]);
+  uintptr_t aligned = (first + CACHE_LINE - 1) & ~static_cast<uintptr_t> (CACHE_LINE - 1);
+  Key *keys = &storage[0] + (aligned - first) / sizeof (Key);
+  std::copy (m_keys, m_keys + m_size, keys);
+  m_storage.swap (storage);
+  m_keys = keys;
+  m_capacity = m_storage.size () - (m_keys - &m_storage[0]);
+}
+
+void
+PackedHeapScheduler::SiftUp (std::size_t index, const Key &key)
+{
+  NS_LOG_FUNCTION (this << index);
+  while (index > 0)
+    {
+      std::size_t parent = (index - 1) / ARITY;
+      if (!IsLess (key, m_keys[parent]))
+        {
+          break;
+        }
+      m_keys[index] = m_keys[parent];
+      index = parent;
+    }
+  m_keys[index] = key;
+}
+
+void
+PackedHeapScheduler::SiftDown (std::size_t index, const Key &key)
+{
+  NS_LOG_FUNCTION (this << index);
+  while (true)
+    {
+      std::size_t first = index * ARITY + 1;
+      if (first >= m_size)
+        {
+          break;
+        }
+      std::size_t last = std::min (first + ARITY, m_size);
+      std::size_t smallest = first;
+      for (std::size_t child = first + 1; child < last; ++child)
+        {
+          if (IsLess (m_keys[child], m_keys[smallest]))
+            {
+              smallest = child;
+            }
+        }
+      if (!IsLess (m_keys[smallest], key))
+        {
+          break;
+        }
+      m_keys[index] = m_keys[smallest];
+      index = smallest;
+    }
+  m_keys[index] = key;
+}
+
+std::size_t
+PackedHeapScheduler::MoveHoleDown (std::size_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  while (true)
+    {
+      std::size_t first = index * ARITY + 1;
+      if (first >= m_size)
+        {
+          return index;
+        }
+      std::size_t smallest = first;
+      if (first + ARITY <= m_size)
+        {
+          // full node, the common case
+          for (std::size_t child = first + 1; child < first + ARITY; ++child)
+            {
+              if (IsLess (m_keys[child], m_keys[smallest]))
+                {
+                  smallest = child;
+                }
+            }
+        }
+      else
+        {
+          for (std::size_t child = first + 1; child < m_size; ++child)
+            {
+              if (IsLess (m_keys[child], m_keys[smallest]))
+                {
+                  smallest = child;
+                }
+            }
+        }
+      m_keys[index] = m_keys[smallest];
+      index = smallest;
+    }
+}
+
+void
+PackedHeapScheduler::RemoveAt (std::size_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  m_freeSlots.push_back (static_cast<uint32_t> (m_keys[index].uidSlot));
+  m_size--;
+  if (index == m_size)
+    {
+      return;
+    }
+  Key last = m_keys[m_size];
+  if (index > 0 && IsLess (last, m_keys[(index - 1) / ARITY]))
+    {
+      SiftUp (index, last);
+    }
+  else if (index == 0)
+    {
+      SiftUp (MoveHoleDown (0), last);
+    }
+  else
+    {
+      SiftDown (index, last);
+    }
+}
+
+void
+PackedHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint32_t slot;
+  if (m_freeSlots.empty ())
+    {
+      slot = m_payloads.size ();
+      m_payloads.push_back (Payload ());
+    }
+  else
+    {
+      slot = m_freeSlots.back ();
+      m_freeSlots.pop_back ();
+    }
+  m_payloads[slot].impl = ev.impl;
+  m_payloads[slot].context = ev.key.m_context;
+
+  if (m_size == m_capacity)
+    {
+      Grow ();
+    }
+  Key key;
+  key.ts = ev.key.m_ts;
+  key.uidSlot = (static_cast<uint64_t> (ev.key.m_uid) << 32) | slot;
+  m_size++;
+  SiftUp (m_size - 1, key);
+}
+
+bool
+PackedHeapScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+PackedHeapScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return GetEvent (m_keys[0]);
+}
+
+Scheduler::Event
+PackedHeapScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event next = GetEvent (m_keys[0]);
+  RemoveAt (0);
+  return next;
+}
+
+void
+PackedHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t uid = ev.key.m_uid;
+  for (std::size_t i = 0; i < m_size; ++i)
+    {
+      if (m_keys[i].ts == ev.key.m_ts && (m_keys[i].uidSlot >> 32) == uid)
+        {
+          NS_ASSERT (GetEvent (m_keys[i]).impl == ev.impl);
+          RemoveAt (i);
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKED_HEAP_SCHEDULER_H
+#define PACKED_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::PackedHeapScheduler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a 4-ary heap event scheduler with packed keys
+ *
+ * Like the HeapScheduler, this scheduler keeps the events in an
+ * implicit heap, but it is laid out to minimize the memory traffic of
+ * the sift operations:
+ *  - the heap only holds 16 byte keys: the timestamp, then the event
+ *    uid and the index of the event payload packed in a second 64 bit
+ *    word, so that two keys are compared with two integer comparisons;
+ *  - the payloads (the EventImpl pointer and the context) are stored
+ *    in a separate array and never move while the event is pending;
+ *  - each node has four children, which fill exactly one cache line
+ *    (the key array is aligned so that siblings never straddle two
+ *    lines), so the heap is half as deep as a binary heap and each
+ *    level of a sift down reads a single line;
+ *  - the hole left by the earliest event is first moved down to a leaf
+ *    along the smallest children, and the last key is then moved up
+ *    from there, which saves one comparison per level since the last
+ *    key usually belongs near the bottom.
+ *
+ * Remove has to scan the keys, so it is linear in the number of events.
+ */
+class PackedHeapScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  PackedHeapScheduler ();
+  /** Destructor. */
+  virtual ~PackedHeapScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** A packed heap key. */
+  struct Key
+  {
+    /** The event timestamp. */
+    uint64_t ts;
+    /** The event uid in the high half, the payload index in the low half. */
+    uint64_t uidSlot;
+  };
+
+  /** An event payload. */
+  struct Payload
+  {
+    /** The event implementation. */
+    EventImpl *impl;
+    /** The event context. */
+    uint32_t context;
+  };
+
+  /**
+   * Compare (less than) two keys.
+   *
+   * \param [in] a The first key.
+   * \param [in] b The second key.
+   * \returns \c true if \c a < \c b
+   */
+  static inline bool IsLess (const Key &a, const Key &b);
+  /**
+   * Build the scheduler event of a key.
+   *
+   * \param [in] key The key.
+   * \returns The event.
+   */
+  inline Scheduler::Event GetEvent (const Key &key) const;
+  /**
+   * Move a key up from a position to its place in the heap.
+   *
+   * \param [in] index The starting position.
+   * \param [in] key The key.
+   */
+  void SiftUp (std::size_t index, const Key &key);
+  /**
+   * Move a key down from a position to its place in the heap.
+   *
+   * \param [in] index The starting position.
+   * \param [in] key The key.
+   */
+  void SiftDown (std::size_t index, const Key &key);
+  /**
+   * Move the hole at a position down to a leaf, along the smallest
+   * children.
+   *
+   * \param [in] index The position of the hole.
+   * \returns The position of the leaf.
+   */
+  std::size_t MoveHoleDown (std::size_t index);
+  /** Make room for one more key. */
+  void Grow (void);
+  /**
+   * Remove the key at a position.
+   *
+   * \param [in] index The position.
+   */
+  void RemoveAt (std::size_t index);
+
+  /** The number of children of each node. */
+  static const std::size_t ARITY = 4;
+  /** The size of a cache line, in bytes. */
+  static const std::size_t CACHE_LINE = 64;
+
+  /** The memory of the keys. */
+  std::vector<Key> m_storage;
+  /**
+   * The keys, managed as a heap rooted at index 0.  This points one
+   * key before a cache line boundary, so that the children of every
+   * node start on a boundary.
+   */
+  Key *m_keys;
+  /** The number of keys. */
+  std::size_t m_size;
+  /** The number of keys which fit in m_storage after m_keys. */
+  std::size_t m_capacity;
+  /** The payloads, indexed by the low half of Key::uidSlot. */
+  std::vector<Payload> m_payloads;
+  /** The indexes of the unused payloads. */
+  std::vector<uint32_t> m_freeSlots;
+};
+
+} // namespace ns3
+
+#endif /* PACKED_HEAP_SCHEDULER_H */
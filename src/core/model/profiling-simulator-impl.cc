@@ -0,0 +1,646 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "profiling-simulator-impl.h"
+#include "default-simulator-impl.h"
+#include "event-impl.h"
+#include "object-factory.h"
+#include "string.h"
+#include "type-id.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+#ifdef HAVE_DLFCN_H
+#include <dlfcn.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::ProfilingSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("ProfilingSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (ProfilingSimulatorImpl);
+
+/**
+ * \ingroup simulator
+ *
+ * An event wrapped to measure the time spent in it, and the time
+ * spent to dispatch it since the end of the previous event.
+ */
+class ProfilingSimulatorImpl::ProfiledEventImpl : public EventImpl
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] impl The profiling simulator implementation.
+   * \param [in] event The wrapped event.
+   * \param [in] profile The profile of the event.
+   */
+  ProfiledEventImpl (ProfilingSimulatorImpl *impl, EventImpl *event, Profile *profile)
+    : m_impl (impl),
+      m_event (event),
+      m_profile (profile)
+  {}
+  virtual ~ProfiledEventImpl ()
+  {
+    m_event->Unref ();
+  }
+  /** \returns The profile of the event. */
+  Profile * GetProfile (void) const
+  {
+    return m_profile;
+  }
+
+protected:
+  virtual void Notify (void)
+  {
+    int64_t eventListNs = m_impl->m_eventListNs;
+    int64_t start = GetWallClockNs ();
+    m_event->Invoke ();
+    int64_t end = GetWallClockNs ();
+    m_profile->invocations++;
+    // the events scheduled and removed by this one are counted in the
+    // event list time
+    m_profile->invokeNs += end - start - (m_impl->m_eventListNs - eventListNs);
+    m_profile->dispatchNs += start - m_impl->m_lastEndNs;
+    m_impl->m_lastEndNs = end;
+  }
+
+private:
+  ProfilingSimulatorImpl *m_impl;   //!< The profiling implementation.
+  EventImpl *m_event;               //!< The wrapped event.
+  Profile *m_profile;               //!< The profile of the event.
+};
+
+TypeId
+ProfilingSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ProfilingSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<ProfilingSimulatorImpl> ()
+    .AddAttribute ("Implementation",
+                   "The simulator implementation which runs the events.",
+                   TypeIdValue (DefaultSimulatorImpl::GetTypeId ()),
+                   MakeTypeIdAccessor (&ProfilingSimulatorImpl::m_implType),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("ReportFile",
+                   "The file of the report written at Simulator::Destroy, "
+                   "or empty for no report.",
+                   StringValue ("simulator-profile.txt"),
+                   MakeStringAccessor (&ProfilingSimulatorImpl::m_reportFile),
+                   MakeStringChecker ())
+    .AddAttribute ("FoldedFile",
+                   "The file of the folded stacks written at Simulator::Destroy, "
+                   "or empty for no file.",
+                   StringValue ("simulator-profile.folded"),
+                   MakeStringAccessor (&ProfilingSimulatorImpl::m_foldedFile),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+ProfilingSimulatorImpl::ProfilingSimulatorImpl ()
+  : m_lastEndNs (0),
+    m_eventListNs (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ProfilingSimulatorImpl::~ProfilingSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ProfilingSimulatorImpl::NotifyConstructionCompleted (void)
+{
+  SimulatorImpl::NotifyConstructionCompleted ();
+  ObjectFactory factory;
+  factory.SetTypeId (m_implType);
+  m_impl = factory.Create<SimulatorImpl> ();
+}
+
+int64_t
+ProfilingSimulatorImpl::GetWallClockNs (void)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+           (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
+
+#ifdef HAVE_ITANIUM_MEMBER_POINTERS
+/**
+ * \ingroup simulator
+ *
+ * Get the address of the code run when a class method is called on an
+ * object, with the layout of the class method pointers of the Itanium
+ * C++ ABI: a virtual method is found in the virtual table of the object.
+ *
+ * \param [in] target The target of an event.
+ * \returns The address of the code of the method, or 0 if unknown.
+ */
+static const void *
+GetMethodAddress (const EventImpl::Target &target)
+{
+  struct
+  {
+    uintptr_t ptr;    // the address, or the offset in the virtual table
+    ptrdiff_t adj;    // the adjustment of the object address
+  } p;
+  if (target.object == 0 || target.methodSize != sizeof (p))
+    {
+      return 0;
+    }
+  std::memcpy (&p, target.method, sizeof (p));
+#if defined (__arm__) || defined (__aarch64__)
+  bool isVirtual = (p.adj & 1) != 0;
+  uintptr_t offset = p.ptr;
+  ptrdiff_t adj = p.adj >> 1;
+#else
+  bool isVirtual = (p.ptr & 1) != 0;
+  uintptr_t offset = p.ptr - 1;
+  ptrdiff_t adj = p.adj;
+#endif
+  if (!isVirtual)
+    {
+      return reinterpret_cast<const void *> (p.ptr);
+    }
+  const char *self = static_cast<const char *> (target.object) + adj;
+  const char *vtable = *reinterpret_cast<const char * const *> (self);
+  return *reinterpret_cast<const void * const *> (vtable + offset);
+}
+#endif /* HAVE_ITANIUM_MEMBER_POINTERS */
+
+ProfilingSimulatorImpl::Key
+ProfilingSimulatorImpl::GetKey (const EventImpl *event, uint32_t context)
+{
+  EventImpl::Target target;
+  event->GetTarget (target);
+  Key key = { std::type_index (typeid (*event)), target.function, 0, {}, context };
+#ifdef HAVE_ITANIUM_MEMBER_POINTERS
+  if (key.address == 0)
+    {
+      key.address = GetMethodAddress (target);
+    }
+#endif /* HAVE_ITANIUM_MEMBER_POINTERS */
+  if (key.address == 0 && target.methodSize != 0)
+    {
+      key.object = target.type;
+      std::memcpy (key.method, target.method, sizeof (key.method));
+    }
+  return key;
+}
+
+ProfilingSimulatorImpl::Profile *
+ProfilingSimulatorImpl::GetProfile (const EventImpl *event, uint32_t context)
+{
+  Key key = GetKey (event, context);
+  Profiles::iterator i = m_profiles.find (key);
+  if (i == m_profiles.end ())
+    {
+      Profile profile = { 0, 0, 0, 0, 0, 0, 0 };
+      i = m_profiles.insert (std::make_pair (key, profile)).first;
+    }
+  return &i->second;
+}
+
+ProfilingSimulatorImpl::Profile *
+ProfilingSimulatorImpl::GetProfile (const EventId &id) const
+{
+  const ProfiledEventImpl *event = dynamic_cast<const ProfiledEventImpl *> (id.PeekEventImpl ());
+  return event != 0 ? event->GetProfile () : 0;
+}
+
+EventImpl *
+ProfilingSimulatorImpl::Wrap (EventImpl *event, Profile *profile)
+{
+  return new ProfiledEventImpl (this, event, profile);
+}
+
+std::string
+ProfilingSimulatorImpl::Demangle (const char *name)
+{
+  std::string demangled = name;
+#if (__GNUC__ >= 3)
+  int status;
+  char *buffer = abi::__cxa_demangle (name, NULL, NULL, &status);
+  if (status == 0)
+    {
+      demangled = buffer;
+    }
+  std::free (buffer);
+#endif
+  return demangled;
+}
+
+std::string
+ProfilingSimulatorImpl::GetTargetName (const Key &key)
+{
+#ifdef HAVE_DLFCN_H
+  Dl_info info;
+  if (key.address != 0
+      && dladdr (key.address, &info) != 0
+      && info.dli_sname != 0
+      && info.dli_saddr == key.address)
+    {
+      return Demangle (info.dli_sname);
+    }
+#endif
+  std::string name = GetTypeTargetName (Demangle (key.type.name ()));
+  std::ostringstream oss;
+  if (key.address != 0)
+    {
+      // the symbol is not exported: the address tells apart the
+      // functions of the same type
+      oss << " at " << key.address;
+    }
+  else if (key.object != 0)
+    {
+      // the class member pointer tells apart the methods of the same type
+      oss << " on " << Demangle (key.object->name ()) << " method " << std::hex;
+      for (std::size_t i = 0; i < sizeof (key.method); ++i)
+        {
+          oss << std::setw (2) << std::setfill ('0') << static_cast<uint32_t> (key.method[i]);
+        }
+    }
+  return name + oss.str ();
+}
+
+std::string
+ProfilingSimulatorImpl::GetTypeTargetName (std::string name)
+{
+  // The events made by MakeEvent are local classes of its
+  // instantiations: keep the type of the function, its first parameter.
+  std::string::size_type start = name.find ("MakeEvent");
+  if (start == std::string::npos)
+    {
+      return name;
+    }
+  int depth = 0;
+  for (std::string::size_type i = start; i < name.size (); ++i)
+    {
+      char c = name[i];
+      if (c == '(' && depth == 0)
+        {
+          start = i + 1;
+          break;
+        }
+      else if (c == '<')
+        {
+          depth++;
+        }
+      else if (c == '>')
+        {
+          depth--;
+        }
+    }
+  for (std::string::size_type i = start; i < name.size (); ++i)
+    {
+      char c = name[i];
+      if (c == '<' || c == '(')
+        {
+          depth++;
+        }
+      else if ((c == '>' || c == ')') && depth > 0)
+        {
+          depth--;
+        }
+      else if (c == ',' || c == ')')
+        {
+          return name.substr (start, i - start);
+        }
+    }
+  return name;
+}
+
+void
+ProfilingSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  m_lastEndNs = GetWallClockNs ();
+  m_impl->Destroy ();
+
+  if (!m_reportFile.empty ())
+    {
+      std::ofstream os (m_reportFile.c_str ());
+      PrintReport (os);
+    }
+  if (!m_foldedFile.empty ())
+    {
+      std::ofstream os (m_foldedFile.c_str ());
+      PrintFolded (os);
+    }
+}
+
+bool
+ProfilingSimulatorImpl::IsFinished (void) const
+{
+  return m_impl->IsFinished ();
+}
+
+void
+ProfilingSimulatorImpl::Stop (void)
+{
+  m_impl->Stop ();
+}
+
+void
+ProfilingSimulatorImpl::Stop (const Time &delay)
+{
+  m_impl->Stop (delay);
+}
+
+EventId
+ProfilingSimulatorImpl::Schedule (const Time &delay, EventImpl *event)
+{
+  int64_t enter = GetWallClockNs ();
+  Profile *profile = GetProfile (event, m_impl->GetContext ());
+  EventImpl *wrapped = Wrap (event, profile);
+  int64_t start = GetWallClockNs ();
+  EventId id = m_impl->Schedule (delay, wrapped);
+  int64_t end = GetWallClockNs ();
+  profile->insertNs += end - start;
+  profile->inserts++;
+  m_eventListNs += end - enter;
+  return id;
+}
+
+void
+ProfilingSimulatorImpl::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event)
+{
+  int64_t enter = GetWallClockNs ();
+  Profile *profile = GetProfile (event, context);
+  EventImpl *wrapped = Wrap (event, profile);
+  int64_t start = GetWallClockNs ();
+  m_impl->ScheduleWithContext (context, delay, wrapped);
+  int64_t end = GetWallClockNs ();
+  profile->insertNs += end - start;
+  profile->inserts++;
+  m_eventListNs += end - enter;
+}
+
+void
+ProfilingSimulatorImpl::ScheduleWithContextBatch (const Time &delay, const Simulator::EventBatch &batch)
+{
+  if (batch.empty ())
+    {
+      return;
+    }
+  int64_t enter = GetWallClockNs ();
+  Simulator::EventBatch wrapped (batch);
+  std::vector<Profile *> profiles;
+  profiles.reserve (batch.size ());
+  for (Simulator::EventBatch::iterator i = wrapped.begin (); i != wrapped.end (); ++i)
+    {
+      Profile *profile = GetProfile (i->event, i->context);
+      i->event = Wrap (i->event, profile);
+      profiles.push_back (profile);
+    }
+  int64_t start = GetWallClockNs ();
+  m_impl->ScheduleWithContextBatch (delay, wrapped);
+  int64_t end = GetWallClockNs ();
+  // the events of the batch share the cost of its insertion
+  int64_t share = (end - start) / static_cast<int64_t> (profiles.size ());
+  for (std::vector<Profile *>::const_iterator i = profiles.begin (); i != profiles.end (); ++i)
+    {
+      (*i)->insertNs += share;
+      (*i)->inserts++;
+    }
+  m_eventListNs += end - enter;
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  int64_t enter = GetWallClockNs ();
+  Profile *profile = GetProfile (event, m_impl->GetContext ());
+  EventImpl *wrapped = Wrap (event, profile);
+  int64_t start = GetWallClockNs ();
+  EventId id = m_impl->ScheduleNow (wrapped);
+  int64_t end = GetWallClockNs ();
+  profile->insertNs += end - start;
+  profile->inserts++;
+  m_eventListNs += end - enter;
+  return id;
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  int64_t enter = GetWallClockNs ();
+  Profile *profile = GetProfile (event, m_impl->GetContext ());
+  EventId id = m_impl->ScheduleDestroy (Wrap (event, profile));
+  m_eventListNs += GetWallClockNs () - enter;
+  return id;
+}
+
+void
+ProfilingSimulatorImpl::Remove (const EventId &id)
+{
+  int64_t enter = GetWallClockNs ();
+  Profile *profile = GetProfile (id);
+  int64_t start = GetWallClockNs ();
+  m_impl->Remove (id);
+  int64_t end = GetWallClockNs ();
+  if (profile != 0)
+    {
+      profile->removeNs += end - start;
+      profile->removes++;
+    }
+  m_eventListNs += end - enter;
+}
+
+void
+ProfilingSimulatorImpl::Cancel (const EventId &id)
+{
+  m_impl->Cancel (id);
+}
+
+bool
+ProfilingSimulatorImpl::IsExpired (const EventId &id) const
+{
+  return m_impl->IsExpired (id);
+}
+
+void
+ProfilingSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_lastEndNs = GetWallClockNs ();
+  m_impl->Run ();
+}
+
+Time
+ProfilingSimulatorImpl::Now (void) const
+{
+  return m_impl->Now ();
+}
+
+Time
+ProfilingSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  return m_impl->GetDelayLeft (id);
+}
+
+Time
+ProfilingSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return m_impl->GetMaximumSimulationTime ();
+}
+
+void
+ProfilingSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_impl->SetScheduler (schedulerFactory);
+}
+
+uint32_t
+ProfilingSimulatorImpl::GetSystemId (void) const
+{
+  return m_impl->GetSystemId ();
+}
+
+uint32_t
+ProfilingSimulatorImpl::GetContext (void) const
+{
+  return m_impl->GetContext ();
+}
+
+uint64_t
+ProfilingSimulatorImpl::GetEventCount (void) const
+{
+  return m_impl->GetEventCount ();
+}
+
+void
+ProfilingSimulatorImpl::Accumulate (Profile &sum, const Profile &profile)
+{
+  sum.invocations += profile.invocations;
+  sum.invokeNs += profile.invokeNs;
+  sum.dispatchNs += profile.dispatchNs;
+  sum.inserts += profile.inserts;
+  sum.insertNs += profile.insertNs;
+  sum.removes += profile.removes;
+  sum.removeNs += profile.removeNs;
+}
+
+void
+ProfilingSimulatorImpl::PrintReport (std::ostream &os) const
+{
+  // the contexts of a target are summed up in the report
+  typedef std::map<std::string, Profile> Targets;
+  Targets targets;
+  Profile zero = { 0, 0, 0, 0, 0, 0, 0 };
+  Profile total = zero;
+  for (Profiles::const_iterator i = m_profiles.begin (); i != m_profiles.end (); ++i)
+    {
+      std::string name = GetTargetName (i->first);
+      Targets::iterator t = targets.insert (std::make_pair (name, zero)).first;
+      Accumulate (t->second, i->second);
+      Accumulate (total, i->second);
+    }
+
+  typedef std::pair<std::string, Profile> Target;
+  std::vector<Target> sorted (targets.begin (), targets.end ());
+  std::stable_sort (sorted.begin (), sorted.end (),
+                    [] (const Target &a, const Target &b)
+                    { return a.second.invokeNs > b.second.invokeNs; });
+
+  os << "# " << total.invocations << " events, "
+     << total.invokeNs * 1e-9 << " s in the events, "
+     << (total.dispatchNs + total.insertNs + total.removeNs) * 1e-9
+     << " s in the event list" << std::endl;
+  os << "#" << std::setw (11) << "time(s)"
+     << std::setw (8) << "%"
+     << std::setw (12) << "count"
+     << std::setw (12) << "mean(us)"
+     << std::setw (12) << "dispatch(s)"
+     << std::setw (12) << "insert(s)"
+     << std::setw (12) << "remove(s)"
+     << "  target" << std::endl;
+  for (std::vector<Target>::const_iterator i = sorted.begin ();
+       i != sorted.end (); ++i)
+    {
+      const Profile &p = i->second;
+      double share = total.invokeNs > 0 ? 100.0 * p.invokeNs / total.invokeNs : 0;
+      double mean = p.invocations > 0 ? p.invokeNs * 1e-3 / p.invocations : 0;
+      os << std::setw (12) << p.invokeNs * 1e-9
+         << std::setw (8) << std::fixed << std::setprecision (2) << share
+         << std::setw (12) << p.invocations
+         << std::setw (12) << std::setprecision (3) << mean
+         << std::defaultfloat << std::setprecision (6)
+         << std::setw (12) << p.dispatchNs * 1e-9
+         << std::setw (12) << p.insertNs * 1e-9
+         << std::setw (12) << p.removeNs * 1e-9
+         << "  " << i->first << std::endl;
+    }
+}
+
+void
+ProfilingSimulatorImpl::PrintFolded (std::ostream &os) const
+{
+  // the frames are separated by semicolons, and the stack by a space
+  // from its time in microseconds
+  std::map<std::string, int64_t> stacks;
+  for (Profiles::const_iterator i = m_profiles.begin (); i != m_profiles.end (); ++i)
+    {
+      const Profile &p = i->second;
+      std::string target = GetTargetName (i->first);
+      std::ostringstream context;
+      if (i->first.context == Simulator::NO_CONTEXT)
+        {
+          context << "no context";
+        }
+      else
+        {
+          context << "context " << i->first.context;
+        }
+      stacks["events;" + context.str () + ";" + target] += p.invokeNs;
+      stacks["event list;dispatch;" + target] += p.dispatchNs;
+      stacks["event list;insert;" + target] += p.insertNs;
+      stacks["event list;remove;" + target] += p.removeNs;
+    }
+  for (std::map<std::string, int64_t>::const_iterator i = stacks.begin (); i != stacks.end (); ++i)
+    {
+      if (i->second >= 1000)
+        {
+          os << i->first << " " << i->second / 1000 << std::endl;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,264 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROFILING_SIMULATOR_IMPL_H
+#define PROFILING_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "event-impl.h"
+#include "ptr.h"
+
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <functional>
+#include <typeindex>
+#include <unordered_map>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::ProfilingSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief A simulator implementation which profiles the events run by
+ * another one.
+ *
+ * Every event scheduled is wrapped in a profiled event, and the wall
+ * clock time spent in it is attributed to its target, the function or
+ * class member function bound by MakeEvent(), and to the context in
+ * which it runs.  The targets are identified by the address of their
+ * code, named by its demangled symbol.  The address of a class member
+ * function is only found with the class member pointer layout of the
+ * Itanium C++ ABI, used by gcc and clang, which is checked by
+ * configure; otherwise the member functions are identified by the type
+ * of their object and their class member pointer.  The time spent by
+ * the wrapped implementation to insert and remove the events in its
+ * event list, and to dispatch them, is attributed in the same way; the
+ * time spent by an event to schedule or remove other events is not
+ * counted in its own time.  At
+ * Simulator::Destroy(), a report of the targets sorted by decreasing
+ * time is written to the \c ReportFile, and the profile is written to
+ * the \c FoldedFile in the folded stack format of the flame graph
+ * tools, in microseconds.
+ *
+ * To profile a simulation:
+ * \code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::ProfilingSimulatorImpl"));
+ * \endcode
+ * or run it with \c --SimulatorImplementationType=ns3::ProfilingSimulatorImpl.
+ *
+ * The targets whose symbol is not exported, such as static functions,
+ * are named by their type and address, or by their type, the type of
+ * their object and their class member pointer, and the events not made
+ * by MakeEvent() by their type.  The profile is not synchronized, so the
+ * wrapped implementation must run the events in a single thread.
+ */
+class ProfilingSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  ProfilingSimulatorImpl ();
+  /** Destructor. */
+  ~ProfilingSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContextBatch (const Time &delay, const Simulator::EventBatch &batch);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * Print the report of the targets, sorted by decreasing time.
+   * \param [in,out] os The output stream.
+   */
+  void PrintReport (std::ostream &os) const;
+  /**
+   * Print the profile in the folded stack format.
+   * \param [in,out] os The output stream.
+   */
+  void PrintFolded (std::ostream &os) const;
+
+private:
+  class ProfiledEventImpl;
+
+  virtual void NotifyConstructionCompleted (void);
+
+  /** The profile of a target in a context. */
+  struct Profile
+  {
+    uint64_t invocations;   //!< The number of invocations.
+    int64_t invokeNs;       //!< The time spent in the target.
+    int64_t dispatchNs;     //!< The time spent to dispatch it.
+    uint64_t inserts;       //!< The number of insertions.
+    int64_t insertNs;       //!< The time spent to insert it.
+    uint64_t removes;       //!< The number of removals.
+    int64_t removeNs;       //!< The time spent to remove it.
+  };
+  /**
+   * The key of a profile: the type of the event, its target and its
+   * context.  The target is the address of its code where it is known;
+   * otherwise a class method is identified by the dynamic type of the
+   * object and the representation of the class member pointer.
+   */
+  struct Key
+  {
+    std::type_index type;           //!< The type of the event.
+    const void *address;            //!< The address of the target, or 0.
+    const std::type_info *object;   //!< The type of the object, or 0.
+    /** The representation of the class member pointer, or zeros. */
+    unsigned char method[sizeof (EventImpl::Target::method)];
+    uint32_t context;               //!< The context of the event.
+    /**
+     * Compare two keys.
+     * \param [in] other The other key.
+     * \returns \c true if the keys are equal.
+     */
+    bool operator== (const Key &other) const
+    {
+      return type == other.type && address == other.address && object == other.object
+             && std::memcmp (method, other.method, sizeof (method)) == 0
+             && context == other.context;
+    }
+  };
+  /** Hash of a Key. */
+  struct KeyHash
+  {
+    /**
+     * Hash a key.
+     * \param [in] key The key.
+     * \returns The hash of the key.
+     */
+    std::size_t operator() (const Key &key) const
+    {
+      std::size_t hash = key.type.hash_code () * 31 + std::hash<const void *> () (key.address);
+      for (std::size_t i = 0; i < sizeof (key.method); ++i)
+        {
+          hash = hash * 31 + key.method[i];
+        }
+      return hash * 31 + key.context;
+    }
+  };
+  /** The profiles of the targets. */
+  typedef std::unordered_map<Key, Profile, KeyHash> Profiles;
+
+  /**
+   * Get the profile of an event.
+   * \param [in] event The event, unwrapped.
+   * \param [in] context The context in which the event runs.
+   * \returns The profile of the event.
+   */
+  Profile * GetProfile (const EventImpl *event, uint32_t context);
+  /**
+   * Get the profile of a scheduled event.
+   * \param [in] id The identifier of the event.
+   * \returns The profile of the event, or 0 if it is not profiled.
+   */
+  Profile * GetProfile (const EventId &id) const;
+  /**
+   * Wrap an event in a profiled event.
+   * \param [in] event The event.
+   * \param [in] profile The profile of the event.
+   * \returns The profiled event.
+   */
+  EventImpl * Wrap (EventImpl *event, Profile *profile);
+  /**
+   * Build the key of the profile of an event.
+   * \param [in] event The event, unwrapped.
+   * \param [in] context The context in which the event runs.
+   * \returns The key.
+   */
+  static Key GetKey (const EventImpl *event, uint32_t context);
+  /**
+   * Get the name of the target of an event.
+   * \param [in] key The key of the profile of the event.
+   * \returns The demangled name of the target.
+   */
+  static std::string GetTargetName (const Key &key);
+  /**
+   * Demangle a C++ symbol or type name.
+   * \param [in] name The mangled name.
+   * \returns The demangled name, or \p name if it cannot be demangled.
+   */
+  static std::string Demangle (const char *name);
+  /**
+   * Get the name of the target of an event from the type of the event.
+   * \param [in] name The demangled name of the type of the event.
+   * \returns The type of the target, for the events made by MakeEvent(),
+   *          or \p name.
+   */
+  static std::string GetTypeTargetName (std::string name);
+
+  /**
+   * Add a profile to a sum.
+   * \param [in,out] sum The sum.
+   * \param [in] profile The profile to add.
+   */
+  static void Accumulate (Profile &sum, const Profile &profile);
+  /** \returns The current wall clock time, in nanoseconds. */
+  static int64_t GetWallClockNs (void);
+
+  /** The wrapped simulator implementation type. */
+  TypeId m_implType;
+  /** The name of the report file. */
+  std::string m_reportFile;
+  /** The name of the folded stack file. */
+  std::string m_foldedFile;
+  /** The profiles of the targets. */
+  Profiles m_profiles;
+  /** The end time of the last event, to measure the dispatch time. */
+  int64_t m_lastEndNs;
+  /**
+   * The time spent in the calls which insert and remove events, to
+   * subtract it from the time of the events which make them.
+   */
+  int64_t m_eventListNs;
+  /** The wrapped simulator implementation. */
+  Ptr<SimulatorImpl> m_impl;
+};
+
+} // namespace ns3
+
+#endif /* PROFILING_SIMULATOR_IMPL_H */
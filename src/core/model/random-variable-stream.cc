@@ -34,6 +34,7 @@
 #include "rng-stream.h"
 #include "rng-seed-manager.h"
 #include "unused.h"
+#include "system-mutex.h"
 #include <cmath>
 #include <iostream>
 
@@ -72,14 +73,62 @@ RandomVariableStream::GetTypeId (void)
   return tid;
 }
 
+namespace {
+
+/**
+ * \ingroup randomvariable
+ * The mutex protecting the list of the existing streams.  It is never
+ * deleted, so that the static streams can be destroyed at any time.
+ * \returns The mutex.
+ */
+SystemMutex &
+GetStreamsMutex (void)
+{
+  static SystemMutex *mutex = new SystemMutex ();
+  return *mutex;
+}
+
+/**
+ * \ingroup randomvariable
+ * The first stream in the list of the existing streams, walked by
+ * RandomVariableStream::ReseedAll.
+ */
+RandomVariableStream *g_streams = 0;
+
+} // unnamed namespace
+
 RandomVariableStream::RandomVariableStream ()
-  : m_rng (0)
+  : m_rng (0),
+    m_streamIndex (0),
+    m_prevStream (0)
 {
   NS_LOG_FUNCTION (this);
+  CriticalSection cs (GetStreamsMutex ());
+  m_nextStream = g_streams;
+  if (m_nextStream != 0)
+    {
+      m_nextStream->m_prevStream = this;
+    }
+  g_streams = this;
 }
 RandomVariableStream::~RandomVariableStream ()
 {
   NS_LOG_FUNCTION (this);
+  {
+    CriticalSection cs (GetStreamsMutex ());
+    if (m_prevStream != 0)
+      {
+        m_prevStream->m_nextStream = m_nextStream;
+      }
+    else
+      {
+        g_streams = m_nextStream;
+      }
+    if (m_nextStream != 0)
+      {
+        m_nextStream->m_prevStream = m_prevStream;
+      }
+  }
   delete m_rng;
 }
 
@@ -108,22 +157,35 @@ RandomVariableStream::SetStream (int64_t stream)
       // number assignment.
       uint64_t nextStream = RngSeedManager::GetNextStreamIndex ();
       NS_ASSERT (nextStream <= ((1ULL) << 63));
-      m_rng = new RngStream (RngSeedManager::GetSeed (),
-                             nextStream,
-                             RngSeedManager::GetRun ());
+      m_streamIndex = nextStream;
     }
   else
     {
       // The last 2^63 streams are reserved for deterministic stream
       // number assignment.
       uint64_t base = ((1ULL) << 63);
-      uint64_t target = base + stream;
-      m_rng = new RngStream (RngSeedManager::GetSeed (),
-                             target,
-                             RngSeedManager::GetRun ());
+      m_streamIndex = base + stream;
     }
+  m_rng = new RngStream (RngSeedManager::GetSeed (),
+                         m_streamIndex,
+                         RngSeedManager::GetRun ());
   m_stream = stream;
 }
+void
+RandomVariableStream::ReseedAll (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint32_t seed = RngSeedManager::GetSeed ();
+  uint64_t run = RngSeedManager::GetRun ();
+  CriticalSection cs (GetStreamsMutex ());
+  for (RandomVariableStream *stream = g_streams; stream != 0; stream = stream->m_nextStream)
+    {
+      if (stream->m_rng != 0)
+        {
+          *stream->m_rng = RngStream (seed, stream->m_streamIndex, run);
+        }
+    }
+}
 int64_t
 RandomVariableStream::GetStream (void) const
 {
@@ -137,6 +137,23 @@ public:
    */
   bool IsAntithetic (void) const;
 
+  /**
+   * \brief Restart all the existing streams from the current seed and run.
+   *
+   * Each stream restarts at the beginning of its sequence for the
+   * current values of \ref GlobalValueRngSeed "RngSeed" and
+   * \ref GlobalValueRngRun "RngRun", as if it had been created after
+   * they were set, and keeps its stream number.  This makes the
+   * branches of a simulation forked by WarmStart, or the replications
+   * of a scenario built once, draw independent random numbers.
+   *
+   * The streams are kept in a list, under a lock taken when they are
+   * created and destroyed, so that drawing a number does not check
+   * for a reseed.  ReseedAll must not be called while other threads
+   * draw random numbers.
+   */
+  static void ReseedAll (void);
+
   /**
    * \brief Get the next random value as a double drawn from the distribution.
    * \return A floating point random value.
@@ -187,6 +204,14 @@ private:
   /** The stream number for the RngStream. */
   int64_t m_stream;
 
+  /** The index of the RngStream, derived from m_stream. */
+  uint64_t m_streamIndex;
+
+  /** The previous stream in the list of the existing streams. */
+  RandomVariableStream *m_prevStream;
+  /** The next stream in the list of the existing streams. */
+  RandomVariableStream *m_nextStream;
+
 };  // class RandomVariableStream
 
 
@@ -33,6 +33,7 @@
 #include "enum.h"
 
 
+#include <algorithm>
 #include <cmath>
 
 
@@ -51,6 +52,13 @@ NS_LOG_COMPONENT_DEFINE ("RealtimeSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (RealtimeSimulatorImpl);
 
+namespace {
+
+/** Capacity of the queue of the events scheduled by other threads. */
+const uint32_t EVENTS_WITH_CONTEXT_CAPACITY = 1024;
+
+} // unnamed namespace
+
 TypeId
 RealtimeSimulatorImpl::GetTypeId (void)
 {
@@ -75,6 +83,9 @@ RealtimeSimulatorImpl::GetTypeId (void)
 
 
 RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
+  : m_eventsWithContext (EVENTS_WITH_CONTEXT_CAPACITY),
+    m_eventsWithContextOverflowing (false),
+    m_eventsWithContextWakeup (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -108,6 +119,10 @@ void
 RealtimeSimulatorImpl::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  {
+    CriticalSection cs (m_mutex);
+    ProcessEventsWithContext ();
+  }
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -222,6 +237,16 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         NS_ASSERT_MSG (m_synchronizer->Realtime (),
                        "RealtimeSimulatorImpl::ProcessOneEvent (): Synchronizer reports not Realtime ()");
 
+        //
+        // Reset the synchronizer so that any future event will interrupt the
+        // wait below (see the comments there), then pick up the events other
+        // threads queued without taking the critical section.  Resetting
+        // first guarantees that an event queued after the events have been
+        // moved will signal the synchronizer.
+        //
+        m_synchronizer->SetCondition (false);
+        ProcessEventsWithContext ();
+
         //
         // tsNow is set to the normalized current real time.  When the simulation was
         // started, the current real time was effectively set to zero; so tsNow is
@@ -249,15 +274,6 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
           {
             tsDelay = tsNext - tsNow;
           }
-
-        //
-        // We've figured out how long we need to delay in order to pace the
-        // simulation time with the real time.  We're going to sleep, but need
-        // to work with the synchronizer to make sure we're awakened if something
-        // external happens (like a packet is received).  This next line resets
-        // the synchronizer so that any future event will cause it to interrupt.
-        //
-        m_synchronizer->SetCondition (false);
       }
 
       //
@@ -433,6 +449,11 @@ RealtimeSimulatorImpl::Run (void)
   m_stop = false;
   m_running = true;
   m_synchronizer->SetOrigin (m_currentTs);
+  {
+    // Events queued by other threads after the previous run ended
+    CriticalSection cs (m_mutex);
+    ProcessEventsWithContext ();
+  }
 
   // Sleep until signalled
   uint64_t tsNow = 0;
@@ -444,6 +465,8 @@ RealtimeSimulatorImpl::Run (void)
       {
         CriticalSection cs (m_mutex);
 
+        m_synchronizer->SetCondition (false);
+        ProcessEventsWithContext ();
         if (!m_events->IsEmpty ())
           {
             process = true;
@@ -481,6 +504,79 @@ RealtimeSimulatorImpl::Run (void)
   m_running = false;
 }
 
+void
+RealtimeSimulatorImpl::PushEventWithContext (uint32_t context, uint64_t ts, EventImpl *impl)
+{
+  NS_LOG_FUNCTION (this << context << ts << impl);
+  EventWithContext ev;
+  ev.context = context;
+  ev.timestamp = ts;
+  ev.event = impl;
+  if (m_eventsWithContextOverflowing.load (std::memory_order_acquire)
+      || !m_eventsWithContext.Push (ev))
+    {
+      CriticalSection cs (m_eventsWithContextMutex);
+      m_eventsWithContextOverflow.push_back (ev);
+      m_eventsWithContextOverflowing.store (true, std::memory_order_release);
+    }
+  // Only the first event queued since the main thread last looked needs
+  // to interrupt its wait.
+  if (!m_eventsWithContextWakeup.exchange (true, std::memory_order_acq_rel))
+    {
+      m_synchronizer->Signal ();
+    }
+}
+
+void
+RealtimeSimulatorImpl::ProcessEventsWithContext (void)
+{
+  // Synchronize with the threads which skipped the Signal() because of
+  // this flag, so that their events are seen below.
+  if (!m_eventsWithContextWakeup.exchange (false, std::memory_order_acq_rel))
+    {
+      return;
+    }
+
+  EventWithContext event;
+  while (m_eventsWithContext.Pop (event))
+    {
+      InsertEventWithContext (event);
+    }
+  if (m_eventsWithContextOverflowing.load (std::memory_order_acquire))
+    {
+      EventsWithContext events;
+      {
+        CriticalSection cs (m_eventsWithContextMutex);
+        // The events a thread pushed to the queue before it found the
+        // queue full must come first, including those still being written.
+        while (m_eventsWithContext.PopWait (event))
+          {
+            InsertEventWithContext (event);
+          }
+        m_eventsWithContextOverflow.swap (events);
+        m_eventsWithContextOverflowing.store (false, std::memory_order_release);
+      }
+      for (EventsWithContext::const_iterator i = events.begin (); i != events.end (); ++i)
+        {
+          InsertEventWithContext (*i);
+        }
+    }
+}
+
+void
+RealtimeSimulatorImpl::InsertEventWithContext (const EventWithContext &event)
+{
+  Scheduler::Event ev;
+  ev.impl = event.event;
+  // The event may have been queued before the current event started
+  ev.key.m_ts = std::max (event.timestamp, m_currentTs);
+  ev.key.m_context = event.context;
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
 bool
 RealtimeSimulatorImpl::Running (void) const
 {
@@ -544,6 +640,14 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
 {
   NS_LOG_FUNCTION (this << context << delay << impl);
 
+  if (m_running && !SystemThread::Equals (m_main))
+    {
+      PushEventWithContext (context,
+                            m_synchronizer->GetCurrentRealtime () + delay.GetTimeStep (),
+                            impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
     uint64_t ts;
@@ -610,6 +714,14 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext (uint32_t context, Time const
 {
   NS_LOG_FUNCTION (this << context << time << impl);
 
+  if (m_running && !SystemThread::Equals (m_main))
+    {
+      PushEventWithContext (context,
+                            m_synchronizer->GetCurrentRealtime () + time.GetTimeStep (),
+                            impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
 
@@ -637,6 +749,13 @@ void
 RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext (uint32_t context, EventImpl *impl)
 {
   NS_LOG_FUNCTION (this << context << impl);
+
+  if (m_running && !SystemThread::Equals (m_main))
+    {
+      PushEventWithContext (context, m_synchronizer->GetCurrentRealtime (), impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
 
@@ -30,7 +30,9 @@
 #include "assert.h"
 #include "log.h"
 #include "system-mutex.h"
+#include "mpsc-queue.h"
 
+#include <atomic>
 #include <list>
 
 /**
@@ -174,6 +176,20 @@ private:
   uint64_t NextTs (void) const;
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Queue an event scheduled by a thread other than the main one while
+   * the simulator is running, and wake up the main thread.
+   *
+   * \param [in] context The event context.
+   * \param [in] ts The absolute event timestamp.
+   * \param [in] impl The event implementation.
+   */
+  void PushEventWithContext (uint32_t context, uint64_t ts, EventImpl *impl);
+  /**
+   * Move the events queued by PushEventWithContext() into the event list.
+   * Should be called with the critical section locked.
+   */
+  void ProcessEventsWithContext (void);
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
@@ -184,7 +200,43 @@ private:
   /** Has the stopping condition been reached? */
   bool m_stop;
   /** Is the simulator currently running. */
-  bool m_running;
+  std::atomic<bool> m_running;
+
+  /** Wrap an event queued by another thread with its execution context. */
+  struct EventWithContext
+  {
+    /** The event context. */
+    uint32_t context;
+    /** The absolute event timestamp. */
+    uint64_t timestamp;
+    /** The event implementation. */
+    EventImpl *event;
+  };
+  /**
+   * Insert an event queued by another thread in the event list.
+   * Should be called with the critical section locked.
+   * \param [in] event The event.
+   */
+  void InsertEventWithContext (const EventWithContext &event);
+  /** Container type for the events queued by other threads. */
+  typedef std::list<EventWithContext> EventsWithContext;
+  /** The events scheduled by other threads while running. */
+  MpscQueue<EventWithContext> m_eventsWithContext;
+  /** The events from other threads which did not fit in m_eventsWithContext. */
+  EventsWithContext m_eventsWithContextOverflow;
+  /**
+   * Flag \c true while m_eventsWithContextOverflow may hold events;
+   * meanwhile the other threads append to it rather than to
+   * m_eventsWithContext, so that the events of each thread stay in order.
+   */
+  std::atomic<bool> m_eventsWithContextOverflowing;
+  /** Mutex to control access to m_eventsWithContextOverflow. */
+  SystemMutex m_eventsWithContextMutex;
+  /**
+   * Flag \c true if the main thread has been signalled since it last
+   * looked at m_eventsWithContext.
+   */
+  std::atomic<bool> m_eventsWithContextWakeup;
 
   /**
    * \name Mutex-protected variables.
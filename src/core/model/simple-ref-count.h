@@ -51,7 +51,7 @@ namespace ns3 {
  * virtual.
  *
  *
- * This template takes 3 arguments but only the first argument is
+ * This template takes 4 arguments but only the first argument is
  * mandatory:
  *
  * \tparam T \explicit The typename of the subclass which derives
@@ -66,10 +66,14 @@ namespace ns3 {
  *      a public static method named 'Delete'. This method will be called
  *      whenever the SimpleRefCount template detects that no references
  *      to the object it manages exist anymore.
+ * \tparam COUNT \explicit The type of the reference count.  By default,
+ *      it is a plain uint32_t; a std::atomic<uint32_t> lets the
+ *      references to an object be released by several threads.
  *
  * Interesting users of this class include ns3::Object as well as ns3::Packet.
  */
-template <typename T, typename PARENT = empty, typename DELETER = DefaultDeleter<T> >
+template <typename T, typename PARENT = empty, typename DELETER = DefaultDeleter<T>,
+          typename COUNT = uint32_t>
 class SimpleRefCount : public PARENT
 {
 public:
@@ -115,8 +119,7 @@ public:
    */
   inline void Unref (void) const
   {
-    m_count--;
-    if (m_count == 0)
+    if (--m_count == 0)
       {
         DELETER::Delete (static_cast<T*> (const_cast<SimpleRefCount *> (this)));
       }
@@ -141,7 +144,7 @@ private:
    * Note we make this mutable so that the const methods can still
    * change it.
    */
-  mutable uint32_t m_count;
+  mutable COUNT m_count;
 };
 
 } // namespace ns3
@@ -42,4 +42,14 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+void
+SimulatorImpl::ScheduleWithContextBatch (const Time &delay, const Simulator::EventBatch &batch)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << batch.size ());
+  for (Simulator::EventBatch::const_iterator i = batch.begin (); i != batch.end (); ++i)
+    {
+      ScheduleWithContext (i->context, delay, i->event);
+    }
+}
+
 } // namespace ns3
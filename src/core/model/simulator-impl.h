@@ -27,6 +27,7 @@
 #include "object.h"
 #include "object-factory.h"
 #include "ptr.h"
+#include "simulator.h"
 
 /**
  * \file
@@ -67,6 +68,13 @@ public:
   virtual EventId Schedule (const Time &delay, EventImpl *event) = 0;
   /** \copydoc Simulator::ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
   virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event) = 0;
+  /**
+   * \copydoc Simulator::ScheduleWithContextBatch
+   *
+   * The default implementation calls ScheduleWithContext() for each
+   * event of the batch.
+   */
+  virtual void ScheduleWithContextBatch (const Time &delay, const Simulator::EventBatch &batch);
   /** \copydoc Simulator::ScheduleNow(const Ptr<EventImpl>&) */
   virtual EventId ScheduleNow (EventImpl *event) = 0;
   /** \copydoc Simulator::ScheduleDestroy(const Ptr<EventImpl>&) */
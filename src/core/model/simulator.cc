@@ -224,6 +224,31 @@ Simulator::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *
 #endif
   return GetImpl ()->ScheduleWithContext (context, delay, impl);
 }
+
+void
+Simulator::ScheduleWithContextBatch (const Time &delay, const EventBatch &batch)
+{
+#ifdef ENABLE_DES_METRICS
+  for (EventBatch::const_iterator i = batch.begin (); i != batch.end (); ++i)
+    {
+      DesMetrics::Get ()->TraceWithContext (i->context, Now (), delay);
+    }
+#endif
+  GetImpl ()->ScheduleWithContextBatch (delay, batch);
+}
+
+void
+Simulator::ScheduleBatch (const Time &delay, const std::vector<EventImpl *> &events)
+{
+  uint32_t context = GetContext ();
+  EventBatch batch (events.size ());
+  for (std::size_t i = 0; i < events.size (); ++i)
+    {
+      batch[i].context = context;
+      batch[i].event = events[i];
+    }
+  ScheduleWithContextBatch (delay, batch);
+}
 EventId
 Simulator::ScheduleDestroy (const Ptr<EventImpl> &ev)
 {
@@ -330,6 +355,13 @@ Simulator::GetEventCount (void)
   return GetImpl ()->GetEventCount ();
 }
 
+EventImpl::PoolStats
+Simulator::GetEventPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return EventImpl::GetPoolStats ();
+}
+
 uint32_t
 Simulator::GetSystemId (void)
 {
@@ -30,6 +30,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 /**
  * @file
@@ -205,6 +206,14 @@ public:
    */
   static uint64_t GetEventCount (void);
 
+  /**
+   * Get the statistics of the pool which recycles the memory of the
+   * events.  They can be used to check that a simulation has reached
+   * an allocation-free steady state.
+   * \returns The event pool statistics.
+   * \see EventImpl::GetPoolStats
+   */
+  static EventImpl::PoolStats GetEventPoolStats (void);
 
   /**
    * @name Schedule events (in the same context) to run at a future time.
@@ -1304,6 +1313,43 @@ public:
    */
   static void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
 
+  /** An event of a batch, with its context. */
+  struct BatchEvent
+  {
+    uint32_t context;  /**< The event context. */
+    EventImpl *event;  /**< The event implementation. */
+  };
+  /** A batch of events which expire at the same time. */
+  typedef std::vector<BatchEvent> EventBatch;
+
+  /**
+   * Schedule a batch of events which expire at the same time, each
+   * in its own context, as when a channel delivers a packet to all
+   * its receivers.  The events are executed in the order of the batch
+   * and no other event is executed between them, exactly as if they
+   * had been scheduled one after the other with ScheduleWithContext();
+   * but the simulator implementation may insert the whole batch in
+   * the event list with a single operation.
+   *
+   * The simulator takes ownership of the events, which cannot be
+   * removed from the event list once scheduled.  Like
+   * ScheduleWithContext(), this method is thread-safe.
+   *
+   * @param [in] delay Delay until the events expire.
+   * @param [in] batch The events to schedule.
+   */
+  static void ScheduleWithContextBatch (const Time &delay, const EventBatch &batch);
+
+  /**
+   * Schedule a batch of events which expire at the same time, in the
+   * current context.
+   *
+   * @param [in] delay Delay until the events expire.
+   * @param [in] events The events to schedule.
+   * @see ScheduleWithContextBatch
+   */
+  static void ScheduleBatch (const Time &delay, const std::vector<EventImpl *> &events);
+
   /**
    * Schedule an event to run at the end of the simulation, after
    * the Stop() time or condition has been reached.
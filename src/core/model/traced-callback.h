@@ -21,7 +21,7 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
 
 /**
@@ -44,7 +44,9 @@ namespace ns3 {
  *
  * This is a functor: the chain of Callbacks is invoked by
  * calling one of the \c operator() forms with the appropriate
- * number of arguments.
+ * number of arguments.  Invoking an empty chain is a single
+ * inlined test, so unconnected trace sources cost almost nothing
+ * on the packet paths.
  *
  * \tparam T1 \explicit Type of the first argument to the functor.
  * \tparam T2 \explicit Type of the second argument to the functor.
@@ -93,6 +95,13 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check for an empty chain, so that the arguments of a trace which
+   * are expensive to build are built only if they are used.
+   *
+   * \returns true if no Callback is connected.
+   */
+  bool IsEmpty (void) const;
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -233,8 +242,15 @@ private:
    * \tparam T7 \deduced Type of the seventh argument to the functor.
    * \tparam T8 \deduced Type of the eighth argument to the functor.
    */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  /** The chain of Callbacks. */
+  typedef std::vector<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  /**
+   * The first Callback of the chain, null if the chain is empty.
+   *
+   * Most trace sources have no or one Callback: it is kept inline, so
+   * that firing them does not read the heap, nor allocate memory.
+   */
+  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> m_first;
+  /** The rest of the chain of Callbacks. */
   CallbackList m_callbackList;
 };
 
@@ -252,7 +268,8 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList ()
+  : m_first (),
+    m_callbackList ()
 {}
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -266,7 +283,18 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBa
     {
       NS_FATAL_ERROR_NO_MSG ();
     }
-  m_callbackList.push_back (cb);
+  if (cb.IsNull ())
+    {
+      return;
+    }
+  if (m_first.IsNull ())
+    {
+      m_first = cb;
+    }
+  else
+    {
+      m_callbackList.push_back (cb);
+    }
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -281,7 +309,7 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback,
       NS_FATAL_ERROR ("when connecting to " << path);
     }
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
-  m_callbackList.push_back (realCb);
+  ConnectWithoutContext (realCb);
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -302,6 +330,18 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const Callbac
           i++;
         }
     }
+  if (!m_first.IsNull () && m_first.IsEqual (callback))
+    {
+      if (m_callbackList.empty ())
+        {
+          m_first.Nullify ();
+        }
+      else
+        {
+          m_first = m_callbackList.front ();
+          m_callbackList.erase (m_callbackList.begin ());
+        }
+    }
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -318,6 +358,15 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
   DisconnectWithoutContext (realCb);
 }
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  return m_first.IsNull ();
+}
 template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
@@ -325,10 +374,15 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
     {
-      (*i)();
+      return;
+    }
+  m_first ();
+  // a Callback may connect another one: do not keep an iterator
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
+    {
+      m_callbackList[i] ();
     }
 }
 template<typename T1, typename T2,
@@ -338,10 +392,14 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
     {
-      (*i)(a1);
+      return;
+    }
+  m_first (a1);
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
+    {
+      m_callbackList[i] (a1);
     }
 }
 template<typename T1, typename T2,
@@ -351,10 +409,14 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (a1, a2);
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2);
+      m_callbackList[i] (a1, a2);
     }
 }
 template<typename T1, typename T2,
@@ -364,10 +426,14 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (a1, a2, a3);
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3);
+      m_callbackList[i] (a1, a2, a3);
     }
 }
 template<typename T1, typename T2,
@@ -377,10 +443,14 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
     {
-      (*i)(a1, a2, a3, a4);
+      return;
+    }
+  m_first (a1, a2, a3, a4);
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
+    {
+      m_callbackList[i] (a1, a2, a3, a4);
     }
 }
 template<typename T1, typename T2,
@@ -390,10 +460,14 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
     {
-      (*i)(a1, a2, a3, a4, a5);
+      return;
+    }
+  m_first (a1, a2, a3, a4, a5);
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
+    {
+      m_callbackList[i] (a1, a2, a3, a4, a5);
     }
 }
 template<typename T1, typename T2,
@@ -403,10 +477,14 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (a1, a2, a3, a4, a5, a6);
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      m_callbackList[i] (a1, a2, a3, a4, a5, a6);
     }
 }
 template<typename T1, typename T2,
@@ -416,10 +494,14 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (a1, a2, a3, a4, a5, a6, a7);
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      m_callbackList[i] (a1, a2, a3, a4, a5, a6, a7);
     }
 }
 template<typename T1, typename T2,
@@ -429,10 +511,14 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_first.IsNull ())
+    {
+      return;
+    }
+  m_first (a1, a2, a3, a4, a5, a6, a7, a8);
+  for (std::size_t i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      m_callbackList[i] (a1, a2, a3, a4, a5, a6, a7, a8);
     }
 }
 
@@ -26,6 +26,8 @@
 #include "boolean.h"
 #include "double.h"
 #include "enum.h"
+#include "fatal-error.h"
+#include <type_traits>
 
 /**
  * \file
@@ -826,6 +828,272 @@ TracedValue<T> operator ! (const TracedValue<T> &lhs)
 
 /**@}*/  // \ingroup tracing
 
+
+/**
+ * \ingroup tracing
+ *
+ * \brief Whether the trace sources of a group are compiled in.
+ *
+ * The trace sources declared with StrippableTracedValue belong to a
+ * group, named by a tag type.  They are compiled in unless the group
+ * is stripped by NS_TRACE_SOURCE_GROUP_STRIP, which specializes this
+ * template.
+ *
+ * \tparam GROUP \explicit The tag type of the group.
+ */
+template <typename GROUP>
+struct TraceSourceGroup
+{
+  /** The trace sources of the group are compiled in. */
+  static const bool enabled = true;
+};
+
+/**
+ * \ingroup tracing
+ *
+ * Strip the trace sources of a group: the StrippableTracedValue of the
+ * group become plain values.
+ *
+ * This must be used in namespace ns3, right after the tag type is
+ * declared, and in every translation unit using the group, usually
+ * under a preprocessor condition set by
+ * <tt>waf configure --strip-trace-sources</tt>.
+ *
+ * \param [in] group The tag type of the group.
+ */
+#define NS_TRACE_SOURCE_GROUP_STRIP(group)                      \
+  template <>                                                   \
+  struct TraceSourceGroup<group>                                \
+  {                                                             \
+    static const bool enabled = false;                          \
+  }
+
+/**
+ * \ingroup tracing
+ *
+ * \brief A plain value standing for a TracedValue whose trace source
+ * is stripped at build time.
+ *
+ * It behaves like the underlying variable, without the test of the
+ * change and the Callbacks of TracedValue.  The trace source remains
+ * registered in the TypeId, but connecting to it is a fatal error, so
+ * that a trace which would never fire does not go unnoticed.
+ *
+ * \tparam T \explicit The underlying type of the value.
+ */
+template <typename T>
+class StrippedTracedValue
+{
+public:
+  /** Default constructor. */
+  StrippedTracedValue ()
+    : m_v ()
+  {}
+  /**
+   * Construct from an explicit variable.
+   * \param [in] v The value.
+   */
+  StrippedTracedValue (const T &v)
+    : m_v (v)
+  {}
+  /**
+   * Copy from a variable type compatible with this underlying type.
+   * \tparam U \deduced Type of the other variable.
+   * \param [in] other The other variable to copy.
+   */
+  template <typename U>
+  StrippedTracedValue (const U &other)
+    : m_v ((T)other)
+  {}
+  /**
+   * Cast to the underlying type.
+   * \returns The underlying value.
+   */
+  operator T () const
+  {
+    return m_v;
+  }
+  /**
+   * Set the value of the underlying variable.
+   * \param [in] v The new value.
+   */
+  void Set (const T &v)
+  {
+    m_v = v;
+  }
+  /**
+   * Get the underlying value.
+   * \returns The value.
+   */
+  T Get (void) const
+  {
+    return m_v;
+  }
+  /**
+   * \name Connection of the stripped trace source, a fatal error.
+   *
+   * \param [in] cb The Callback.
+   * \param [in] path The context.
+   */
+  /**@{*/
+  void ConnectWithoutContext (const CallbackBase &cb)
+  {
+    NS_FATAL_ERROR ("Cannot connect to a trace source stripped at build time; "
+                    "reconfigure without --strip-trace-sources");
+  }
+  void Connect (const CallbackBase &cb, std::string path)
+  {
+    NS_FATAL_ERROR ("Cannot connect to " << path << ": the trace source is stripped at "
+                    "build time; reconfigure without --strip-trace-sources");
+  }
+  void DisconnectWithoutContext (const CallbackBase &cb)
+  {
+    ConnectWithoutContext (cb);
+  }
+  void Disconnect (const CallbackBase &cb, std::string path)
+  {
+    Connect (cb, path);
+  }
+  /**@}*/
+  /**
+   * Pre/post- increment/decrement operator.
+   * \returns This value.
+   */
+  /**@{*/
+  StrippedTracedValue &operator++ ()
+  {
+    ++m_v;
+    return *this;
+  }
+  StrippedTracedValue &operator-- ()
+  {
+    --m_v;
+    return *this;
+  }
+  StrippedTracedValue operator++ (int)
+  {
+    StrippedTracedValue old (*this);
+    ++m_v;
+    return old;
+  }
+  StrippedTracedValue operator-- (int)
+  {
+    StrippedTracedValue old (*this);
+    --m_v;
+    return old;
+  }
+  /**@}*/
+  /**
+   * Operator assignment.
+   * \tparam U \deduced The type of the right operand.
+   * \param [in] rhs The right operand.
+   * \returns This value.
+   */
+  /**@{*/
+  template <typename U>
+  StrippedTracedValue &operator += (const U &rhs)
+  {
+    m_v += rhs;
+    return *this;
+  }
+  template <typename U>
+  StrippedTracedValue &operator -= (const U &rhs)
+  {
+    m_v -= rhs;
+    return *this;
+  }
+  template <typename U>
+  StrippedTracedValue &operator *= (const U &rhs)
+  {
+    m_v *= rhs;
+    return *this;
+  }
+  template <typename U>
+  StrippedTracedValue &operator /= (const U &rhs)
+  {
+    m_v /= rhs;
+    return *this;
+  }
+  template <typename U>
+  StrippedTracedValue &operator %= (const U &rhs)
+  {
+    m_v %= rhs;
+    return *this;
+  }
+  template <typename U>
+  StrippedTracedValue &operator <<= (const U &rhs)
+  {
+    m_v <<= rhs;
+    return *this;
+  }
+  template <typename U>
+  StrippedTracedValue &operator >>= (const U &rhs)
+  {
+    m_v >>= rhs;
+    return *this;
+  }
+  template <typename U>
+  StrippedTracedValue &operator &= (const U &rhs)
+  {
+    m_v &= rhs;
+    return *this;
+  }
+  template <typename U>
+  StrippedTracedValue &operator |= (const U &rhs)
+  {
+    m_v |= rhs;
+    return *this;
+  }
+  template <typename U>
+  StrippedTracedValue &operator ^= (const U &rhs)
+  {
+    m_v ^= rhs;
+    return *this;
+  }
+  /**@}*/
+
+private:
+  T m_v;  //!< The underlying value.
+};
+
+/**
+ * \ingroup tracing
+ * Output streamer for StrippedTracedValue.
+ *
+ * \tparam T \deduced The underlying type.
+ * \param [in,out] os The output stream.
+ * \param [in] rhs The value to print.
+ * \returns The stream.
+ */
+template <typename T>
+std::ostream& operator << (std::ostream& os, const StrippedTracedValue<T>& rhs)
+{
+  return os << rhs.Get ();
+}
+
+/**
+ * \ingroup tracing
+ *
+ * A TracedValue of a group of trace sources, or a StrippedTracedValue
+ * if the group is stripped.
+ *
+ * \code
+ *   struct QueueTraceSources {};
+ *   #ifdef NS3_STRIP_TRACE_SOURCES_QUEUE
+ *   NS_TRACE_SOURCE_GROUP_STRIP (QueueTraceSources);
+ *   #endif
+ *   ...
+ *   StrippableTracedValue<uint32_t, QueueTraceSources> m_nBytes;
+ * \endcode
+ *
+ * \tparam T \explicit The underlying type of the value.
+ * \tparam GROUP \explicit The tag type of the group.
+ */
+template <typename T, typename GROUP>
+using StrippableTracedValue = typename std::conditional<TraceSourceGroup<GROUP>::enabled,
+                                                        TracedValue<T>,
+                                                        StrippedTracedValue<T> >::type;
+
 } // namespace ns3
 
 #endif /* TRACED_VALUE_H */
@@ -22,8 +22,13 @@
 #include "type-id.h"
 #include "singleton.h"
 #include "trace-source-accessor.h"
+#include "pointer.h"
+#include "system-mutex.h"
 
-#include <map>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -50,8 +55,13 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
  * \ingroup object
  * \brief TypeId information manager
  *
- * Information records are stored in a vector.  Name and hash lookup
- * are performed by maps to the vector index.
+ * Information records are stored in a deque, so that they stay in
+ * place when types are registered.  Name and hash lookup are performed
+ * by hash tables to the deque index.
+ *
+ * The Attributes of a type and of its parents are gathered in a table
+ * indexed by name, built at the first lookup or construction of the type
+ * and rebuilt after an Attribute is added to any type.
  *
  * \internal
  * <b>Hash Chaining</b>
@@ -78,6 +88,8 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
 class IidManager : public Singleton<IidManager>
 {
 public:
+  /** Constructor. */
+  IidManager ();
   /**
    * Create a new unique type id.
    * \param [in] name The name of this type id.
@@ -229,6 +241,31 @@ public:
    * \returns The information associated to attribute whose index is \p i.
    */
   struct TypeId::AttributeInformation GetAttribute (uint16_t uid, std::size_t i) const;
+  /**
+   * Get the number of attributes of a type id and of its parents.
+   * \param [in] uid The id.
+   * \returns The number of attributes, the inherited ones included.
+   */
+  std::size_t GetAllAttributeN (uint16_t uid) const;
+  /**
+   * Get an attribute of a type id or of its parents by index.
+   * \param [in] uid The id.
+   * \param [in] i Index into the attributes of the type id and of its parents.
+   * \param [out] owner The id of the type declaring the attribute.
+   * \returns The information associated to the attribute whose index is \p i.
+   */
+  const struct TypeId::AttributeInformation & GetAllAttribute (uint16_t uid,
+                                                               std::size_t i,
+                                                               uint16_t *owner) const;
+  /**
+   * Find an attribute of a type id or of its parents by name.
+   * \param [in] uid The id.
+   * \param [in] name The name of the attribute.
+   * \returns The information associated to the attribute declared by the
+   *          nearest type, or 0 if no type declares it.
+   */
+  const struct TypeId::AttributeInformation * FindAttribute (uint16_t uid,
+                                                             const std::string &name) const;
   /**
    * Record a new TraceSource.
    * \param [in] uid The id.
@@ -293,6 +330,25 @@ private:
    */
   static TypeId::hash_t Hasher (const std::string name);
 
+  /**
+   * The Attributes of a type id and of its parents.  A table is not
+   * changed once it is published: a new one replaces it when an
+   * Attribute is added.
+   */
+  struct AttributeTable
+  {
+    /** The Attribute generation of the table. */
+    uint32_t generation;
+    /**
+     * The ids of the types declaring the Attributes and their indices,
+     * the Attributes of the type id first, then those of its parent,
+     * and so on.
+     */
+    std::vector<std::pair<uint16_t, std::size_t> > attributes;
+    /** The index in attributes of each name, declared by the nearest type. */
+    std::unordered_map<std::string, std::size_t> names;
+  };
+
   /** The information record about a single type id. */
   struct IidInformation
   {
@@ -320,9 +376,9 @@ private:
     TypeId::SupportLevel supportLevel;
     /** Support message. */
     std::string supportMsg;
+    /** The Attributes of this type id and of its parents, 0 if not built. */
+    std::atomic<const struct AttributeTable *> attributeTable;
   };
-  /** Iterator type. */
-  typedef std::vector<struct IidInformation>::const_iterator Iterator;
 
   /**
    * Retrieve the information record for a type.
@@ -330,20 +386,39 @@ private:
    * \returns The information record.
    */
   struct IidManager::IidInformation * LookupInformation (uint16_t uid) const;
+  /**
+   * Get the Attributes of a type id and of its parents, building their
+   * table if it is missing or older than the last Attribute added.
+   * \param [in] uid The id.
+   * \returns The table of the Attributes.
+   */
+  const struct AttributeTable & GetAttributeTable (uint16_t uid) const;
 
   /** The container of all type id records. */
-  std::vector<struct IidInformation> m_information;
+  std::deque<struct IidInformation> m_information;
 
   /** Type of the by-name index. */
-  typedef std::map<std::string, uint16_t> namemap_t;
+  typedef std::unordered_map<std::string, uint16_t> namemap_t;
   /** The by-name index. */
   namemap_t m_namemap;
 
   /** Type of the by-hash index. */
-  typedef std::map<TypeId::hash_t, uint16_t> hashmap_t;
+  typedef std::unordered_map<TypeId::hash_t, uint16_t> hashmap_t;
   /** The by-hash index. */
   hashmap_t m_hashmap;
 
+  /** The generation of the Attributes, changed when one is added. */
+  std::atomic<uint32_t> m_attributeGeneration;
+  /** Serializes the building of the Attribute tables. */
+  mutable SystemMutex m_attributeTableMutex;
+  /**
+   * All the Attribute tables built, protected by m_attributeTableMutex.
+   * The replaced tables are kept, since other threads may still read
+   * them; they are few, as the Attributes are added when the types are
+   * registered.
+   */
+  mutable std::vector<std::unique_ptr<const struct AttributeTable> > m_attributeTables;
+
 
   /** IidManager constants. */
   enum
@@ -380,6 +455,12 @@ IidManager::Hasher (const std::string name)
  */
 #define IIDL IID << ": "
 
+IidManager::IidManager ()
+  : m_attributeGeneration (1)
+{
+  NS_LOG_FUNCTION (IID);
+}
+
 uint16_t
 IidManager::AllocateUid (std::string name)
 {
@@ -434,7 +515,8 @@ IidManager::AllocateUid (std::string name)
         }
     }
 
-  struct IidInformation information;
+  m_information.emplace_back ();
+  struct IidInformation &information = m_information.back ();
   information.name = name;
   information.hash = hash;
   information.parent = 0;
@@ -442,7 +524,7 @@ IidManager::AllocateUid (std::string name)
   information.size = (std::size_t)(-1);
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
-  m_information.push_back (information);
+  information.attributeTable = 0;
   std::size_t tuid = m_information.size ();
   NS_ASSERT (tuid <= 0xffff);
   uint16_t uid = static_cast<uint16_t> (tuid);
@@ -677,9 +759,12 @@ IidManager::AddAttribute (uint16_t uid,
   info.originalInitialValue = initialValue;
   info.accessor = accessor;
   info.checker = checker;
+  info.isPointer = dynamic_cast<const PointerChecker *> (PeekPointer (checker)) != 0;
   info.supportLevel = supportLevel;
   info.supportMsg = supportMsg;
   information->attributes.push_back (info);
+  // the tables of the children of this type, if any, are out of date
+  m_attributeGeneration.fetch_add (1, std::memory_order_release);
   NS_LOG_LOGIC (IIDL << information->attributes.size () - 1);
 }
 void
@@ -714,6 +799,81 @@ IidManager::GetAttribute (uint16_t uid, std::size_t i) const
   return information->attributes[i];
 }
 
+const struct IidManager::AttributeTable &
+IidManager::GetAttributeTable (uint16_t uid) const
+{
+  NS_LOG_FUNCTION (IID << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  uint32_t generation = m_attributeGeneration.load (std::memory_order_acquire);
+  const struct AttributeTable *table = information->attributeTable.load (std::memory_order_acquire);
+  if (table != 0 && table->generation == generation)
+    {
+      return *table;
+    }
+  // objects of this type may be constructed by several threads at once
+  CriticalSection critical (m_attributeTableMutex);
+  table = information->attributeTable.load (std::memory_order_relaxed);
+  if (table != 0 && table->generation == generation)
+    {
+      return *table;
+    }
+  // build a new table, the readers of the current one keep it
+  std::unique_ptr<struct AttributeTable> built (new struct AttributeTable);
+  built->generation = generation;
+  uint16_t tid = uid;
+  while (true)
+    {
+      struct IidInformation *declaring = LookupInformation (tid);
+      for (std::size_t i = 0; i < declaring->attributes.size (); i++)
+        {
+          built->names.insert (std::make_pair (declaring->attributes[i].name,
+                                               built->attributes.size ()));
+          built->attributes.push_back (std::make_pair (tid, i));
+        }
+      if (declaring->parent == tid || declaring->parent == 0)
+        {
+          break;
+        }
+      tid = declaring->parent;
+    }
+  NS_LOG_LOGIC (IIDL << information->name << " " << built->attributes.size ());
+  table = built.get ();
+  m_attributeTables.push_back (std::move (built));
+  information->attributeTable.store (table, std::memory_order_release);
+  return *table;
+}
+
+std::size_t
+IidManager::GetAllAttributeN (uint16_t uid) const
+{
+  NS_LOG_FUNCTION (IID << uid);
+  return GetAttributeTable (uid).attributes.size ();
+}
+
+const struct TypeId::AttributeInformation &
+IidManager::GetAllAttribute (uint16_t uid, std::size_t i, uint16_t *owner) const
+{
+  NS_LOG_FUNCTION (IID << uid << i << owner);
+  const struct AttributeTable &table = GetAttributeTable (uid);
+  NS_ASSERT (i < table.attributes.size ());
+  *owner = table.attributes[i].first;
+  return LookupInformation (*owner)->attributes[table.attributes[i].second];
+}
+
+const struct TypeId::AttributeInformation *
+IidManager::FindAttribute (uint16_t uid, const std::string &name) const
+{
+  NS_LOG_FUNCTION (IID << uid << name);
+  const struct AttributeTable &table = GetAttributeTable (uid);
+  std::unordered_map<std::string, std::size_t>::const_iterator it = table.names.find (name);
+  if (it == table.names.end ())
+    {
+      return 0;
+    }
+  const std::pair<uint16_t, std::size_t> &attribute = table.attributes[it->second];
+  return &LookupInformation (attribute.first)->attributes[attribute.second];
+}
+
 bool
 IidManager::HasTraceSource (uint16_t uid,
                             std::string name)
@@ -882,40 +1042,24 @@ bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do
+  const struct TypeId::AttributeInformation *tmp = IidManager::Get ()->FindAttribute (m_tid, name);
+  if (tmp == 0)
     {
-      tid = nextTid;
-      for (std::size_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "Attribute '" << name << "' is deprecated: "
-                            << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("Attribute '" << name <<
-                                  "' is obsolete, with no fallback: " <<
-                                  tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
+      return false;
     }
-  while (nextTid != tid);
-  return false;
+  if (tmp->supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "Attribute '" << name << "' is deprecated: "
+                << tmp->supportMsg << std::endl;
+    }
+  else if (tmp->supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("Attribute '" << name <<
+                      "' is obsolete, with no fallback: " <<
+                      tmp->supportMsg);
+    }
+  *info = *tmp;
+  return true;
 }
 
 TypeId
@@ -1085,6 +1229,21 @@ TypeId::GetAttribute (std::size_t i) const
   NS_LOG_FUNCTION (this << i);
   return IidManager::Get ()->GetAttribute (m_tid, i);
 }
+std::size_t
+TypeId::GetAllAttributeN (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return IidManager::Get ()->GetAllAttributeN (m_tid);
+}
+const struct TypeId::AttributeInformation &
+TypeId::GetAllAttribute (std::size_t i, TypeId *tid) const
+{
+  NS_LOG_FUNCTION (this << i << tid);
+  uint16_t owner;
+  const struct TypeId::AttributeInformation &info = IidManager::Get ()->GetAllAttribute (m_tid, i, &owner);
+  *tid = TypeId (owner);
+  return info;
+}
 std::string
 TypeId::GetAttributeFullName (std::size_t i) const
 {
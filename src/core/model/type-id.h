@@ -90,6 +90,8 @@ public:
     Ptr<const AttributeAccessor> accessor;
     /** Checker object. */
     Ptr<const AttributeChecker> checker;
+    /** The checker is a PointerChecker: the attribute links to an Object. */
+    bool isPointer;
     /** Support level/deprecation. */
     TypeId::SupportLevel supportLevel;
     /** Support message. */
@@ -265,6 +267,26 @@ public:
    * \returns The full name associated to the attribute whose index is \p i.
    */
   std::string GetAttributeFullName (std::size_t i) const;
+  /**
+   * Get the number of attributes of this TypeId and of its parents.
+   *
+   * \returns The number of attributes, the inherited ones included.
+   */
+  std::size_t GetAllAttributeN (void) const;
+  /**
+   * Get an attribute of this TypeId or of its parents by index.
+   *
+   * The attributes of this TypeId come first, then those of its parent,
+   * and so on, in the order in which they are constructed.  Their table
+   * is built at the first call, instead of walking the parents each time.
+   * The reference is valid until an attribute is added to the TypeId
+   * declaring it.
+   *
+   * \param [in] i Index, less than GetAllAttributeN ().
+   * \param [out] tid The TypeId declaring the attribute.
+   * \returns The information associated to the attribute whose index is \p i.
+   */
+  const struct TypeId::AttributeInformation & GetAllAttribute (std::size_t i, TypeId *tid) const;
 
   /**
    * Get the constructor callback.
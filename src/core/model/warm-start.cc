@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "warm-start.h"
+#include "simulator.h"
+#include "fatal-error.h"
+#include "log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::WarmStart implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WarmStart");
+
+namespace {
+
+/** The index of the branch of this process. */
+uint32_t g_branch = 0;
+/** The processes of the other branches, in the original process. */
+std::vector<pid_t> g_children;
+
+/** Flush the output buffered by the standard streams. */
+void
+FlushStandardStreams (void)
+{
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+}
+
+} // unnamed namespace
+
+void
+WarmStart::Fork (const Time &delay, uint32_t branches,
+                 Callback<void, uint32_t> configure)
+{
+  NS_LOG_FUNCTION (delay << branches);
+  NS_ASSERT_MSG (branches > 0, "at least one branch is needed");
+  Simulator::Schedule (delay, &WarmStart::DoFork, branches, configure);
+}
+
+uint32_t
+WarmStart::GetBranch (void)
+{
+  return g_branch;
+}
+
+void
+WarmStart::DoFork (uint32_t branches, Callback<void, uint32_t> configure)
+{
+  NS_LOG_FUNCTION (branches);
+  // otherwise the children would print the output buffered so far again
+  FlushStandardStreams ();
+
+  for (uint32_t branch = 1; branch < branches; ++branch)
+    {
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("fork failed for branch " << branch << ": " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          g_branch = branch;
+          g_children.clear ();
+          break;
+        }
+      NS_LOG_LOGIC ("branch " << branch << " is process " << pid);
+      g_children.push_back (pid);
+    }
+
+  if (!configure.IsNull ())
+    {
+      configure (g_branch);
+    }
+}
+
+uint32_t
+WarmStart::Wait (int status)
+{
+  NS_LOG_FUNCTION (status);
+  if (g_branch != 0)
+    {
+      // the static objects belong to the original process, do not
+      // destroy them a second time
+      FlushStandardStreams ();
+      _exit (status);
+    }
+  uint32_t failed = 0;
+  for (std::vector<pid_t>::const_iterator i = g_children.begin (); i != g_children.end (); ++i)
+    {
+      int status;
+      pid_t pid;
+      do
+        {
+          pid = waitpid (*i, &status, 0);
+        }
+      while (pid < 0 && errno == EINTR);
+      if (pid < 0 || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_WARN ("branch process " << *i << " failed");
+          failed++;
+        }
+    }
+  g_children.clear ();
+  return failed;
+}
+
+} // namespace ns3
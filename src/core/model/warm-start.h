@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include "callback.h"
+#include "nstime.h"
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::WarmStart declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Fork a running simulation into several branches.
+ *
+ * Runs which share the same warm-up, such as ARP resolution, routing
+ * convergence or the TCP slow start, can simulate it once: at the end
+ * of the warm-up the process forks, and every child process continues
+ * from a copy of the complete simulation state, with its events,
+ * objects, packets and random number streams, as if it had been
+ * restored from a snapshot.  The pages of memory are shared by the
+ * processes until they are modified.
+ *
+ * Every branch, the original process included, then calls the branch
+ * callback with its index, to change the parameters of the simulation
+ * which differ between the runs.  The branches draw the same random
+ * numbers unless the callback changes them, for example by calling
+ * RngSeedManager::SetRun() then RandomVariableStream::ReseedAll().
+ *
+ * \code
+ *   void SetRate (uint32_t branch)
+ *   {
+ *     Config::Set ("/NodeList/0/DeviceList/0/DataRate",
+ *                  DataRateValue (DataRate ((branch + 1) * 1000000)));
+ *   }
+ *
+ *   int main (int argc, char *argv[])
+ *   {
+ *     // build the scenario
+ *     WarmStart::Fork (Seconds (30), 8, MakeCallback (&SetRate));
+ *     Simulator::Stop (Seconds (60));
+ *     Simulator::Run ();
+ *     // write the results of the branch WarmStart::GetBranch ()
+ *     Simulator::Destroy ();
+ *     int status = ...; // non-zero if the branch failed
+ *     uint32_t failed = WarmStart::Wait (status);
+ *     return (status != 0 || failed > 0) ? 1 : 0;
+ *   }
+ * \endcode
+ *
+ * The branches run at the same time.  Only the thread running the
+ * simulation is copied by the fork, so WarmStart cannot be used with a
+ * simulator implementation running events on several threads, nor with
+ * devices reading from a file descriptor in another thread.  The output
+ * buffered by the standard streams is flushed before forking.
+ */
+class WarmStart
+{
+public:
+  /**
+   * Fork the simulation after a delay.
+   * \param [in] delay The duration of the warm-up, from now.
+   * \param [in] branches The number of branches, the original process
+   *             included.
+   * \param [in] configure The callback called by each branch, with its
+   *             index, right after the fork.
+   */
+  static void Fork (const Time &delay, uint32_t branches,
+                    Callback<void, uint32_t> configure);
+  /**
+   * Get the index of the current branch.
+   * \returns The index of the branch, 0 for the original process or if
+   *          the simulation was not forked.
+   */
+  static uint32_t GetBranch (void);
+  /**
+   * Wait for the end of the branches.
+   *
+   * In the original process, wait for all the other branches to exit.
+   * In the other branches, flush the standard streams and exit the
+   * process with \p status without destroying the static objects, so
+   * the output files of the branch must be closed before calling
+   * Wait().
+   *
+   * \param [in] status The exit status of the branch, non-zero if the
+   *             branch failed.
+   * \returns The number of other branches which failed, in the
+   *          original process.
+   */
+  static uint32_t Wait (int status = 0);
+
+private:
+  /**
+   * Fork the simulation now.
+   * \param [in] branches The number of branches.
+   * \param [in] configure The branch callback.
+   */
+  static void DoFork (uint32_t branches, Callback<void, uint32_t> configure);
+};
+
+} // namespace ns3
+
+#endif /* WARM_START_H */
@@ -1186,6 +1186,110 @@ IntegerTraceSourceTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_got1, 0, "Hitting a TracedValue after disconnect still causes callback");
 }
 
+// ===========================================================================
+// Trace sources of a stripped group are plain values, but remain registered
+// in the TypeId.
+// ===========================================================================
+/** The tag of a group of trace sources which is stripped. */
+struct StrippedTestTraceSources {};
+/** The tag of a group of trace sources which is not stripped. */
+struct KeptTestTraceSources {};
+
+namespace ns3 {
+
+NS_TRACE_SOURCE_GROUP_STRIP (StrippedTestTraceSources);
+
+} // namespace ns3
+
+class StrippedTraceSourceObject : public Object
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::StrippedTraceSourceObject")
+      .AddConstructor<StrippedTraceSourceObject> ()
+      .SetParent<Object> ()
+      .HideFromDocumentation ()
+      .AddTraceSource ("Stripped", "help text",
+                       MakeTraceSourceAccessor (&StrippedTraceSourceObject::m_stripped),
+                       "ns3::TracedValueCallback::Uint32")
+      .AddTraceSource ("Kept", "help text",
+                       MakeTraceSourceAccessor (&StrippedTraceSourceObject::m_kept),
+                       "ns3::TracedValueCallback::Uint32")
+    ;
+    return tid;
+  }
+
+  StrippableTracedValue<uint32_t, StrippedTestTraceSources> m_stripped;
+  StrippableTracedValue<uint32_t, KeptTestTraceSources> m_kept;
+};
+
+class StrippedTraceSourceTestCase : public TestCase
+{
+public:
+  StrippedTraceSourceTestCase (std::string description);
+  virtual ~StrippedTraceSourceTestCase ()
+  {}
+
+private:
+  virtual void DoRun (void);
+
+  void NotifyKept (uint32_t old, uint32_t n)
+  {
+    NS_UNUSED (old);
+    m_got = n;
+  }
+  uint32_t m_got;
+};
+
+StrippedTraceSourceTestCase::StrippedTraceSourceTestCase (std::string description)
+  : TestCase (description)
+{}
+
+void
+StrippedTraceSourceTestCase::DoRun (void)
+{
+  bool stripped = std::is_same<StrippableTracedValue<uint32_t, StrippedTestTraceSources>,
+                               StrippedTracedValue<uint32_t> >::value;
+  NS_TEST_ASSERT_MSG_EQ (stripped, true, "The trace source of a stripped group is not a plain value");
+  bool kept = std::is_same<StrippableTracedValue<uint32_t, KeptTestTraceSources>,
+                           TracedValue<uint32_t> >::value;
+  NS_TEST_ASSERT_MSG_EQ (kept, true, "The trace source of a group is not a TracedValue");
+
+  Ptr<StrippedTraceSourceObject> p = CreateObject<StrippedTraceSourceObject> ();
+  NS_TEST_ASSERT_MSG_NE (p, 0, "Unable to CreateObject");
+
+  //
+  // The stripped value behaves like the underlying variable.
+  //
+  p->m_stripped = 10;
+  p->m_stripped += 5;
+  p->m_stripped++;
+  --p->m_stripped;
+  p->m_stripped -= 3;
+  p->m_stripped <<= 1;
+  NS_TEST_ASSERT_MSG_EQ (p->m_stripped.Get (), 24, "Unexpected value of a stripped trace source");
+  uint32_t v = p->m_stripped;
+  NS_TEST_ASSERT_MSG_EQ (v, 24, "Unexpected conversion of a stripped trace source");
+
+  //
+  // The stripped trace source is still registered, so that connecting to it
+  // is a fatal error rather than an unknown name.
+  //
+  TypeId tid = StrippedTraceSourceObject::GetTypeId ();
+  NS_TEST_ASSERT_MSG_NE (tid.LookupTraceSourceByName ("Stripped"), 0,
+                         "The stripped trace source is not registered");
+
+  //
+  // The trace source of the other group still fires.
+  //
+  m_got = 0;
+  bool ok = p->TraceConnectWithoutContext ("Kept", MakeCallback (&StrippedTraceSourceTestCase::NotifyKept, this));
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Could not TraceConnectWithoutContext() \"Kept\" to NotifyKept()");
+  p->m_kept = 7;
+  NS_TEST_ASSERT_MSG_EQ (m_got, 7, "Hitting a TracedValue does not cause trace callback to be called");
+}
+
 // ===========================================================================
 // Trace sources used like Attributes must also work as trace sources.  Make
 // sure we can use them that way.
@@ -1492,6 +1596,7 @@ AttributesTestSuite::AttributesTestSuite ()
   AddTestCase (new CallbackValueTestCase ("Check Attributes of type CallbackValue"), TestCase::QUICK);
   AddTestCase (new IntegerTraceSourceAttributeTestCase ("Ensure TracedValue<uint8_t> can be set like IntegerValue"), TestCase::QUICK);
   AddTestCase (new IntegerTraceSourceTestCase ("Ensure TracedValue<uint8_t> also works as trace source"), TestCase::QUICK);
+  AddTestCase (new StrippedTraceSourceTestCase ("Ensure a stripped trace source is a plain value, still registered"), TestCase::QUICK);
   AddTestCase (new TracedCallbackTestCase ("Ensure TracedCallback<double, int, float> works as trace source"), TestCase::QUICK);
 }
 
@@ -0,0 +1,256 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/binary-log-sink.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+
+#include <sstream>
+#include <string>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup logging
+ * \ingroup binary-log-sink-tests
+ * BinaryLogSink test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup binary-log-sink-tests BinaryLogSink test suite
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryLogSinkTest");
+
+/**
+ * \ingroup binary-log-sink-tests
+ *
+ * Check that the records of the BinaryLogSink decode to the text
+ * the NS_LOG macros print.
+ */
+class BinaryLogSinkDecodeTestCase : public TestCase
+{
+public:
+  BinaryLogSinkDecodeTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Log a few messages.
+   * \param [in] value A value to log.
+   */
+  void Record (int value);
+};
+
+BinaryLogSinkDecodeTestCase::BinaryLogSinkDecodeTestCase ()
+  : TestCase ("Check that the binary records decode to the text messages")
+{}
+
+void
+BinaryLogSinkDecodeTestCase::Record (int value)
+{
+  NS_LOG_FUNCTION (value << "abc" << std::string ("def") << uint8_t (7));
+  NS_LOG_INFO ("value " << value << ' ' << 2.5 << " " << MilliSeconds (3) << " " << MicroSeconds (-5));
+  NS_LOG_LOGIC ("hex " << std::hex << 255 << std::dec << " " << 255);
+}
+
+void
+BinaryLogSinkDecodeTestCase::DoRun (void)
+{
+#ifdef NS3_LOG_ENABLE
+  LogComponentEnable ("BinaryLogSinkTest", LOG_LEVEL_ALL);
+  BinaryLogSink::Enable (4096);
+  Simulator::ScheduleWithContext (3, Seconds (1), &BinaryLogSinkDecodeTestCase::Record, this, 42);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (BinaryLogSink::GetRecordCount (), 3, "wrong number of records");
+  NS_TEST_EXPECT_MSG_EQ (BinaryLogSink::GetLostCount (), 0, "no record should be lost");
+  std::stringstream binary;
+  BinaryLogSink::Write (binary);
+  BinaryLogSink::Disable ();
+  LogComponentDisable ("BinaryLogSinkTest", LOG_LEVEL_ALL);
+
+  std::ostringstream text;
+  NS_TEST_ASSERT_MSG_EQ (BinaryLogSink::Decode (binary, text), true, "decoding failed");
+  std::string expected =
+    "+1s 3 BinaryLogSinkTest:Record(42, \"abc\", \"def\", 7)\n"
+    "+1s 3 BinaryLogSinkTest:Record(): [INFO ] value 42 2.5 +3000000.0ns -5000.0ns\n"
+    "+1s 3 BinaryLogSinkTest:Record(): [LOGIC] hex ff 255\n";
+  NS_TEST_EXPECT_MSG_EQ (text.str (), expected, "wrong decoded text");
+
+  std::istringstream garbage ("not a binary log");
+  NS_TEST_EXPECT_MSG_EQ (BinaryLogSink::Decode (garbage, text), false, "garbage decoded");
+#endif /* NS3_LOG_ENABLE */
+}
+
+/**
+ * \ingroup binary-log-sink-tests
+ *
+ * Check that the ring buffer keeps the most recent records.
+ */
+class BinaryLogSinkOverwriteTestCase : public TestCase
+{
+public:
+  BinaryLogSinkOverwriteTestCase ();
+  virtual void DoRun (void);
+};
+
+BinaryLogSinkOverwriteTestCase::BinaryLogSinkOverwriteTestCase ()
+  : TestCase ("Check that the oldest records are overwritten")
+{}
+
+void
+BinaryLogSinkOverwriteTestCase::DoRun (void)
+{
+#ifdef NS3_LOG_ENABLE
+  LogComponentEnable ("BinaryLogSinkTest", LOG_LEVEL_DEBUG);
+  BinaryLogSink::Enable (1024);
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      NS_LOG_DEBUG ("message " << i);
+    }
+  uint64_t records = BinaryLogSink::GetRecordCount ();
+  NS_TEST_EXPECT_MSG_GT (records, 10, "too few records kept");
+  NS_TEST_EXPECT_MSG_EQ (records + BinaryLogSink::GetLostCount (), 1000, "records miscounted");
+
+  std::stringstream binary;
+  BinaryLogSink::Write (binary);
+  BinaryLogSink::Disable ();
+  LogComponentDisable ("BinaryLogSinkTest", LOG_LEVEL_DEBUG);
+
+  std::ostringstream text;
+  NS_TEST_ASSERT_MSG_EQ (BinaryLogSink::Decode (binary, text), true, "decoding failed");
+  std::string decoded = text.str ();
+  std::ostringstream lost;
+  lost << "(" << 1000 - records << " earlier records overwritten)\n";
+  NS_TEST_EXPECT_MSG_EQ (decoded.substr (0, lost.str ().size ()), lost.str (), "lost records not reported");
+  std::string last = "[DEBUG] message 999\n";
+  NS_TEST_EXPECT_MSG_EQ (decoded.substr (decoded.size () - last.size ()), last, "last record missing");
+#endif /* NS3_LOG_ENABLE */
+}
+
+namespace ceiling {
+
+NS_LOG_COMPONENT_DEFINE_CEILING ("BinaryLogSinkCeilingTest", ns3::LOG_LEVEL_INFO);
+
+#ifdef NS3_LOG_ENABLE
+/** The number of arguments of the log messages which were evaluated. */
+static uint32_t g_evaluated = 0;
+
+/**
+ * Count the evaluation of a log message argument.
+ * \returns The number of arguments evaluated so far.
+ */
+static uint32_t
+Evaluate (void)
+{
+  return ++g_evaluated;
+}
+
+/** Log one message at each level. */
+static void
+LogAll (void)
+{
+  NS_LOG_FUNCTION (Evaluate ());
+  NS_LOG_ERROR ("error " << Evaluate ());
+  NS_LOG_WARN ("warn " << Evaluate ());
+  NS_LOG_DEBUG ("debug " << Evaluate ());
+  NS_LOG_INFO ("info " << Evaluate ());
+  NS_LOG_LOGIC ("logic " << Evaluate ());
+}
+#endif /* NS3_LOG_ENABLE */
+
+} // namespace ceiling
+
+/**
+ * \ingroup binary-log-sink-tests
+ *
+ * Check that the messages above the ceiling of a log component are
+ * compiled out, even when the component is enabled at all levels.
+ */
+class BinaryLogSinkCeilingTestCase : public TestCase
+{
+public:
+  BinaryLogSinkCeilingTestCase ();
+  virtual void DoRun (void);
+};
+
+BinaryLogSinkCeilingTestCase::BinaryLogSinkCeilingTestCase ()
+  : TestCase ("Check that the messages above the log level ceiling are compiled out")
+{}
+
+void
+BinaryLogSinkCeilingTestCase::DoRun (void)
+{
+  static_assert ((ceiling::g_logCeiling & (LOG_FUNCTION | LOG_LOGIC)) == 0,
+                 "the levels above the ceiling must not be compiled in");
+#ifdef NS3_LOG_ENABLE
+  // The levels kept by the component ceiling and by the global one
+  // given to waf configure with --log-level-ceiling
+  const int32_t levels[] = {LOG_ERROR, LOG_WARN, LOG_DEBUG, LOG_INFO, LOG_FUNCTION, LOG_LOGIC};
+  uint32_t expected = 0;
+  for (uint32_t i = 0; i < sizeof (levels) / sizeof (levels[0]); ++i)
+    {
+      if ((levels[i] & LOG_LEVEL_INFO & NS3_LOG_LEVEL_CEILING) != 0)
+        {
+          expected++;
+        }
+    }
+
+  LogComponentEnable ("BinaryLogSinkCeilingTest", LOG_LEVEL_ALL);
+  BinaryLogSink::Enable (4096);
+  ceiling::g_evaluated = 0;
+  ceiling::LogAll ();
+  uint64_t records = BinaryLogSink::GetRecordCount ();
+  BinaryLogSink::Disable ();
+  LogComponentDisable ("BinaryLogSinkCeilingTest", LOG_LEVEL_ALL);
+
+  NS_TEST_EXPECT_MSG_EQ (records, expected, "wrong number of records");
+  NS_TEST_EXPECT_MSG_EQ (ceiling::g_evaluated, expected, "arguments evaluated above the ceiling");
+#endif /* NS3_LOG_ENABLE */
+}
+
+/**
+ * \ingroup binary-log-sink-tests
+ *
+ * BinaryLogSink TestSuite
+ */
+class BinaryLogSinkTestSuite : public TestSuite
+{
+public:
+  BinaryLogSinkTestSuite ()
+    : TestSuite ("binary-log-sink", UNIT)
+  {
+    AddTestCase (new BinaryLogSinkDecodeTestCase, TestCase::QUICK);
+    AddTestCase (new BinaryLogSinkOverwriteTestCase, TestCase::QUICK);
+    AddTestCase (new BinaryLogSinkCeilingTestCase, TestCase::QUICK);
+  }
+};
+
+/** Static variable for test initialization */
+static BinaryLogSinkTestSuite g_binaryLogSinkTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
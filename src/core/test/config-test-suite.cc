@@ -71,6 +71,10 @@ public:
    * \param a test object a
    */
   void AddNodeA (Ptr<ConfigTestObject> a);
+  /**
+   * Remove the last node A, without notifying the change of the graph
+   */
+  void RemoveLastNodeA (void);
   /**
    * Add node B function
    * \param b test object b
@@ -167,6 +171,12 @@ ConfigTestObject::AddNodeA (Ptr<ConfigTestObject> a)
   m_nodesA.push_back (a);
 }
 
+void
+ConfigTestObject::RemoveLastNodeA (void)
+{
+  m_nodesA.pop_back ();
+}
+
 void
 ConfigTestObject::AddNodeB (Ptr<ConfigTestObject> b)
 {
@@ -840,6 +850,128 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test that the lookups of Config paths, remembered between the calls,
+ * see the changes of the graph of objects.
+ */
+class LookupCacheConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  LookupCacheConfigTestCase ();
+  /** Destructor. */
+  virtual ~LookupCacheConfigTestCase ()
+  {}
+
+private:
+  virtual void DoRun (void);
+
+};
+
+LookupCacheConfigTestCase::LookupCacheConfigTestCase ()
+  : TestCase ("Check that the repeated lookups of paths see the changes of the objects")
+{}
+
+void
+LookupCacheConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Names::Add ("LookupCacheRoot", root);
+  Ptr<ConfigTestObject> objects[5];
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      objects[i] = CreateObject<ConfigTestObject> ();
+    }
+  root->AddNodeA (objects[0]);
+  root->AddNodeA (objects[1]);
+  root->AddNodeA (objects[2]);
+
+  Config::MatchContainer matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Three objects should match");
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "The same objects should match again");
+  NS_TEST_EXPECT_MSG_EQ (matches.Get (2), objects[2], "The objects should match in order");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetMatchedPath (2), "/Names/LookupCacheRoot/NodesA/2/",
+                         "Wrong path of the last object");
+
+  //
+  // Overlapping ranges match each object once, in the order of the indices.
+  //
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/2|[0-1]|[1-5]|7");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Three objects should match the ranges");
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (matches.Get (i), objects[i], "Wrong object " << i);
+    }
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/[2-1]|x|3");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetN (), 0, "No object should match");
+
+  //
+  // An existing object added to a container without an attribute is seen
+  // after the change of the graph is notified.
+  //
+  root->AddNodeA (objects[3]);
+  Object::NotifyGraphChange ();
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 4, "The added object should match");
+  NS_TEST_EXPECT_MSG_EQ (matches.Get (3), objects[3], "Wrong added object");
+
+  //
+  // Creating an object does not change the graph, but an object created
+  // and added to a container is seen since the container grew.
+  //
+  uint64_t generation = Object::GetGraphGeneration ();
+  root->AddNodeA (CreateObject<ConfigTestObject> ());
+  NS_TEST_EXPECT_MSG_EQ (Object::GetGraphGeneration (), generation,
+                         "Creating an object should not change the graph");
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/*");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetN (), 5, "The created object should match");
+
+  //
+  // Setting an existing object as an attribute changes the graph.
+  //
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodeA");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetN (), 0, "No object should match a null pointer");
+  root->SetAttribute ("NodeA", PointerValue (objects[4]));
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodeA");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "The object set should match");
+  NS_TEST_EXPECT_MSG_EQ (matches.Get (0), objects[4], "Wrong object set");
+
+  //
+  // An object removed from a container without a notification, and not
+  // destroyed, does not match anymore since the container shrank.
+  //
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 5, "Five objects should match");
+  Ptr<Object> removed = matches.Get (4);
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/3|4");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 2, "Two objects should match the indices");
+  root->RemoveLastNodeA ();
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 4, "The removed object should not match");
+  NS_TEST_EXPECT_MSG_EQ (matches.Get (3), objects[3], "Wrong last object");
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/3|4");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "The removed object should not match the indices");
+  NS_TEST_EXPECT_MSG_EQ (matches.Get (0), objects[3], "Wrong object of the indices");
+  matches = Config::LookupMatches ("/Names/LookupCacheRoot/NodesA/[0-9]");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetN (), 4, "The container should be read again");
+
+  //
+  // Destroying an object found by a path changes the graph, destroying
+  // another object does not.
+  //
+  generation = Object::GetGraphGeneration ();
+  CreateObject<ConfigTestObject> ();
+  NS_TEST_EXPECT_MSG_EQ (Object::GetGraphGeneration (), generation,
+                         "Destroying an object not found by a path should not change the graph");
+  removed = 0;
+  NS_TEST_EXPECT_MSG_NE (Object::GetGraphGeneration (), generation,
+                         "Destroying an object found by a path should change the graph");
+
+  Names::Clear ();
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -858,6 +990,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new LookupCacheConfigTestCase);
 }
 
 /**
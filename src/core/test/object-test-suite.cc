@@ -402,6 +402,77 @@ AggregateObjectTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
 }
 
+/**
+ * \ingroup object-tests
+ * Test the lookups of the aggregated Objects are remembered correctly.
+ */
+class GetObjectLookupTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  GetObjectLookupTestCase ();
+  /** Destructor. */
+  virtual ~GetObjectLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+GetObjectLookupTestCase::GetObjectLookupTestCase ()
+  : TestCase ("Check the lookups of GetObject are remembered correctly")
+{}
+
+GetObjectLookupTestCase::~GetObjectLookupTestCase ()
+{}
+
+void
+GetObjectLookupTestCase::DoRun (void)
+{
+  Ptr<BaseA> baseA = CreateObject<BaseA> ();
+
+  //
+  // A failed lookup must not be remembered once an object of the type
+  // is aggregated.
+  //
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (), 0, "Unexpectedly found a DerivedB");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (), 0, "Unexpectedly found a DerivedB");
+  Ptr<DerivedB> derivedB = CreateObject<DerivedB> ();
+  baseA->AggregateObject (derivedB);
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (), derivedB, "Cannot GetObject for DerivedB after the aggregation");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), derivedB, "Cannot GetObject for BaseB after the aggregation");
+  NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<BaseA> (), baseA, "Cannot GetObject (through derivedB) for BaseA");
+
+  //
+  // Look up many TypeIds, enough to fill the table several times, and
+  // check the results are still right.
+  //
+  for (uint32_t round = 0; round < 3; round++)
+    {
+      for (uint16_t i = 0; i < TypeId::GetRegisteredN (); i++)
+        {
+          TypeId tid = TypeId::GetRegistered (i);
+          Ptr<Object> found = baseA->GetObject<Object> (tid);
+          if (tid == BaseA::GetTypeId ())
+            {
+              NS_TEST_ASSERT_MSG_EQ (found, baseA, "Wrong object for " << tid.GetName ());
+            }
+          else if (tid == BaseB::GetTypeId () || tid == DerivedB::GetTypeId ())
+            {
+              NS_TEST_ASSERT_MSG_EQ (found, derivedB, "Wrong object for " << tid.GetName ());
+            }
+          else if (tid == Object::GetTypeId ())
+            {
+              NS_TEST_ASSERT_MSG_NE (found, 0, "No object for " << tid.GetName ());
+            }
+          else if (tid != ObjectBase::GetTypeId ())
+            {
+              NS_TEST_ASSERT_MSG_EQ (found, 0, "Unexpected object for " << tid.GetName ());
+            }
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (), derivedB, "Cannot GetObject for DerivedB after many lookups");
+}
+
 /**
  * \ingroup object-tests
  * Test an Object factory can create Objects
@@ -491,6 +562,7 @@ ObjectTestSuite::ObjectTestSuite ()
 {
   AddTestCase (new CreateObjectTestCase);
   AddTestCase (new AggregateObjectTestCase);
+  AddTestCase (new GetObjectLookupTestCase);
   AddTestCase (new ObjectFactoryTestCase);
 }
 
@@ -18,11 +18,24 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/test.h"
+#include "ns3/core-config.h"
 #include "ns3/simulator.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/packed-heap-scheduler.h"
+#include "ns3/profiling-simulator-impl.h"
+#include "ns3/string.h"
+#include "ns3/random-variable-stream.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -464,6 +477,391 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  Scheduler::Event MakeSchedulerEvent (uint64_t ts);
+  uint32_t m_uid;
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the event order against MapScheduler with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_uid (0),
+    m_schedulerFactory (schedulerFactory)
+{}
+
+Scheduler::Event
+SchedulerOrderTestCase::MakeSchedulerEvent (uint64_t ts)
+{
+  Scheduler::Event ev;
+  ev.impl = 0;
+  ev.key.m_ts = ts;
+  ev.key.m_uid = m_uid++;
+  ev.key.m_context = 0;
+  return ev;
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<Scheduler> reference = CreateObject<MapScheduler> ();
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  // the events which can still be removed, by uid
+  std::map<uint32_t, Scheduler::Event> pending;
+  uint64_t now = 0;
+
+  // bursts of identical timestamps, short and long delays
+  for (uint32_t i = 0; i < 5000; ++i)
+    {
+      uint64_t ts = (i % 3 == 0) ? 1000 : rng->GetInteger (0, 1000000);
+      Scheduler::Event ev = MakeSchedulerEvent (ts);
+      scheduler->Insert (ev);
+      reference->Insert (ev);
+      pending[ev.key.m_uid] = ev;
+    }
+  for (uint32_t i = 0; i < 20000; ++i)
+    {
+      double choice = rng->GetValue ();
+      if (choice < 0.5 && !reference->IsEmpty ())
+        {
+          Scheduler::Event expected = reference->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (scheduler->PeekNext ().key.m_uid, expected.key.m_uid, "wrong next event");
+          Scheduler::Event ev = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected.key.m_uid, "wrong event removed");
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_ts, expected.key.m_ts, "wrong event time");
+          pending.erase (ev.key.m_uid);
+          now = ev.key.m_ts;
+        }
+      else if (choice < 0.9)
+        {
+          uint64_t delay = (choice < 0.7) ? rng->GetInteger (0, 100) : rng->GetInteger (0, 1000000);
+          Scheduler::Event ev = MakeSchedulerEvent (now + delay);
+          scheduler->Insert (ev);
+          reference->Insert (ev);
+          pending[ev.key.m_uid] = ev;
+        }
+      else if (!pending.empty ())
+        {
+          std::map<uint32_t, Scheduler::Event>::iterator it =
+            pending.lower_bound (rng->GetInteger (0, m_uid));
+          if (it == pending.end ())
+            {
+              it = pending.begin ();
+            }
+          scheduler->Remove (it->second);
+          reference->Remove (it->second);
+          pending.erase (it);
+        }
+    }
+  while (!reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "events lost");
+      Scheduler::Event expected = reference->RemoveNext ();
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected.key.m_uid, "wrong event removed");
+    }
+  NS_TEST_EXPECT_MSG_EQ (scheduler->IsEmpty (), true, "too many events");
+}
+
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+  virtual void DoRun (void);
+  void Tick (uint32_t n);
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that the event memory is recycled")
+{}
+
+void
+SimulatorEventPoolTestCase::Tick (uint32_t n)
+{
+  if (n > 0)
+    {
+      Simulator::Schedule (NanoSeconds (1 + n % 7), &SimulatorEventPoolTestCase::Tick, this, n - 1);
+    }
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Simulator::Schedule (NanoSeconds (i), &SimulatorEventPoolTestCase::Tick, this, 2000);
+    }
+  Simulator::Stop (MicroSeconds (1));
+  Simulator::Run ();
+  EventImpl::PoolStats before = Simulator::GetEventPoolStats ();
+  Simulator::Run ();
+  EventImpl::PoolStats after = Simulator::GetEventPoolStats ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_GT (after.allocations - before.allocations, 100000, "too few events allocated");
+  NS_TEST_EXPECT_MSG_EQ (after.pooled - before.pooled, after.allocations - before.allocations,
+                         "steady state events not allocated from the pool");
+  NS_TEST_EXPECT_MSG_EQ (after.systemAllocations, before.systemAllocations,
+                         "steady state events allocated from the system");
+}
+
+class SimulatorBatchTestCase : public TestCase
+{
+public:
+  SimulatorBatchTestCase ();
+  virtual void DoRun (void);
+  void Record (uint32_t id);
+  void StopNow (uint32_t id);
+  std::vector<uint32_t> m_ids;
+  std::vector<uint32_t> m_contexts;
+};
+
+SimulatorBatchTestCase::SimulatorBatchTestCase ()
+  : TestCase ("Check that a batch of events runs as the same events scheduled one by one")
+{}
+
+void
+SimulatorBatchTestCase::Record (uint32_t id)
+{
+  m_ids.push_back (id);
+  m_contexts.push_back (Simulator::GetContext ());
+}
+
+void
+SimulatorBatchTestCase::StopNow (uint32_t id)
+{
+  Record (id);
+  Simulator::Stop ();
+}
+
+void
+SimulatorBatchTestCase::DoRun (void)
+{
+  Simulator::ScheduleWithContext (7, Seconds (1), &SimulatorBatchTestCase::Record, this, 0);
+  Simulator::EventBatch batch;
+  for (uint32_t i = 1; i <= 4; ++i)
+    {
+      Simulator::BatchEvent ev;
+      ev.context = 10 + i;
+      ev.event = MakeEvent (i == 2 ? &SimulatorBatchTestCase::StopNow : &SimulatorBatchTestCase::Record,
+                            this, i);
+      batch.push_back (ev);
+    }
+  Simulator::ScheduleWithContextBatch (Seconds (1), batch);
+  EventId cancelled = Simulator::Schedule (Seconds (1), &SimulatorBatchTestCase::Record, this, 5);
+  Simulator::ScheduleWithContext (8, Seconds (1), &SimulatorBatchTestCase::Record, this, 6);
+  cancelled.Cancel ();
+
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_ids.size (), 3, "the batch was not stopped");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventCount (), 3, "wrong event count");
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  uint32_t expectedContexts[] = { 7, 11, 12, 13, 14, 8 };
+  NS_TEST_ASSERT_MSG_EQ (m_ids.size (), 6, "wrong number of events");
+  for (uint32_t i = 0; i < m_ids.size (); ++i)
+    {
+      uint32_t id = (i == 5) ? 6 : i;
+      NS_TEST_EXPECT_MSG_EQ (m_ids[i], id, "wrong event order");
+      NS_TEST_EXPECT_MSG_EQ (m_contexts[i], expectedContexts[i], "wrong event context");
+    }
+}
+
+class SimulatorProfilingTestCase : public TestCase
+{
+public:
+  SimulatorProfilingTestCase ();
+  virtual void DoRun (void);
+  void Count (uint32_t n);
+  void Deliver (void);
+  void Discard (void);
+  virtual void Spawn (void);
+  /** Spend some wall clock time, so that every target has a folded stack. */
+  static void Work (void);
+  uint32_t m_counted;
+  uint32_t m_delivered;
+  uint32_t m_discarded;
+};
+
+SimulatorProfilingTestCase::SimulatorProfilingTestCase ()
+  : TestCase ("Check that the profiling implementation attributes the events to their targets"),
+    m_counted (0),
+    m_delivered (0),
+    m_discarded (0)
+{}
+
+void
+SimulatorProfilingTestCase::Work (void)
+{
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ()
+    + std::chrono::microseconds (5);
+  while (std::chrono::steady_clock::now () < end)
+    {
+    }
+}
+
+void
+SimulatorProfilingTestCase::Count (uint32_t n)
+{
+  Work ();
+  m_counted++;
+}
+
+void
+SimulatorProfilingTestCase::Deliver (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), 7, "wrong context");
+  Work ();
+  m_delivered++;
+}
+
+void
+SimulatorProfilingTestCase::Discard (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), 3, "wrong context");
+  Work ();
+  m_discarded++;
+}
+
+void
+SimulatorProfilingTestCase::Spawn (void)
+{
+  Work ();
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Simulator::Schedule (Seconds (1), &SimulatorProfilingTestCase::Discard, this);
+    }
+}
+
+void
+SimulatorProfilingTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (ProfilingSimulatorImpl::GetTypeId ());
+  factory.Set ("ReportFile", StringValue (""));
+  factory.Set ("FoldedFile", StringValue (""));
+  Ptr<ProfilingSimulatorImpl> impl = factory.Create<ProfilingSimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &SimulatorProfilingTestCase::Count, this, i);
+    }
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Simulator::ScheduleWithContext (7, Seconds (i), &SimulatorProfilingTestCase::Deliver, this);
+    }
+  // the virtual member function is profiled as the final overrider
+  Simulator::ScheduleWithContext (3, Seconds (2), &SimulatorProfilingTestCase::Spawn, this);
+  EventId removed = Simulator::Schedule (Seconds (1), &SimulatorProfilingTestCase::Count, this, 10);
+  EventId cancelled = Simulator::Schedule (Seconds (1), &SimulatorProfilingTestCase::Deliver, this);
+  Simulator::Remove (removed);
+  cancelled.Cancel ();
+  NS_TEST_EXPECT_MSG_EQ (cancelled.IsExpired (), true, "event not cancelled");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (4), "wrong end time");
+
+  std::ostringstream report;
+  impl->PrintReport (report);
+  std::ostringstream folded;
+  impl->PrintFolded (folded);
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_counted, 5, "wrong number of events");
+  NS_TEST_EXPECT_MSG_EQ (m_delivered, 3, "wrong number of events");
+  NS_TEST_EXPECT_MSG_EQ (m_discarded, 2, "wrong number of events");
+  NS_TEST_EXPECT_MSG_EQ (report.str ().find ("# 11 events"), 0, "wrong total in the report");
+
+  // the member functions with the same signature have their own rows
+  std::string count = "SimulatorProfilingTestCase::Count(unsigned int)";
+  std::string deliver = "SimulatorProfilingTestCase::Deliver()";
+  std::string discard = "SimulatorProfilingTestCase::Discard()";
+  std::string spawn = "SimulatorProfilingTestCase::Spawn()";
+  std::map<std::string, uint32_t> expected;
+  expected[count] = 5;
+  expected[deliver] = 3;
+  expected[discard] = 2;
+  expected[spawn] = 1;
+  std::map<std::string, uint32_t> counts;
+  std::istringstream lines (report.str ());
+  std::string line;
+  while (std::getline (lines, line))
+    {
+      if (line[0] == '#')
+        {
+          continue;
+        }
+      std::istringstream row (line);
+      double time, share, mean, dispatch, insert, remove;
+      uint32_t invocations;
+      row >> time >> share >> invocations >> mean >> dispatch >> insert >> remove;
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (time, 0, "negative time in the events of " << line);
+      std::string target;
+      std::getline (row >> std::ws, target);
+      counts[target] = invocations;
+    }
+  NS_TEST_EXPECT_MSG_EQ (counts.size (), expected.size (), "wrong number of targets");
+  // without dladdr, or without the Itanium C++ ABI to find the address
+  // of the member functions, the targets are named by their type and
+  // address or member pointer, so only the counts and the contexts are
+  // checked
+  std::multiset<uint32_t> invocations;
+  for (std::map<std::string, uint32_t>::const_iterator i = counts.begin (); i != counts.end (); ++i)
+    {
+      invocations.insert (i->second);
+    }
+  std::multiset<uint32_t> expectedInvocations;
+  for (std::map<std::string, uint32_t>::const_iterator i = expected.begin (); i != expected.end (); ++i)
+    {
+      expectedInvocations.insert (i->second);
+    }
+#if defined (HAVE_DLFCN_H) && defined (HAVE_ITANIUM_MEMBER_POINTERS)
+  for (std::map<std::string, uint32_t>::const_iterator i = expected.begin (); i != expected.end (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (counts[i->first], i->second, "wrong count for " << i->first);
+    }
+#endif /* HAVE_DLFCN_H && HAVE_ITANIUM_MEMBER_POINTERS */
+  NS_TEST_EXPECT_MSG_EQ ((invocations == expectedInvocations), true, "wrong counts of the targets");
+
+  // every target spends at least 5 microseconds in each context
+  std::set<std::string> stacks;
+  std::multiset<std::string> contexts;
+  std::istringstream foldedLines (folded.str ());
+  while (std::getline (foldedLines, line))
+    {
+      std::string::size_type space = line.rfind (' ');
+      NS_TEST_ASSERT_MSG_NE (space, std::string::npos, "malformed folded stack " << line);
+      if (line.compare (0, 7, "events;") == 0)
+        {
+          stacks.insert (line.substr (0, space));
+          contexts.insert (line.substr (0, line.find (';', 7)));
+          NS_TEST_EXPECT_MSG_GT_OR_EQ (std::atoi (line.c_str () + space + 1), 5,
+                                       "wrong time in " << line);
+        }
+    }
+  std::set<std::string> expectedStacks;
+  expectedStacks.insert ("events;no context;" + count);
+  expectedStacks.insert ("events;context 7;" + deliver);
+  expectedStacks.insert ("events;context 3;" + discard);
+  expectedStacks.insert ("events;context 3;" + spawn);
+  std::multiset<std::string> expectedContexts;
+  for (std::set<std::string>::const_iterator i = expectedStacks.begin (); i != expectedStacks.end (); ++i)
+    {
+      expectedContexts.insert (i->substr (0, i->find (';', 7)));
+    }
+  NS_TEST_EXPECT_MSG_EQ ((contexts == expectedContexts), true, "wrong folded stacks:\n" << folded.str ());
+#ifdef HAVE_DLFCN_H
+  NS_TEST_EXPECT_MSG_EQ ((stacks == expectedStacks), true, "wrong folded stacks:\n" << folded.str ());
+#endif /* HAVE_DLFCN_H */
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -480,5 +878,22 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (PackedHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (PackedHeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+
+    AddTestCase (new SimulatorEventPoolTestCase, TestCase::QUICK);
+    AddTestCase (new SimulatorBatchTestCase, TestCase::QUICK);
+    AddTestCase (new SimulatorProfilingTestCase, TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -27,11 +27,13 @@
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
 
+#include <atomic>
 #include <chrono>  // seconds, milliseconds
 #include <ctime>
 #include <list>
 #include <thread>  // sleep_for
 #include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -225,6 +227,117 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+/**
+ * Check that bursts of events scheduled by other threads, large enough
+ * to overflow the queue of events with context, are all executed in the
+ * order each thread scheduled them.
+ */
+class ThreadedSimulatorBurstTestCase : public TestCase
+{
+public:
+  ThreadedSimulatorBurstTestCase (const std::string &simulatorType);
+  void Start (void);
+  void Poll (void);
+  void Received (unsigned int threadno, uint32_t seq);
+  static void SchedulingThread (std::pair<ThreadedSimulatorBurstTestCase *, unsigned int> context);
+  std::string m_simulatorType;
+  std::vector<uint32_t> m_next;
+  std::atomic<uint32_t> m_received;
+  bool m_ordered;
+  std::list<Ptr<SystemThread> > m_threadlist;
+
+private:
+  virtual void DoRun (void);
+};
+
+/** The number of threads in ThreadedSimulatorBurstTestCase. */
+static const unsigned int BURST_THREADS = 4;
+/** The number of events scheduled by each thread in ThreadedSimulatorBurstTestCase. */
+static const uint32_t BURST_EVENTS = 5000;
+
+ThreadedSimulatorBurstTestCase::ThreadedSimulatorBurstTestCase (const std::string &simulatorType)
+  : TestCase ("Check bursts of events from other threads in " + simulatorType),
+    m_simulatorType (simulatorType)
+{}
+
+void
+ThreadedSimulatorBurstTestCase::SchedulingThread (std::pair<ThreadedSimulatorBurstTestCase *, unsigned int> context)
+{
+  ThreadedSimulatorBurstTestCase *me = context.first;
+  unsigned int threadno = context.second;
+  for (uint32_t seq = 0; seq < BURST_EVENTS; ++seq)
+    {
+      Simulator::ScheduleWithContext (threadno, Seconds (0),
+                                      &ThreadedSimulatorBurstTestCase::Received, me,
+                                      threadno, seq);
+    }
+}
+
+void
+ThreadedSimulatorBurstTestCase::Start (void)
+{
+  for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+  Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorBurstTestCase::Poll, this);
+}
+
+void
+ThreadedSimulatorBurstTestCase::Poll (void)
+{
+  // Keep the main loop busy until all the events have been received
+  if (m_received < BURST_THREADS * BURST_EVENTS)
+    {
+      Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorBurstTestCase::Poll, this);
+    }
+  else
+    {
+      Simulator::Stop ();
+    }
+}
+
+void
+ThreadedSimulatorBurstTestCase::Received (unsigned int threadno, uint32_t seq)
+{
+  if (Simulator::GetContext () != threadno || m_next[threadno] != seq)
+    {
+      m_ordered = false;
+    }
+  m_next[threadno] = seq + 1;
+  m_received++;
+}
+
+void
+ThreadedSimulatorBurstTestCase::DoRun (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (m_simulatorType));
+  m_next.assign (BURST_THREADS, 0);
+  m_received = 0;
+  m_ordered = true;
+  for (unsigned int i = 0; i < BURST_THREADS; ++i)
+    {
+      m_threadlist.push_back (
+        Create<SystemThread> (MakeBoundCallback (
+                                &ThreadedSimulatorBurstTestCase::SchedulingThread,
+                                std::pair<ThreadedSimulatorBurstTestCase *, unsigned int> (this,i) )) );
+    }
+
+  // Start the threads once running, so that their events are queued
+  Simulator::Schedule (Seconds (0), &ThreadedSimulatorBurstTestCase::Start, this);
+  Simulator::Run ();
+  for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+  m_threadlist.clear ();
+  Simulator::Destroy ();
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, BURST_THREADS * BURST_EVENTS, "Events lost");
+  NS_TEST_EXPECT_MSG_EQ (m_ordered, true, "Events executed out of order");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -261,6 +374,7 @@ public:
                 AddTestCase (new ThreadedSimulatorEventsTestCase (factory, simulatorTypes[i], threadcounts[j]), TestCase::QUICK);
               }
           }
+        AddTestCase (new ThreadedSimulatorBurstTestCase (simulatorTypes[i]), TestCase::QUICK);
       }
   }
 } g_threadedSimulatorTestSuite;
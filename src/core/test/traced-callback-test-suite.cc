@@ -20,6 +20,8 @@
 #include "ns3/traced-callback.h"
 #include "ns3/unused.h"
 
+#include <sstream>
+
 using namespace ns3;
 
 class BasicTracedCallbackTestCase : public TestCase
@@ -67,6 +69,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // these methods do is to set corresponding member variables m_one and m_two.
   //
   TracedCallback<uint8_t, double> trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "A new trace should be empty");
 
   //
   // Connect both callbacks to their respective test methods.  If we hit the
@@ -77,6 +80,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbTwo, this));
   m_one = false;
   m_two = false;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "The trace should not be empty");
   trace (1, 2);
   NS_TEST_ASSERT_MSG_EQ (m_one, true, "Callback CbOne not called");
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
@@ -100,6 +104,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   trace (1, 2);
   NS_TEST_ASSERT_MSG_EQ (m_one, false, "Callback CbOne unexpectedly called");
   NS_TEST_ASSERT_MSG_EQ (m_two, false, "Callback CbTwo unexpectedly called");
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "The trace should be empty again");
 
   //
   // If we connect them back up, then both callbacks should be called.
@@ -113,6 +118,85 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ChainTracedCallbackTestCase : public TestCase
+{
+public:
+  ChainTracedCallbackTestCase ();
+  virtual ~ChainTracedCallbackTestCase ()
+  {}
+
+private:
+  virtual void DoRun (void);
+
+  static void Cb (ChainTracedCallbackTestCase *test, uint32_t id, uint32_t value);
+  static void CbConnect (ChainTracedCallbackTestCase *test, uint32_t value);
+  std::string Fire (uint32_t value);
+
+  TracedCallback<uint32_t> m_trace;
+  std::ostringstream m_calls;
+};
+
+ChainTracedCallbackTestCase::ChainTracedCallbackTestCase ()
+  : TestCase ("Check the order and the changes of the TracedCallback chain")
+{}
+
+void
+ChainTracedCallbackTestCase::Cb (ChainTracedCallbackTestCase *test, uint32_t id, uint32_t value)
+{
+  test->m_calls << id << ":" << value << " ";
+}
+
+void
+ChainTracedCallbackTestCase::CbConnect (ChainTracedCallbackTestCase *test, uint32_t value)
+{
+  test->m_calls << "c:" << value << " ";
+  test->m_trace.ConnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Cb, test, 9));
+}
+
+std::string
+ChainTracedCallbackTestCase::Fire (uint32_t value)
+{
+  m_calls.str ("");
+  m_trace (value);
+  return m_calls.str ();
+}
+
+void
+ChainTracedCallbackTestCase::DoRun (void)
+{
+  //
+  // The callbacks are called in the order of their connection.
+  //
+  NS_TEST_ASSERT_MSG_EQ (Fire (0), "", "An empty trace called something");
+  m_trace.ConnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Cb, this, 1));
+  NS_TEST_ASSERT_MSG_EQ (Fire (1), "1:1 ", "Wrong calls with one callback");
+  m_trace.ConnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Cb, this, 2));
+  m_trace.ConnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Cb, this, 3));
+  NS_TEST_ASSERT_MSG_EQ (Fire (2), "1:2 2:2 3:2 ", "Wrong calls with three callbacks");
+
+  //
+  // Disconnecting the first callback keeps the order of the others.
+  //
+  m_trace.DisconnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Cb, this, 1));
+  NS_TEST_ASSERT_MSG_EQ (Fire (3), "2:3 3:3 ", "Wrong calls after the first callback is disconnected");
+  m_trace.ConnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Cb, this, 1));
+  NS_TEST_ASSERT_MSG_EQ (Fire (4), "2:4 3:4 1:4 ", "Wrong calls after a callback is connected again");
+  m_trace.DisconnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Cb, this, 3));
+  NS_TEST_ASSERT_MSG_EQ (Fire (5), "2:5 1:5 ", "Wrong calls after a middle callback is disconnected");
+
+  //
+  // A callback connected by a callback is called in the same invocation.
+  //
+  m_trace.ConnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::CbConnect, this));
+  NS_TEST_ASSERT_MSG_EQ (Fire (6), "2:6 1:6 c:6 9:6 ", "Wrong calls when a callback connects another one");
+  m_trace.DisconnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::CbConnect, this));
+  m_trace.DisconnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Cb, this, 9));
+  m_trace.DisconnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Cb, this, 2));
+  m_trace.DisconnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Cb, this, 1));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "The trace should be empty");
+  NS_TEST_ASSERT_MSG_EQ (Fire (7), "", "An empty trace called something");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -123,6 +207,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ChainTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
@@ -25,6 +25,8 @@
 #include "ns3/integer.h"
 #include "ns3/double.h"
 #include "ns3/object.h"
+#include "ns3/object-factory.h"
+#include "ns3/string.h"
 #include "ns3/traced-value.h"
 #include "ns3/type-id.h"
 #include "ns3/test.h"
@@ -334,6 +336,126 @@ DeprecatedAttributeTestCase::DoRun (void)
 }
 
 
+//----------------------------
+//
+// Inherited Attribute test
+
+class InheritedAttributeParent : public Object
+{
+public:
+  InheritedAttributeParent ()
+    : m_parent (0),
+      m_added (0)
+  {}
+  virtual ~InheritedAttributeParent ()
+  {}
+
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("InheritedAttributeParent")
+      .SetParent<Object> ()
+      .AddAttribute ("parentAttribute",
+                     "the Attribute of the parent",
+                     IntegerValue (2),
+                     MakeIntegerAccessor (&InheritedAttributeParent::m_parent),
+                     MakeIntegerChecker<int> ());
+    return tid;
+  }
+
+  int m_parent;
+  int m_added;
+};
+
+class InheritedAttributeChild : public InheritedAttributeParent
+{
+public:
+  InheritedAttributeChild ()
+    : m_child (0)
+  {}
+  virtual ~InheritedAttributeChild ()
+  {}
+
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("InheritedAttributeChild")
+      .SetParent<InheritedAttributeParent> ()
+      .AddConstructor<InheritedAttributeChild> ()
+      .AddAttribute ("childAttribute",
+                     "the Attribute of the child",
+                     IntegerValue (3),
+                     MakeIntegerAccessor (&InheritedAttributeChild::m_child),
+                     MakeIntegerChecker<int> ());
+    return tid;
+  }
+
+  int m_child;
+};
+
+class InheritedAttributeTestCase : public TestCase
+{
+public:
+  InheritedAttributeTestCase ();
+  virtual ~InheritedAttributeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+InheritedAttributeTestCase::InheritedAttributeTestCase ()
+  : TestCase ("Check the table of the Attributes of a TypeId and of its parents")
+{}
+
+InheritedAttributeTestCase::~InheritedAttributeTestCase ()
+{}
+
+void
+InheritedAttributeTestCase::DoRun (void)
+{
+  TypeId parent = InheritedAttributeParent::GetTypeId ();
+  TypeId child = InheritedAttributeChild::GetTypeId ();
+  std::size_t n = child.GetAttributeN () + parent.GetAttributeN () + Object::GetTypeId ().GetAttributeN ();
+  NS_TEST_ASSERT_MSG_EQ (child.GetAllAttributeN (), n, "wrong number of attributes");
+
+  // the attributes of the child come first, then those of the parent
+  TypeId owner;
+  NS_TEST_ASSERT_MSG_EQ (child.GetAllAttribute (0, &owner).name, "childAttribute",
+                         "wrong first attribute");
+  NS_TEST_ASSERT_MSG_EQ (owner, child, "wrong TypeId of the first attribute");
+  NS_TEST_ASSERT_MSG_EQ (child.GetAllAttribute (1, &owner).name, "parentAttribute",
+                         "wrong second attribute");
+  NS_TEST_ASSERT_MSG_EQ (owner, parent, "wrong TypeId of the second attribute");
+
+  struct TypeId::AttributeInformation info;
+  NS_TEST_ASSERT_MSG_EQ (child.LookupAttributeByName ("parentAttribute", &info), true,
+                         "lookup attribute of the parent");
+  NS_TEST_ASSERT_MSG_EQ (info.name, "parentAttribute", "wrong attribute found");
+  NS_TEST_ASSERT_MSG_EQ (parent.LookupAttributeByName ("childAttribute", &info), false,
+                         "lookup attribute of the child in the parent");
+  NS_TEST_ASSERT_MSG_EQ (child.LookupAttributeByName ("addedAttribute", &info), false,
+                         "lookup attribute not added yet");
+
+  // an attribute added to the parent is found in the child
+  parent.AddAttribute ("addedAttribute",
+                       "the Attribute added to the parent",
+                       IntegerValue (4),
+                       MakeIntegerAccessor (&InheritedAttributeParent::m_added),
+                       MakeIntegerChecker<int> ());
+  NS_TEST_ASSERT_MSG_EQ (child.GetAllAttributeN (), n + 1, "attribute added not counted");
+  NS_TEST_ASSERT_MSG_EQ (child.LookupAttributeByName ("addedAttribute", &info), true,
+                         "lookup attribute added to the parent");
+
+  // the objects are constructed with the attributes of their parents
+  ObjectFactory factory;
+  factory.SetTypeId (child);
+  factory.Set ("parentAttribute", StringValue ("7"));
+  Ptr<InheritedAttributeChild> object = factory.Create<InheritedAttributeChild> ();
+  NS_TEST_ASSERT_MSG_EQ (object->m_child, 3, "child attribute not constructed");
+  NS_TEST_ASSERT_MSG_EQ (object->m_parent, 7, "parent attribute not set by the factory");
+  NS_TEST_ASSERT_MSG_EQ (object->m_added, 4, "attribute added to the parent not constructed");
+}
+
+
 //----------------------------
 //
 // Performance test
@@ -447,6 +569,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
   AddTestCase (new DeprecatedAttributeTestCase, QUICK);
+  AddTestCase (new InheritedAttributeTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;
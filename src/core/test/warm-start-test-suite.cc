@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/warm-start.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include <algorithm>
+#include <vector>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup simulator
+ * \ingroup warm-start-tests
+ * WarmStart test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup warm-start-tests WarmStart test suite
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+/**
+ * \ingroup warm-start-tests
+ *
+ * Check that the branches continue from the state of the simulation at
+ * the fork, with their own parameters.
+ */
+class WarmStartForkTestCase : public TestCase
+{
+public:
+  WarmStartForkTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /** The result of a branch, sent to the original process. */
+  struct Result
+  {
+    uint32_t branch;   //!< The branch index.
+    uint32_t param;    //!< The parameter set by the branch callback.
+    uint32_t warmup;   //!< The number of warm-up events run.
+    double value;      //!< A random value drawn after the fork.
+  };
+
+  /** Warm-up event. */
+  void WarmUp (void);
+  /**
+   * Branch callback.
+   * \param [in] branch The branch index.
+   */
+  void Configure (uint32_t branch);
+  /** Send the result of the branch. */
+  void Report (void);
+
+  int m_pipe[2];                          //!< The pipe for the results.
+  uint32_t m_param;                       //!< The branch parameter.
+  uint32_t m_warmup;                      //!< The number of warm-up events.
+  Ptr<UniformRandomVariable> m_random;    //!< Created before the fork.
+};
+
+WarmStartForkTestCase::WarmStartForkTestCase ()
+  : TestCase ("Check that the forked branches share the state at the fork"),
+    m_param (0),
+    m_warmup (0)
+{}
+
+void
+WarmStartForkTestCase::WarmUp (void)
+{
+  m_warmup++;
+  // advance the random stream before the fork
+  m_random->GetValue ();
+}
+
+void
+WarmStartForkTestCase::Configure (uint32_t branch)
+{
+  m_param = 10 * branch;
+  if (branch == 2)
+    {
+      RngSeedManager::SetRun (RngSeedManager::GetRun () + 5);
+      RandomVariableStream::ReseedAll ();
+    }
+}
+
+void
+WarmStartForkTestCase::Report (void)
+{
+  Result result;
+  result.branch = WarmStart::GetBranch ();
+  result.param = m_param;
+  result.warmup = m_warmup;
+  result.value = m_random->GetValue ();
+  ssize_t written = write (m_pipe[1], &result, sizeof (result));
+  NS_TEST_EXPECT_MSG_EQ (written, (ssize_t)sizeof (result), "write failed");
+}
+
+void
+WarmStartForkTestCase::DoRun (void)
+{
+  uint64_t run = RngSeedManager::GetRun ();
+  NS_TEST_ASSERT_MSG_EQ (pipe (m_pipe), 0, "pipe failed");
+  m_random = CreateObject<UniformRandomVariable> ();
+
+  Simulator::Schedule (Seconds (0.5), &WarmStartForkTestCase::WarmUp, this);
+  WarmStart::Fork (Seconds (1), 3, MakeCallback (&WarmStartForkTestCase::Configure, this));
+  Simulator::Schedule (Seconds (2), &WarmStartForkTestCase::Report, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  // the other branches exit here, failed if one of their checks failed
+  uint32_t failed = WarmStart::Wait (IsStatusFailure () ? 1 : 0);
+  NS_TEST_EXPECT_MSG_EQ (failed, 0, "branch failed");
+  RngSeedManager::SetRun (run);
+
+  std::vector<Result> results (3);
+  ssize_t size = sizeof (Result) * results.size ();
+  NS_TEST_ASSERT_MSG_EQ (read (m_pipe[0], &results[0], size), size, "missing results");
+  close (m_pipe[0]);
+  close (m_pipe[1]);
+  m_random = 0;
+
+  std::sort (results.begin (), results.end (),
+             [] (const Result &a, const Result &b) { return a.branch < b.branch; });
+  for (uint32_t i = 0; i < results.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (results[i].branch, i, "wrong branch");
+      NS_TEST_EXPECT_MSG_EQ (results[i].param, 10 * i, "wrong parameter");
+      NS_TEST_EXPECT_MSG_EQ (results[i].warmup, 1, "warm-up not shared");
+    }
+  NS_TEST_EXPECT_MSG_EQ (results[1].value, results[0].value, "random streams not shared");
+  NS_TEST_EXPECT_MSG_NE (results[2].value, results[0].value, "random stream not reseeded");
+}
+
+/**
+ * \ingroup warm-start-tests
+ *
+ * Check that the original process counts the branches which exit with
+ * a failure status.
+ */
+class WarmStartStatusTestCase : public TestCase
+{
+public:
+  WarmStartStatusTestCase ();
+  virtual void DoRun (void);
+};
+
+WarmStartStatusTestCase::WarmStartStatusTestCase ()
+  : TestCase ("Check that the failed branches are reported")
+{}
+
+void
+WarmStartStatusTestCase::DoRun (void)
+{
+  WarmStart::Fork (Seconds (1), 4, MakeNullCallback<void, uint32_t> ());
+  Simulator::Run ();
+  Simulator::Destroy ();
+  uint32_t branch = WarmStart::GetBranch ();
+  // branches 1 and 3 fail
+  uint32_t failed = WarmStart::Wait (branch % 2);
+  NS_TEST_EXPECT_MSG_EQ (branch, 0, "the other branches must exit");
+  NS_TEST_EXPECT_MSG_EQ (failed, 2, "wrong number of failed branches");
+}
+
+/**
+ * \ingroup warm-start-tests
+ *
+ * WarmStart TestSuite
+ */
+class WarmStartTestSuite : public TestSuite
+{
+public:
+  WarmStartTestSuite ()
+    : TestSuite ("warm-start", UNIT)
+  {
+    AddTestCase (new WarmStartForkTestCase, TestCase::QUICK);
+    AddTestCase (new WarmStartStatusTestCase, TestCase::QUICK);
+  }
+};
+
+/** Static variable for test initialization */
+static WarmStartTestSuite g_warmStartTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
@@ -222,24 +222,29 @@ CsmaChannel::TransmitEnd ()
 
   NS_LOG_LOGIC ("Receive");
 
+  // all the events expire at the same time: schedule them as a batch
+  Simulator::EventBatch batch;
+  batch.reserve (m_deviceList.size () + 1);
   std::vector<CsmaDeviceRec>::iterator it;
-  uint32_t devId = 0;
   for (it = m_deviceList.begin (); it < m_deviceList.end (); it++)
     {
       if (it->IsActive ())
         {
           // schedule reception events
-          Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
-                                          m_delay,
-                                          &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+          Simulator::BatchEvent ev;
+          ev.context = it->devicePtr->GetNode ()->GetId ();
+          ev.event = MakeEvent (&CsmaNetDevice::Receive, it->devicePtr,
+                                m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+          batch.push_back (ev);
         }
-      devId++;
     }
 
   // also schedule for the tx side to go back to IDLE
-  Simulator::Schedule (m_delay, &CsmaChannel::PropagationCompleteEvent,
-                       this);
+  Simulator::BatchEvent ev;
+  ev.context = Simulator::GetContext ();
+  ev.event = MakeEvent (&CsmaChannel::PropagationCompleteEvent, this);
+  batch.push_back (ev);
+  Simulator::ScheduleWithContextBatch (m_delay, batch);
   return retVal;
 }
 
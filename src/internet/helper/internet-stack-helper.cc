@@ -47,6 +47,7 @@
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/global-router-interface.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/binary-trace-file.h"
 #include <limits>
 #include <map>
 
@@ -598,6 +599,12 @@ Ipv4L3ProtocolDropSinkWithoutContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::DROP, "", p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -622,6 +629,12 @@ Ipv4L3ProtocolTxSinkWithoutContext (
       return;
     }
 
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::TRANSMIT, "", packet);
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -646,6 +659,12 @@ Ipv4L3ProtocolRxSinkWithoutContext (
       return;
     }
 
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::RECEIVE, "", packet);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -684,6 +703,12 @@ Ipv4L3ProtocolDropSinkWithContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::DROP, context, p);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *p << std::endl;
@@ -715,6 +740,12 @@ Ipv4L3ProtocolTxSinkWithContext (
       return;
     }
 
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::TRANSMIT, context, packet);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -746,6 +777,12 @@ Ipv4L3ProtocolRxSinkWithContext (
       return;
     }
 
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::RECEIVE, context, packet);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -936,6 +973,12 @@ Ipv6L3ProtocolDropSinkWithoutContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::DROP, "", p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -960,6 +1003,12 @@ Ipv6L3ProtocolTxSinkWithoutContext (
       return;
     }
 
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::TRANSMIT, "", packet);
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -984,6 +1033,12 @@ Ipv6L3ProtocolRxSinkWithoutContext (
       return;
     }
 
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::RECEIVE, "", packet);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -1022,6 +1077,12 @@ Ipv6L3ProtocolDropSinkWithContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::DROP, context, p);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *p << std::endl;
@@ -1053,6 +1114,12 @@ Ipv6L3ProtocolTxSinkWithContext (
       return;
     }
 
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::TRANSMIT, context, packet);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -1084,6 +1151,12 @@ Ipv6L3ProtocolRxSinkWithContext (
       return;
     }
 
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::RECEIVE, context, packet);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -248,6 +248,8 @@ private:
 
   bool m_calcChecksum; //!< true if the checksum must be calculated
 
+  friend struct HeaderCacheTraits<Ipv4Header>;
+
   uint16_t m_payloadSize; //!< payload size
   uint16_t m_identification; //!< identification
   uint32_t m_tos : 8; //!< TOS, also used as DSCP + ECN value
@@ -262,6 +264,26 @@ private:
   uint16_t m_headerSize; //!< IP header size
 };
 
+/**
+ * \ingroup ipv4
+ * Keep the Ipv4Header objects in the packets when the header cache is
+ * enabled, unless their checksum is enabled: the receiver must then
+ * verify the checksum in the buffer.
+ */
+template <>
+struct HeaderCacheTraits<Ipv4Header>
+{
+  static const bool cached = true;  //!< Cache the headers.
+  /**
+   * \param header the header added to a packet.
+   * \returns true if the header may be kept.
+   */
+  static bool IsCached (const Ipv4Header &header)
+  {
+    return !header.m_calcChecksum;
+  }
+};
+
 } // namespace ns3
 
 
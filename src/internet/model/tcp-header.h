@@ -348,11 +348,34 @@ private:
   bool m_calcChecksum;    //!< Flag to calculate checksum
   bool m_goodChecksum;    //!< Flag to indicate that checksum is correct
 
+  friend struct HeaderCacheTraits<TcpHeader>;
+
   static const uint8_t m_maxOptionsLen = 40;         //!< Maximum options length
   TcpOptionList m_options;     //!< TcpOption present in the header
   uint8_t m_optionsLen;        //!< Tcp options length.
 };
 
+/**
+ * \ingroup tcp
+ * Keep the TcpHeader objects in the packets when the header cache is
+ * enabled, unless their checksum is enabled: the receiver must then
+ * verify the checksum in the buffer.  The options of a kept header are
+ * shared with the object which was serialized.
+ */
+template <>
+struct HeaderCacheTraits<TcpHeader>
+{
+  static const bool cached = true;  //!< Cache the headers.
+  /**
+   * \param header the header added to a packet.
+   * \returns true if the header may be kept.
+   */
+  static bool IsCached (const TcpHeader &header)
+  {
+    return !header.m_calcChecksum;
+  }
+};
+
 } // namespace ns3
 
 #endif /* TCP_HEADER */
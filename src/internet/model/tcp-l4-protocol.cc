@@ -719,6 +719,7 @@ TcpL4Protocol::AddSocket (Ptr<TcpSocketBase> socket)
     }
 
   m_sockets.push_back (socket);
+  Object::NotifyGraphChange ();
 }
 
 bool
@@ -732,6 +733,7 @@ TcpL4Protocol::RemoveSocket (Ptr<TcpSocketBase> socket)
       if (*it == socket)
         {
           m_sockets.erase (it);
+          Object::NotifyGraphChange ();
           return true;
         }
 
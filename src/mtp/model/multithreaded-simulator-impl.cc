@@ -0,0 +1,946 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/unused.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/** Timestamp used for "no event". */
+static const uint64_t NO_TS = std::numeric_limits<uint64_t>::max ();
+
+/**
+ * Check whether a channel may join nodes of different LPs.  Its devices
+ * must not share any state through the channel, which is only known for
+ * the point-to-point and simple channels: a shared medium such as a
+ * CsmaChannel is updated by the transmissions of all its devices.
+ *
+ * \param [in] tid The TypeId of the channel.
+ * \returns \c true if the channel may join nodes of different LPs.
+ */
+static bool
+IsLpBoundary (TypeId tid)
+{
+  while (true)
+    {
+      if (tid.GetName () == "ns3::PointToPointChannel"
+          || tid.GetName () == "ns3::SimpleChannel")
+        {
+          return true;
+        }
+      if (tid.GetParent () == tid)
+        {
+          return false;
+        }
+      tid = tid.GetParent ();
+    }
+}
+
+thread_local MultithreadedSimulatorImpl::LogicalProcess *
+MultithreadedSimulatorImpl::m_currentLp = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mtp")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaxThreads",
+                   "The maximum number of threads (and logical processes) "
+                   "used to run the simulation, 0 to use one thread per "
+                   "hardware thread.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_maxThreads),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  m_global.index = 0;
+  m_global.uid = 4;
+  m_global.currentUid = 0;
+  m_global.currentTs = 0;
+  m_global.currentContext = Simulator::NO_CONTEXT;
+  m_global.eventCount = 0;
+  m_global.unscheduledEvents = 0;
+  m_partitioned = false;
+  m_maxThreads = 0;
+  m_lookAhead = NO_TS;
+  m_maxLookAhead = NO_TS;
+  m_windowEnd = NO_TS;
+  m_parity = 0;
+  m_stop = false;
+  m_stopTs = NO_TS;
+  m_round = 0;
+  m_pending = 0;
+  m_terminate = false;
+  m_externalEventsEmpty = true;
+  m_main = SystemThread::Self ();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  ReceiveExternalEvents ();
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); ++i)
+    {
+      LogicalProcess *lp = *i;
+      ReceiveMailboxes (lp, 0);
+      ReceiveMailboxes (lp, 1);
+      while (!lp->events->IsEmpty ())
+        {
+          Scheduler::Event next = lp->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      lp->events = 0;
+      delete lp;
+    }
+  m_lps.clear ();
+  ReceiveMailboxes (&m_global, 0);
+  ReceiveMailboxes (&m_global, 1);
+  while (!m_global.events->IsEmpty ())
+    {
+      Scheduler::Event next = m_global.events->RemoveNext ();
+      next.impl->Unref ();
+    }
+  m_global.events = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+
+  std::vector<LogicalProcess *> lps (m_lps);
+  lps.push_back (&m_global);
+  for (std::vector<LogicalProcess *>::iterator i = lps.begin (); i != lps.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if ((*i)->events != 0)
+        {
+          while (!(*i)->events->IsEmpty ())
+            {
+              Scheduler::Event next = (*i)->events->RemoveNext ();
+              scheduler->Insert (next);
+            }
+        }
+      (*i)->events = scheduler;
+    }
+}
+
+// All the logical processes belong to the same system
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+void
+MultithreadedSimulatorImpl::SetMaximumLookAhead (const Time lookAhead)
+{
+  if (lookAhead.IsStrictlyPositive ())
+    {
+      NS_LOG_FUNCTION (this << lookAhead);
+      m_maxLookAhead = lookAhead.GetTimeStep ();
+    }
+  else
+    {
+      NS_LOG_WARN ("attempted to set look ahead negative: " << lookAhead);
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (std::min<uint64_t> (m_lookAhead, GetMaximumSimulationTime ().GetTimeStep ()));
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount (void) const
+{
+  return m_lps.size ();
+}
+
+MultithreadedSimulatorImpl::LogicalProcess *
+MultithreadedSimulatorImpl::GetCurrentLp (void) const
+{
+  if (m_currentLp != 0)
+    {
+      return m_currentLp;
+    }
+  if (SystemThread::Equals (m_main))
+    {
+      return const_cast<LogicalProcess *> (&m_global);
+    }
+  return 0;
+}
+
+MultithreadedSimulatorImpl::LogicalProcess *
+MultithreadedSimulatorImpl::GetLpForContext (uint32_t context) const
+{
+  if (context < m_nodeLp.size ())
+    {
+      return m_lps[m_nodeLp[context]];
+    }
+  return const_cast<LogicalProcess *> (&m_global);
+}
+
+Scheduler::EventKey
+MultithreadedSimulatorImpl::Insert (LogicalProcess *lp, uint32_t context,
+                                    uint64_t ts, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = lp->uid;
+  lp->uid++;
+  lp->unscheduledEvents++;
+  lp->events->Insert (ev);
+  return ev.key;
+}
+
+void
+MultithreadedSimulatorImpl::Partition (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Group the nodes which cannot be separated: a channel without a
+  // positive delay gives no lookahead between the nodes it connects,
+  // and a shared medium keeps a state updated by all of them.
+  uint32_t nNodes = NodeList::GetNNodes ();
+  std::vector<uint32_t> group (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      group[i] = i;
+    }
+  struct ChannelInfo
+  {
+    std::vector<uint32_t> nodes;
+    uint64_t delay;
+  };
+  std::vector<ChannelInfo> channels;
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      Ptr<Channel> channel = *i;
+      ChannelInfo info;
+      info.delay = 0;
+      TypeId::AttributeInformation attribute;
+      if (IsLpBoundary (channel->GetInstanceTypeId ())
+          && channel->GetInstanceTypeId ().LookupAttributeByName ("Delay", &attribute)
+          && attribute.checker->GetValueTypeName () == "ns3::TimeValue")
+        {
+          TimeValue delay;
+          channel->GetAttribute ("Delay", delay);
+          if (delay.Get ().IsStrictlyPositive ())
+            {
+              info.delay = delay.Get ().GetTimeStep ();
+            }
+        }
+      for (uint32_t j = 0; j < channel->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = channel->GetDevice (j);
+          if (device != 0 && device->GetNode () != 0)
+            {
+              info.nodes.push_back (device->GetNode ()->GetId ());
+            }
+        }
+      if (info.delay == 0)
+        {
+          for (uint32_t j = 1; j < info.nodes.size (); ++j)
+            {
+              uint32_t a = info.nodes[0];
+              uint32_t b = info.nodes[j];
+              while (group[a] != a)
+                {
+                  a = group[a];
+                }
+              while (group[b] != b)
+                {
+                  b = group[b];
+                }
+              group[std::max (a, b)] = std::min (a, b);
+            }
+        }
+      else
+        {
+          channels.push_back (info);
+        }
+    }
+  // Each group is identified by its smallest node id; as a node is
+  // always attached to a smaller one, a single pass is enough.
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      group[i] = group[group[i]];
+    }
+
+  uint32_t nThreads = m_maxThreads;
+  if (nThreads == 0)
+    {
+      nThreads = std::max (1u, std::thread::hardware_concurrency ());
+    }
+
+  m_nodeLp.assign (nNodes, 0);
+  uint32_t nLps = 1;
+  uint32_t maxSystemId = 0;
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      maxSystemId = std::max (maxSystemId, NodeList::GetNode (i)->GetSystemId ());
+    }
+  if (maxSystemId != 0)
+    {
+      // Follow the partitioning chosen by the user
+      nLps = std::min (nThreads, maxSystemId + 1);
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          m_nodeLp[i] = NodeList::GetNode (i)->GetSystemId () % nLps;
+          if (m_nodeLp[i] != m_nodeLp[group[i]])
+            {
+              NS_FATAL_ERROR ("Nodes " << group[i] << " and " << i <<
+                              " share a channel without delay or a shared medium"
+                              " but have different system ids");
+            }
+        }
+    }
+  else if (nNodes != 0)
+    {
+      // Assign the largest groups first, each one to the least loaded LP
+      std::vector<uint32_t> size (nNodes, 0);
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          size[group[i]]++;
+        }
+      std::vector<std::pair<uint32_t, uint32_t> > groups;
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          if (size[i] != 0)
+            {
+              groups.push_back (std::make_pair (nNodes - size[i], i));
+            }
+        }
+      std::sort (groups.begin (), groups.end ());
+      nLps = std::min<uint32_t> (nThreads, groups.size ());
+      std::vector<uint32_t> load (nLps, 0);
+      for (uint32_t i = 0; i < groups.size (); ++i)
+        {
+          uint32_t lp = std::min_element (load.begin (), load.end ()) - load.begin ();
+          load[lp] += nNodes - groups[i].first;
+          m_nodeLp[groups[i].second] = lp;
+        }
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          m_nodeLp[i] = m_nodeLp[group[i]];
+        }
+    }
+
+  // The lookahead is the smallest delay of the channels between LPs
+  m_lookAhead = m_maxLookAhead;
+  bool crossing = false;
+  for (std::vector<ChannelInfo>::const_iterator i = channels.begin (); i != channels.end (); ++i)
+    {
+      for (uint32_t j = 1; j < i->nodes.size (); ++j)
+        {
+          if (m_nodeLp[i->nodes[j]] != m_nodeLp[i->nodes[0]])
+            {
+              m_lookAhead = std::min (m_lookAhead, i->delay);
+              crossing = true;
+              break;
+            }
+        }
+    }
+#ifndef NS3_ATOMIC_REFCOUNT
+  // The channels send copies of their packets to the other LP, which
+  // share the buffers of the packet kept by the sender
+  if (crossing)
+    {
+      NS_FATAL_ERROR ("The packets sent between " << nLps << " threads need "
+                      "atomic reference counts: configure ns-3 with --enable-atomic-refcount, "
+                      "or set ns3::MultithreadedSimulatorImpl::MaxThreads to 1");
+    }
+#else /* NS3_ATOMIC_REFCOUNT */
+  NS_UNUSED (crossing);
+#endif /* NS3_ATOMIC_REFCOUNT */
+  NS_LOG_INFO ("partitioned " << nNodes << " nodes in " << nLps <<
+               " logical processes, lookahead " << GetLookAhead ());
+
+  for (uint32_t i = 0; i < nLps; ++i)
+    {
+      LogicalProcess *lp = new LogicalProcess ();
+      lp->index = i;
+      lp->events = m_schedulerFactory.Create<Scheduler> ();
+      Mailbox empty;
+      empty.minTs = NO_TS;
+      lp->inbox[0].assign (nLps, empty);
+      lp->inbox[1].assign (nLps, empty);
+      lp->uid = m_global.uid;
+      lp->currentUid = 0;
+      lp->currentTs = m_global.currentTs;
+      lp->currentContext = Simulator::NO_CONTEXT;
+      lp->eventCount = 0;
+      lp->unscheduledEvents = 0;
+      m_lps.push_back (lp);
+    }
+  Mailbox empty;
+  empty.minTs = NO_TS;
+  m_global.index = nLps;
+  m_global.inbox[0].assign (nLps, empty);
+  m_global.inbox[1].assign (nLps, empty);
+  m_partitioned = true;
+
+  // Move the events scheduled so far to their LP, keeping their keys
+  std::vector<Scheduler::Event> events;
+  while (!m_global.events->IsEmpty ())
+    {
+      events.push_back (m_global.events->RemoveNext ());
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      LogicalProcess *lp = GetLpForContext (i->key.m_context);
+      lp->events->Insert (*i);
+      if (lp != &m_global)
+        {
+          lp->unscheduledEvents++;
+          m_global.unscheduledEvents--;
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ReceiveMailboxes (LogicalProcess *lp, uint32_t parity)
+{
+  for (std::vector<Mailbox>::iterator i = lp->inbox[parity].begin (); i != lp->inbox[parity].end (); ++i)
+    {
+      for (std::vector<MailboxEvent>::const_iterator j = i->events.begin (); j != i->events.end (); ++j)
+        {
+          Insert (lp, j->context, j->timestamp, j->event);
+        }
+      i->events.clear ();
+      i->minTs = NO_TS;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ReceiveExternalEvents (void)
+{
+  if (m_externalEventsEmpty.load (std::memory_order_acquire))
+    {
+      return;
+    }
+
+  // swap queues
+  ExternalEvents externalEvents;
+  {
+    CriticalSection cs (m_externalEventsMutex);
+    m_externalEvents.swap (externalEvents);
+    m_externalEventsEmpty = true;
+  }
+  while (!externalEvents.empty ())
+    {
+      ExternalEvent event = externalEvents.front ();
+      externalEvents.pop_front ();
+      // The current time is the start of the last window, but an LP
+      // may already have run events after it.
+      LogicalProcess *lp = GetLpForContext (event.context);
+      uint64_t ts = std::max (m_global.currentTs + event.delay, lp->currentTs);
+      Insert (lp, event.context, ts, event.event);
+    }
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetNextTs (const LogicalProcess *lp) const
+{
+  uint64_t next = NO_TS;
+  if (!lp->events->IsEmpty ())
+    {
+      next = lp->events->PeekNext ().key.m_ts;
+    }
+  for (std::vector<Mailbox>::const_iterator i = lp->inbox[m_parity].begin (); i != lp->inbox[m_parity].end (); ++i)
+    {
+      next = std::min (next, i->minTs);
+    }
+  return next;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (LogicalProcess *lp)
+{
+  Scheduler::Event next = lp->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= lp->currentTs);
+  lp->unscheduledEvents--;
+  lp->eventCount++;
+
+  lp->currentTs = next.key.m_ts;
+  lp->currentContext = next.key.m_context;
+  lp->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow (LogicalProcess *lp)
+{
+  ReceiveMailboxes (lp, m_parity ^ 1);
+  while (!lp->events->IsEmpty ()
+         && lp->events->PeekNext ().key.m_ts < m_windowEnd
+         && !m_stop.load (std::memory_order_relaxed))
+    {
+      ProcessOneEvent (lp);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::StartWorker (MultithreadedSimulatorImpl *impl, uint32_t index)
+{
+  impl->Worker (index);
+}
+
+void
+MultithreadedSimulatorImpl::Worker (uint32_t index)
+{
+  m_currentLp = m_lps[index];
+  uint32_t seen = 0;
+  while (true)
+    {
+      uint32_t round;
+      while ((round = m_round.load (std::memory_order_acquire)) == seen)
+        {
+          std::this_thread::yield ();
+        }
+      seen = round;
+      if (m_terminate.load (std::memory_order_relaxed))
+        {
+          break;
+        }
+      ProcessWindow (m_currentLp);
+      m_pending.fetch_sub (1, std::memory_order_release);
+    }
+  m_currentLp = 0;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return m_global.events->IsEmpty ();
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Set the current threadId as the main threadId
+  m_main = SystemThread::Self ();
+  m_currentLp = 0;
+  if (!m_partitioned)
+    {
+      Partition ();
+    }
+  m_stop = false;
+
+  m_round = 0;
+  m_terminate = false;
+  for (uint32_t i = 1; i < m_lps.size (); ++i)
+    {
+      Ptr<SystemThread> thread =
+        Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::StartWorker, this, i));
+      thread->Start ();
+      m_threads.push_back (thread);
+    }
+
+  while (!m_stop)
+    {
+      // All the workers are idle here
+      ReceiveExternalEvents ();
+      ReceiveMailboxes (&m_global, m_parity);
+      uint64_t next = NO_TS;
+      for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); ++i)
+        {
+          next = std::min (next, GetNextTs (*i));
+        }
+      uint64_t globalNext = GetNextTs (&m_global);
+      uint64_t stopTs = m_stopTs.load ();
+      if (std::min (next, globalNext) == NO_TS)
+        {
+          break;
+        }
+      if (std::min (next, globalNext) >= stopTs)
+        {
+          m_global.currentTs = stopTs;
+          m_stopTs = NO_TS;
+          break;
+        }
+      if (globalNext <= next)
+        {
+          // Events without a node context are run alone, before the
+          // node events with the same timestamp.
+          ProcessOneEvent (&m_global);
+          continue;
+        }
+
+      uint64_t windowEnd = NO_TS;
+      if (m_lookAhead < NO_TS - next)
+        {
+          windowEnd = next + m_lookAhead;
+        }
+      m_windowEnd = std::min (windowEnd, std::min (globalNext, stopTs));
+      // The global LP keeps the simulation time seen by the other
+      // threads; no global event is earlier than the window end.
+      m_global.currentTs = next;
+      m_parity ^= 1;
+      m_pending.store (m_lps.size () - 1, std::memory_order_relaxed);
+      m_round.fetch_add (1, std::memory_order_release);
+      m_currentLp = m_lps[0];
+      ProcessWindow (m_currentLp);
+      m_currentLp = 0;
+      while (m_pending.load (std::memory_order_acquire) != 0)
+        {
+          std::this_thread::yield ();
+        }
+    }
+
+  m_terminate = true;
+  m_round.fetch_add (1, std::memory_order_release);
+  for (std::vector<Ptr<SystemThread> >::iterator i = m_threads.begin (); i != m_threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  m_threads.clear ();
+  m_windowEnd = NO_TS;
+
+  // Leave the events in the queues so that the simulation can be resumed
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); ++i)
+    {
+      ReceiveMailboxes (*i, 0);
+      ReceiveMailboxes (*i, 1);
+      m_global.currentTs = std::max (m_global.currentTs, (*i)->currentTs);
+    }
+  ReceiveMailboxes (&m_global, 0);
+  ReceiveMailboxes (&m_global, 1);
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  int unscheduledEvents = m_global.unscheduledEvents;
+  for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); ++i)
+    {
+      unscheduledEvents += (*i)->unscheduledEvents;
+    }
+  NS_ASSERT (!IsFinished () || unscheduledEvents == 0);
+  NS_UNUSED (unscheduledEvents);
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Stop(): Negative delay");
+  uint64_t ts = Now ().GetTimeStep () + delay.GetTimeStep ();
+  uint64_t current = m_stopTs.load ();
+  while (ts < current && !m_stopTs.compare_exchange_weak (current, ts))
+    {
+    }
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  LogicalProcess *lp = GetCurrentLp ();
+  NS_ASSERT_MSG (lp != 0, "Simulator::Schedule Thread-unsafe invocation!");
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+  Scheduler::EventKey key = Insert (lp, lp->currentContext,
+                                    lp->currentTs + delay.GetTimeStep (), event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  LogicalProcess *current = GetCurrentLp ();
+  if (current == 0)
+    {
+      ExternalEvent ev;
+      ev.context = context;
+      // Current time added in ReceiveExternalEvents()
+      ev.delay = delay.GetTimeStep ();
+      ev.event = event;
+      {
+        CriticalSection cs (m_externalEventsMutex);
+        m_externalEvents.push_back (ev);
+        m_externalEventsEmpty = false;
+      }
+      return;
+    }
+
+  uint64_t ts = current->currentTs + delay.GetTimeStep ();
+  LogicalProcess *target = GetLpForContext (context);
+  if (target == current || current == &m_global)
+    {
+      // The workers are idle when the global LP is running
+      Insert (target, context, ts, event);
+      return;
+    }
+  if (ts < m_windowEnd)
+    {
+      NS_FATAL_ERROR ("Event for context " << context << " scheduled " << delay <<
+                      " ahead crosses logical processes with a lookahead of " << GetLookAhead ());
+    }
+  Mailbox &mailbox = target->inbox[m_parity][current->index];
+  MailboxEvent ev;
+  ev.context = context;
+  ev.timestamp = ts;
+  ev.event = event;
+  mailbox.events.push_back (ev);
+  mailbox.minTs = std::min (mailbox.minTs, ts);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  LogicalProcess *lp = GetCurrentLp ();
+  NS_ASSERT_MSG (lp != 0, "Simulator::ScheduleNow Thread-unsafe invocation!");
+
+  Scheduler::EventKey key = Insert (lp, lp->currentContext, lp->currentTs, event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), Now ().GetTimeStep (), 0xffffffff, 2);
+  CriticalSection cs (m_destroyEventsMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  LogicalProcess *lp = GetCurrentLp ();
+  if (lp == 0)
+    {
+      lp = const_cast<LogicalProcess *> (&m_global);
+    }
+  return TimeStep (lp->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - Now ().GetTimeStep ());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  LogicalProcess *lp = GetLpForContext (id.GetContext ());
+  NS_ASSERT_MSG (lp == GetCurrentLp () || GetCurrentLp () == &m_global,
+                 "Simulator::Remove of an event owned by another logical process");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  lp->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  lp->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const LogicalProcess *lp = GetLpForContext (id.GetContext ());
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < lp->currentTs
+      || (id.GetTs () == lp->currentTs && id.GetUid () <= lp->currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  LogicalProcess *lp = GetCurrentLp ();
+  if (lp == 0)
+    {
+      lp = const_cast<LogicalProcess *> (&m_global);
+    }
+  return lp->currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t count = m_global.eventCount;
+  for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); ++i)
+    {
+      count += (*i)->eventCount;
+    }
+  return count;
+}
+
+} // namespace ns3
@@ -0,0 +1,319 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup mtp
+ *
+ * \brief Shared-memory parallel simulator implementation.
+ *
+ * The nodes of the simulation are partitioned into logical processes
+ * (LPs), each of which owns a private event queue and is executed by
+ * its own worker thread.  The partitioning is computed when Run() is
+ * first called: nodes joined by a channel without a positive "Delay"
+ * attribute, or by a shared medium such as a CsmaChannel, are always
+ * kept in the same LP, and the remaining groups are balanced across
+ * LPs.  Only the point-to-point and simple channels (and their
+ * subclasses) may join nodes of different LPs.  If the nodes were
+ * created with explicit system ids (as for the MPI simulators), those
+ * ids select the LP.
+ *
+ * The packets sent between LPs share their buffers with the packets
+ * kept by the sender, so running more than one LP requires ns-3 to be
+ * configured with --enable-atomic-refcount; otherwise Run() aborts
+ * when a channel joins two LPs.
+ *
+ * Synchronization is conservative and uses a granted time window: the
+ * lookahead is the smallest "Delay" of the channels that cross LP
+ * boundaries, and in each round every LP executes the events that are
+ * earlier than the smallest pending timestamp plus the lookahead.
+ * Events scheduled for a node of another LP are appended to per-thread
+ * mailboxes which are only read once all the workers have reached the
+ * end of the round, so no locking is needed on the event path.
+ *
+ * Events without a node context (or with a context which does not
+ * match any node known when the partitioning was done) are kept in a
+ * separate, global queue and are executed serially by the main thread
+ * while the workers are idle; they can therefore touch any node.
+ *
+ * This implementation is selected with
+ * \code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::MultithreadedSimulatorImpl"));
+ * \endcode
+ *
+ * \warning The models must not share mutable state between nodes
+ * which are assigned to different LPs.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * Set an upper bound for the lookahead.  The lookahead computed from
+   * the channel delays is never larger than this value.
+   *
+   * \param [in] lookAhead The maximum lookahead, must be positive.
+   */
+  void SetMaximumLookAhead (const Time lookAhead);
+
+  /**
+   * \return The lookahead used by the last call to Run().
+   */
+  Time GetLookAhead (void) const;
+
+  /**
+   * \return The number of logical processes (and worker threads) used
+   *         by the last call to Run().
+   */
+  uint32_t GetPartitionCount (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event sent to another LP, waiting in a mailbox. */
+  struct MailboxEvent
+  {
+    /** The event context. */
+    uint32_t context;
+    /** The absolute event timestamp. */
+    uint64_t timestamp;
+    /** The event implementation. */
+    EventImpl *event;
+  };
+
+  /** Events sent by one LP to another during a round. */
+  struct Mailbox
+  {
+    /** The pending events, in sending order. */
+    std::vector<MailboxEvent> events;
+    /** The smallest timestamp in events. */
+    uint64_t minTs;
+  };
+
+  /** A logical process: one partition of the nodes. */
+  struct LogicalProcess
+  {
+    /** The index of this LP; the global LP has the largest index. */
+    uint32_t index;
+    /** The event priority queue. */
+    Ptr<Scheduler> events;
+    /**
+     * Incoming mailboxes, indexed by the sending LP.  There are two
+     * sets, used in alternate rounds, so that an LP can empty the set
+     * filled during the previous round while the other LPs are
+     * already sending events for the current one.
+     */
+    std::vector<Mailbox> inbox[2];
+    /** Next event unique id. */
+    uint32_t uid;
+    /** Unique id of the current event. */
+    uint32_t currentUid;
+    /** Timestamp of the current event. */
+    uint64_t currentTs;
+    /** Execution context of the current event. */
+    uint32_t currentContext;
+    /** The event count. */
+    uint64_t eventCount;
+    /** Number of events inserted but not yet executed. */
+    int unscheduledEvents;
+  };
+
+  /** Event received from a thread which is not part of the simulation. */
+  struct ExternalEvent
+  {
+    /** The event context. */
+    uint32_t context;
+    /** The event delay, relative to the time it is received. */
+    uint64_t delay;
+    /** The event implementation. */
+    EventImpl *event;
+  };
+
+  /**
+   * \return The LP of the calling thread.
+   */
+  LogicalProcess * GetCurrentLp (void) const;
+  /**
+   * \param [in] context An event context.
+   * \return The LP which owns events with this context.
+   */
+  LogicalProcess * GetLpForContext (uint32_t context) const;
+  /**
+   * Insert an event in the queue of an LP.
+   * \param [in] lp The LP.
+   * \param [in] context The event context.
+   * \param [in] ts The absolute event timestamp.
+   * \param [in] event The event implementation.
+   * \return The key of the inserted event.
+   */
+  Scheduler::EventKey Insert (LogicalProcess *lp, uint32_t context,
+                              uint64_t ts, EventImpl *event);
+  /**
+   * Build the LPs from the nodes and channels, compute the lookahead
+   * and move the events scheduled before Run() to their LP.
+   */
+  void Partition (void);
+  /**
+   * Move the events received in the mailboxes of an LP to its queue.
+   * \param [in] lp The LP.
+   * \param [in] parity The set of mailboxes to read.
+   */
+  void ReceiveMailboxes (LogicalProcess *lp, uint32_t parity);
+  /** Move the events received from foreign threads to their LP. */
+  void ReceiveExternalEvents (void);
+  /**
+   * \param [in] lp The LP.
+   * \return The timestamp of the next event of the LP, including the
+   *         events waiting in its mailboxes.
+   */
+  uint64_t GetNextTs (const LogicalProcess *lp) const;
+  /**
+   * Execute the next event of an LP.
+   * \param [in] lp The LP.
+   */
+  void ProcessOneEvent (LogicalProcess *lp);
+  /**
+   * Execute all the events of an LP earlier than the current window end.
+   * \param [in] lp The LP.
+   */
+  void ProcessWindow (LogicalProcess *lp);
+  /**
+   * Worker thread entry point.
+   * \param [in] index The index of the LP executed by this worker.
+   */
+  void Worker (uint32_t index);
+  /**
+   * Trampoline to Worker(), used as the SystemThread callback.
+   * \param [in] impl The simulator implementation.
+   * \param [in] index The index of the LP executed by this worker.
+   */
+  static void StartWorker (MultithreadedSimulatorImpl *impl, uint32_t index);
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Mutex to control access to the destroy events. */
+  SystemMutex m_destroyEventsMutex;
+
+  /** The scheduler factory, used to create the LP queues. */
+  ObjectFactory m_schedulerFactory;
+  /** The LP for the events without a node context. */
+  LogicalProcess m_global;
+  /** The LPs executed in parallel, LP 0 runs in the main thread. */
+  std::vector<LogicalProcess *> m_lps;
+  /** The LP index of each node, indexed by node id. */
+  std::vector<uint32_t> m_nodeLp;
+  /** Flag \c true once the nodes have been partitioned. */
+  bool m_partitioned;
+  /** Maximum number of threads, 0 means one per hardware thread. */
+  uint32_t m_maxThreads;
+
+  /** The lookahead, in time steps. */
+  uint64_t m_lookAhead;
+  /** The upper bound of the lookahead, in time steps. */
+  uint64_t m_maxLookAhead;
+  /** The end of the current window (exclusive), in time steps. */
+  uint64_t m_windowEnd;
+  /** The set of mailboxes written during the current round. */
+  uint32_t m_parity;
+
+  /** Flag calling for the end of the simulation. */
+  std::atomic<bool> m_stop;
+  /** The absolute time at which the simulation must stop. */
+  std::atomic<uint64_t> m_stopTs;
+  /** The round counter, incremented by the main thread to start a round. */
+  std::atomic<uint32_t> m_round;
+  /** The number of workers which have not finished the current round. */
+  std::atomic<uint32_t> m_pending;
+  /** Flag asking the workers to exit. */
+  std::atomic<bool> m_terminate;
+  /** The worker threads. */
+  std::vector<Ptr<SystemThread> > m_threads;
+
+  /** Container type for the events received from foreign threads. */
+  typedef std::list<ExternalEvent> ExternalEvents;
+  /** The events received from foreign threads. */
+  ExternalEvents m_externalEvents;
+  /** Flag \c true if no event was received from foreign threads. */
+  std::atomic<bool> m_externalEventsEmpty;
+  /** Mutex to control access to the events from foreign threads. */
+  SystemMutex m_externalEventsMutex;
+
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+
+  /** The LP executed by the calling thread, if any. */
+  static thread_local LogicalProcess *m_currentLp;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
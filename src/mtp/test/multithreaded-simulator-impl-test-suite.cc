@@ -0,0 +1,347 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mtp-tests
+ *
+ * Check that a ring of nodes exchanging events across logical processes
+ * sees the same events, at the same times, as with the default
+ * simulator implementation.
+ */
+class MultithreadedSimulatorImplRingTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorImplRingTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Build the ring and run the simulation.
+   * \param [in] impl The simulator implementation.
+   * \return The sorted event times seen by each node, then by the
+   *         global events.
+   */
+  std::vector<std::vector<uint64_t> > RunRing (Ptr<SimulatorImpl> impl);
+  /**
+   * Event received by a node from its neighbour.
+   * \param [in] node The node index.
+   * \param [in] hops The number of hops left.
+   */
+  void Hop (uint32_t node, uint32_t hops);
+  /**
+   * Event scheduled by a node for itself.
+   * \param [in] node The node index.
+   */
+  void Local (uint32_t node);
+  /** Event without a node context. */
+  void Global (void);
+
+  /** The event times seen by each node, then by the global events. */
+  std::vector<std::vector<uint64_t> > m_times;
+  /**
+   * The number of events run with a wrong context, by node: the events
+   * run on the worker threads, which must not call the test macros.
+   */
+  std::vector<uint32_t> m_wrongContexts;
+  /** The number of logical processes of the last run. */
+  uint32_t m_partitions;
+  /** The lookahead of the last run. */
+  Time m_lookAhead;
+};
+
+/** The number of nodes in the ring. */
+static const uint32_t RING_SIZE = 8;
+
+MultithreadedSimulatorImplRingTestCase::MultithreadedSimulatorImplRingTestCase ()
+  : TestCase ("Check that events crossing logical processes are delivered in time")
+{}
+
+void
+MultithreadedSimulatorImplRingTestCase::Hop (uint32_t node, uint32_t hops)
+{
+  if (Simulator::GetContext () != node)
+    {
+      m_wrongContexts[node]++;
+    }
+  m_times[node].push_back (Simulator::Now ().GetTimeStep ());
+  Simulator::Schedule (MicroSeconds (100 * (node + 1)),
+                       &MultithreadedSimulatorImplRingTestCase::Local, this, node);
+  if (hops > 0)
+    {
+      uint32_t next = (node + 1) % RING_SIZE;
+      Simulator::ScheduleWithContext (next, MilliSeconds (1) + MicroSeconds (node),
+                                      &MultithreadedSimulatorImplRingTestCase::Hop, this,
+                                      next, hops - 1);
+    }
+}
+
+void
+MultithreadedSimulatorImplRingTestCase::Local (uint32_t node)
+{
+  if (Simulator::GetContext () != node)
+    {
+      m_wrongContexts[node]++;
+    }
+  m_times[node].push_back (Simulator::Now ().GetTimeStep ());
+}
+
+void
+MultithreadedSimulatorImplRingTestCase::Global (void)
+{
+  m_times[RING_SIZE].push_back (Simulator::Now ().GetTimeStep ());
+  // Global events can reach any node with any delay
+  Simulator::ScheduleWithContext (3, MicroSeconds (1),
+                                  &MultithreadedSimulatorImplRingTestCase::Local, this, 3);
+}
+
+std::vector<std::vector<uint64_t> >
+MultithreadedSimulatorImplRingTestCase::RunRing (Ptr<SimulatorImpl> impl)
+{
+  m_times.assign (RING_SIZE + 1, std::vector<uint64_t> ());
+  m_wrongContexts.assign (RING_SIZE, 0);
+  Simulator::SetImplementation (impl);
+
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < RING_SIZE; ++i)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+  for (uint32_t i = 0; i < RING_SIZE; ++i)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      // The last two nodes cannot be separated
+      Time delay = (i == RING_SIZE - 2) ? Seconds (0) : MilliSeconds (1);
+      channel->SetAttribute ("Delay", TimeValue (delay));
+      for (uint32_t j = i; j <= i + 1; ++j)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetChannel (channel);
+          nodes[j % RING_SIZE]->AddDevice (device);
+        }
+    }
+
+  for (uint32_t i = 0; i < RING_SIZE; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (10 * i),
+                                      &MultithreadedSimulatorImplRingTestCase::Hop, this,
+                                      i, 20);
+    }
+  Simulator::Schedule (MicroSeconds (5500), &MultithreadedSimulatorImplRingTestCase::Global, this);
+  Simulator::Stop (MilliSeconds (15));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (15), "wrong stop time");
+
+  Ptr<MultithreadedSimulatorImpl> mtp = DynamicCast<MultithreadedSimulatorImpl> (impl);
+  if (mtp != 0)
+    {
+      m_partitions = mtp->GetPartitionCount ();
+      m_lookAhead = mtp->GetLookAhead ();
+    }
+  Simulator::Destroy ();
+
+  for (uint32_t i = 0; i <= RING_SIZE; ++i)
+    {
+      std::sort (m_times[i].begin (), m_times[i].end ());
+    }
+  return m_times;
+}
+
+void
+MultithreadedSimulatorImplRingTestCase::DoRun (void)
+{
+  std::vector<std::vector<uint64_t> > expected = RunRing (CreateObject<DefaultSimulatorImpl> ());
+  Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl> ();
+#ifdef NS3_ATOMIC_REFCOUNT
+  impl->SetAttribute ("MaxThreads", UintegerValue (4));
+#else /* NS3_ATOMIC_REFCOUNT */
+  // The channels between the logical processes could carry packets,
+  // which cannot be shared between threads
+  impl->SetAttribute ("MaxThreads", UintegerValue (1));
+#endif /* NS3_ATOMIC_REFCOUNT */
+  std::vector<std::vector<uint64_t> > times = RunRing (impl);
+
+#ifdef NS3_ATOMIC_REFCOUNT
+  NS_TEST_ASSERT_MSG_EQ (m_partitions, 4, "wrong number of logical processes");
+  NS_TEST_ASSERT_MSG_EQ (m_lookAhead, MilliSeconds (1), "wrong lookahead");
+#else /* NS3_ATOMIC_REFCOUNT */
+  NS_TEST_ASSERT_MSG_EQ (m_partitions, 1, "wrong number of logical processes");
+#endif /* NS3_ATOMIC_REFCOUNT */
+  NS_TEST_ASSERT_MSG_EQ (expected[RING_SIZE].size (), 1, "global event not run");
+  for (uint32_t i = 0; i <= RING_SIZE; ++i)
+    {
+      if (i < RING_SIZE)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_wrongContexts[i], 0, "events run with a wrong context on " << i);
+        }
+      NS_TEST_ASSERT_MSG_EQ (times[i].size (), expected[i].size (), "wrong number of events for " << i);
+      for (uint32_t j = 0; j < times[i].size (); ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ (times[i][j], expected[i][j], "wrong event time for " << i);
+        }
+    }
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * Check that an event scheduled from a foreign thread in the middle of
+ * the simulation is timestamped from the current simulation time.
+ */
+class MultithreadedSimulatorImplExternalTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorImplExternalTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Periodic event of a node.
+   * \param [in] node The node index.
+   */
+  void Tick (uint32_t node);
+  /** Schedule an event for node 1 from a foreign thread. */
+  void Inject (void);
+  /** Event scheduled by the foreign thread. */
+  void Received (void);
+
+  /** The times at which the event of the foreign thread ran. */
+  std::vector<Time> m_received;
+  /** The context of the event of the foreign thread. */
+  uint32_t m_receivedContext;
+};
+
+/** The number of nodes in the line of the external event test. */
+static const uint32_t LINE_SIZE = 4;
+
+MultithreadedSimulatorImplExternalTestCase::MultithreadedSimulatorImplExternalTestCase ()
+  : TestCase ("Check the time of the events scheduled by foreign threads")
+{}
+
+void
+MultithreadedSimulatorImplExternalTestCase::Tick (uint32_t node)
+{
+  if (Simulator::Now () < MilliSeconds (10))
+    {
+      Simulator::Schedule (MicroSeconds (100), &MultithreadedSimulatorImplExternalTestCase::Tick,
+                           this, node);
+    }
+}
+
+void
+MultithreadedSimulatorImplExternalTestCase::Inject (void)
+{
+  std::thread thread ([this] ()
+    {
+      Simulator::ScheduleWithContext (1, MicroSeconds (10),
+                                      &MultithreadedSimulatorImplExternalTestCase::Received,
+                                      this);
+    });
+  thread.join ();
+}
+
+void
+MultithreadedSimulatorImplExternalTestCase::Received (void)
+{
+  m_received.push_back (Simulator::Now ());
+  m_receivedContext = Simulator::GetContext ();
+}
+
+void
+MultithreadedSimulatorImplExternalTestCase::DoRun (void)
+{
+  Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl> ();
+#ifdef NS3_ATOMIC_REFCOUNT
+  impl->SetAttribute ("MaxThreads", UintegerValue (LINE_SIZE));
+#else /* NS3_ATOMIC_REFCOUNT */
+  impl->SetAttribute ("MaxThreads", UintegerValue (1));
+#endif /* NS3_ATOMIC_REFCOUNT */
+  Simulator::SetImplementation (impl);
+
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < LINE_SIZE; ++i)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+  for (uint32_t i = 0; i + 1 < LINE_SIZE; ++i)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+      for (uint32_t j = i; j <= i + 1; ++j)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetChannel (channel);
+          nodes[j]->AddDevice (device);
+        }
+    }
+
+  for (uint32_t i = 0; i < LINE_SIZE; ++i)
+    {
+      Simulator::ScheduleWithContext (i, Seconds (0), &MultithreadedSimulatorImplExternalTestCase::Tick,
+                                      this, i);
+    }
+  Simulator::ScheduleWithContext (2, MilliSeconds (5), &MultithreadedSimulatorImplExternalTestCase::Inject,
+                                  this);
+  Simulator::Stop (MilliSeconds (20));
+  Simulator::Run ();
+  Time lookAhead = impl->GetLookAhead ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), 1, "event of the foreign thread not run");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedContext, 1, "wrong context");
+  // Counted from the start of the window which ran the injection
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (m_received[0], MilliSeconds (5) - lookAhead + MicroSeconds (10),
+                               "event of the foreign thread timestamped in the past");
+#ifdef NS3_ATOMIC_REFCOUNT
+  NS_TEST_EXPECT_MSG_EQ (lookAhead, MilliSeconds (1), "wrong lookahead");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_received[0], MilliSeconds (5) + lookAhead + MicroSeconds (10),
+                               "event of the foreign thread delayed by more than a window");
+#endif /* NS3_ATOMIC_REFCOUNT */
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * Multithreaded simulator implementation TestSuite
+ */
+class MultithreadedSimulatorImplTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorImplTestSuite ()
+    : TestSuite ("multithreaded-simulator-impl", UNIT)
+  {
+    AddTestCase (new MultithreadedSimulatorImplRingTestCase, TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorImplExternalTestCase, TestCase::QUICK);
+  }
+};
+
+/** Static variable for test initialization */
+static MultithreadedSimulatorImplTestSuite g_multithreadedSimulatorImplTestSuite;
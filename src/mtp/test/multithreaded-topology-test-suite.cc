@@ -0,0 +1,262 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/mac48-address.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/csma-helper.h"
+#include "ns3/point-to-point-helper.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mtp-tests
+ *
+ * Check that two CSMA LANs joined by point-to-point links receive the
+ * same packets, at the same times, as with the default simulator
+ * implementation.  Each LAN must stay in one logical process, since the
+ * CsmaChannel state is shared by all its devices, and the links between
+ * the LANs carry packets from one thread to the other.
+ */
+class MultithreadedSimulatorImplTopologyTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorImplTopologyTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /** A packet received: the receive time and the packet size. */
+  typedef std::pair<uint64_t, uint32_t> Reception;
+
+  /**
+   * Build the topology and run the simulation.
+   * \param [in] impl The simulator implementation.
+   * \return The sorted packets received by each node.
+   */
+  std::vector<std::vector<Reception> > RunTopology (Ptr<SimulatorImpl> impl);
+  /**
+   * Send a packet on a device, and schedule the next one.
+   * \param [in] device The device.
+   * \param [in] size The size of the packet.
+   * \param [in] interval The time to the next packet.
+   */
+  void Send (Ptr<NetDevice> device, uint32_t size, Time interval);
+  /**
+   * Receive a packet, and forward the packets received from a
+   * point-to-point link to the LAN of the node.
+   * \param [in] device The receiving device.
+   * \param [in] packet The packet.
+   * \param [in] protocol The protocol number.
+   * \param [in] from The sender address.
+   * \returns \c true.
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                uint16_t protocol, const Address &from);
+
+  /** The packets received by each node. */
+  std::vector<std::vector<Reception> > m_receptions;
+  /** The number of events run with a wrong context, by node. */
+  std::vector<uint32_t> m_wrongContexts;
+  /** The CSMA device of each node. */
+  std::vector<Ptr<NetDevice> > m_lan;
+  /** The number of logical processes of the last run. */
+  uint32_t m_partitions;
+  /** The lookahead of the last run. */
+  Time m_lookAhead;
+};
+
+/** The number of nodes of each LAN. */
+static const uint32_t LAN_SIZE = 3;
+/** The end of the simulation, in milliseconds. */
+static const uint32_t STOP_MS = 40;
+
+MultithreadedSimulatorImplTopologyTestCase::MultithreadedSimulatorImplTopologyTestCase ()
+  : TestCase ("Check that a CSMA and point-to-point topology gives the same results with threads")
+{}
+
+void
+MultithreadedSimulatorImplTopologyTestCase::Send (Ptr<NetDevice> device, uint32_t size, Time interval)
+{
+  uint32_t node = device->GetNode ()->GetId ();
+  if (Simulator::GetContext () != node)
+    {
+      m_wrongContexts[node]++;
+    }
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x0800);
+  Simulator::Schedule (interval, &MultithreadedSimulatorImplTopologyTestCase::Send, this,
+                       device, size, interval);
+}
+
+bool
+MultithreadedSimulatorImplTopologyTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                                     uint16_t protocol, const Address &from)
+{
+  uint32_t node = device->GetNode ()->GetId ();
+  if (Simulator::GetContext () != node)
+    {
+      m_wrongContexts[node]++;
+    }
+  m_receptions[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (),
+                                                packet->GetSize ()));
+  if (device != m_lan[node])
+    {
+      m_lan[node]->Send (packet->Copy (), m_lan[node]->GetBroadcast (), 0x0800);
+    }
+  return true;
+}
+
+std::vector<std::vector<MultithreadedSimulatorImplTopologyTestCase::Reception> >
+MultithreadedSimulatorImplTopologyTestCase::RunTopology (Ptr<SimulatorImpl> impl)
+{
+  m_receptions.assign (2 * LAN_SIZE, std::vector<Reception> ());
+  m_wrongContexts.assign (2 * LAN_SIZE, 0);
+  m_lan.clear ();
+  Simulator::SetImplementation (impl);
+
+  NodeContainer lanA;
+  lanA.Create (LAN_SIZE);
+  NodeContainer lanB;
+  lanB.Create (LAN_SIZE);
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("10Mbps"));
+  csma.SetChannelAttribute ("Delay", TimeValue (NanoSeconds (6560)));
+  NetDeviceContainer lanADevices = csma.Install (lanA);
+  NetDeviceContainer lanBDevices = csma.Install (lanB);
+  // The backoffs must not depend on the streams used by the previous run
+  csma.AssignStreams (lanADevices, 0);
+  csma.AssignStreams (lanBDevices, 100);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  p2p.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (2) + NanoSeconds (13)));
+  NetDeviceContainer link0 = p2p.Install (lanA.Get (0), lanB.Get (0));
+  p2p.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (3) + NanoSeconds (29)));
+  NetDeviceContainer link1 = p2p.Install (lanA.Get (1), lanB.Get (1));
+
+  NetDeviceContainer all;
+  all.Add (lanADevices);
+  all.Add (lanBDevices);
+  m_lan.assign (all.Begin (), all.End ());
+  all.Add (link0);
+  all.Add (link1);
+  for (NetDeviceContainer::Iterator i = all.Begin (); i != all.End (); ++i)
+    {
+      (*i)->SetReceiveCallback (MakeCallback (&MultithreadedSimulatorImplTopologyTestCase::Receive, this));
+    }
+
+  // Every node sends on its LAN, the collisions exercise the backoff
+  for (uint32_t i = 0; i < 2 * LAN_SIZE; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (7 * i + 1),
+                                      &MultithreadedSimulatorImplTopologyTestCase::Send, this,
+                                      m_lan[i], 200 + 10 * i, MicroSeconds (900 + 37 * i));
+    }
+  // The ends of the links send to each other
+  NetDeviceContainer links;
+  links.Add (link0);
+  links.Add (link1);
+  for (uint32_t i = 0; i < links.GetN (); ++i)
+    {
+      Ptr<NetDevice> device = links.Get (i);
+      Simulator::ScheduleWithContext (device->GetNode ()->GetId (), MicroSeconds (11 * i + 3),
+                                      &MultithreadedSimulatorImplTopologyTestCase::Send, this,
+                                      device, 500 + 20 * i, MicroSeconds (1300 + 53 * i));
+    }
+
+  Simulator::Stop (MilliSeconds (STOP_MS));
+  Simulator::Run ();
+  Ptr<MultithreadedSimulatorImpl> mtp = DynamicCast<MultithreadedSimulatorImpl> (impl);
+  if (mtp != 0)
+    {
+      m_partitions = mtp->GetPartitionCount ();
+      m_lookAhead = mtp->GetLookAhead ();
+    }
+  Simulator::Destroy ();
+  m_lan.clear ();
+
+  for (uint32_t i = 0; i < m_receptions.size (); ++i)
+    {
+      std::sort (m_receptions[i].begin (), m_receptions[i].end ());
+    }
+  return m_receptions;
+}
+
+void
+MultithreadedSimulatorImplTopologyTestCase::DoRun (void)
+{
+  std::vector<std::vector<Reception> > expected = RunTopology (CreateObject<DefaultSimulatorImpl> ());
+  Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl> ();
+#ifdef NS3_ATOMIC_REFCOUNT
+  impl->SetAttribute ("MaxThreads", UintegerValue (4));
+#else /* NS3_ATOMIC_REFCOUNT */
+  // The packets cannot be shared between threads
+  impl->SetAttribute ("MaxThreads", UintegerValue (1));
+#endif /* NS3_ATOMIC_REFCOUNT */
+  std::vector<std::vector<Reception> > receptions = RunTopology (impl);
+
+#ifdef NS3_ATOMIC_REFCOUNT
+  // One logical process per LAN, joined by the links
+  NS_TEST_ASSERT_MSG_EQ (m_partitions, 2, "wrong number of logical processes");
+  NS_TEST_ASSERT_MSG_EQ (m_lookAhead, MilliSeconds (2) + NanoSeconds (13), "wrong lookahead");
+#else /* NS3_ATOMIC_REFCOUNT */
+  NS_TEST_ASSERT_MSG_EQ (m_partitions, 1, "wrong number of logical processes");
+#endif /* NS3_ATOMIC_REFCOUNT */
+  for (uint32_t i = 0; i < receptions.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_wrongContexts[i], 0, "events run with a wrong context on " << i);
+      NS_TEST_ASSERT_MSG_GT (expected[i].size (), 0, "no packet received by " << i);
+      NS_TEST_ASSERT_MSG_EQ (receptions[i].size (), expected[i].size (),
+                             "wrong number of packets received by " << i);
+      for (uint32_t j = 0; j < receptions[i].size (); ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ (receptions[i][j].first, expected[i][j].first,
+                                 "wrong receive time on " << i);
+          NS_TEST_EXPECT_MSG_EQ (receptions[i][j].second, expected[i][j].second,
+                                 "wrong packet received by " << i);
+        }
+    }
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * Multithreaded simulator implementation topology TestSuite
+ */
+class MultithreadedTopologyTestSuite : public TestSuite
+{
+public:
+  MultithreadedTopologyTestSuite ()
+    : TestSuite ("multithreaded-topology", UNIT)
+  {
+    AddTestCase (new MultithreadedSimulatorImplTopologyTestCase, TestCase::QUICK);
+  }
+};
+
+/** Static variable for test initialization */
+static MultithreadedTopologyTestSuite g_multithreadedTopologyTestSuite;
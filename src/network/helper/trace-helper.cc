@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/binary-trace-file.h"
 
 #include "trace-helper.h"
 
@@ -208,6 +209,15 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
   return StreamWrapper;
 }
 
+Ptr<OutputStreamWrapper>
+AsciiTraceHelper::CreateBinaryFileStream (std::string filename, BinaryTraceWriter::Layout layout)
+{
+  NS_LOG_FUNCTION (filename << layout);
+
+  Ptr<BinaryTraceWriter> writer = Create<BinaryTraceWriter> (filename, layout);
+  return Create<OutputStreamWrapper> (writer);
+}
+
 std::string
 AsciiTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -310,6 +320,12 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::ENQUEUE, "", p);
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -317,6 +333,12 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::ENQUEUE, context, p);
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -336,6 +358,12 @@ void
 AsciiTraceHelper::DefaultDropSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::DROP, "", p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -343,6 +371,12 @@ void
 AsciiTraceHelper::DefaultDropSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::DROP, context, p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -363,6 +397,12 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::DEQUEUE, "", p);
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -370,6 +410,12 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::DEQUEUE, context, p);
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -387,6 +433,12 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::RECEIVE, "", p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -394,6 +446,12 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::RECEIVE, context, p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -25,6 +25,7 @@
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/binary-trace-file.h"
 
 namespace ns3 {
 
@@ -222,6 +223,25 @@ public:
   Ptr<OutputStreamWrapper> CreateFileStream (std::string filename, 
                                              std::ios::openmode filemode = std::ios::out);
 
+  /**
+   * @brief Create a binary trace file and wrap it in an OutputStreamWrapper.
+   *
+   * The default trace sinks given the returned stream write compact
+   * binary records instead of text lines, so the stream can be passed to
+   * the EnableAscii methods of the helpers in place of the stream
+   * returned by CreateFileStream.  The sinks of the IPv4, IPv6 and Wi-Fi
+   * PHY helpers also write binary records, without the Wi-Fi mode; the
+   * lines written by the other sinks are kept as text records.  Use
+   * BinaryTraceReader or the binary-trace-convert program to read the
+   * file.
+   *
+   * @param filename file name
+   * @param layout layout of the records in the file
+   * @returns a smart pointer to the output stream
+   */
+  Ptr<OutputStreamWrapper> CreateBinaryFileStream (std::string filename,
+                                                   BinaryTraceWriter::Layout layout = BinaryTraceWriter::COLUMN);
+
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
    * does not accept nor log a trace context.
@@ -18,8 +18,13 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "buffer.h"
+#include "packet-memory-stats.h"
 #include "ns3/assert.h"
+#include "ns3/abort.h"
 #include "ns3/log.h"
+#ifdef NS3_ATOMIC_REFCOUNT
+#include "ns3/system-mutex.h"
+#endif /* NS3_ATOMIC_REFCOUNT */
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -49,49 +54,165 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
+#ifdef NS3_ATOMIC_REFCOUNT
+namespace {
+
+/** The maximum number of packet memory counters. */
+const uint32_t PACKET_MEMORY_COUNTERS = 8;
+
+/**
+ * \ingroup packet
+ * Get the mutex of the list of the threads which count the packet
+ * memory, which is never destroyed, so that the threads can exit after
+ * the static destructors.
+ * \returns The mutex.
+ */
+SystemMutex &
+GetPacketMemoryMutex (void)
+{
+  static SystemMutex *mutex = new SystemMutex ();
+  return *mutex;
+}
+
+/**
+ * \ingroup packet
+ * The copies of the packet memory counters of a thread, linked in the
+ * list of the threads while it runs.
+ */
+struct PacketMemoryThread
+{
+  PacketMemoryThread ();
+  ~PacketMemoryThread ();
+  /** The copies of the counters, only written by their thread. */
+  std::atomic<uint64_t> values[PACKET_MEMORY_COUNTERS];
+  PacketMemoryThread *prev;   //!< The previous thread in the list.
+  PacketMemoryThread *next;   //!< The next thread in the list.
+};
+
+/** The first thread in the list of the threads. */
+PacketMemoryThread *g_packetMemoryThreads = 0;
+/** The initial values and the copies of the threads which exited. */
+std::atomic<uint64_t> g_packetMemoryExited[PACKET_MEMORY_COUNTERS];
+/** The number of counters. */
+uint32_t g_packetMemoryCounters = 0;
+
+/* The copies of a thread are constructed the first time it counts, and
+ * destroyed when it exits.  Once destroyed, they are not re-created:
+ * the memory counted later on is added to the exited threads.
+ */
+thread_local PacketMemoryThread g_packetMemoryThread;
+thread_local bool g_packetMemoryThreadExited = false;
+
+PacketMemoryThread::PacketMemoryThread ()
+  : prev (0)
+{
+  for (uint32_t i = 0; i < PACKET_MEMORY_COUNTERS; ++i)
+    {
+      values[i].store (0, std::memory_order_relaxed);
+    }
+  CriticalSection cs (GetPacketMemoryMutex ());
+  next = g_packetMemoryThreads;
+  if (next != 0)
+    {
+      next->prev = this;
+    }
+  g_packetMemoryThreads = this;
+}
 
-uint32_t Buffer::g_recommendedStart = 0;
+PacketMemoryThread::~PacketMemoryThread ()
+{
+  g_packetMemoryThreadExited = true;
+  CriticalSection cs (GetPacketMemoryMutex ());
+  for (uint32_t i = 0; i < PACKET_MEMORY_COUNTERS; ++i)
+    {
+      g_packetMemoryExited[i].fetch_add (values[i].load (std::memory_order_relaxed),
+                                         std::memory_order_relaxed);
+    }
+  if (prev != 0)
+    {
+      prev->next = next;
+    }
+  else
+    {
+      g_packetMemoryThreads = next;
+    }
+  if (next != 0)
+    {
+      next->prev = prev;
+    }
+}
+
+} // unnamed namespace
+
+PacketMemoryCounter::PacketMemoryCounter (uint64_t value)
+{
+  CriticalSection cs (GetPacketMemoryMutex ());
+  NS_ABORT_MSG_IF (g_packetMemoryCounters == PACKET_MEMORY_COUNTERS,
+                   "Too many packet memory counters");
+  m_index = g_packetMemoryCounters++;
+  g_packetMemoryExited[m_index].store (value, std::memory_order_relaxed);
+}
+
+PacketMemoryCounter &
+PacketMemoryCounter::operator += (uint64_t delta)
+{
+  if (g_packetMemoryThreadExited)
+    {
+      g_packetMemoryExited[m_index].fetch_add (delta, std::memory_order_relaxed);
+    }
+  else
+    {
+      // only this thread writes its copy: no read-modify-write needed
+      std::atomic<uint64_t> &value = g_packetMemoryThread.values[m_index];
+      value.store (value.load (std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+  return *this;
+}
+
+PacketMemoryCounter &
+PacketMemoryCounter::operator -= (uint64_t delta)
+{
+  return *this += -delta;
+}
+
+PacketMemoryCounter::operator uint64_t (void) const
+{
+  CriticalSection cs (GetPacketMemoryMutex ());
+  uint64_t sum = g_packetMemoryExited[m_index].load (std::memory_order_relaxed);
+  for (PacketMemoryThread *thread = g_packetMemoryThreads; thread != 0; thread = thread->next)
+    {
+      sum += thread->values[m_index].load (std::memory_order_relaxed);
+    }
+  return sum;
+}
+#endif /* NS3_ATOMIC_REFCOUNT */
+
+
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+PacketMemoryCounter Buffer::g_allocatedBytes (0);
+PacketMemoryPeak Buffer::g_peakAllocatedBytes (0);
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
+/* Each thread recycles the buffers it releases into its own free list,
+ * which is constructed the first time the thread uses it, whatever the
+ * order of the static constructors, and destroyed when the thread
+ * exits.  Once destroyed, it is not re-created: the buffers released
+ * later on are deallocated.
  */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
+thread_local uint32_t Buffer::g_maxSize = 0;
+thread_local Buffer::FreeList Buffer::g_freeList;
+thread_local bool Buffer::g_freeListDestroyed = false;
+thread_local uint64_t Buffer::g_freeListBytes = 0;
+uint32_t Buffer::g_freeListLimit = 1000;
+
+Buffer::FreeList::~FreeList ()
 {
   NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
+  g_freeListDestroyed = true;
+  for (iterator i = begin (); i != end (); i++)
     {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
+      Buffer::Deallocate (*i);
     }
+  g_freeListBytes = 0;
 }
 
 void
@@ -99,19 +220,51 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
   g_maxSize = std::max (g_maxSize, data->m_size);
   /* feed into free list */
   if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+      g_freeListDestroyed)
+    {
+      Buffer::Deallocate (data);
+    }
+  else if (g_freeList.size () >= g_freeListLimit)
     {
       Buffer::Deallocate (data);
+      // the limit may have been lowered by another thread
+      TrimFreeList ();
     }
   else
     {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      g_freeList.push_back (data);
+      g_freeListBytes += GetAllocatedSize (data);
+    }
+}
+
+void
+Buffer::SetFreeListLimit (uint32_t limit)
+{
+  NS_LOG_FUNCTION (limit);
+  g_freeListLimit = limit;
+  if (!g_freeListDestroyed)
+    {
+      TrimFreeList ();
+    }
+}
+
+void
+Buffer::TrimFreeList (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  while (g_freeList.size () > g_freeListLimit)
+    {
+      struct Buffer::Data *data = g_freeList.back ();
+      g_freeList.pop_back ();
+      g_freeListBytes -= GetAllocatedSize (data);
+      Buffer::Deallocate (data);
+    }
+  if (g_freeList.empty ())
+    {
+      std::vector<struct Buffer::Data*> ().swap (g_freeList);
     }
 }
 
@@ -120,16 +273,14 @@ Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
   /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
+  if (!g_freeListDestroyed)
     {
-      while (!g_freeList->empty ()) 
+      FreeList &freeList = g_freeList;
+      while (!freeList.empty ()) 
         {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
+          struct Buffer::Data *data = freeList.back ();
+          freeList.pop_back ();
+          g_freeListBytes -= GetAllocatedSize (data);
           if (data->m_size >= dataSize) 
             {
               data->m_count = 1;
@@ -157,8 +308,35 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
+
+void
+Buffer::SetFreeListLimit (uint32_t limit)
+{
+  NS_LOG_FUNCTION (limit);
+}
 #endif /* BUFFER_FREE_LIST */
 
+void
+Buffer::GetMemoryStats (PacketMemoryStats &stats)
+{
+  NS_LOG_FUNCTION (&stats);
+  stats.bufferBytes = ReadPacketMemory (g_allocatedBytes, g_peakAllocatedBytes);
+  stats.peakBufferBytes = g_peakAllocatedBytes;
+#ifdef BUFFER_FREE_LIST
+  stats.bufferFreeList = g_freeListDestroyed ? 0 : g_freeList.size ();
+  stats.bufferFreeListBytes = g_freeListBytes;
+#else /* BUFFER_FREE_LIST */
+  stats.bufferFreeList = 0;
+  stats.bufferFreeListBytes = 0;
+#endif /* BUFFER_FREE_LIST */
+}
+
+uint32_t
+Buffer::GetAllocatedSize (const struct Buffer::Data *data)
+{
+  return data->m_size - 1 + sizeof (struct Buffer::Data);
+}
+
 struct Buffer::Data *
 Buffer::Allocate (uint32_t reqSize)
 {
@@ -173,6 +351,7 @@ Buffer::Allocate (uint32_t reqSize)
   struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
   data->m_size = reqSize;
   data->m_count = 1;
+  AddPacketMemory (g_allocatedBytes, g_peakAllocatedBytes, size);
   return data;
 }
 
@@ -181,6 +360,7 @@ Buffer::Deallocate (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
+  g_allocatedBytes -= GetAllocatedSize (data);
   uint8_t *buf = reinterpret_cast<uint8_t *> (data);
   delete [] buf;
 }
@@ -262,8 +442,7 @@ Buffer::operator = (Buffer const&o)
   if (m_data != o.m_data) 
     {
       // not assignment to self.
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           Recycle (m_data);
         }
@@ -285,8 +464,7 @@ Buffer::~Buffer ()
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (--m_data->m_count == 0) 
     {
       Recycle (m_data);
     }
@@ -310,7 +488,12 @@ Buffer::AddAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (CheckInternalState ());
+#ifdef NS3_ATOMIC_REFCOUNT
+  // another thread may be growing the shared data at the same time
+  bool isDirty = m_data->m_count > 1;
+#else
   bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
+#endif
   if (m_start >= start && !isDirty)
     {
       /* enough space in the buffer and not dirty. 
@@ -328,8 +511,7 @@ Buffer::AddAtStart (uint32_t start)
       uint32_t newSize = GetInternalSize () + start;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0)
+      if (--m_data->m_count == 0)
         {
           Buffer::Recycle (m_data);
         }
@@ -355,7 +537,12 @@ Buffer::AddAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+#ifdef NS3_ATOMIC_REFCOUNT
+  // another thread may be growing the shared data at the same time
+  bool isDirty = m_data->m_count > 1;
+#else
   bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+#endif
   if (GetInternalEnd () + end <= m_data->m_size && !isDirty)
     {
       /* enough space in buffer and not dirty
@@ -373,8 +560,7 @@ Buffer::AddAtEnd (uint32_t end)
       uint32_t newSize = GetInternalSize () + end;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           Buffer::Recycle (m_data);
         }
@@ -400,9 +586,7 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
-      m_end == m_zeroAreaEnd &&
-      m_end == m_data->m_dirtyEnd &&
+  if (m_end == m_zeroAreaEnd &&
       o.m_start == o.m_zeroAreaStart &&
       o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
     {
@@ -411,6 +595,15 @@ Buffer::AddAtEnd (const Buffer &o)
        * we attempt to aggregate two buffers which contain
        * adjacent zero areas.
        */
+      if (m_data->m_count != 1 || m_end != m_data->m_dirtyEnd)
+        {
+          /**
+           * The data is shared with other buffers: copy the bytes
+           * around our zero area before growing it, rather than the
+           * whole buffer.
+           */
+          *this = CreatePrivateCopy ();
+        }
       uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
       m_zeroAreaEnd += zeroSize;
       m_end = m_zeroAreaEnd;
@@ -426,7 +619,19 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
-  *this = CreateFullCopy ();
+  /**
+   * A buffer has a single zero area, so the zero bytes of one of the
+   * two buffers must be written out: keep the larger zero area.
+   */
+  if (o.m_zeroAreaEnd - o.m_zeroAreaStart > m_zeroAreaEnd - m_zeroAreaStart)
+    {
+      Buffer tmp = o;
+      tmp.AddAtStart (GetSize ());
+      tmp.Begin ().Write (Begin (), End ());
+      *this = tmp;
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
   AddAtEnd (o.GetSize ());
   Buffer::Iterator destStart = End ();
   destStart.Prev (o.GetSize ());
@@ -552,6 +757,24 @@ Buffer::CreateFullCopy (void) const
   return *this;
 }
 
+Buffer
+Buffer::CreatePrivateCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  Buffer tmp (m_zeroAreaEnd - m_zeroAreaStart);
+  uint32_t dataStart = m_zeroAreaStart - m_start;
+  tmp.AddAtStart (dataStart);
+  tmp.Begin ().Write (m_data->m_data + m_start, dataStart);
+  uint32_t dataEnd = m_end - m_zeroAreaEnd;
+  tmp.AddAtEnd (dataEnd);
+  Buffer::Iterator i = tmp.End ();
+  i.Prev (dataEnd);
+  i.Write (m_data->m_data + m_zeroAreaStart, dataEnd);
+  NS_ASSERT (tmp.CheckInternalState ());
+  return tmp;
+}
+
 uint32_t 
 Buffer::GetSerializedSize (void) const
 {
@@ -843,25 +1066,36 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the bytes written are all before or all after our zero area
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
   m_current += toCopy;
 }
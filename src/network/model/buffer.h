@@ -24,11 +24,125 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#ifdef NS3_ATOMIC_REFCOUNT
+#include <atomic>
+#endif
 
 #define BUFFER_FREE_LIST 1
 
 namespace ns3 {
 
+struct PacketMemoryStats;
+
+#ifdef NS3_ATOMIC_REFCOUNT
+/**
+ * \ingroup packet
+ * The reference counts of the packets and of the data they share.
+ *
+ * They are atomic when ns-3 is configured with
+ * \c --enable-atomic-refcount, so that the copies of a packet can be
+ * released by several threads.
+ */
+typedef std::atomic<uint32_t> PacketRefCount;
+
+/**
+ * \ingroup packet
+ * A counter of the memory used by the packets of all the threads.
+ *
+ * Each thread updates its own copy of the counter with relaxed loads
+ * and stores, which do not contend with the other threads, and the
+ * value of the counter is the sum of the copies of all the threads,
+ * including those which exited.  The copy of a thread wraps below
+ * zero when it releases the memory counted by another thread, but the
+ * sum does not.
+ */
+class PacketMemoryCounter
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] value The initial value.
+   */
+  PacketMemoryCounter (uint64_t value);
+  /**
+   * Add to the copy of the counter of this thread.
+   * \param [in] delta The value to add.
+   * \returns The counter.
+   */
+  PacketMemoryCounter & operator += (uint64_t delta);
+  /**
+   * Subtract from the copy of the counter of this thread.
+   * \param [in] delta The value to subtract.
+   * \returns The counter.
+   */
+  PacketMemoryCounter & operator -= (uint64_t delta);
+  /**
+   * Sum the copies of all the threads.
+   * \returns The value of the counter.
+   */
+  operator uint64_t (void) const;
+
+private:
+  uint32_t m_index;  //!< The index of the counter in the copies of the threads.
+};
+
+/**
+ * \ingroup packet
+ * The peak of a PacketMemoryCounter, raised when the counter is read.
+ */
+typedef std::atomic<uint64_t> PacketMemoryPeak;
+#else /* NS3_ATOMIC_REFCOUNT */
+typedef uint32_t PacketRefCount;
+typedef uint64_t PacketMemoryCounter;
+typedef uint64_t PacketMemoryPeak;
+#endif /* NS3_ATOMIC_REFCOUNT */
+
+/**
+ * \ingroup packet
+ * Add to a memory counter and raise its peak.
+ *
+ * With the atomic reference counts, the counter is summed over the
+ * threads only when it is read, so its peak is raised by
+ * ReadPacketMemory() instead.
+ *
+ * \param [in,out] counter The counter.
+ * \param [in,out] peak The peak of the counter.
+ * \param [in] delta The value to add.
+ */
+inline void
+AddPacketMemory (PacketMemoryCounter &counter, PacketMemoryPeak &peak, uint64_t delta)
+{
+  counter += delta;
+#ifndef NS3_ATOMIC_REFCOUNT
+  if (counter > peak)
+    {
+      peak = counter;
+    }
+#endif /* NS3_ATOMIC_REFCOUNT */
+}
+
+/**
+ * \ingroup packet
+ * Read a memory counter and raise its peak.
+ *
+ * \param [in] counter The counter.
+ * \param [in,out] peak The peak of the counter.
+ * \returns The value of the counter.
+ */
+inline uint64_t
+ReadPacketMemory (const PacketMemoryCounter &counter, PacketMemoryPeak &peak)
+{
+  uint64_t value = counter;
+#ifdef NS3_ATOMIC_REFCOUNT
+  uint64_t current = peak.load (std::memory_order_relaxed);
+  while (value > current
+         && !peak.compare_exchange_weak (current, value, std::memory_order_relaxed))
+    {
+    }
+#endif /* NS3_ATOMIC_REFCOUNT */
+  return value;
+}
+
 /**
  * \ingroup packet
  *
@@ -65,10 +179,15 @@ namespace ns3 {
  * contains real data bytes in its BufferData instance but it also
  * contains "virtual zero data" which typically is used to represent
  * application-level payload. No memory is allocated to store the
- * zero bytes of application-level payload unless the user fragments
- * a Buffer: this application-level payload is kept track of with
- * a pair of integers which describe where in the buffer content
- * the "virtual zero area" starts and ends.
+ * zero bytes of application-level payload: this application-level
+ * payload is kept track of with a pair of integers which describe
+ * where in the buffer content the "virtual zero area" starts and
+ * ends, so that adding and removing bytes, fragmenting a buffer or
+ * concatenating two buffers with adjacent zero areas cost the same
+ * whatever the size of the payload.  The zero bytes are only written
+ * out when the data is accessed in place with PeekData, or when two
+ * buffers whose zero areas are not adjacent are concatenated, in
+ * which case the smaller of the two zero areas is written out.
  *
  * \verbatim
  * ***: unused bytes
@@ -642,6 +761,30 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * \brief Set the maximum number of data blocks kept in the free lists.
+   *
+   * Each thread keeps its own free list.  The data blocks released
+   * beyond this limit are returned to the allocator, and the blocks in
+   * excess are released immediately from the free list of the calling
+   * thread, and from the free lists of the other threads the next time
+   * they release a block.  The default limit is 1000 blocks.  The limit
+   * must not be changed while other threads handle packets.
+   *
+   * \param limit The maximum number of data blocks in a free list.
+   */
+  static void SetFreeListLimit (uint32_t limit);
+  /**
+   * \brief Get the memory used by the buffers.
+   *
+   * Fill the fields of the Buffer data blocks: the allocated bytes
+   * are counted for all the threads, the free list is the one of the
+   * calling thread.
+   *
+   * \param [out] stats The statistics to fill.
+   */
+  static void GetMemoryStats (PacketMemoryStats &stats);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -663,7 +806,7 @@ private:
      * The reference count of an instance of this data structure.
      * Each buffer which references an instance holds a count.
      */
-    uint32_t m_count;
+    PacketRefCount m_count;
     /**
      * the size of the m_data field below.
      */
@@ -693,6 +836,14 @@ private:
    */
   Buffer CreateFullCopy (void) const;
 
+  /**
+   * \brief Create a copy of the buffer which does not share its
+   * data with this buffer, and keeps its zero area virtual.
+   *
+   * \returns a copy of the buffer
+   */
+  Buffer CreatePrivateCopy (void) const;
+
   /**
    * \brief Transform a "Virtual byte buffer" into a "Real byte buffer"
    */
@@ -737,6 +888,11 @@ private:
    * \returns a pointer to the created buffer storage
    */
   static struct Buffer::Data *Create (uint32_t size);
+  /**
+   * \brief Release the data storages in excess of the limit from the
+   * free list of this thread.
+   */
+  static void TrimFreeList (void);
   /**
    * \brief Allocate a buffer data storage
    * \param reqSize the storage size to create
@@ -748,6 +904,15 @@ private:
    * \param data the buffer data storage
    */
   static void Deallocate (struct Buffer::Data *data);
+  /**
+   * \brief Get the memory allocated for a buffer data storage
+   * \param data the buffer data storage
+   * \returns the number of bytes allocated
+   */
+  static uint32_t GetAllocatedSize (const struct Buffer::Data *data);
+
+  static PacketMemoryCounter g_allocatedBytes; //!< Bytes of the allocated data
+  static PacketMemoryPeak g_peakAllocatedBytes; //!< Peak of the bytes of the allocated data
 
   struct Data *m_data; //!< the buffer data storage
 
@@ -765,9 +930,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value.  Each thread keeps its own heuristic.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -791,16 +956,16 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
+  /// Container for buffer data, released when its thread exits
+  struct FreeList : public std::vector<struct Buffer::Data*>
   {
-    ~LocalStaticDestructor ();
+    ~FreeList ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  static thread_local uint32_t g_maxSize; //!< Max observed data size
+  static thread_local FreeList g_freeList; //!< Buffer data container
+  static thread_local bool g_freeListDestroyed; //!< The free list of this thread is destroyed
+  static thread_local uint64_t g_freeListBytes; //!< Bytes of the data in the free list
+  static uint32_t g_freeListLimit; //!< Max data in the free list
 #endif
 };
 
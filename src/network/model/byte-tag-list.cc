@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "buffer.h"
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
@@ -40,7 +41,7 @@ NS_LOG_COMPONENT_DEFINE ("ByteTagList");
  */
 struct ByteTagListData {
   uint32_t size;   //!< size of the data
-  uint32_t count;  //!< use counter (for smart deallocation)
+  PacketRefCount count;  //!< use counter (for smart deallocation)
   uint32_t dirty;  //!< number of bytes actually in use
   uint8_t data[4]; //!< data
 };
@@ -51,18 +52,22 @@ struct ByteTagListData {
  *
  * \brief Container class for struct ByteTagListData
  *
- * Internal use only.
+ * Internal use only.  Each thread has its own free list, released
+ * when the thread exits.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
+class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
 {
 public:
   ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+};
+static thread_local ByteTagListDataFreeList g_freeList; //!< Container for struct ByteTagListData
+static thread_local bool g_freeListDestroyed = false; //!< g_freeList is destroyed
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
   NS_LOG_FUNCTION (this);
+  g_freeListDestroyed = true;
   for (ByteTagListDataFreeList::iterator i = begin ();
        i != end (); i++)
     {
@@ -200,7 +205,12 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       m_used = 0;
     } 
   else if (m_data->size < spaceNeeded ||
+#ifdef NS3_ATOMIC_REFCOUNT
+           // another thread may be appending to the shared data
+           m_data->count != 1)
+#else
            (m_data->count != 1 && m_data->dirty != m_used))
+#endif
     {
       struct ByteTagListData *newData = Allocate (spaceNeeded);
       std::memcpy (&newData->data, &m_data->data, m_used);
@@ -345,7 +355,7 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (!g_freeListDestroyed && !g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
       g_freeList.pop_back ();
@@ -376,10 +386,10 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
       return;
     }
   g_maxSize = std::max (g_maxSize, data->size);
-  data->count--;
-  if (data->count == 0)
+  if (--data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      if (g_freeListDestroyed ||
+          g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
@@ -414,8 +424,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
-  data->count--;
-  if (data->count == 0)
+  if (--data->count == 0)
     {
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
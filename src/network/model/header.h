@@ -113,6 +113,30 @@ public:
  */
 std::ostream & operator << (std::ostream &os, const Header &header);
 
+/**
+ * \ingroup packet
+ *
+ * \brief Whether a Packet keeps the headers of this type it serializes.
+ *
+ * When the header cache is enabled with Packet::EnableHeaderCache,
+ * Packet::AddHeader keeps a copy of the headers of the types for which
+ * this trait is specialized with \c cached set to \c true, and
+ * Packet::RemoveHeader and Packet::PeekHeader return that copy instead
+ * of deserializing the buffer again.  Only specialize it for a type
+ * whose Deserialize method restores every field a receiver reads from
+ * the object which was serialized.  The specializations also define
+ * a static \c IsCached method, which tells whether a given header may
+ * be kept: a header whose checksum is verified by the receiver must be
+ * deserialized.
+ *
+ * \tparam T \explicit The type of the header.
+ */
+template <typename T>
+struct HeaderCacheTraits
+{
+  static const bool cached = false;  //!< Do not cache the headers.
+};
+
 } // namespace ns3
 
 #endif /* HEADER_H */
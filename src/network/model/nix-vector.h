@@ -60,7 +60,7 @@ namespace ns3 {
  * routed.
  */
 
-class NixVector : public SimpleRefCount<NixVector>
+class NixVector : public SimpleRefCount<NixVector, empty, DefaultDeleter<NixVector>, PacketRefCount>
 {
 public:
   NixVector ();
@@ -130,6 +130,7 @@ Node::AddDevice (Ptr<NetDevice> device)
   NS_LOG_FUNCTION (this << device);
   uint32_t index = m_devices.size ();
   m_devices.push_back (device);
+  Object::NotifyGraphChange ();
   device->SetNode (this);
   device->SetIfIndex (index);
   device->SetReceiveCallback (MakeCallback (&Node::NonPromiscReceiveFromDevice, this));
@@ -159,6 +160,7 @@ Node::AddApplication (Ptr<Application> application)
   NS_LOG_FUNCTION (this << application);
   uint32_t index = m_applications.size ();
   m_applications.push_back (application);
+  Object::NotifyGraphChange ();
   application->SetNode (this);
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &Application::Initialize, application);
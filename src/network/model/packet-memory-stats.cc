@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-memory-stats.h"
+#include "packet.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketMemoryStats");
+
+NS_OBJECT_ENSURE_REGISTERED (PacketMemoryMonitor);
+
+std::ostream &
+operator << (std::ostream &os, const PacketMemoryStats &stats)
+{
+  os << "packets=" << stats.packets
+     << " (peak " << stats.peakPackets << ")"
+     << " buffer=" << stats.bufferBytes
+     << " (peak " << stats.peakBufferBytes << ")"
+     << " buffer-free-list=" << stats.bufferFreeList
+     << " (" << stats.bufferFreeListBytes << " bytes)"
+     << " metadata=" << stats.metadataBytes
+     << " (peak " << stats.peakMetadataBytes << ")"
+     << " metadata-free-list=" << stats.metadataFreeList
+     << " (" << stats.metadataFreeListBytes << " bytes)"
+     << " tags=" << stats.packetTags
+     << " (" << stats.packetTagHeapBytes << " heap bytes)";
+  return os;
+}
+
+TypeId
+PacketMemoryMonitor::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PacketMemoryMonitor")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<PacketMemoryMonitor> ()
+    .AddAttribute ("Interval",
+                   "The interval between two samples of the statistics.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&PacketMemoryMonitor::m_interval),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddTraceSource ("Stats",
+                     "The memory used by the packets, sampled every Interval.",
+                     MakeTraceSourceAccessor (&PacketMemoryMonitor::m_statsTrace),
+                     "ns3::PacketMemoryMonitor::StatsTracedCallback")
+  ;
+  return tid;
+}
+
+PacketMemoryMonitor::PacketMemoryMonitor ()
+  : m_last (Packet::GetMemoryStats ())
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PacketMemoryMonitor::~PacketMemoryMonitor ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PacketMemoryMonitor::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  Object::DoDispose ();
+}
+
+void
+PacketMemoryMonitor::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  m_event = Simulator::ScheduleNow (&PacketMemoryMonitor::Sample, this);
+}
+
+void
+PacketMemoryMonitor::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+}
+
+PacketMemoryStats
+PacketMemoryMonitor::GetLastSample (void) const
+{
+  return m_last;
+}
+
+void
+PacketMemoryMonitor::Sample (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_last = Packet::GetMemoryStats ();
+  NS_LOG_LOGIC (m_last);
+  m_statsTrace (m_last);
+  m_event = Simulator::Schedule (m_interval, &PacketMemoryMonitor::Sample, this);
+}
+
+} // namespace ns3
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_MEMORY_STATS_H
+#define PACKET_MEMORY_STATS_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
+
+#include <ostream>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief The memory used by the packets.
+ *
+ * The bytes of the Buffer and PacketMetadata data blocks include the
+ * blocks kept in their free lists, which are also reported
+ * separately.  The peaks are the maximum values since the start of
+ * the process.  The counters cover all the threads, but each thread
+ * keeps its own free lists, and only the free lists of the thread
+ * which gets the statistics are reported.  With the atomic reference
+ * counts, each thread also keeps its own copy of the counters, which
+ * are summed here, and the peaks are only the maximum values read.
+ *
+ * \see Packet::GetMemoryStats
+ */
+struct PacketMemoryStats
+{
+  uint64_t packets;                 //!< Live Packet objects.
+  uint64_t peakPackets;             //!< Peak of the live Packet objects.
+  uint64_t bufferBytes;             //!< Bytes of the Buffer data blocks.
+  uint64_t peakBufferBytes;         //!< Peak of the bytes of the Buffer data blocks.
+  uint64_t bufferFreeList;          //!< Buffer data blocks in the free list.
+  uint64_t bufferFreeListBytes;     //!< Bytes of the Buffer data blocks in the free list.
+  uint64_t metadataBytes;           //!< Bytes of the PacketMetadata data blocks.
+  uint64_t peakMetadataBytes;       //!< Peak of the bytes of the PacketMetadata data blocks.
+  uint64_t metadataFreeList;        //!< PacketMetadata data blocks in the free list.
+  uint64_t metadataFreeListBytes;   //!< Bytes of the PacketMetadata data blocks in the free list.
+  uint64_t packetTags;              //!< Packet tags stored in the packets.
+  uint64_t packetTagHeapBytes;      //!< Bytes allocated on the heap for the packet tags.
+};
+
+/**
+ * \brief Stream insertion operator.
+ *
+ * \param [in,out] os The output stream.
+ * \param [in] stats The statistics to print.
+ * \returns The output stream.
+ */
+std::ostream & operator << (std::ostream &os, const PacketMemoryStats &stats);
+
+/**
+ * \ingroup packet
+ *
+ * \brief Sample the memory used by the packets periodically.
+ *
+ * Once started, the monitor calls Packet::GetMemoryStats every
+ * \c Interval and reports the statistics through the \c Stats trace
+ * source:
+ * \code
+ *   Ptr<PacketMemoryMonitor> monitor = CreateObject<PacketMemoryMonitor> ();
+ *   monitor->TraceConnectWithoutContext ("Stats", MakeCallback (&PrintStats));
+ *   monitor->Start ();
+ * \endcode
+ */
+class PacketMemoryMonitor : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  PacketMemoryMonitor ();
+  virtual ~PacketMemoryMonitor ();
+
+  /** Start sampling the statistics, now and then every \c Interval. */
+  void Start (void);
+  /** Stop sampling the statistics. */
+  void Stop (void);
+  /**
+   * \returns The statistics of the last sample.
+   */
+  PacketMemoryStats GetLastSample (void) const;
+
+  /**
+   * TracedCallback signature for the statistics.
+   *
+   * \param [in] stats The statistics.
+   */
+  typedef void (* StatsTracedCallback) (const PacketMemoryStats &stats);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /** Sample the statistics and schedule the next sample. */
+  void Sample (void);
+
+  Time m_interval;                   //!< The interval between samples.
+  EventId m_event;                   //!< The next sample.
+  PacketMemoryStats m_last;          //!< The last sample.
+  /** The trace source fired with each sample. */
+  TracedCallback<const PacketMemoryStats &> m_statsTrace;
+};
+
+} // namespace ns3
+
+#endif /* PACKET_MEMORY_STATS_H */
@@ -26,6 +26,7 @@
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
+#include "packet-memory-stats.h"
 
 namespace ns3 {
 
@@ -34,18 +35,24 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local bool PacketMetadata::m_freeListDestroyed = false;
+thread_local uint64_t PacketMetadata::m_freeListBytes = 0;
+uint32_t PacketMetadata::m_freeListLimit = 1000;
+PacketMemoryCounter PacketMetadata::m_allocatedBytes (0);
+PacketMemoryPeak PacketMetadata::m_peakAllocatedBytes (0);
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
   NS_LOG_FUNCTION (this);
+  PacketMetadata::m_freeListDestroyed = true;
   for (iterator i = begin (); i != end (); i++)
     {
       PacketMetadata::Deallocate (*i);
     }
-  PacketMetadata::m_enable = false;
+  PacketMetadata::m_freeListBytes = 0;
 }
 
 void 
@@ -70,6 +77,44 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::SetFreeListLimit (uint32_t limit)
+{
+  NS_LOG_FUNCTION (limit);
+  m_freeListLimit = limit;
+  if (!m_freeListDestroyed)
+    {
+      TrimFreeList ();
+    }
+}
+
+void
+PacketMetadata::TrimFreeList (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  while (m_freeList.size () > m_freeListLimit)
+    {
+      struct PacketMetadata::Data *data = m_freeList.back ();
+      m_freeList.pop_back ();
+      m_freeListBytes -= GetAllocatedSize (data);
+      PacketMetadata::Deallocate (data);
+    }
+  if (m_freeList.empty ())
+    {
+      std::vector<struct Data *> ().swap (m_freeList);
+    }
+}
+
+void
+PacketMetadata::GetMemoryStats (PacketMemoryStats &stats)
+{
+  NS_LOG_FUNCTION (&stats);
+  stats.metadataBytes = ReadPacketMemory (m_allocatedBytes, m_peakAllocatedBytes);
+  stats.peakMetadataBytes = m_peakAllocatedBytes;
+  stats.metadataFreeList = m_freeListDestroyed ? 0 : m_freeList.size ();
+  stats.metadataFreeListBytes = m_freeListBytes;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -77,8 +122,7 @@ PacketMetadata::ReserveCopy (uint32_t size)
   struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
   memcpy (newData->m_data, m_data->m_data, m_used);
   newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (--m_data->m_count == 0) 
     {
       PacketMetadata::Recycle (m_data);
     }
@@ -100,10 +144,16 @@ PacketMetadata::Reserve (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   NS_ASSERT (m_data != 0);
+#ifdef NS3_ATOMIC_REFCOUNT
+  // another thread may be appending to the shared data at the same time
+  if (m_data->m_size >= m_used + size &&
+      m_data->m_count == 1)
+#else
   if (m_data->m_size >= m_used + size &&
       (m_head == 0xffff ||
        m_data->m_count == 1 ||
        m_data->m_dirtyEnd == m_used))
+#endif
     {
       /* enough room, not dirty. */
     }
@@ -379,10 +429,15 @@ PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
   uint32_t typeUidSize = GetUleb128Size (item->typeUid);
   uint32_t sizeSize = GetUleb128Size (item->size);
   uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
+#ifdef NS3_ATOMIC_REFCOUNT
+  if (m_used + n > m_data->m_size ||
+      m_data->m_count != 1)
+#else
   if (m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
        m_used != m_data->m_dirtyEnd))
+#endif
     {
       ReserveCopy (n);
     }
@@ -417,10 +472,15 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
   uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
+#ifdef NS3_ATOMIC_REFCOUNT
+  if (m_used + n > m_data->m_size ||
+      m_data->m_count != 1)
+#else
   if (m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
        m_used != m_data->m_dirtyEnd))
+#endif
     {
       ReserveCopy (n);
     }
@@ -575,10 +635,11 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  while (!m_freeListDestroyed && !m_freeList.empty ()) 
     {
       struct PacketMetadata::Data *data = m_freeList.back ();
       m_freeList.pop_back ();
+      m_freeListBytes -= GetAllocatedSize (data);
       if (data->m_size >= size) 
         {
           NS_LOG_LOGIC ("create found size="<<data->m_size);
@@ -596,21 +657,27 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || m_freeListDestroyed)
     {
       PacketMetadata::Deallocate (data);
       return;
     } 
   NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
+  if (data->m_size < m_maxSize) 
     {
       PacketMetadata::Deallocate (data);
     } 
+  else if (m_freeList.size () >= m_freeListLimit)
+    {
+      PacketMetadata::Deallocate (data);
+      // the limit may have been lowered by another thread
+      TrimFreeList ();
+    }
   else 
     {
       m_freeList.push_back (data);
+      m_freeListBytes += GetAllocatedSize (data);
     }
 }
 
@@ -629,15 +696,22 @@ PacketMetadata::Allocate (uint32_t n)
   data->m_size = n;
   data->m_count = 1;
   data->m_dirtyEnd = 0;
+  AddPacketMemory (m_allocatedBytes, m_peakAllocatedBytes, size);
   return data;
 }
 void 
 PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
+  m_allocatedBytes -= GetAllocatedSize (data);
   uint8_t *buf = (uint8_t *)data;
   delete [] buf;
 }
+uint32_t
+PacketMetadata::GetAllocatedSize (const struct PacketMetadata::Data *data)
+{
+  return sizeof (struct Data) + data->m_size - PACKET_METADATA_DATA_M_DATA_SIZE;
+}
 
 
 PacketMetadata 
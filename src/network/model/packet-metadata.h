@@ -32,6 +32,7 @@ namespace ns3 {
 
 class Chunk;
 class Buffer;
+struct PacketMemoryStats;
 class Header;
 class Trailer;
 
@@ -160,6 +161,29 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Set the maximum number of data blocks kept in the free lists.
+   *
+   * Each thread keeps its own free list.  The data blocks released
+   * beyond this limit are returned to the allocator, and the blocks in
+   * excess are released immediately from the free list of the calling
+   * thread, and from the free lists of the other threads the next time
+   * they release a block.  The default limit is 1000 blocks.  The limit
+   * must not be changed while other threads handle packets.
+   *
+   * \param limit The maximum number of data blocks in a free list.
+   */
+  static void SetFreeListLimit (uint32_t limit);
+  /**
+   * \brief Get the memory used by the packet metadata.
+   *
+   * Fill the fields of the PacketMetadata data blocks: the allocated
+   * bytes are counted for all the threads, the free list is the one of
+   * the calling thread.
+   *
+   * \param [out] stats The statistics to fill.
+   */
+  static void GetMemoryStats (PacketMemoryStats &stats);
 
   /**
    * \brief Constructor
@@ -413,7 +437,7 @@ private:
    */
   struct Data {
     /** number of references to this struct Data instance. */
-    uint32_t m_count;
+    PacketRefCount m_count;
     /** size (in bytes) of m_data buffer below */
     uint16_t m_size;
     /** max of the m_used field over all objects which
@@ -495,7 +519,7 @@ private:
   };
 
   /**
-   * \brief Class to hold all the metadata
+   * \brief Class to hold all the metadata, released when its thread exits
    */
   class DataFreeList : public std::vector<struct Data *>
   {
@@ -649,6 +673,11 @@ public:
    * \returns a pointer to the created buffer storage
    */
   static struct PacketMetadata::Data *Create (uint32_t size);
+  /**
+   * \brief Release the data storages in excess of the limit from the
+   * free list of this thread.
+   */
+  static void TrimFreeList (void);
   /**
    * \brief Allocate a buffer data storage
    * \param n the storage size to create
@@ -660,8 +689,19 @@ public:
    * \param data the buffer data storage
    */
   static void Deallocate (struct PacketMetadata::Data *data);
+  /**
+   * \brief Get the memory allocated for a buffer data storage
+   * \param data the buffer data storage
+   * \returns the number of bytes allocated
+   */
+  static uint32_t GetAllocatedSize (const struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  static thread_local DataFreeList m_freeList; //!< the metadata data storage
+  static thread_local bool m_freeListDestroyed; //!< The free list of this thread is destroyed
+  static thread_local uint64_t m_freeListBytes; //!< Bytes of the data in the free list
+  static uint32_t m_freeListLimit; //!< Max data in the free list
+  static PacketMemoryCounter m_allocatedBytes; //!< Bytes of the allocated data
+  static PacketMemoryPeak m_peakAllocatedBytes; //!< Peak of the bytes of the allocated data
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -672,8 +712,8 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -722,8 +762,7 @@ PacketMetadata::operator = (PacketMetadata const& o)
     {
       // not self assignment
       NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           PacketMetadata::Recycle (m_data);
         }
@@ -740,8 +779,7 @@ PacketMetadata::operator = (PacketMetadata const& o)
 PacketMetadata::~PacketMetadata ()
 {
   NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (--m_data->m_count == 0) 
     {
       PacketMetadata::Recycle (m_data);
     }
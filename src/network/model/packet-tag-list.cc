@@ -20,285 +20,218 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a small vector of Packet tags, stored inline in the packet.
 */
 
 #include "packet-tag-list.h"
 #include "tag-buffer.h"
 #include "tag.h"
+#include "packet-memory-stats.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <cstdlib>
 #include <cstring>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
-PacketTagList::TagData *
-PacketTagList::CreateTagData (size_t dataSize)
-{
-  NS_ASSERT_MSG (dataSize
-                 < std::numeric_limits<decltype(TagData::size)>::max (),
-                 "Requested TagData size " << dataSize
-                 << " exceeds maximum "
-                 << std::numeric_limits<decltype(TagData::size)>::max () );
-
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+PacketMemoryCounter PacketTagList::g_tags (0);
+PacketMemoryCounter PacketTagList::g_heapBytes (0);
 
-  TagData * tag = new (p) TagData;
-  tag->size = dataSize;
-  return tag;
+void
+PacketTagList::AllocateData (TagData *data, uint32_t size)
+{
+  data->size = size;
+  if (size > TAG_DATA_INLINE_SIZE)
+    {
+      data->heapData = static_cast<uint8_t *> (std::malloc (size));
+      g_heapBytes += size;
+      // The matching frees are in FreeHeap, Remove and Replace
+    }
 }
 
-bool
-PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
+void
+PacketTagList::CopyFromHeap (const PacketTagList &o)
 {
-  TypeId tid = tag.GetInstanceTypeId ();
-  NS_LOG_FUNCTION (this << tid);
-  NS_LOG_INFO     ("looking for " << tid);
-
-  // trivial case when list is empty
-  if (m_next == 0)
+  NS_LOG_FUNCTION (this << o.m_count);
+  if (o.m_count > m_capacity)
     {
-      return false;
+      m_tags = new TagData[o.m_count];
+      m_capacity = o.m_count;
+      g_heapBytes += m_capacity * sizeof (TagData);
     }
-
-  bool found = false;
-
-  struct TagData ** prevNext = &m_next; // previous node's next pointer
-  struct TagData  * cur      =  m_next; // cursor to current node
-  struct TagData  * it = 0;             // utility
-
-  // Search from the head of the list until we find tid or a merge
-  while (cur != 0)
+  for (uint32_t i = 0; i < o.m_count; ++i)
     {
-      if (cur->count > 1)
-        {
-          // found merge
-          NS_LOG_INFO ("found initial merge before tid");
-          break;
-        }
-      else if (cur->tid == tid)
-        {
-          NS_LOG_INFO ("found tid before initial merge, calling writer");
-          found = (this->*Writer)(tag, true, cur, prevNext);
-          break;
-        }
-      else
+      new (&m_tags[i]) TagData (o.m_tags[i]);
+      if (o.m_tags[i].size > TAG_DATA_INLINE_SIZE)
         {
-          // no merge or tid found yet, move on
-          prevNext = &cur->next;
-          cur      =  cur->next;
+          AllocateData (&m_tags[i], o.m_tags[i].size);
+          std::memcpy (m_tags[i].heapData, o.m_tags[i].heapData, o.m_tags[i].size);
         }
-    }  // while !found && !cow
-
-  // did we find it or run out of tags?
-  if (cur == 0 || found)
-    {
-      NS_LOG_INFO ("returning after header with found: " << found);
-      return found;
     }
+  m_count = o.m_count;
+  m_heapData = o.m_heapData;
+}
 
-  // From here on out, we have to copy the list
-  // until we find tid, then link past it
-
-  // Before we do all that work, let's make sure tid really exists
-  for (it = cur; it != 0; it = it->next)
+void
+PacketTagList::FreeHeap (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; m_heapData != 0 && i < m_count; ++i)
     {
-      if (it->tid == tid)
+      if (m_tags[i].size > TAG_DATA_INLINE_SIZE)
         {
-          break;
+          std::free (m_tags[i].heapData);
+          g_heapBytes -= m_tags[i].size;
+          m_heapData--;
         }
     }
-  if (it == 0)
+  if (m_tags != m_inline)
     {
-      // got to end of list without finding tid
-      NS_LOG_INFO ("tid not found after first merge");
-      return found;
+      g_heapBytes -= m_capacity * sizeof (TagData);
+      delete [] m_tags;
+      m_tags = m_inline;
+      m_capacity = INLINE_TAGS;
     }
+}
 
-  // At this point cur is a merge, but untested for tid
-  NS_ASSERT (cur != 0);
-  NS_ASSERT (cur->count > 1);
-
-  /*
-     Walk the remainder of the list, copying, until we find tid
-     As we put a copy of the cur node onto our list,
-     we move the merge point down the list.
-
-     Starting position                  End position
-       T1 is a merge                     T1.count decremented
-                                         T2 is a merge
-                                         T1' is a copy of T1
-
-          other                             other
-               \                                 \
-      Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-           /   /                                         /|
-      pNext cur                         Prev  ->  T1' --/ |
-                                                     /    |
-                                                pNext   cur
-
-     When we reach tid, we link past it, decrement count, and we're done.
-  */
-
-  // Should normally check for null cur pointer,
-  // but since we know tid exists, we'll skip this test
-  while ( /* cur && */ cur->tid != tid)
+PacketTagList::TagData *
+PacketTagList::Append (void)
+{
+  if (m_count == m_capacity)
     {
-      NS_ASSERT (cur != 0);
-      NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
-      struct TagData * copy = CreateTagData (cur->size);
-      copy->tid = cur->tid;
-      copy->count = 1;
-      copy->size = cur->size;
-      memcpy (copy->data, cur->data, copy->size);
-      copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
-      *prevNext = copy;                   // point prior list at copy
-      prevNext = &copy->next;             // advance
-      cur      =  copy->next;
+      NS_LOG_LOGIC ("growing the list to " << 2 * m_capacity << " tags");
+      TagData *tags = new TagData[2 * m_capacity];
+      g_heapBytes += 2 * m_capacity * sizeof (TagData);
+      for (uint32_t i = 0; i < m_count; ++i)
+        {
+          tags[i] = m_tags[i];
+        }
+      if (m_tags != m_inline)
+        {
+          g_heapBytes -= m_capacity * sizeof (TagData);
+          delete [] m_tags;
+        }
+      m_tags = tags;
+      m_capacity *= 2;
     }
-  // Sanity check:
-  NS_ASSERT (cur != 0);                 // cur should be non-zero
-  NS_ASSERT (cur->tid == tid);          // cur->tid should be tid
-  NS_ASSERT (cur->count > 1);           // cur should be a merge
-
-  // link around tid, removing it from our list
-  found = (this->*Writer)(tag, false, cur, prevNext);
-  return found;
-
+  return new (&m_tags[m_count++]) TagData;
 }
 
 bool
 PacketTagList::Remove (Tag & tag)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
-}
-
-// COWWriter implementing Remove
-bool
-PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
-                             struct PacketTagList::TagData  * cur,
-                             struct PacketTagList::TagData ** prevNext)
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-  *prevNext = cur->next;            // link around cur
-
-  if (preMerge)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  TagData *cur = Find (tid);
+  if (cur == 0)
     {
-      // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      return false;
     }
-  else
+  tag.Deserialize (TagBuffer (cur->GetData (), cur->GetData () + cur->size));
+  if (cur->size > TAG_DATA_INLINE_SIZE)
     {
-      // cur is always a merge at this point
-      // unmerge cur, since we linked around it already
-      cur->count--;
-      if (cur->next != 0)
-        {
-          // there's a next, so make it a merge
-          cur->next->count++;
-        }
+      std::free (cur->heapData);
+      g_heapBytes -= cur->size;
+      m_heapData--;
     }
-  return found;
-}
-
-bool
-PacketTagList::Replace (Tag & tag)
-{
-  bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
-  if (!found)
+  // keep the order of the tags for PacketTagIterator
+  TagData *end = m_tags + m_count;
+  for (TagData *next = cur + 1; next != end; ++cur, ++next)
     {
-      Add (tag);
+      *cur = *next;
     }
-  return found;
+  m_count--;
+  g_tags -= 1;
+  return true;
 }
 
-// COWWriter implementing Replace
 bool
-PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
-                              struct PacketTagList::TagData  * cur,
-                              struct PacketTagList::TagData ** prevNext)
+PacketTagList::Replace (Tag & tag)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  if (preMerge)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  TagData *cur = Find (tid);
+  if (cur == 0)
     {
-      // found tid before first merge, so just rewrite
-      tag.Serialize (TagBuffer (cur->data, cur->data + cur->size));
+      Add (tag);
+      return false;
     }
-  else
+  uint32_t size = tag.GetSerializedSize ();
+  if (size != cur->size)
     {
-      // cur is always a merge at this point
-      // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
-      struct TagData * copy = CreateTagData (tag.GetSerializedSize ());
-      copy->tid = tag.GetInstanceTypeId ();
-      copy->count = 1;
-      tag.Serialize (TagBuffer (copy->data, copy->data + copy->size));
-      copy->next = cur->next;           // merge into tail
-      if (copy->next != 0)
+      if (cur->size > TAG_DATA_INLINE_SIZE)
         {
-          copy->next->count++;          // mark new merge
+          std::free (cur->heapData);
+          g_heapBytes -= cur->size;
+          m_heapData--;
+        }
+      AllocateData (cur, size);
+      if (size > TAG_DATA_INLINE_SIZE)
+        {
+          m_heapData++;
         }
-      *prevNext = copy;                 // point prior list at copy
     }
-  return found;
+  tag.Serialize (TagBuffer (cur->GetData (), cur->GetData () + cur->size));
+  return true;
 }
 
 void 
 PacketTagList::Add (const Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
   // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  NS_ASSERT_MSG (Find (tid) == 0, "Error: cannot add the same kind of tag twice.");
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  TagData *data = self->Append ();
+  g_tags += 1;
+  data->tid = tid;
+  uint32_t size = tag.GetSerializedSize ();
+  AllocateData (data, size);
+  if (size > TAG_DATA_INLINE_SIZE)
     {
-      NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
-                     "Error: cannot add the same kind of tag twice.");
+      self->m_heapData++;
     }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
-  head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
-  tag.Serialize (TagBuffer (head->data, head->data + head->size));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  tag.Serialize (TagBuffer (data->GetData (), data->GetData () + size));
 }
 
 bool
 PacketTagList::Peek (Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  NS_LOG_FUNCTION (this << tid);
+  const TagData *cur = Find (tid);
+  if (cur == 0)
     {
-      if (cur->tid == tid) 
-        {
-          /* found tag */
-          tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-          return true;
-        }
+      /* no tag found */
+      return false;
     }
-  /* no tag found */
-  return false;
+  /* found tag */
+  tag.Deserialize (TagBuffer (const_cast<uint8_t *> (cur->GetData ()),
+                              const_cast<uint8_t *> (cur->GetData ()) + cur->size));
+  return true;
 }
 
 const struct PacketTagList::TagData *
-PacketTagList::Head (void) const
+PacketTagList::Begin (void) const
 {
-  return m_next;
+  return m_tags;
 }
 
-} /* namespace ns3 */
+const struct PacketTagList::TagData *
+PacketTagList::End (void) const
+{
+  return m_tags + m_count;
+}
 
+void
+PacketTagList::GetMemoryStats (PacketMemoryStats &stats)
+{
+  NS_LOG_FUNCTION (&stats);
+  stats.packetTags = g_tags;
+  stats.packetTagHeapBytes = g_heapBytes;
+}
+
+} /* namespace ns3 */
@@ -22,16 +22,19 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a small vector of Packet tags, stored inline in the packet.
 */
 
 #include <stdint.h>
+#include <new>
 #include <ostream>
 #include "ns3/type-id.h"
+#include "buffer.h"
 
 namespace ns3 {
 
 class Tag;
+struct PacketMemoryStats;
 
 /**
  * \ingroup packet
@@ -43,108 +46,56 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
+ * The tags are stored in serialized form in a contiguous array of
+ * TagData.  The first #INLINE_TAGS of them are stored inline in the
+ * list, hence in the Packet itself, and the serialized data of a tag
+ * is stored inline in its TagData when it fits in
+ * #TAG_DATA_INLINE_SIZE bytes.  A packet with a few small tags thus
+ * needs no allocation to add, find or remove them; a larger array,
+ * or larger tags, are allocated on the heap.
  *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      }
- * \enddot
+ * Copying a list copies its tags: the common tags are smaller than a
+ * list node, so this is cheaper than sharing them.
  *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
- *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
- *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
- *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
- *
- * \par <b> Copy-on-write </b> is implemented as follows:
- *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
- *
- *   - Copy constructor (PacketTagList(const PacketTagList & o))
- *     and assignment (#operator=(const PacketTagList & o))
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
- *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ * A tag is found by scanning the TypeId of the tags in the array,
+ * which share a few cache lines.
  */
 class PacketTagList 
 {
 public:
+  /** The size of the serialized data of a tag stored inline. */
+  static const uint32_t TAG_DATA_INLINE_SIZE = 16;
+  /** The number of tags stored inline. */
+  static const uint32_t INLINE_TAGS = 6;
+
   /**
-   * Tree node for sharing serialized tags.
-   *
-   * See PacketTagList for a discussion of the data structure.
+   * A tag serialized in the list.
    *
    * \internal
    * Unfortunately this has to be public, because
    * PacketTagIterator::Item::GetTag() needs the data and size values.
    * The Item nested class can't be forward declared, so friending isn't
    * possible.
-   *
-   * We use placement new so we can allocate enough room for the Tag
-   * type which will be serialized into data.  See Object::Aggregates
-   * for a similar construction.
    */
   struct TagData
   {
-    struct TagData * next;      /**< Pointer to next in list */
-    uint32_t count;             /**< Number of incoming links */
-    TypeId tid;                 /**< Type of the tag serialized into #data */
-    uint32_t size;              /**< Size of the \c data buffer */
-    uint8_t data[1];            /**< Serialization buffer */
+    TypeId tid;                 /**< Type of the tag serialized into the data */
+    uint32_t size;              /**< Size of the data */
+    union
+    {
+      uint8_t inlineData[TAG_DATA_INLINE_SIZE];  /**< Data of a small tag */
+      uint8_t *heapData;                         /**< Data of a large tag */
+    };
+    /** \returns the serialization buffer. */
+    uint8_t * GetData (void)
+    {
+      return size <= TAG_DATA_INLINE_SIZE ? inlineData : heapData;
+    }
+    /** \returns the serialization buffer. */
+    const uint8_t * GetData (void) const
+    {
+      return size <= TAG_DATA_INLINE_SIZE ? inlineData : heapData;
+    }
   };  /* struct TagData */
 
   /**
@@ -155,9 +106,6 @@ public:
    * Copy constructor
    *
    * \param [in] o The PacketTagList to copy.
-   *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -165,20 +113,15 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    * \returns the copied object
-   *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
    * Destructor
-   *
-   * #RemoveAll's the tags up to the first merge.
    */
   inline ~PacketTagList ();
 
   /**
-   * Add a tag to the head of this branch.
+   * Add a tag to the list.
    *
    * \param [in] tag The tag to add
    */
@@ -210,78 +153,77 @@ public:
    */
   bool Peek (Tag &tag) const;
   /**
-   * Remove all tags from this list (up to the first merge).
+   * Remove all tags from this list.
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to the first tag of the list, the oldest one.
    */
-  const struct PacketTagList::TagData *Head (void) const;
+  const struct PacketTagList::TagData *Begin (void) const;
+  /**
+   * \returns pointer past the last tag of the list, the newest one.
+   */
+  const struct PacketTagList::TagData *End (void) const;
+  /**
+   * Get the memory used by the packet tags.
+   *
+   * Fill the fields of the packet tags.
+   *
+   * \param [out] stats The statistics to fill.
+   */
+  static void GetMemoryStats (PacketMemoryStats &stats);
 
 private:
   /**
-   * Allocate and construct a TagData struct, sizing the data area
-   * large enough to serialize dataSize bytes from a Tag.
+   * Find a tag in the list.
    *
-   * \param [in] dataSize The serialized size of the Tag.
-   * \returns The newly constructed TagData object.
+   * \param [in] tid The type of the tag.
+   * \returns The tag, or 0 if it is not in the list.
    */
-  static
-  TagData * CreateTagData (size_t dataSize);
-  
+  inline TagData * Find (TypeId tid) const;
   /**
-   * Typedef of method function pointer for copy-on-write operations
+   * Copy the tags of another list, into this empty list.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True if operation successful, false otherwise
+   * \param [in] o The list to copy.
    */
-  typedef bool (PacketTagList::*COWWriter)
-    (Tag       & tag, bool         preMerge,
-    struct TagData * cur, struct TagData ** prevNext);
+  inline void CopyFrom (const PacketTagList &o);
   /**
-   * Traverse the list implementing copy-on-write, using \pname{Writer}.
+   * Copy the tags of another list, when some of them are stored on
+   * the heap.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] Writer The copy-on-write function to use.
-   * \returns True if \pname{tag} found, false otherwise.
+   * \param [in] o The list to copy.
    */
-  bool COWTraverse   (Tag & tag, PacketTagList::COWWriter Writer);
+  void CopyFromHeap (const PacketTagList &o);
   /**
-   * Copy-on-write implementing Remove.
-   *
-   * \param [in] tag The target tag type to remove.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag will definitely be removed.
+   * Free the tags stored on the heap.
    */
-  bool RemoveWriter  (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  void FreeHeap (void);
   /**
-   * Copy-on-write implementing Replace
+   * Make room for one more tag at the end of the list.
    *
-   * \param [in] tag The target tag type to replace
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *          false otherwise.
-   * \param [in] cur Pointer to the tag
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag value will definitely be replaced.
+   * \returns The new tag, whose data is not allocated yet.
    */
-  bool ReplaceWriter (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
-
+  TagData * Append (void);
   /**
-   * Pointer to first \ref TagData on the list
+   * Allocate the data of a tag.
+   *
+   * \param [in,out] data The tag.
+   * \param [in] size The serialized size of the tag.
    */
-  struct TagData *m_next;
+  static void AllocateData (TagData *data, uint32_t size);
+
+  static PacketMemoryCounter g_tags;        //!< The number of tags in all the lists
+  static PacketMemoryCounter g_heapBytes;   //!< The bytes allocated on the heap by all the lists
+
+  TagData *m_tags;                  //!< The tags, m_inline or on the heap
+  uint32_t m_count;                 //!< The number of tags
+  uint32_t m_capacity;              //!< The capacity of m_tags
+  uint32_t m_heapData;              //!< The number of tags with data on the heap
+  union
+  {
+    /** The tags stored inline, only constructed when they are used. */
+    TagData m_inline[INLINE_TAGS];
+  };
 };
 
 } // namespace ns3
@@ -293,33 +235,32 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_tags (m_inline),
+    m_count (0),
+    m_capacity (INLINE_TAGS),
+    m_heapData (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_tags (m_inline),
+    m_count (0),
+    m_capacity (INLINE_TAGS),
+    m_heapData (0)
 {
-  if (m_next != 0)
-    {
-      m_next->count++;
-    }
+  CopyFrom (o);
 }
 
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o) 
     {
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
-    {
-      m_next->count++;
-    }
+  CopyFrom (o);
   return *this;
 }
 
@@ -331,27 +272,41 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
-  struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  if (m_tags != m_inline || m_heapData != 0)
     {
-      cur->count--;
-      if (cur->count > 0) 
-        {
-          break;
-        }
-      if (prev != 0) 
-        {
-          prev->~TagData ();
-          std::free (prev);
-        }
-      prev = cur;
+      FreeHeap ();
     }
-  if (prev != 0) 
+  g_tags -= m_count;
+  m_count = 0;
+}
+
+void
+PacketTagList::CopyFrom (const PacketTagList &o)
+{
+  g_tags += o.m_count;
+  if (o.m_count > INLINE_TAGS || o.m_heapData != 0)
     {
-      prev->~TagData ();
-      std::free (prev);
+      CopyFromHeap (o);
+      return;
+    }
+  for (uint32_t i = 0; i < o.m_count; ++i)
+    {
+      new (&m_tags[i]) TagData (o.m_tags[i]);
+    }
+  m_count = o.m_count;
+}
+
+PacketTagList::TagData *
+PacketTagList::Find (TypeId tid) const
+{
+  for (uint32_t i = 0; i < m_count; ++i)
+    {
+      if (m_tags[i].tid == tid)
+        {
+          return &m_tags[i];
+        }
     }
-  m_next = 0;
+  return 0;
 }
 
 } // namespace ns3
@@ -18,17 +18,23 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "packet.h"
+#include "packet-memory-stats.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include <string>
 #include <cstdarg>
+#include <atomic>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+thread_local uint32_t Packet::m_nextUid = 0;
+thread_local uint32_t Packet::m_uidRangeEnd = 0;
+PacketMemoryCounter Packet::m_packets (0);
+PacketMemoryPeak Packet::m_peakPackets (0);
+bool Packet::m_enableHeaderCache = false;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -81,22 +87,23 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *begin,
+                                      const struct PacketTagList::TagData *end)
+  : m_begin (begin),
+    m_current (end)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_current != m_begin;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
-  const struct PacketTagList::TagData *prev = m_current;
-  m_current = m_current->next;
-  return PacketTagIterator::Item (prev);
+  m_current--;
+  return PacketTagIterator::Item (m_current);
 }
 
 PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
@@ -112,8 +119,8 @@ void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
   NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
-  tag.Deserialize (TagBuffer ((uint8_t*)m_data->data,
-                              (uint8_t*)m_data->data + m_data->size));
+  tag.Deserialize (TagBuffer ((uint8_t*)m_data->GetData (),
+                              (uint8_t*)m_data->GetData () + m_data->size));
 }
 
 
@@ -126,6 +133,26 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+/** The start of the next range of uids taken by a thread. */
+static std::atomic<uint32_t> g_nextUidRange (0);
+
+void
+Packet::CountPacket (void)
+{
+  AddPacketMemory (m_packets, m_peakPackets, 1);
+}
+
+uint32_t
+Packet::AllocateUid (void)
+{
+  if (m_nextUid == m_uidRangeEnd)
+    {
+      m_nextUid = g_nextUidRange.fetch_add (UID_RANGE_SIZE, std::memory_order_relaxed);
+      m_uidRangeEnd = m_nextUid + UID_RANGE_SIZE;
+    }
+  return m_nextUid++;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -136,18 +163,21 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
-    m_nixVector (0)
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), 0),
+    m_nixVector (0),
+    m_headerCache (0)
 {
-  m_globalUid++;
+  CountPacket ();
 }
 
 Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
-    m_metadata (o.m_metadata)
+    m_metadata (o.m_metadata),
+    m_headerCache (o.m_headerCache)
 {
+  CountPacket ();
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
 }
@@ -165,6 +195,7 @@ Packet::operator = (const Packet &o)
   m_metadata = o.m_metadata;
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
     : m_nixVector = 0;
+  m_headerCache = o.m_headerCache;
   return *this;
 }
 
@@ -178,18 +209,21 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
-    m_nixVector (0)
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
+    m_nixVector (0),
+    m_headerCache (0)
 {
-  m_globalUid++;
+  CountPacket ();
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
     m_byteTagList (),
     m_packetTagList (),
     m_metadata (0,0),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_headerCache (0)
 {
+  CountPacket ();
   NS_ASSERT (magic);
   Deserialize (buffer, size);
 }
@@ -204,10 +238,11 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
-    m_nixVector (0)
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
+    m_nixVector (0),
+    m_headerCache (0)
 {
-  m_globalUid++;
+  CountPacket ();
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -219,8 +254,15 @@ Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList,
     m_byteTagList (byteTagList),
     m_packetTagList (packetTagList),
     m_metadata (metadata),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_headerCache (0)
 {
+  CountPacket ();
+}
+
+Packet::~Packet ()
+{
+  m_packets -= 1;
 }
 
 Ptr<Packet>
@@ -254,6 +296,12 @@ Packet::GetNixVector (void) const
 
 void
 Packet::AddHeader (const Header &header)
+{
+  uint32_t size = DoAddHeader (header);
+  PushHeaderCache (0, size, 0);
+}
+uint32_t
+Packet::DoAddHeader (const Header &header)
 {
   uint32_t size = header.GetSerializedSize ();
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
@@ -262,6 +310,7 @@ Packet::AddHeader (const Header &header)
   m_byteTagList.AddAtStart (size);
   header.Serialize (m_buffer.Begin ());
   m_metadata.AddHeader (header, size);
+  return size;
 }
 uint32_t
 Packet::RemoveHeader (Header &header, uint32_t size)
@@ -270,22 +319,26 @@ Packet::RemoveHeader (Header &header, uint32_t size)
   end = m_buffer.Begin ();
   end.Next (size);
   uint32_t deserialized = header.Deserialize (m_buffer.Begin (), end);
-  NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
-  m_buffer.RemoveAtStart (deserialized);
-  m_byteTagList.Adjust (-deserialized);
-  m_metadata.RemoveHeader (header, deserialized);
+  DoRemoveHeader (header, deserialized);
+  PopHeaderCache (deserialized);
   return deserialized;
 }
 uint32_t
 Packet::RemoveHeader (Header &header)
 {
   uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
-  NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
-  m_buffer.RemoveAtStart (deserialized);
-  m_byteTagList.Adjust (-deserialized);
-  m_metadata.RemoveHeader (header, deserialized);
+  DoRemoveHeader (header, deserialized);
+  PopHeaderCache (deserialized);
   return deserialized;
 }
+void
+Packet::DoRemoveHeader (const Header &header, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+  m_buffer.RemoveAtStart (size);
+  m_byteTagList.Adjust (-size);
+  m_metadata.RemoveHeader (header, size);
+}
 uint32_t
 Packet::PeekHeader (Header &header) const
 {
@@ -321,6 +374,7 @@ Packet::RemoveTrailer (Trailer &trailer)
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtEnd (deserialized);
   m_metadata.RemoveTrailer (trailer, deserialized);
+  TrimHeaderCache ();
   return deserialized;
 }
 uint32_t
@@ -357,6 +411,7 @@ Packet::RemoveAtEnd (uint32_t size)
   NS_LOG_FUNCTION (this << size);
   m_buffer.RemoveAtEnd (size);
   m_metadata.RemoveAtEnd (size);
+  TrimHeaderCache ();
 }
 void 
 Packet::RemoveAtStart (uint32_t size)
@@ -365,6 +420,120 @@ Packet::RemoveAtStart (uint32_t size)
   m_buffer.RemoveAtStart (size);
   m_byteTagList.Adjust (-size);
   m_metadata.RemoveAtStart (size);
+  PopHeaderCache (size);
+}
+
+Packet::HeaderCache *
+Packet::GetWritableHeaderCache (void)
+{
+  if (m_headerCache == 0)
+    {
+      m_headerCache = Create<HeaderCache> ();
+    }
+  else if (m_headerCache->GetReferenceCount () > 1)
+    {
+      m_headerCache = Create<HeaderCache> (*m_headerCache);
+    }
+  return PeekPointer (m_headerCache);
+}
+
+void
+Packet::PushHeaderCache (const std::type_info *type, uint32_t size,
+                         Ptr<const CachedHeaderBase> header)
+{
+  if (type == 0 && m_headerCache == 0)
+    {
+      // nothing kept to track below this header
+      return;
+    }
+  HeaderCache *cache = GetWritableHeaderCache ();
+  if (cache->count == HEADER_CACHE_SIZE)
+    {
+      // forget the innermost header
+      for (uint32_t i = 1; i < HEADER_CACHE_SIZE; ++i)
+        {
+          cache->entries[i - 1] = cache->entries[i];
+        }
+      cache->count--;
+    }
+  HeaderCacheEntry &entry = cache->entries[cache->count];
+  entry.type = type;
+  entry.size = size;
+  entry.header = header;
+  cache->count++;
+}
+
+void
+Packet::PopHeaderCache (uint32_t size)
+{
+  if (m_headerCache == 0 || size == 0)
+    {
+      return;
+    }
+  uint32_t count = m_headerCache->count;
+  while (count > 0 && size > 0)
+    {
+      const HeaderCacheEntry &entry = m_headerCache->entries[count - 1];
+      if (entry.size > size)
+        {
+          // part of a header was removed
+          ClearHeaderCache ();
+          return;
+        }
+      size -= entry.size;
+      count--;
+    }
+  if (count == 0)
+    {
+      ClearHeaderCache ();
+      return;
+    }
+  HeaderCache *cache = GetWritableHeaderCache ();
+  for (uint32_t i = count; i < cache->count; ++i)
+    {
+      cache->entries[i].type = 0;
+      cache->entries[i].header = 0;
+    }
+  cache->count = count;
+}
+
+void
+Packet::TrimHeaderCache (void)
+{
+  if (m_headerCache == 0)
+    {
+      return;
+    }
+  uint32_t size = 0;
+  for (uint32_t i = 0; i < m_headerCache->count; ++i)
+    {
+      size += m_headerCache->entries[i].size;
+    }
+  if (size > m_buffer.GetSize ())
+    {
+      ClearHeaderCache ();
+    }
+}
+
+void
+Packet::ClearHeaderCache (void)
+{
+  m_headerCache = 0;
+}
+
+const Packet::HeaderCacheEntry *
+Packet::LookupHeaderCache (const std::type_info &type) const
+{
+  if (m_headerCache == 0 || m_headerCache->count == 0)
+    {
+      return 0;
+    }
+  const HeaderCacheEntry *entry = &m_headerCache->entries[m_headerCache->count - 1];
+  if (entry->type == 0 || *entry->type != type)
+    {
+      return 0;
+    }
+  return entry;
 }
 
 void 
@@ -582,6 +751,41 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableHeaderCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enableHeaderCache = true;
+}
+
+void
+Packet::DisableHeaderCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enableHeaderCache = false;
+}
+
+PacketMemoryStats
+Packet::GetMemoryStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketMemoryStats stats;
+  stats.packets = ReadPacketMemory (m_packets, m_peakPackets);
+  stats.peakPackets = m_peakPackets;
+  Buffer::GetMemoryStats (stats);
+  PacketMetadata::GetMemoryStats (stats);
+  PacketTagList::GetMemoryStats (stats);
+  return stats;
+}
+
+void
+Packet::SetFreeListLimits (uint32_t buffers, uint32_t metadata)
+{
+  NS_LOG_FUNCTION (buffers << metadata);
+  Buffer::SetFreeListLimit (buffers);
+  PacketMetadata::SetFreeListLimit (metadata);
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -920,7 +1124,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList.Begin (), m_packetTagList.End ());
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <typeinfo>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -34,11 +35,13 @@
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
 #include "ns3/deprecated.h"
+#include "ns3/int-to-type.h"
 
 namespace ns3 {
 
 // Forward declaration
 class Address;
+struct PacketMemoryStats;
   
 /**
  * \ingroup network
@@ -173,10 +176,13 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param begin the first item
+   * \param end past the last item
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
-  const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  PacketTagIterator (const struct PacketTagList::TagData *begin,
+                     const struct PacketTagList::TagData *end);
+  const struct PacketTagList::TagData *m_begin;  //!< the first tag in a packet
+  const struct PacketTagList::TagData *m_current;  //!< past the next tag, iterating from the newest one
 };
 
 /**
@@ -227,8 +233,17 @@ private:
  *
  * The performance aspects copy-on-write semantics of the
  * Packet API are discussed in \ref packetperf
+ *
+ * A packet can be created by a thread and handed to another one: the
+ * data blocks are recycled in free lists owned by the thread which
+ * releases them, and each thread takes the uids of its packets from its
+ * own range.  The copies of a packet can only be used by several
+ * threads at the same time when ns-3 is configured with
+ * \c --enable-atomic-refcount: the reference counts of the packets and
+ * of their shared data are then atomic, and the data shared by several
+ * copies is never extended in place.
  */
-class Packet : public SimpleRefCount<Packet>
+class Packet : public SimpleRefCount<Packet, empty, DefaultDeleter<Packet>, PacketRefCount>
 {
 public:
 
@@ -252,10 +267,12 @@ public:
    * \brief Create a packet with a zero-filled payload.
    *
    * The memory necessary for the payload is not allocated:
-   * it will be allocated at any later point if you attempt
-   * to fragment this packet or to access the zero-filled
-   * bytes. The packet is allocated with a new uid (as 
-   * returned by getUid).
+   * the payload is virtual, and fragmenting this packet,
+   * adding or removing headers and concatenating it with
+   * other packets of virtual payload do not depend on its
+   * size. It will be allocated if you attempt to access the
+   * zero-filled bytes in place with PeekData. The packet is
+   * allocated with a new uid (as returned by getUid).
    * 
    * \param size the size of the zero-filled payload
    */
@@ -284,6 +301,7 @@ public:
    * \param size the size of the input buffer.
    */
   Packet (uint8_t const*buffer, uint32_t size);
+  ~Packet ();
   /**
    * \brief Create a new packet which contains a fragment of the original
    * packet.
@@ -313,6 +331,17 @@ public:
    * \param header a reference to the header to add to this packet.
    */
   void AddHeader (const Header & header);
+  /**
+   * \brief Add header to this packet, and keep a copy of it if the
+   * header cache is enabled for its type.
+   *
+   * \tparam T \deduced The type of the header.
+   * \param header a reference to the header to add to this packet.
+   *
+   * \sa EnableHeaderCache HeaderCacheTraits
+   */
+  template <typename T>
+  void AddHeader (const T & header);
   /**
    * \brief Deserialize and remove the header from the internal buffer.
    *
@@ -323,6 +352,19 @@ public:
    * \returns the number of bytes removed from the packet.
    */
   uint32_t RemoveHeader (Header &header);
+  /**
+   * \brief Remove the header from the internal buffer.
+   *
+   * If the header at the start of the packet is a copy of type \p T
+   * kept by the header cache, it is returned without being
+   * deserialized.
+   *
+   * \tparam T \deduced The type of the header.
+   * \param header a reference to the header to remove from the internal buffer.
+   * \returns the number of bytes removed from the packet.
+   */
+  template <typename T>
+  uint32_t RemoveHeader (T &header);
   /**
    * \brief Deserialize and remove the header from the internal buffer.
    *
@@ -344,6 +386,19 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header) const;
+  /**
+   * \brief Read, but does _not_ remove, the header from the internal buffer.
+   *
+   * If the header at the start of the packet is a copy of type \p T
+   * kept by the header cache, it is returned without being
+   * deserialized.
+   *
+   * \tparam T \deduced The type of the header.
+   * \param header a reference to the header to read from the internal buffer.
+   * \returns the number of bytes read from the packet.
+   */
+  template <typename T>
+  uint32_t PeekHeader (T &header) const;
   /**
    * \brief Deserialize but does _not_ remove the header from the internal buffer.
    * s
@@ -530,6 +585,54 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the cache of the deserialized headers.
+   *
+   * The headers are always serialized in the byte buffer, but once
+   * this method is called, AddHeader also keeps a copy of the headers
+   * of the types which opt in with HeaderCacheTraits.  RemoveHeader and
+   * PeekHeader return that copy, as long as the header is still at the
+   * start of the packet, instead of deserializing it from the buffer.
+   * The copies are shared by the copies of the packet, and dropped
+   * by the operations which remove the bytes of a header in another
+   * way, or by CreateFragment.  A packet only allocates its cache when
+   * it keeps a header.
+   */
+  static void EnableHeaderCache (void);
+  /**
+   * \brief Disable the cache of the deserialized headers.
+   *
+   * The headers added from now on are not kept; the packets which
+   * already keep headers still return them.
+   */
+  static void DisableHeaderCache (void);
+  /**
+   * \brief Get the memory used by the packets.
+   *
+   * The counters are updated as the packets, their buffers, metadata
+   * and tags are created and released, so this method does not walk
+   * any packet.  They count the packets of all the threads, except the
+   * free lists, which are the ones of the calling thread.
+   *
+   * \returns The statistics of the memory used by the packets.
+   * \see PacketMemoryMonitor to sample them periodically.
+   */
+  static PacketMemoryStats GetMemoryStats (void);
+  /**
+   * \brief Set the maximum number of data blocks kept in the free lists.
+   *
+   * The Buffer and PacketMetadata data blocks released by the packets
+   * are kept in free lists to be reused by the next packets, up to
+   * 1000 blocks each by default.  Lowering the limits releases the
+   * blocks in excess immediately, for instance to return the memory
+   * kept after a burst of traffic to the allocator.  Each thread has
+   * its own free lists: the ones of the other threads are trimmed the
+   * next time they release a block.
+   *
+   * \param buffers The maximum number of Buffer data blocks.
+   * \param metadata The maximum number of PacketMetadata data blocks.
+   */
+  static void SetFreeListLimits (uint32_t buffers, uint32_t metadata);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -779,6 +882,145 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /** A copy of a header kept by the header cache. */
+  class CachedHeaderBase : public SimpleRefCount<CachedHeaderBase, empty,
+                                                 DefaultDeleter<CachedHeaderBase>,
+                                                 PacketRefCount>
+  {
+  public:
+    /** Destructor. */
+    virtual ~CachedHeaderBase () {}
+  };
+  /**
+   * A copy of a header of a known type.
+   * \tparam T \explicit The type of the header.
+   */
+  template <typename T>
+  class CachedHeader : public CachedHeaderBase
+  {
+  public:
+    /**
+     * Constructor.
+     * \param [in] header The header to copy.
+     */
+    CachedHeader (const T &header) : m_header (header) {}
+    T m_header;   //!< The copy of the header.
+  };
+  /** A header at the start of the packet. */
+  struct HeaderCacheEntry
+  {
+    const std::type_info *type;          //!< The type of the header, or 0 if not kept.
+    uint32_t size;                       //!< The serialized size of the header.
+    Ptr<const CachedHeaderBase> header;  //!< The copy of the header, or 0 if not kept.
+  };
+  /** The maximum number of headers tracked by the header cache. */
+  static const uint32_t HEADER_CACHE_SIZE = 4;
+  /**
+   * The headers at the start of a packet, shared by its copies until
+   * one of them adds or removes a header.
+   */
+  class HeaderCache : public SimpleRefCount<HeaderCache, empty,
+                                            DefaultDeleter<HeaderCache>,
+                                            PacketRefCount>
+  {
+  public:
+    HeaderCache () : count (0) {}
+    HeaderCacheEntry entries[HEADER_CACHE_SIZE]; //!< The headers, the first one last.
+    uint32_t count;                              //!< The number of headers tracked.
+  };
+
+  /**
+   * \brief Add a header which is not cached.
+   * \tparam T \deduced The type of the header.
+   * \param header the header.
+   */
+  template <typename T>
+  void AddCachedHeader (const T &header, IntToType<0>);
+  /**
+   * \brief Add a header and keep a copy of it.
+   * \tparam T \deduced The type of the header.
+   * \param header the header.
+   */
+  template <typename T>
+  void AddCachedHeader (const T &header, IntToType<1>);
+  /**
+   * \brief Remove a header which is not cached.
+   * \tparam T \deduced The type of the header.
+   * \param header the header.
+   * \returns the number of bytes removed.
+   */
+  template <typename T>
+  uint32_t RemoveCachedHeader (T &header, IntToType<0>);
+  /**
+   * \brief Remove a header, from the header cache if possible.
+   * \tparam T \deduced The type of the header.
+   * \param header the header.
+   * \returns the number of bytes removed.
+   */
+  template <typename T>
+  uint32_t RemoveCachedHeader (T &header, IntToType<1>);
+  /**
+   * \brief Read a header which is not cached.
+   * \tparam T \deduced The type of the header.
+   * \param header the header.
+   * \returns the number of bytes read.
+   */
+  template <typename T>
+  uint32_t PeekCachedHeader (T &header, IntToType<0>) const;
+  /**
+   * \brief Read a header, from the header cache if possible.
+   * \tparam T \deduced The type of the header.
+   * \param header the header.
+   * \returns the number of bytes read.
+   */
+  template <typename T>
+  uint32_t PeekCachedHeader (T &header, IntToType<1>) const;
+
+  /**
+   * \brief Serialize a header at the start of the buffer.
+   * \param header the header.
+   * \returns the size of the header.
+   */
+  uint32_t DoAddHeader (const Header &header);
+  /**
+   * \brief Remove the bytes of a header from the start of the buffer.
+   * \param header the header, already read.
+   * \param size the size of the header.
+   */
+  void DoRemoveHeader (const Header &header, uint32_t size);
+  /**
+   * \brief Track a header added at the start of the packet.
+   * \param type the type of the header, or 0 if it is not kept.
+   * \param size the size of the header.
+   * \param header the copy of the header, or 0 if it is not kept.
+   */
+  void PushHeaderCache (const std::type_info *type, uint32_t size,
+                        Ptr<const CachedHeaderBase> header);
+  /**
+   * \brief Drop the headers whose bytes were removed from the start
+   * of the packet.
+   * \param size the number of bytes removed.
+   */
+  void PopHeaderCache (uint32_t size);
+  /**
+   * \brief Drop the headers if bytes were removed from them at the
+   * end of the packet.
+   */
+  void TrimHeaderCache (void);
+  /** \brief Drop all the headers. */
+  void ClearHeaderCache (void);
+  /**
+   * \brief Get the header cache of this packet only, to modify it.
+   * \returns the header cache, created or copied if needed.
+   */
+  HeaderCache * GetWritableHeaderCache (void);
+  /**
+   * \brief Look for a copy of the header at the start of the packet.
+   * \param type the type of the header.
+   * \returns the header entry, or 0 if it is not a kept copy of this type.
+   */
+  const HeaderCacheEntry * LookupHeaderCache (const std::type_info &type) const;
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -787,7 +1029,24 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  /** The headers at the start of the packet, or 0 if none is tracked. */
+  Ptr<HeaderCache> m_headerCache;
+
+  /** Count a new packet. */
+  static inline void CountPacket (void);
+  /**
+   * Allocate the uid of a new packet from the range of this thread.
+   * \returns The uid.
+   */
+  static inline uint32_t AllocateUid (void);
+
+  /** The number of uids in the range taken at once by a thread. */
+  static const uint32_t UID_RANGE_SIZE = 1024;
+  static thread_local uint32_t m_nextUid; //!< Next uid of the range of this thread
+  static thread_local uint32_t m_uidRangeEnd; //!< End of the range of uids of this thread
+  static PacketMemoryCounter m_packets; //!< Number of live packets
+  static PacketMemoryPeak m_peakPackets; //!< Peak of the number of live packets
+  static bool m_enableHeaderCache; //!< Enable the header cache
 };
 
 /**
@@ -816,11 +1075,11 @@ std::ostream& operator<< (std::ostream& os, const Packet &packet);
  *   - ns3::Packet::AddHeader
  *   - ns3::Packet::AddTrailer
  *   - both versions of ns3::Packet::AddAtEnd
- *   - ns3::Packet::RemovePacketTag
- *   - ns3::Packet::ReplacePacketTag
  *
  * Non-dirty operations:
  *   - ns3::Packet::AddPacketTag
+ *   - ns3::Packet::RemovePacketTag
+ *   - ns3::Packet::ReplacePacketTag
  *   - ns3::Packet::PeekPacketTag
  *   - ns3::Packet::RemoveAllPacketTags
  *   - ns3::Packet::AddByteTag
@@ -854,6 +1113,91 @@ Packet::GetSize (void) const
   return m_buffer.GetSize ();
 }
 
+template <typename T>
+void
+Packet::AddHeader (const T &header)
+{
+  AddCachedHeader (header, IntToType<HeaderCacheTraits<T>::cached> ());
+}
+
+template <typename T>
+uint32_t
+Packet::RemoveHeader (T &header)
+{
+  return RemoveCachedHeader (header, IntToType<HeaderCacheTraits<T>::cached> ());
+}
+
+template <typename T>
+uint32_t
+Packet::PeekHeader (T &header) const
+{
+  return PeekCachedHeader (header, IntToType<HeaderCacheTraits<T>::cached> ());
+}
+
+template <typename T>
+void
+Packet::AddCachedHeader (const T &header, IntToType<0>)
+{
+  AddHeader (static_cast<const Header &> (header));
+}
+
+template <typename T>
+void
+Packet::AddCachedHeader (const T &header, IntToType<1>)
+{
+  if (!m_enableHeaderCache || typeid (header) != typeid (T)
+      || !HeaderCacheTraits<T>::IsCached (header))
+    {
+      AddHeader (static_cast<const Header &> (header));
+      return;
+    }
+  uint32_t size = DoAddHeader (header);
+  PushHeaderCache (&typeid (T), size, Create<CachedHeader<T> > (header));
+}
+
+template <typename T>
+uint32_t
+Packet::RemoveCachedHeader (T &header, IntToType<0>)
+{
+  return RemoveHeader (static_cast<Header &> (header));
+}
+
+template <typename T>
+uint32_t
+Packet::RemoveCachedHeader (T &header, IntToType<1>)
+{
+  const HeaderCacheEntry *entry = LookupHeaderCache (typeid (T));
+  if (entry == 0 || typeid (header) != typeid (T))
+    {
+      return RemoveHeader (static_cast<Header &> (header));
+    }
+  header = static_cast<const CachedHeader<T> *> (PeekPointer (entry->header))->m_header;
+  uint32_t size = entry->size;
+  DoRemoveHeader (header, size);
+  PopHeaderCache (size);
+  return size;
+}
+
+template <typename T>
+uint32_t
+Packet::PeekCachedHeader (T &header, IntToType<0>) const
+{
+  return PeekHeader (static_cast<Header &> (header));
+}
+
+template <typename T>
+uint32_t
+Packet::PeekCachedHeader (T &header, IntToType<1>) const
+{
+  const HeaderCacheEntry *entry = LookupHeaderCache (typeid (T));
+  if (entry == 0 || typeid (header) != typeid (T))
+    {
+      return PeekHeader (static_cast<Header &> (header));
+    }
+  header = static_cast<const CachedHeader<T> *> (PeekPointer (entry->header))->m_header;
+  return entry->size;
+}
+
 } // namespace ns3
 
 #endif /* PACKET_H */
@@ -0,0 +1,331 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/binary-trace-file.h"
+#include "ns3/trace-helper.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/fatal-impl.h"
+
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceTestSuite");
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Write records and text in a binary trace file and read them back.
+ */
+class BinaryTraceRoundTripTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] layout The layout of the file.
+   * \param [in] compress Whether to compress the blocks.
+   */
+  BinaryTraceRoundTripTestCase (BinaryTraceWriter::Layout layout, bool compress);
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Write a record, or a line of text every tenth record.
+   * \param [in] writer The writer.
+   * \param [in] i The index of the record.
+   */
+  void Write (Ptr<BinaryTraceWriter> writer, uint32_t i);
+
+  BinaryTraceWriter::Layout m_layout;   //!< The layout of the file.
+  bool m_compress;                      //!< Compress the blocks.
+  std::string m_testFilename;           //!< The file name.
+  std::vector<Ptr<Packet> > m_packets;  //!< The packets written.
+};
+
+BinaryTraceRoundTripTestCase::BinaryTraceRoundTripTestCase (BinaryTraceWriter::Layout layout, bool compress)
+  : TestCase (std::string ("Check the round trip of the ")
+              + (layout == BinaryTraceWriter::ROW ? "row" : "column") + " layout"
+              + (compress ? ", compressed" : "")),
+    m_layout (layout),
+    m_compress (compress)
+{
+}
+
+void
+BinaryTraceRoundTripTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  filename << rand ();
+  m_testFilename = CreateTempDirFilename (filename.str () + ".btr");
+}
+
+void
+BinaryTraceRoundTripTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+BinaryTraceRoundTripTestCase::Write (Ptr<BinaryTraceWriter> writer, uint32_t i)
+{
+  if (i % 10 == 9)
+    {
+      *writer->GetTextStream () << "text " << i << std::endl;
+      return;
+    }
+  std::ostringstream context;
+  context << "/NodeList/" << i % 3 << "/DeviceList/0/TxQueue/Enqueue";
+  writer->Write (static_cast<BinaryTraceWriter::EventType> (1 + i % 4),
+                 i % 5 == 0 ? "" : context.str (), m_packets[i]);
+}
+
+void
+BinaryTraceRoundTripTestCase::DoRun (void)
+{
+  const uint32_t n = 100;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      m_packets.push_back (Create<Packet> (i * 13));
+    }
+
+  // small blocks, so that the records span several blocks
+  Ptr<BinaryTraceWriter> writer = Create<BinaryTraceWriter> (m_testFilename, m_layout, m_compress, 16);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (i * i), &BinaryTraceRoundTripTestCase::Write, this, writer, i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  writer->Close ();
+
+  BinaryTraceReader reader (m_testFilename);
+  NS_TEST_EXPECT_MSG_EQ (reader.GetLayout (), m_layout, "The layout should be kept");
+  BinaryTraceWriter::Record record;
+  std::string text;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader.Next (record, text), true, "Record " << i << " should be read");
+      NS_TEST_EXPECT_MSG_EQ (record.time, MicroSeconds (i * i).GetTimeStep (), "Wrong time of record " << i);
+      NS_TEST_EXPECT_MSG_EQ_TOL (reader.GetSeconds (record.time), i * i * 1e-6, 1e-12, "Wrong time of record " << i);
+      if (i % 10 == 9)
+        {
+          std::ostringstream expected;
+          expected << "text " << i;
+          NS_TEST_EXPECT_MSG_EQ (record.type, BinaryTraceWriter::TEXT, "Record " << i << " should be text");
+          NS_TEST_EXPECT_MSG_EQ (text, expected.str (), "Wrong text of record " << i);
+          continue;
+        }
+      std::ostringstream context;
+      context << "/NodeList/" << i % 3 << "/DeviceList/0/TxQueue/Enqueue";
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.type, 1 + i % 4, "Wrong type of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (reader.GetContext (record.context), (i % 5 == 0 ? "" : context.str ()),
+                             "Wrong context of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.uid, m_packets[i]->GetUid (), "Wrong uid of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.size, i * 13, "Wrong size of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (text, "", "Record " << i << " should have no text");
+    }
+  NS_TEST_EXPECT_MSG_EQ (reader.Next (record, text), false, "There should be no more records");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Hook the default ascii trace sinks to a queue with a binary stream.
+ */
+class BinaryTraceHelperTestCase : public TestCase
+{
+public:
+  BinaryTraceHelperTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;   //!< The file name.
+};
+
+BinaryTraceHelperTestCase::BinaryTraceHelperTestCase ()
+  : TestCase ("Check the default ascii trace sinks with a binary stream")
+{
+}
+
+void
+BinaryTraceHelperTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  filename << rand ();
+  m_testFilename = CreateTempDirFilename (filename.str () + ".btr");
+}
+
+void
+BinaryTraceHelperTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+BinaryTraceHelperTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetMaxSize (QueueSize ("2p"));
+  {
+    AsciiTraceHelper ascii;
+    Ptr<OutputStreamWrapper> stream = ascii.CreateBinaryFileStream (m_testFilename);
+    NS_TEST_ASSERT_MSG_NE (stream->GetBinaryTraceWriter (), 0, "The stream should have a binary writer");
+    ascii.HookDefaultEnqueueSinkWithContext<Queue<Packet> > (queue, "queue", "Enqueue", stream);
+    ascii.HookDefaultDequeueSinkWithoutContext<Queue<Packet> > (queue, "Dequeue", stream);
+    ascii.HookDefaultDropSinkWithContext<Queue<Packet> > (queue, "queue", "Drop", stream);
+    *stream->GetStream () << "start" << std::endl;
+  }
+
+  Ptr<Packet> p1 = Create<Packet> (100);
+  Ptr<Packet> p2 = Create<Packet> (200);
+  Ptr<Packet> p3 = Create<Packet> (300);
+  queue->Enqueue (p1);
+  queue->Enqueue (p2);
+  queue->Enqueue (p3);
+  queue->Dequeue ();
+  // the stream is closed with the last callback
+  queue = 0;
+
+  BinaryTraceReader reader (m_testFilename);
+  BinaryTraceWriter::EventType types[] = {
+    BinaryTraceWriter::TEXT, BinaryTraceWriter::ENQUEUE, BinaryTraceWriter::ENQUEUE,
+    BinaryTraceWriter::DROP, BinaryTraceWriter::DEQUEUE
+  };
+  Ptr<Packet> packets[] = { 0, p1, p2, p3, p1 };
+  BinaryTraceWriter::Record record;
+  std::string text;
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader.Next (record, text), true, "Record " << i << " should be read");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.type, (uint32_t)types[i], "Wrong type of record " << i);
+      if (i == 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ (text, "start", "Wrong text");
+          continue;
+        }
+      NS_TEST_EXPECT_MSG_EQ (record.uid, packets[i]->GetUid (), "Wrong uid of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (record.size, packets[i]->GetSize (), "Wrong size of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (reader.GetContext (record.context), (i == 4 ? "" : "queue"),
+                             "Wrong context of record " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (reader.Next (record, text), false, "There should be no more records");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the streams flushed on a fatal error write the current
+ * block of a binary trace file.
+ */
+class BinaryTraceFatalFlushTestCase : public TestCase
+{
+public:
+  BinaryTraceFatalFlushTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;   //!< The file name.
+};
+
+BinaryTraceFatalFlushTestCase::BinaryTraceFatalFlushTestCase ()
+  : TestCase ("Check that a fatal error writes the current block of a binary trace")
+{
+}
+
+void
+BinaryTraceFatalFlushTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  filename << rand ();
+  m_testFilename = CreateTempDirFilename (filename.str () + ".btr");
+}
+
+void
+BinaryTraceFatalFlushTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+BinaryTraceFatalFlushTestCase::DoRun (void)
+{
+  Ptr<BinaryTraceWriter> writer = Create<BinaryTraceWriter> (m_testFilename);
+  Ptr<Packet> p = Create<Packet> (100);
+  writer->Write (BinaryTraceWriter::TRANSMIT, "phy", p);
+  // as done by NS_FATAL_ERROR before it terminates the program
+  FatalImpl::FlushStreams ();
+
+  BinaryTraceReader reader (m_testFilename);
+  BinaryTraceWriter::Record record;
+  std::string text;
+  NS_TEST_ASSERT_MSG_EQ (reader.Next (record, text), true, "The record should be written");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.type, (uint32_t)BinaryTraceWriter::TRANSMIT, "Wrong type");
+  NS_TEST_EXPECT_MSG_EQ (record.uid, p->GetUid (), "Wrong uid");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetContext (record.context), "phy", "Wrong context");
+  NS_TEST_EXPECT_MSG_EQ (reader.Next (record, text), false, "There should be no more records");
+  writer->Close ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary trace file TestSuite
+ */
+class BinaryTraceTestSuite : public TestSuite
+{
+public:
+  BinaryTraceTestSuite ()
+    : TestSuite ("binary-trace", UNIT)
+  {
+    AddTestCase (new BinaryTraceRoundTripTestCase (BinaryTraceWriter::ROW, false), TestCase::QUICK);
+    AddTestCase (new BinaryTraceRoundTripTestCase (BinaryTraceWriter::ROW, true), TestCase::QUICK);
+    AddTestCase (new BinaryTraceRoundTripTestCase (BinaryTraceWriter::COLUMN, false), TestCase::QUICK);
+    AddTestCase (new BinaryTraceRoundTripTestCase (BinaryTraceWriter::COLUMN, true), TestCase::QUICK);
+    AddTestCase (new BinaryTraceHelperTestCase (), TestCase::QUICK);
+    AddTestCase (new BinaryTraceFatalFlushTestCase (), TestCase::QUICK);
+  }
+};
+
+static BinaryTraceTestSuite g_binaryTraceTestSuite; //!< Static variable for test initialization
@@ -387,6 +387,43 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // concatenate zero areas of buffers which share their data
+  buffer = Buffer (10000);
+  buffer.AddAtStart (2);
+  buffer.Begin ().WriteU16 (0x1234);
+  other = buffer;
+  Buffer payload = Buffer (20000);
+  payload.AddAtEnd (1);
+  i = payload.End ();
+  i.Prev ();
+  i.WriteU8 (0x56);
+  buffer.AddAtEnd (payload);
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 30003, "Bad size after concatenation");
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSerializedSize (), 20, "Zero area written out");
+  NS_TEST_ASSERT_MSG_EQ (other.GetSize (), 10002, "Shared buffer modified");
+  i = buffer.Begin ();
+  uint16_t before = i.ReadU16 ();
+  NS_TEST_ASSERT_MSG_EQ (before, 0x1234, "Bad data before the zero area");
+  i = buffer.End ();
+  i.Prev ();
+  uint8_t after = i.ReadU8 ();
+  NS_TEST_ASSERT_MSG_EQ (after, 0x56, "Bad data after the zero area");
+
+  // concatenate zero areas which are not adjacent: only the smaller
+  // one is written out
+  buffer = Buffer (100);
+  buffer.AddAtEnd (1);
+  i = buffer.End ();
+  i.Prev ();
+  i.WriteU8 (0x78);
+  buffer.AddAtEnd (Buffer (50000));
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 50101, "Bad size after concatenation");
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSerializedSize (), 12 + 104, "Larger zero area written out");
+  i = buffer.Begin ();
+  i.Next (100);
+  after = i.ReadU8 ();
+  NS_TEST_ASSERT_MSG_EQ (after, 0x78, "Bad data after concatenation");
 }
 
 /**
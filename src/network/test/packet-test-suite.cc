@@ -19,6 +19,8 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/packet-memory-stats.h"
+#include "ns3/simulator.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
@@ -1035,6 +1037,500 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test tag whose serialized size is set by its constructor.
+ *
+ * \note Class internal to packet-test-suite.cc
+ */
+class AResizableTestTag : public Tag
+{
+public:
+  /// Constructor
+  /// \param size The serialized size of the tag.
+  AResizableTestTag (uint8_t size = 1) : m_size (size), m_error (false) {}
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("AResizableTestTag")
+      .SetParent<Tag> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<AResizableTestTag> ()
+      ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return m_size;
+  }
+  virtual void Serialize (TagBuffer buf) const {
+    buf.WriteU8 (m_size);
+    for (uint8_t i = 1; i < m_size; ++i)
+      {
+        buf.WriteU8 (m_size);
+      }
+  }
+  virtual void Deserialize (TagBuffer buf) {
+    m_size = buf.ReadU8 ();
+    for (uint8_t i = 1; i < m_size; ++i)
+      {
+        if (buf.ReadU8 () != m_size)
+          {
+            m_error = true;
+          }
+      }
+  }
+  virtual void Print (std::ostream &os) const {
+    os << "(" << (uint16_t) m_size << ")";
+  }
+  uint8_t m_size;   //!< Serialized size
+  bool m_error;     //!< Error in the Tag
+};
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet Tag list storage unit tests: the tags stored on the heap, the
+ * lists longer than the inline array, and the replacement of a tag by
+ * one of another size.
+ */
+class PacketTagListStorageTest : public TestCase
+{
+public:
+  PacketTagListStorageTest ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the value of a tag in a list.
+   * \tparam N \explicit The type of the tag.
+   * \param ptl The list.
+   * \param data The expected value of the tag, or -1 if it is missing.
+   * \param msg Message
+   */
+  template <int N>
+  void CheckTag (const PacketTagList &ptl, int data, const char *msg);
+  /**
+   * Check the size of a tag in a list.
+   * \param ptl The list.
+   * \param size The expected size of the tag.
+   * \param msg Message
+   */
+  void CheckResizable (const PacketTagList &ptl, uint8_t size, const char *msg);
+};
+
+PacketTagListStorageTest::PacketTagListStorageTest ()
+  : TestCase ("PacketTagList storage")
+{
+}
+
+template <int N>
+void
+PacketTagListStorageTest::CheckTag (const PacketTagList &ptl, int data, const char *msg)
+{
+  ATestTag<N> tag;
+  bool found = ptl.Peek (tag);
+  NS_TEST_EXPECT_MSG_EQ (found, (data >= 0), msg << ": peek tag " << N);
+  if (found)
+    {
+      NS_TEST_EXPECT_MSG_EQ (tag.GetData (), data, msg << ": value of tag " << N);
+      NS_TEST_EXPECT_MSG_EQ (tag.m_error, false, msg << ": data of tag " << N);
+    }
+}
+
+void
+PacketTagListStorageTest::CheckResizable (const PacketTagList &ptl, uint8_t size, const char *msg)
+{
+  AResizableTestTag tag;
+  NS_TEST_EXPECT_MSG_EQ (ptl.Peek (tag), true, msg << ": peek");
+  NS_TEST_EXPECT_MSG_EQ ((uint16_t) tag.m_size, (uint16_t) size, msg << ": size");
+  NS_TEST_EXPECT_MSG_EQ (tag.m_error, false, msg << ": data");
+}
+
+void
+PacketTagListStorageTest::DoRun (void)
+{
+  PacketMemoryStats before;
+  PacketTagList::GetMemoryStats (before);
+
+  { // Tags larger than the inline data
+    NS_TEST_ASSERT_MSG_GT (ATestTag<20> ().GetSerializedSize (), PacketTagList::TAG_DATA_INLINE_SIZE,
+                           "the tag is stored inline");
+    PacketTagList ptl;
+    ptl.Add (ATestTag<20> (3));
+    ptl.Add (ATestTag<1> (4));
+    ptl.Add (ATestTag<30> (5));
+    PacketTagList copy = ptl;
+    ATestTag<20> t20;
+    NS_TEST_EXPECT_MSG_EQ (copy.Remove (t20), true, "large tag not removed");
+    NS_TEST_EXPECT_MSG_EQ (t20.GetData (), 3, "wrong large tag removed");
+    CheckTag<20> (copy, -1, "heap copy");
+    CheckTag<1> (copy, 4, "heap copy");
+    CheckTag<30> (copy, 5, "heap copy");
+    CheckTag<20> (ptl, 3, "heap orig");
+    CheckTag<1> (ptl, 4, "heap orig");
+    CheckTag<30> (ptl, 5, "heap orig");
+  }
+
+  { // More tags than stored inline
+    PacketTagList ptl;
+    ptl.Add (ATestTag<1> (1));
+    ptl.Add (ATestTag<2> (2));
+    ptl.Add (ATestTag<3> (3));
+    ptl.Add (ATestTag<20> (20));
+    ptl.Add (ATestTag<5> (5));
+    ptl.Add (ATestTag<6> (6));
+    ptl.Add (ATestTag<7> (7));
+    ptl.Add (ATestTag<8> (8));
+    ptl.Add (ATestTag<9> (9));
+    NS_TEST_ASSERT_MSG_GT (static_cast<uint32_t> (ptl.End () - ptl.Begin ()), PacketTagList::INLINE_TAGS,
+                           "the tags are stored inline");
+    NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (ptl.End () - ptl.Begin ()), 9, "wrong number of tags");
+    PacketTagList copy;
+    copy = ptl;
+    ATestTag<3> t3;
+    ATestTag<8> t8;
+    copy.Remove (t3);
+    copy.Remove (t8);
+    copy.Add (ATestTag<10> (10));
+    NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (copy.End () - copy.Begin ()), 8, "wrong number of tags");
+    CheckTag<1> (copy, 1, "long copy");
+    CheckTag<2> (copy, 2, "long copy");
+    CheckTag<3> (copy, -1, "long copy");
+    CheckTag<20> (copy, 20, "long copy");
+    CheckTag<5> (copy, 5, "long copy");
+    CheckTag<6> (copy, 6, "long copy");
+    CheckTag<7> (copy, 7, "long copy");
+    CheckTag<8> (copy, -1, "long copy");
+    CheckTag<9> (copy, 9, "long copy");
+    CheckTag<10> (copy, 10, "long copy");
+    CheckTag<1> (ptl, 1, "long orig");
+    CheckTag<2> (ptl, 2, "long orig");
+    CheckTag<3> (ptl, 3, "long orig");
+    CheckTag<20> (ptl, 20, "long orig");
+    CheckTag<5> (ptl, 5, "long orig");
+    CheckTag<6> (ptl, 6, "long orig");
+    CheckTag<7> (ptl, 7, "long orig");
+    CheckTag<8> (ptl, 8, "long orig");
+    CheckTag<9> (ptl, 9, "long orig");
+    CheckTag<10> (ptl, -1, "long orig");
+    ptl.RemoveAll ();
+    NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (ptl.End () - ptl.Begin ()), 0, "tags not removed");
+    CheckTag<1> (copy, 1, "long copy after RemoveAll");
+  }
+
+  { // Replace with a tag of another size
+    PacketTagList ptl;
+    ptl.Add (ATestTag<1> (1));
+    ptl.Add (AResizableTestTag (4));
+    ptl.Add (ATestTag<2> (2));
+    PacketTagList copy = ptl;
+    AResizableTestTag grown (40);
+    NS_TEST_EXPECT_MSG_EQ (ptl.Replace (grown), true, "tag not replaced");
+    CheckResizable (ptl, 40, "inline to heap");
+    CheckResizable (copy, 4, "inline to heap, copy");
+    AResizableTestTag larger (60);
+    ptl.Replace (larger);
+    CheckResizable (ptl, 60, "heap to larger heap");
+    AResizableTestTag shrunk (8);
+    ptl.Replace (shrunk);
+    CheckResizable (ptl, 8, "heap to inline");
+    AResizableTestTag same (8);
+    ptl.Replace (same);
+    CheckResizable (ptl, 8, "same size");
+    CheckTag<1> (ptl, 1, "replace");
+    CheckTag<2> (ptl, 2, "replace");
+    copy.Replace (larger);
+    CheckResizable (copy, 60, "copy inline to heap");
+  }
+
+  PacketMemoryStats after;
+  PacketTagList::GetMemoryStats (after);
+  NS_TEST_EXPECT_MSG_EQ (after.packetTags, before.packetTags, "tags leaked");
+  NS_TEST_EXPECT_MSG_EQ (after.packetTagHeapBytes, before.packetTagHeapBytes, "tag data leaked");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test header kept by the header cache, which counts its
+ * deserializations.
+ */
+class ACachedTestHeader : public Header
+{
+public:
+  /**
+   * Constructor.
+   * \param value The value of the header.
+   */
+  ACachedTestHeader (uint32_t value = 0) : m_value (value) {}
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ACachedTestHeader")
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<ACachedTestHeader> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return 4;
+  }
+  virtual void Serialize (Buffer::Iterator iter) const {
+    iter.WriteHtonU32 (m_value);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator iter) {
+    m_deserialized++;
+    m_value = iter.ReadNtohU32 ();
+    return 4;
+  }
+  virtual void Print (std::ostream &os) const {
+    os << m_value;
+  }
+  uint32_t m_value;                 //!< The value of the header.
+  static uint32_t m_deserialized;   //!< The number of deserializations.
+};
+
+uint32_t ACachedTestHeader::m_deserialized = 0;
+
+namespace ns3 {
+
+/** Keep the test headers in the header cache. */
+template <>
+struct HeaderCacheTraits<ACachedTestHeader>
+{
+  static const bool cached = true;  //!< Cache the headers.
+  /**
+   * \param header the header.
+   * \returns true if the value of the header is not 0.
+   */
+  static bool IsCached (const ACachedTestHeader &header)
+  {
+    return header.m_value != 0;
+  }
+};
+
+} // namespace ns3
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet header cache unit tests.
+ */
+class PacketHeaderCacheTest : public TestCase
+{
+public:
+  PacketHeaderCacheTest ();
+private:
+  virtual void DoRun (void);
+};
+
+PacketHeaderCacheTest::PacketHeaderCacheTest ()
+  : TestCase ("Packet header cache")
+{
+}
+
+void
+PacketHeaderCacheTest::DoRun (void)
+{
+  Packet::EnableHeaderCache ();
+  ACachedTestHeader::m_deserialized = 0;
+
+  Ptr<Packet> p = Create<Packet> (10);
+  p->AddHeader (ACachedTestHeader (7));
+  uint8_t bytes[4];
+  p->CopyData (bytes, 4);
+  NS_TEST_EXPECT_MSG_EQ (bytes[3], 7, "the header is not serialized");
+
+  ACachedTestHeader h;
+  NS_TEST_EXPECT_MSG_EQ (p->PeekHeader (h), 4, "wrong size peeked");
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 7, "wrong header peeked");
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 0, "the header is deserialized");
+
+  // a header which is not kept above the cached one
+  Ptr<Packet> copy = p->Copy ();
+  p->AddHeader (ATestHeader<3> ());
+  p->AddHeader (ATestHeader<2> ());
+  ATestHeader<2> two;
+  p->RemoveHeader (two);
+  p->RemoveAtStart (3);
+  h.m_value = 0;
+  NS_TEST_EXPECT_MSG_EQ (p->RemoveHeader (h), 4, "wrong size removed");
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 7, "wrong header removed");
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 0, "the header is deserialized");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 10, "wrong packet size");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekHeader (h), 4, "wrong size peeked");
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 0, "the payload is read from the header cache");
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 1, "the payload is not deserialized");
+
+  // the copies share the kept header
+  NS_TEST_EXPECT_MSG_EQ (copy->RemoveHeader (h), 4, "wrong size removed");
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 7, "wrong header removed");
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 1, "the header is deserialized");
+
+  // removing a part of the header drops it
+  copy->AddHeader (ACachedTestHeader (8));
+  copy->RemoveAtStart (1);
+  copy->PeekHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 2, "the header is not deserialized");
+
+  // a header added through its base class is not kept
+  ACachedTestHeader nine (9);
+  const Header &base = nine;
+  copy->AddHeader (base);
+  copy->PeekHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 9, "wrong header peeked");
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 3, "the header is not deserialized");
+
+  // fragments do not keep the headers
+  copy->AddHeader (ACachedTestHeader (10));
+  Ptr<Packet> fragment = copy->CreateFragment (0, 8);
+  fragment->RemoveHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 10, "wrong header removed");
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 4, "the header is not deserialized");
+
+  // removing the end of the packet into the header drops it
+  copy->RemoveAtEnd (copy->GetSize ());
+  copy->AddHeader (ACachedTestHeader (10));
+  copy->RemoveAtEnd (3);
+  copy->AddPaddingAtEnd (3);
+  NS_TEST_EXPECT_MSG_EQ (copy->PeekHeader (h), 4, "wrong size peeked");
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 5, "the header is not deserialized");
+
+  // the headers refused by their traits are not kept
+  copy->AddHeader (ACachedTestHeader (0));
+  copy->PeekHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 6, "the header is not deserialized");
+
+  // a copy which adds a header does not change the headers of the original
+  Ptr<Packet> original = Create<Packet> (10);
+  original->AddHeader (ACachedTestHeader (11));
+  Ptr<Packet> modified = original->Copy ();
+  modified->AddHeader (ACachedTestHeader (12));
+  NS_TEST_EXPECT_MSG_EQ (original->RemoveHeader (h), 4, "wrong size removed");
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 11, "wrong header removed");
+  NS_TEST_EXPECT_MSG_EQ (modified->RemoveHeader (h), 4, "wrong size removed");
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 12, "wrong header removed");
+  NS_TEST_EXPECT_MSG_EQ (modified->RemoveHeader (h), 4, "wrong size removed");
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 11, "wrong header removed");
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 6, "the header is deserialized");
+
+  // the packets do not keep the headers once the cache is disabled
+  Packet::DisableHeaderCache ();
+  Ptr<Packet> disabled = Create<Packet> (10);
+  disabled->AddHeader (ACachedTestHeader (13));
+  disabled->RemoveHeader (h);
+  NS_TEST_EXPECT_MSG_EQ (h.m_value, 13, "wrong header removed");
+  NS_TEST_EXPECT_MSG_EQ (ACachedTestHeader::m_deserialized, 7, "the header is not deserialized");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet memory statistics unit tests.
+ */
+class PacketMemoryStatsTest : public TestCase
+{
+public:
+  PacketMemoryStatsTest ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Count the samples of the monitor.
+   * \param stats The statistics sampled.
+   */
+  void Sampled (const PacketMemoryStats &stats);
+  uint32_t m_samples; //!< The number of samples
+};
+
+PacketMemoryStatsTest::PacketMemoryStatsTest ()
+  : TestCase ("Packet memory statistics"),
+    m_samples (0)
+{
+}
+
+void
+PacketMemoryStatsTest::Sampled (const PacketMemoryStats &stats)
+{
+  NS_UNUSED (stats);
+  m_samples++;
+}
+
+void
+PacketMemoryStatsTest::DoRun (void)
+{
+  PacketMemoryStats before = Packet::GetMemoryStats ();
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (ATestHeader<10> ());
+  p->AddPacketTag (ATestTag<2> ());
+  Ptr<Packet> copy = p->Copy ();
+  PacketMemoryStats stats = Packet::GetMemoryStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.packets, before.packets + 2, "the packets are not counted");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (stats.peakPackets, stats.packets, "wrong peak of packets");
+  NS_TEST_EXPECT_MSG_GT (stats.bufferBytes, 0, "the buffer is not counted");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (stats.peakBufferBytes, stats.bufferBytes, "wrong peak of bytes");
+  NS_TEST_EXPECT_MSG_EQ (stats.packetTags, before.packetTags + 2, "the tags are not counted");
+
+  ATestTag<2> tag;
+  copy->RemovePacketTag (tag);
+  copy = 0;
+  stats = Packet::GetMemoryStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.packets, before.packets + 1, "the packets are not released");
+  NS_TEST_EXPECT_MSG_EQ (stats.packetTags, before.packetTags + 1, "the tags are not released");
+  p = 0;
+  stats = Packet::GetMemoryStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.packets, before.packets, "the packets are not released");
+  NS_TEST_EXPECT_MSG_EQ (stats.packetTags, before.packetTags, "the tags are not released");
+  NS_TEST_EXPECT_MSG_GT (stats.bufferFreeList, 0, "the buffer is not recycled");
+
+  // the blocks in the free lists are returned to the allocator
+  Packet::SetFreeListLimits (0, 0);
+  stats = Packet::GetMemoryStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.bufferFreeList, 0, "the buffer free list is not trimmed");
+  NS_TEST_EXPECT_MSG_EQ (stats.bufferFreeListBytes, 0, "the buffer free list is not trimmed");
+  NS_TEST_EXPECT_MSG_EQ (stats.metadataFreeList, 0, "the metadata free list is not trimmed");
+  NS_TEST_EXPECT_MSG_EQ (stats.metadataFreeListBytes, 0, "the metadata free list is not trimmed");
+  NS_TEST_EXPECT_MSG_LT (stats.bufferBytes, before.bufferBytes + 1,
+                         "the buffer is not released");
+  Create<Packet> (100);
+  NS_TEST_EXPECT_MSG_EQ (Packet::GetMemoryStats ().bufferFreeList, 0, "the buffer is kept");
+  Packet::SetFreeListLimits (1000, 1000);
+
+  // the monitor samples the statistics every interval
+  p = Create<Packet> (100);
+  Ptr<PacketMemoryMonitor> monitor = CreateObject<PacketMemoryMonitor> ();
+  monitor->SetAttribute ("Interval", TimeValue (Seconds (1)));
+  monitor->TraceConnectWithoutContext ("Stats",
+                                       MakeCallback (&PacketMemoryStatsTest::Sampled, this));
+  monitor->Start ();
+  Simulator::Stop (Seconds (2.5));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_samples, 3, "wrong number of samples");
+  NS_TEST_EXPECT_MSG_EQ (monitor->GetLastSample ().packets, before.packets + 1,
+                         "wrong last sample");
+  monitor->Dispose ();
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1548,9 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketTagListStorageTest, TestCase::QUICK);
+  AddTestCase (new PacketHeaderCacheTest, TestCase::QUICK);
+  AddTestCase (new PacketMemoryStatsTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,315 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/packet.h"
+#include "ns3/packet-memory-stats.h"
+#include "ns3/header.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * A header holding a sequence number.
+ */
+class SequenceHeader : public Header
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * Constructor.
+   * \param [in] sequence The sequence number.
+   */
+  SequenceHeader (uint32_t sequence = 0);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  uint32_t m_sequence; //!< The sequence number.
+};
+
+TypeId
+SequenceHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("anon::SequenceHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Network")
+    .HideFromDocumentation ()
+    .AddConstructor<SequenceHeader> ()
+  ;
+  return tid;
+}
+
+SequenceHeader::SequenceHeader (uint32_t sequence)
+  : m_sequence (sequence)
+{
+}
+
+TypeId
+SequenceHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+SequenceHeader::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+SequenceHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU32 (m_sequence);
+}
+
+uint32_t
+SequenceHeader::Deserialize (Buffer::Iterator start)
+{
+  m_sequence = start.ReadNtohU32 ();
+  return 4;
+}
+
+void
+SequenceHeader::Print (std::ostream &os) const
+{
+  os << "sequence=" << m_sequence;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * A queue of packets handed from a thread to another one.
+ */
+class PacketChannel
+{
+public:
+  /**
+   * Hand a packet to the other thread.
+   *
+   * The reference of the sender is released with the lock held, so
+   * that the reference count is never updated by both threads at once.
+   *
+   * \param [in,out] p The packet, or 0 at the end of the stream; reset to 0.
+   */
+  void Send (Ptr<Packet> &p)
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_packets.push_back (p);
+    p = 0;
+    m_condition.notify_one ();
+  }
+  /**
+   * Wait for a packet from the other thread.
+   * \returns The packet, or 0 at the end of the stream.
+   */
+  Ptr<Packet> Receive (void)
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    while (m_packets.empty ())
+      {
+        m_condition.wait (lock);
+      }
+    Ptr<Packet> p = m_packets.front ();
+    m_packets.pop_front ();
+    return p;
+  }
+
+private:
+  std::mutex m_mutex;                     //!< Protects m_packets.
+  std::condition_variable m_condition;    //!< Signals a new packet.
+  std::deque<Ptr<Packet> > m_packets;     //!< The packets in transit.
+};
+
+} // unnamed namespace
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Hand packets between threads, which create, modify and release them.
+ * With atomic reference counts, the sender also keeps modifying a copy
+ * of every packet it sends.
+ */
+class PacketThreadTestCase : public TestCase
+{
+public:
+  PacketThreadTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** The results of a pair of threads. */
+  struct Pair
+  {
+    PacketChannel channel;              //!< The packets handed over.
+    std::vector<uint64_t> uids;         //!< The uids of the packets received.
+    uint32_t errors;                    //!< The packets received corrupted.
+    uint32_t senderErrors;              //!< The copies corrupted at the sender.
+  };
+
+  /**
+   * Create and send packets.
+   * \param [in,out] pair The pair of threads.
+   */
+  static void Sender (Pair *pair);
+  /**
+   * Receive and check packets.
+   * \param [in,out] pair The pair of threads.
+   */
+  static void Receiver (Pair *pair);
+
+  /** The number of packets sent by each sender. */
+  static const uint32_t PACKETS = 20000;
+  /** The number of pairs of threads. */
+  static const uint32_t PAIRS = 4;
+};
+
+PacketThreadTestCase::PacketThreadTestCase ()
+  : TestCase ("Hand packets between threads")
+{
+}
+
+void
+PacketThreadTestCase::Sender (Pair *pair)
+{
+  for (uint32_t i = 0; i < PACKETS; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (100 + i % 200);
+      p->AddHeader (SequenceHeader (i));
+#ifdef NS3_ATOMIC_REFCOUNT
+      Ptr<Packet> copy = p->Copy ();
+      pair->channel.Send (p);
+      copy->AddHeader (SequenceHeader (~i));
+      SequenceHeader header;
+      copy->RemoveHeader (header);
+      if (header.m_sequence != ~i)
+        {
+          pair->senderErrors++;
+        }
+      copy->RemoveHeader (header);
+      if (header.m_sequence != i)
+        {
+          pair->senderErrors++;
+        }
+#else
+      pair->channel.Send (p);
+#endif
+    }
+  Ptr<Packet> end = 0;
+  pair->channel.Send (end);
+}
+
+void
+PacketThreadTestCase::Receiver (Pair *pair)
+{
+  uint32_t expected = 0;
+  for (Ptr<Packet> p = pair->channel.Receive (); p; p = pair->channel.Receive ())
+    {
+      pair->uids.push_back (p->GetUid ());
+      p->AddHeader (SequenceHeader (expected + 1));
+      SequenceHeader header;
+      p->RemoveHeader (header);
+      if (header.m_sequence != expected + 1)
+        {
+          pair->errors++;
+        }
+      p->RemoveHeader (header);
+      if (header.m_sequence != expected
+          || p->GetSize () != 100 + expected % 200)
+        {
+          pair->errors++;
+        }
+      expected++;
+    }
+}
+
+void
+PacketThreadTestCase::DoRun (void)
+{
+  // register the header and create the simulator before the threads
+  SequenceHeader::GetTypeId ();
+  Create<Packet> ();
+  PacketMemoryStats before = Packet::GetMemoryStats ();
+
+  std::vector<Pair> pairs (PAIRS);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < PAIRS; ++i)
+    {
+      pairs[i].errors = 0;
+      pairs[i].senderErrors = 0;
+      threads.push_back (std::thread (&PacketThreadTestCase::Sender, &pairs[i]));
+      threads.push_back (std::thread (&PacketThreadTestCase::Receiver, &pairs[i]));
+    }
+  for (std::vector<std::thread>::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      i->join ();
+    }
+
+  std::vector<uint64_t> uids;
+  for (uint32_t i = 0; i < PAIRS; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (pairs[i].uids.size (), PACKETS, "packets lost");
+      NS_TEST_EXPECT_MSG_EQ (pairs[i].errors, 0, "packets corrupted");
+      NS_TEST_EXPECT_MSG_EQ (pairs[i].senderErrors, 0, "copies corrupted");
+      uids.insert (uids.end (), pairs[i].uids.begin (), pairs[i].uids.end ());
+    }
+  std::sort (uids.begin (), uids.end ());
+  bool unique = std::adjacent_find (uids.begin (), uids.end ()) == uids.end ();
+  NS_TEST_EXPECT_MSG_EQ (unique, true, "two packets have the same uid");
+
+  // the packets counted by the senders are released by the receivers
+  PacketMemoryStats after = Packet::GetMemoryStats ();
+  NS_TEST_EXPECT_MSG_EQ (after.packets, before.packets, "wrong number of packets");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Packet thread safety TestSuite
+ */
+class PacketThreadTestSuite : public TestSuite
+{
+public:
+  PacketThreadTestSuite ();
+};
+
+PacketThreadTestSuite::PacketThreadTestSuite ()
+  : TestSuite ("packet-thread", UNIT)
+{
+  AddTestCase (new PacketThreadTestCase, TestCase::QUICK);
+}
+
+static PacketThreadTestSuite g_packetThreadTestSuite; //!< Static variable for test initialization
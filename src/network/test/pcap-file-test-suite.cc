@@ -25,6 +25,11 @@
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#ifndef _WIN32
+#include "ns3/warm-start.h"
+#endif
 
 using namespace ns3;
 
@@ -1144,6 +1149,266 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the files written by a background
+ * thread are the same as the files written directly.
+ */
+class AsyncWriteTestCase : public TestCase
+{
+public:
+  AsyncWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase ()
+  : TestCase ("Check that PcapFile::OpenAsync writes the same file as PcapFile::Open")
+{
+}
+
+void
+AsyncWriteTestCase::DoRun (void)
+{
+  //
+  // Copy the known packets to a file written directly and to a file written
+  // in the background, with buffers smaller than some of the records.
+  //
+  std::string known = CreateDataDirFilename ("known.pcap");
+  std::string direct = CreateTempDirFilename ("direct.pcap");
+  std::string async = CreateTempDirFilename ("async.pcap");
+  PcapFile in, out, asyncOut;
+  in.Open (known, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Open (" << known << ", \"std::ios::in\") returns error");
+  out.Open (direct, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (out.Fail (), false, "Open (" << direct << ", \"std::ios::out\") returns error");
+  asyncOut.OpenAsync (async, 100);
+  NS_TEST_ASSERT_MSG_EQ (asyncOut.Fail (), false, "OpenAsync (" << async << ") returns error");
+  out.Init (in.GetDataLinkType (), in.GetSnapLen ());
+  asyncOut.Init (in.GetDataLinkType (), in.GetSnapLen ());
+
+  uint8_t data[2000];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      in.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Read() of known good packet " << i << " returns error");
+      out.Write (tsSec, tsUsec, data, readLen);
+      asyncOut.Write (tsSec, tsUsec, data, readLen);
+    }
+  out.Close ();
+  asyncOut.Close ();
+  NS_TEST_EXPECT_MSG_EQ (asyncOut.Fail (), false, "The background writes should not fail");
+
+  uint32_t sec (0), usec (0), packets (0);
+  bool diff = PcapFile::Diff (direct, async, sec, usec, packets);
+  NS_TEST_EXPECT_MSG_EQ (diff, false, "The files should be the same");
+  NS_TEST_EXPECT_MSG_EQ (packets, N_KNOWN_PACKETS, "The files should have all the known packets");
+
+  //
+  // The packets written in the background are truncated to the snap length.
+  //
+  asyncOut.OpenAsync (async, 1000);
+  asyncOut.Init (1, 64);
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      asyncOut.Write (0, i, Create<Packet> (1000 + i));
+    }
+  asyncOut.Close ();
+  in.Close ();
+  in.Open (async, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Open (" << async << ", \"std::ios::in\") returns error");
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      in.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Read() of packet " << i << " returns error");
+      NS_TEST_EXPECT_MSG_EQ (tsUsec, i, "Wrong time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (inclLen, 64, "Wrong saved length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (origLen, 1000 + i, "Wrong length of packet " << i);
+    }
+  in.Close ();
+
+  //
+  // The files written together share the thread, and their buffers grow
+  // up to the maximum size.
+  //
+  const uint32_t files = 3;
+  PcapFile shared[files];
+  std::string names[files];
+  for (uint32_t i = 0; i < files; ++i)
+    {
+      std::ostringstream name;
+      name << "shared-" << i << ".pcap";
+      names[i] = CreateTempDirFilename (name.str ());
+      shared[i].OpenAsync (names[i], 1 << 20);
+      NS_TEST_ASSERT_MSG_EQ (shared[i].Fail (), false, "OpenAsync (" << names[i] << ") returns error");
+      shared[i].Init (1);
+    }
+  for (uint32_t j = 0; j < 2000; ++j)
+    {
+      for (uint32_t i = 0; i < files; ++i)
+        {
+          shared[i].Write (0, j, Create<Packet> (100 + i + j % 1000));
+        }
+    }
+  for (uint32_t i = 0; i < files; ++i)
+    {
+      shared[i].Close ();
+      NS_TEST_EXPECT_MSG_EQ (shared[i].Fail (), false, "The background writes should not fail");
+      in.Open (names[i], std::ios::in);
+      NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Open (" << names[i] << ", \"std::ios::in\") returns error");
+      for (uint32_t j = 0; j < 2000; ++j)
+        {
+          in.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+          NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Read() of packet " << j << " of file " << i << " returns error");
+          NS_TEST_EXPECT_MSG_EQ (tsUsec, j, "Wrong time of packet " << j << " of file " << i);
+          NS_TEST_EXPECT_MSG_EQ (origLen, 100 + i + j % 1000, "Wrong length of packet " << j << " of file " << i);
+        }
+      in.Close ();
+    }
+
+  //
+  // The compressed files are gzip files, or uncompressed pcap files when
+  // ns-3 is built without zlib.
+  //
+  if (AsyncFileWriter::IsCompressionSupported ())
+    {
+      std::string compressed = CreateTempDirFilename ("async.pcap.gz");
+      asyncOut.OpenAsync (compressed, 1000, true);
+      NS_TEST_ASSERT_MSG_EQ (asyncOut.Fail (), false, "OpenAsync (" << compressed << ", true) returns error");
+      asyncOut.Init (1);
+      asyncOut.Close ();
+      std::ifstream gz (compressed.c_str (), std::ios::in | std::ios::binary);
+      unsigned char magic[2] = { 0, 0 };
+      gz.read ((char *)magic, 2);
+      NS_TEST_EXPECT_MSG_EQ ((magic[0] == 0x1f && magic[1] == 0x8b), true, "The file should be compressed with gzip");
+    }
+  else
+    {
+      asyncOut.OpenAsync (async, 1000, true);
+      NS_TEST_ASSERT_MSG_EQ (asyncOut.Fail (), false, "OpenAsync (" << async << ", true) returns error");
+      asyncOut.Init (1);
+      asyncOut.Close ();
+      in.Open (async, std::ios::in);
+      NS_TEST_EXPECT_MSG_EQ (in.Fail (), false, "The file should be written uncompressed");
+      in.Close ();
+    }
+}
+
+#ifndef _WIN32
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the files written in the background
+ * are flushed before a fork, and that a forked process can write its
+ * own files.
+ */
+class AsyncWriteForkTestCase : public TestCase
+{
+public:
+  AsyncWriteForkTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Write packets to the file open before the fork in the original
+   * process, and to a new file in the other branch.
+   */
+  void WriteBranch (void);
+
+  PcapFile m_shared;          //!< The file open before the fork.
+  std::string m_sharedName;   //!< The name of the file open before the fork.
+  std::string m_branchName;   //!< The name of the file of the other branch.
+};
+
+AsyncWriteForkTestCase::AsyncWriteForkTestCase ()
+  : TestCase ("Check that the files written in the background survive a WarmStart fork")
+{
+}
+
+void
+AsyncWriteForkTestCase::WriteBranch (void)
+{
+  if (WarmStart::GetBranch () != 0)
+    {
+      PcapFile file;
+      file.OpenAsync (m_branchName, 1000);
+      NS_TEST_ASSERT_MSG_EQ (file.Fail (), false, "OpenAsync (" << m_branchName << ") returns error");
+      file.Init (1);
+      for (uint32_t i = 0; i < 100; ++i)
+        {
+          file.Write (1, i, Create<Packet> (200 + i));
+        }
+      file.Close ();
+      NS_TEST_EXPECT_MSG_EQ (file.Fail (), false, "The background writes of the branch should not fail");
+      return;
+    }
+
+  // the packets written before the fork are in the file
+  NS_TEST_EXPECT_MSG_EQ (CheckFileLength (m_sharedName, 24 + 10 * (16 + 100)), true,
+                         "The file should be flushed before the fork");
+  for (uint32_t i = 10; i < 20; ++i)
+    {
+      m_shared.Write (1, i, Create<Packet> (100));
+    }
+}
+
+void
+AsyncWriteForkTestCase::DoRun (void)
+{
+  m_sharedName = CreateTempDirFilename ("async-fork.pcap");
+  m_branchName = CreateTempDirFilename ("async-fork-branch.pcap");
+  m_shared.OpenAsync (m_sharedName, 1 << 20);
+  NS_TEST_ASSERT_MSG_EQ (m_shared.Fail (), false, "OpenAsync (" << m_sharedName << ") returns error");
+  m_shared.Init (1);
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      m_shared.Write (0, i, Create<Packet> (100));
+    }
+
+  WarmStart::Fork (Seconds (1), 2, MakeNullCallback<void, uint32_t> ());
+  Simulator::Schedule (Seconds (2), &AsyncWriteForkTestCase::WriteBranch, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  // the other branch exits here, failed if one of its checks failed
+  uint32_t failed = WarmStart::Wait (IsStatusFailure () ? 1 : 0);
+  NS_TEST_EXPECT_MSG_EQ (failed, 0, "branch failed");
+  m_shared.Close ();
+  NS_TEST_EXPECT_MSG_EQ (m_shared.Fail (), false, "The background writes should not fail");
+
+  uint8_t data[2000];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  PcapFile in;
+  in.Open (m_sharedName, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Open (" << m_sharedName << ", \"std::ios::in\") returns error");
+  for (uint32_t i = 0; i < 20; ++i)
+    {
+      in.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Read() of packet " << i << " returns error");
+      NS_TEST_EXPECT_MSG_EQ (tsSec, i / 10, "Wrong time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (tsUsec, i, "Wrong time of packet " << i);
+    }
+  in.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (in.Eof (), true, "The packets should be written once");
+  in.Close ();
+  in.Clear ();
+
+  in.Open (m_branchName, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Open (" << m_branchName << ", \"std::ios::in\") returns error");
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      in.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Read() of packet " << i << " of the branch returns error");
+      NS_TEST_EXPECT_MSG_EQ (origLen, 200 + i, "Wrong length of packet " << i << " of the branch");
+    }
+  in.Close ();
+}
+#endif /* _WIN32 */
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1432,10 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncWriteTestCase, TestCase::QUICK);
+#ifndef _WIN32
+  AddTestCase (new AsyncWriteForkTestCase, TestCase::QUICK);
+#endif
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
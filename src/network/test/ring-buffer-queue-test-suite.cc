@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ring-buffer-queue.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/string.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * RingBufferQueue unit tests.
+ */
+class RingBufferQueueTestCase : public TestCase
+{
+public:
+  RingBufferQueueTestCase ();
+  virtual void DoRun (void);
+};
+
+RingBufferQueueTestCase::RingBufferQueueTestCase ()
+  : TestCase ("Sanity check on the ring buffer queue implementation")
+{
+}
+void
+RingBufferQueueTestCase::DoRun (void)
+{
+  Ptr<RingBufferQueue<Packet> > queue = CreateObject<RingBufferQueue<Packet> > ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxSize", StringValue ("3p")), true,
+                         "Verify that we can actually set the attribute");
+
+  Ptr<Packet> p1, p2, p3, p4;
+  p1 = Create<Packet> (10);
+  p2 = Create<Packet> (20);
+  p3 = Create<Packet> (30);
+  p4 = Create<Packet> (40);
+
+  NS_TEST_EXPECT_MSG_EQ ((queue->Peek () == 0), true, "There should be no packet to peek");
+  NS_TEST_EXPECT_MSG_EQ ((queue->Dequeue () == 0), true, "There should be no packet to dequeue");
+  queue->Enqueue (p1);
+  queue->Enqueue (p2);
+  queue->Enqueue (p3);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 3, "There should be three packets in there");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 60, "There should be 60 bytes in there");
+  NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (p4), false, "The fourth packet should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPacketsBeforeEnqueue (), 1, "One packet should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->Peek ()->GetUid (), p1->GetUid (), "The first packet should be peeked");
+
+  Ptr<Packet> packet = queue->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), p1->GetUid (), "Was this the first packet ?");
+  packet = queue->Remove ();
+  NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), p2->GetUid (), "Was this the second packet ?");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPacketsAfterDequeue (), 1, "One packet should be removed");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 1, "There should be one packet in there");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 30, "There should be 30 bytes in there");
+
+  // wrap around the end of the ring buffer many times
+  uint32_t capacity = queue->GetCapacity ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (Create<Packet> (i)), true, "The packet should be enqueued");
+      packet = queue->Dequeue ();
+      NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), (i == 0 ? 30 : i - 1), "The packets should be in order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetCapacity (), capacity, "The ring buffer should not grow");
+
+  queue->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+
+  // grow the ring buffer while it wraps around
+  queue->SetMaxSize (QueueSize ("100p"));
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      queue->Enqueue (Create<Packet> (i));
+    }
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      queue->Dequeue ();
+    }
+  for (uint32_t i = 10; i < 100; i++)
+    {
+      queue->Enqueue (Create<Packet> (i));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 95, "There should be 95 packets in there");
+  for (uint32_t i = 5; i < 100; i++)
+    {
+      packet = queue->Dequeue ();
+      NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), i, "The packets should be in order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetCapacity (), 128, "The ring buffer should hold 128 packets");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a RingBufferQueue fires the same trace sources and keeps the
+ * same statistics as a DropTailQueue.
+ */
+class RingBufferQueueTraceTestCase : public TestCase
+{
+public:
+  RingBufferQueueTraceTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Record a trace.
+   * \param [in] trace The trace the item is recorded in.
+   * \param [in] context The trace source.
+   * \param [in] item The item.
+   */
+  static void Record (std::ostringstream *trace, std::string context, Ptr<const Packet> item);
+  /**
+   * Apply the same operations to a queue.
+   * \param [in] queue The queue.
+   * \returns The trace and the statistics of the queue.
+   */
+  static std::string Run (Ptr<Queue<Packet> > queue);
+};
+
+RingBufferQueueTraceTestCase::RingBufferQueueTraceTestCase ()
+  : TestCase ("Check the trace sources of the ring buffer queue")
+{
+}
+
+void
+RingBufferQueueTraceTestCase::Record (std::ostringstream *trace, std::string context, Ptr<const Packet> item)
+{
+  *trace << context << " " << item->GetSize () << std::endl;
+}
+
+std::string
+RingBufferQueueTraceTestCase::Run (Ptr<Queue<Packet> > queue)
+{
+  std::ostringstream trace;
+  const char *sources[] = { "Enqueue", "Dequeue", "Drop", "DropBeforeEnqueue", "DropAfterDequeue" };
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      queue->TraceConnect (sources[i], sources[i], MakeBoundCallback (&RingBufferQueueTraceTestCase::Record, &trace));
+    }
+  queue->SetMaxSize (QueueSize ("1000B"));
+
+  Ptr<Packet> packets[64];
+  for (uint32_t i = 0; i < 64; i++)
+    {
+      packets[i] = Create<Packet> (100 + (i * 37) % 100);
+    }
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      switch ((i * 7) % 5)
+        {
+        case 0:
+        case 1:
+        case 2:
+          queue->Enqueue (packets[i % 64]->Copy ());
+          break;
+        case 3:
+          queue->Dequeue ();
+          break;
+        case 4:
+          queue->Remove ();
+          break;
+        }
+      trace << queue->GetNPackets () << " " << queue->GetNBytes () << std::endl;
+    }
+  trace << queue->GetTotalReceivedPackets () << " " << queue->GetTotalReceivedBytes () << " "
+        << queue->GetTotalDroppedPacketsBeforeEnqueue () << " " << queue->GetTotalDroppedBytesBeforeEnqueue () << " "
+        << queue->GetTotalDroppedPacketsAfterDequeue () << " " << queue->GetTotalDroppedBytesAfterDequeue ();
+  return trace.str ();
+}
+
+void
+RingBufferQueueTraceTestCase::DoRun (void)
+{
+  std::string expected = Run (CreateObject<DropTailQueue<Packet> > ());
+  std::string actual = Run (CreateObject<RingBufferQueue<Packet> > ());
+  NS_TEST_EXPECT_MSG_EQ ((actual.size () > 0), true, "The trace should not be empty");
+  NS_TEST_EXPECT_MSG_EQ ((actual == expected), true, "The traces of the queues should be the same");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief RingBufferQueue TestSuite
+ */
+class RingBufferQueueTestSuite : public TestSuite
+{
+public:
+  RingBufferQueueTestSuite ()
+    : TestSuite ("ring-buffer-queue", UNIT)
+  {
+    AddTestCase (new RingBufferQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new RingBufferQueueTraceTestCase (), TestCase::QUICK);
+  }
+};
+
+static RingBufferQueueTestSuite g_ringBufferQueueTestSuite; //!< Static variable for test initialization
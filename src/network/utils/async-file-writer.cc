@@ -0,0 +1,493 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-file-writer.h"
+#include "ns3/core-config.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_PTHREAD_H
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <pthread.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AsyncFileWriter");
+
+/** The initial size of the buffers, if the maximum size is larger. */
+static const uint32_t INITIAL_BUFFER_SIZE = 64 << 10;
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * \ingroup network
+ *
+ * The thread writing the buffers of all the AsyncFileWriters.
+ *
+ * Only the forking thread is copied by fork(), so the writers are
+ * flushed and the thread is kept idle while the process forks, then the
+ * child starts its own thread.
+ */
+class AsyncFileWriterThread
+{
+public:
+  /**
+   * \returns The thread; it is never deleted, so that the writers can be
+   *          closed at any time before the exit.
+   */
+  static AsyncFileWriterThread * Get (void)
+  {
+    static AsyncFileWriterThread *thread = new AsyncFileWriterThread ();
+    return thread;
+  }
+
+  /**
+   * Register an open writer, starting the thread if it is the first one.
+   * \param [in] writer The writer.
+   */
+  void Acquire (AsyncFileWriter *writer)
+  {
+    std::unique_lock<std::mutex> start (m_startMutex);
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_writers.push_back (writer);
+    if (m_writers.size () == 1)
+      {
+        m_stop = false;
+        m_thread = std::thread (&AsyncFileWriterThread::Run, this);
+      }
+  }
+
+  /**
+   * Unregister a closed writer, whose buffers are written, stopping the
+   * thread if it is the last one.
+   * \param [in] writer The writer.
+   */
+  void Release (AsyncFileWriter *writer)
+  {
+    std::unique_lock<std::mutex> start (m_startMutex);
+    {
+      std::unique_lock<std::mutex> lock (m_mutex);
+      std::vector<AsyncFileWriter *>::iterator i = std::find (m_writers.begin (), m_writers.end (), writer);
+      NS_ASSERT (i != m_writers.end ());
+      m_writers.erase (i);
+      if (!m_writers.empty ())
+        {
+          return;
+        }
+      m_stop = true;
+    }
+    m_condition.notify_all ();
+    m_thread.join ();
+  }
+
+  /**
+   * Wait until the previous buffer of a writer is written.
+   * \param [in] writer The writer.
+   * \returns true if the writer had to wait.
+   */
+  bool Wait (AsyncFileWriter *writer)
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    bool waited = writer->m_pending;
+    while (writer->m_pending)
+      {
+        m_condition.wait (lock);
+      }
+    return waited;
+  }
+
+  /**
+   * Hand a buffer to the thread; the previous buffer of the writer must
+   * be written.
+   * \param [in] writer The writer.
+   * \param [in] buffer The index of the buffer.
+   * \param [in] size The number of bytes to write.
+   */
+  void Submit (AsyncFileWriter *writer, uint32_t buffer, uint32_t size)
+  {
+    {
+      std::unique_lock<std::mutex> lock (m_mutex);
+      NS_ASSERT (!writer->m_pending);
+      writer->m_pending = true;
+      Job job = { writer, buffer, size };
+      m_jobs.push_back (job);
+    }
+    m_condition.notify_all ();
+  }
+
+private:
+  AsyncFileWriterThread ()
+    : m_stop (false)
+  {
+    pthread_atfork (&AsyncFileWriterThread::PrepareFork,
+                    &AsyncFileWriterThread::ParentFork,
+                    &AsyncFileWriterThread::ChildFork);
+  }
+
+  /**
+   * Called before fork(): write all the buffered bytes, so that they are
+   * not written again by the child, and keep the thread idle.
+   */
+  static void PrepareFork (void)
+  {
+    AsyncFileWriterThread *thread = Get ();
+    thread->m_startMutex.lock ();
+    std::vector<AsyncFileWriter *> writers;
+    {
+      std::unique_lock<std::mutex> lock (thread->m_mutex);
+      writers = thread->m_writers;
+    }
+    for (std::vector<AsyncFileWriter *>::const_iterator i = writers.begin (); i != writers.end (); ++i)
+      {
+        (*i)->Submit ();
+        thread->Wait (*i);
+        (*i)->FlushFile ();
+      }
+    thread->m_mutex.lock ();
+  }
+
+  /** Called by the parent after fork(). */
+  static void ParentFork (void)
+  {
+    AsyncFileWriterThread *thread = Get ();
+    thread->m_mutex.unlock ();
+    thread->m_startMutex.unlock ();
+  }
+
+  /**
+   * Called by the child after fork(): the thread and the threads waiting
+   * on the condition do not exist in the child, so the synchronization
+   * objects are built again, without destroying the copies, and a new
+   * thread is started for the open writers.
+   */
+  static void ChildFork (void)
+  {
+    AsyncFileWriterThread *thread = Get ();
+    new (&thread->m_startMutex) std::mutex ();
+    new (&thread->m_mutex) std::mutex ();
+    new (&thread->m_condition) std::condition_variable ();
+    new (&thread->m_thread) std::thread ();
+    NS_ASSERT (thread->m_jobs.empty ());
+    thread->m_stop = false;
+    if (!thread->m_writers.empty ())
+      {
+        thread->m_thread = std::thread (&AsyncFileWriterThread::Run, thread);
+      }
+  }
+
+  /** A buffer to write. */
+  struct Job
+  {
+    AsyncFileWriter *writer;  //!< The writer.
+    uint32_t buffer;          //!< The index of the buffer.
+    uint32_t size;            //!< The number of bytes to write.
+  };
+
+  /** The loop of the thread. */
+  void Run (void)
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    while (true)
+      {
+        while (m_jobs.empty () && !m_stop)
+          {
+            m_condition.wait (lock);
+          }
+        if (m_jobs.empty ())
+          {
+            return;
+          }
+        Job job = m_jobs.front ();
+        m_jobs.pop_front ();
+        // the writer does not touch a submitted buffer
+        lock.unlock ();
+        job.writer->WriteFile (&job.writer->m_buffers[job.buffer][0], job.size);
+        lock.lock ();
+        job.writer->m_pending = false;
+        m_condition.notify_all ();
+      }
+  }
+
+  std::mutex m_startMutex;             //!< Serialize the starts and stops of the thread.
+  std::thread m_thread;                //!< The thread.
+  std::mutex m_mutex;                  //!< Protect the state below.
+  std::condition_variable m_condition; //!< Signal the changes of the state.
+  std::vector<AsyncFileWriter *> m_writers; //!< The open writers.
+  bool m_stop;                         //!< Stop the thread.
+  std::deque<Job> m_jobs;              //!< The buffers to write, in order.
+};
+#endif /* HAVE_PTHREAD_H */
+
+AsyncFileWriter::AsyncFileWriter ()
+  : m_bufferSize (0),
+    m_current (0),
+    m_gzFile (0),
+    m_open (false),
+    m_failed (false),
+    m_waits (0),
+    m_pending (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AsyncFileWriter::~AsyncFileWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+AsyncFileWriter::IsCompressionSupported (void)
+{
+#ifdef HAVE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool
+AsyncFileWriter::Open (std::string const &filename, uint32_t bufferSize, bool compress)
+{
+  NS_LOG_FUNCTION (this << filename << bufferSize << compress);
+  NS_ASSERT_MSG (!m_open, "AsyncFileWriter::Open(): the file is already open");
+  NS_ASSERT (bufferSize > 0);
+  if (compress && !IsCompressionSupported ())
+    {
+      NS_LOG_WARN ("Cannot compress " << filename << ": ns-3 is built without zlib, "
+                   "the file is written uncompressed");
+      compress = false;
+    }
+  if (compress)
+    {
+#ifdef HAVE_ZLIB
+      // favor the speed: the thread should keep up with the simulation
+      m_gzFile = gzopen (filename.c_str (), "wb1");
+      if (m_gzFile == 0)
+        {
+          return false;
+        }
+#endif
+    }
+  else
+    {
+      m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!m_file.is_open ())
+        {
+          return false;
+        }
+    }
+  m_open = true;
+  m_failed = false;
+  m_waits = 0;
+  m_bufferSize = bufferSize;
+  m_buffers[0].resize (std::min (bufferSize, INITIAL_BUFFER_SIZE));
+  m_current = 0;
+  setp (&m_buffers[0][0], &m_buffers[0][0] + m_buffers[0].size ());
+#ifdef HAVE_PTHREAD_H
+  AsyncFileWriterThread::Get ()->Acquire (this);
+#endif
+  return true;
+}
+
+bool
+AsyncFileWriter::IsOpen (void) const
+{
+  return m_open;
+}
+
+bool
+AsyncFileWriter::Fail (void) const
+{
+  return m_failed;
+}
+
+uint64_t
+AsyncFileWriter::GetWaitCount (void) const
+{
+  return m_waits;
+}
+
+void
+AsyncFileWriter::WriteFile (const char *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+#ifdef HAVE_ZLIB
+  if (m_gzFile != 0)
+    {
+      if (gzwrite (static_cast<gzFile> (m_gzFile), data, size) != static_cast<int> (size))
+        {
+          m_failed = true;
+        }
+      return;
+    }
+#endif
+  m_file.write (data, size);
+  if (!m_file)
+    {
+      m_failed = true;
+    }
+}
+
+void
+AsyncFileWriter::FlushFile (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_ZLIB
+  if (m_gzFile != 0)
+    {
+      if (gzflush (static_cast<gzFile> (m_gzFile), Z_SYNC_FLUSH) != Z_OK)
+        {
+          m_failed = true;
+        }
+      return;
+    }
+#endif
+  m_file.flush ();
+  if (!m_file)
+    {
+      m_failed = true;
+    }
+}
+
+void
+AsyncFileWriter::Submit (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t size = pptr () - pbase ();
+  if (size == 0)
+    {
+      return;
+    }
+  // double the size of the buffers each time one is filled
+  uint32_t next = m_buffers[m_current].size ();
+  if (pptr () == epptr ())
+    {
+      next = std::min (2 * next, m_bufferSize);
+    }
+#ifdef HAVE_PTHREAD_H
+  AsyncFileWriterThread *thread = AsyncFileWriterThread::Get ();
+  if (thread->Wait (this))
+    {
+      m_waits++;
+    }
+  thread->Submit (this, m_current, size);
+  m_current = 1 - m_current;
+#else
+  WriteFile (pbase (), size);
+#endif
+  // the thread is done with the other buffer
+  std::vector<char> &buffer = m_buffers[m_current];
+  if (buffer.size () < next)
+    {
+      buffer.resize (next);
+    }
+  setp (&buffer[0], &buffer[0] + buffer.size ());
+}
+
+AsyncFileWriter::int_type
+AsyncFileWriter::overflow (int_type c)
+{
+  if (!m_open)
+    {
+      return traits_type::eof ();
+    }
+  Submit ();
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      *pptr () = traits_type::to_char_type (c);
+      pbump (1);
+    }
+  return traits_type::not_eof (c);
+}
+
+std::streamsize
+AsyncFileWriter::xsputn (const char *s, std::streamsize n)
+{
+  if (!m_open)
+    {
+      return 0;
+    }
+  std::streamsize written = 0;
+  while (written < n)
+    {
+      if (pptr () == epptr ())
+        {
+          Submit ();
+        }
+      std::streamsize size = std::min<std::streamsize> (n - written, epptr () - pptr ());
+      std::memcpy (pptr (), s + written, size);
+      pbump (size);
+      written += size;
+    }
+  return written;
+}
+
+int
+AsyncFileWriter::sync (void)
+{
+  if (m_open)
+    {
+      Submit ();
+    }
+  return m_failed ? -1 : 0;
+}
+
+void
+AsyncFileWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_open)
+    {
+      return;
+    }
+  Submit ();
+#ifdef HAVE_PTHREAD_H
+  AsyncFileWriterThread *thread = AsyncFileWriterThread::Get ();
+  thread->Wait (this);
+  thread->Release (this);
+#endif
+#ifdef HAVE_ZLIB
+  if (m_gzFile != 0)
+    {
+      if (gzclose (static_cast<gzFile> (m_gzFile)) != Z_OK)
+        {
+          m_failed = true;
+        }
+      m_gzFile = 0;
+    }
+#endif
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  m_open = false;
+  setp (0, 0);
+  std::vector<char> ().swap (m_buffers[0]);
+  std::vector<char> ().swap (m_buffers[1]);
+}
+
+} // namespace ns3
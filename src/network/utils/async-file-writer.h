@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <atomic>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+class AsyncFileWriterThread;
+
+/**
+ * \ingroup network
+ *
+ * \brief A stream buffer writing a file from a background thread.
+ *
+ * The bytes written to the stream are copied in a buffer.  When it is
+ * full, or when the stream is flushed, the buffer is handed to a thread
+ * which writes it to the file, while the stream writes in a second
+ * buffer; the writer waits only if the thread has not finished with the
+ * previous buffer yet.  A single thread writes the buffers of all the
+ * open writers, in the order they are handed to it; it is started with
+ * the first writer opened and stopped with the last one closed.  The
+ * file can be compressed with gzip, in the same thread, if ns-3 is
+ * built with zlib.
+ *
+ * The buffers start small and double each time one is filled, up to the
+ * size given to Open, so the files which get little traffic use little
+ * memory.
+ *
+ * Without thread support, the buffer is written by the writer when it
+ * is full.
+ *
+ * The process can fork, e.g., with WarmStart, from the thread using the
+ * writers: all the buffered bytes are written before the fork, and the
+ * child starts its own writing thread.  The files are shared by the
+ * processes, so a file open before the fork should be written by one
+ * of them only.
+ *
+ * \code
+ *   AsyncFileWriter writer;
+ *   writer.Open ("trace.pcap", 4 << 20, false);
+ *   std::ostream os (&writer);
+ *   os.write (data, size);
+ *   writer.Close ();
+ * \endcode
+ */
+class AsyncFileWriter : public std::streambuf
+{
+public:
+  AsyncFileWriter ();
+  /** Close the file. */
+  ~AsyncFileWriter ();
+
+  /**
+   * Open a file and start the thread writing it.
+   *
+   * If the file should be compressed but ns-3 is built without zlib, it
+   * is written uncompressed, with a warning.
+   *
+   * \param [in] filename The name of the file, truncated if it exists.
+   * \param [in] bufferSize The maximum size of each of the two buffers.
+   * \param [in] compress Whether to compress the file with gzip.
+   * \returns false if the file cannot be opened.
+   */
+  bool Open (std::string const &filename, uint32_t bufferSize, bool compress);
+  /** Write the buffered bytes, stop the thread and close the file. */
+  void Close (void);
+  /** \returns true if the file is open. */
+  bool IsOpen (void) const;
+  /** \returns true if a write to the file failed. */
+  bool Fail (void) const;
+  /**
+   * \returns The number of times the writer waited for the thread to
+   *          write the previous buffer.
+   */
+  uint64_t GetWaitCount (void) const;
+
+  /** \returns true if the files can be compressed, i.e., if ns-3 is built with zlib. */
+  static bool IsCompressionSupported (void);
+
+protected:
+  virtual int_type overflow (int_type c);
+  virtual std::streamsize xsputn (const char *s, std::streamsize n);
+  virtual int sync (void);
+
+private:
+  friend class AsyncFileWriterThread;
+
+  /** Hand the current buffer to the thread and switch to the other one. */
+  void Submit (void);
+  /**
+   * Write bytes to the file.
+   * \param [in] data The bytes.
+   * \param [in] size The number of bytes.
+   */
+  void WriteFile (const char *data, uint32_t size);
+  /** Flush the bytes buffered by the file stream, once the thread is done. */
+  void FlushFile (void);
+
+  std::vector<char> m_buffers[2];   //!< The two buffers.
+  uint32_t m_bufferSize;            //!< The maximum size of the buffers.
+  uint32_t m_current;               //!< The buffer the stream writes in.
+  std::ofstream m_file;             //!< The file, if not compressed.
+  void *m_gzFile;                   //!< The compressed file, if any.
+  bool m_open;                      //!< The file is open.
+  std::atomic<bool> m_failed;       //!< A write to the file failed.
+  uint64_t m_waits;                 //!< The number of waits for the thread.
+  /** A buffer is being written by the thread, protected by its mutex. */
+  bool m_pending;
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_FILE_WRITER_H */
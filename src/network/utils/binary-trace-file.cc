@@ -0,0 +1,521 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-trace-file.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-impl.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+namespace {
+
+/** The magic string at the start of a binary trace file. */
+const char g_magic[8] = { 'n', 's', '3', 'b', 't', 'r', 'c', '\0' };
+/** The version of the file format. */
+const uint32_t g_version = 1;
+/** The size of a serialized record. */
+const uint32_t g_recordSize = 8 + 8 + 4 + 4 + 1;
+/** The type of the chunk defining a context. */
+const char g_contextChunk = 'C';
+/** The type of the chunk holding a block of records. */
+const char g_blockChunk = 'B';
+
+/**
+ * Append an integer in little endian order.
+ * \param [in,out] buffer The buffer.
+ * \param [in] value The integer.
+ * \param [in] size The number of bytes of the integer.
+ */
+void
+PutLe (std::string &buffer, uint64_t value, uint32_t size)
+{
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      buffer.push_back (static_cast<char> ((value >> (8 * i)) & 0xff));
+    }
+}
+
+/**
+ * Read an integer in little endian order.
+ * \param [in] data The bytes of the integer.
+ * \param [in] size The number of bytes of the integer.
+ * \returns The integer.
+ */
+uint64_t
+GetLe (const char *data, uint32_t size)
+{
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      value |= static_cast<uint64_t> (static_cast<uint8_t> (data[i])) << (8 * i);
+    }
+  return value;
+}
+
+} // anonymous namespace
+
+BinaryTraceWriter::TextBuffer::TextBuffer (BinaryTraceWriter *writer)
+  : m_writer (writer)
+{
+}
+
+BinaryTraceWriter::TextBuffer::int_type
+BinaryTraceWriter::TextBuffer::overflow (int_type c)
+{
+  if (traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      return traits_type::not_eof (c);
+    }
+  if (traits_type::to_char_type (c) == '\n')
+    {
+      m_writer->WriteText (m_line);
+      m_line.clear ();
+    }
+  else
+    {
+      m_line.push_back (traits_type::to_char_type (c));
+    }
+  return c;
+}
+
+BinaryTraceWriter::FlushBuffer::FlushBuffer (BinaryTraceWriter *writer)
+  : m_writer (writer)
+{
+}
+
+int
+BinaryTraceWriter::FlushBuffer::sync (void)
+{
+  m_writer->Flush ();
+  return 0;
+}
+
+BinaryTraceWriter::BinaryTraceWriter (std::string filename, Layout layout,
+                                      bool compress, uint32_t blockRecords)
+  : m_layout (layout),
+    m_compress (compress && IsCompressionSupported ()),
+    m_blockRecords (blockRecords),
+    m_lastContextId (0),
+    m_textBuffer (this),
+    m_textStream (&m_textBuffer),
+    m_flushBuffer (this),
+    m_flushStream (&m_flushBuffer)
+{
+  NS_LOG_FUNCTION (this << filename << layout << compress << blockRecords);
+  NS_ABORT_MSG_UNLESS (blockRecords > 0, "BinaryTraceWriter: empty blocks");
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "BinaryTraceWriter: unable to open " << filename);
+  m_records.reserve (blockRecords);
+
+  std::string header (g_magic, sizeof (g_magic));
+  PutLe (header, g_version, 4);
+  PutLe (header, layout, 1);
+  PutLe (header, Time::GetResolution (), 1);
+  m_file.write (header.data (), header.size ());
+  // the empty context has the id 0
+  m_contexts[""] = 0;
+  FatalImpl::RegisterStream (&m_flushStream);
+}
+
+BinaryTraceWriter::~BinaryTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+BinaryTraceWriter::IsCompressionSupported (void)
+{
+#ifdef HAVE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint32_t
+BinaryTraceWriter::GetContextId (const std::string &context)
+{
+  // the traces of a trace source often follow each other
+  if (context == m_lastContext)
+    {
+      return m_lastContextId;
+    }
+  std::unordered_map<std::string, uint32_t>::const_iterator it = m_contexts.find (context);
+  uint32_t id;
+  if (it != m_contexts.end ())
+    {
+      id = it->second;
+    }
+  else
+    {
+      id = m_contexts.size ();
+      m_contexts[context] = id;
+      m_contextChunks.push_back (g_contextChunk);
+      PutLe (m_contextChunks, id, 4);
+      PutLe (m_contextChunks, context.size (), 4);
+      m_contextChunks.append (context);
+    }
+  m_lastContext = context;
+  m_lastContextId = id;
+  return id;
+}
+
+void
+BinaryTraceWriter::Append (const Record &record)
+{
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  m_records.push_back (record);
+  if (m_records.size () >= m_blockRecords)
+    {
+      WriteBlock ();
+    }
+}
+
+void
+BinaryTraceWriter::Write (EventType type, const std::string &context, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << type << context << p);
+  Record record;
+  record.time = Simulator::Now ().GetTimeStep ();
+  record.uid = p->GetUid ();
+  record.context = GetContextId (context);
+  record.size = p->GetSize ();
+  record.type = type;
+  Append (record);
+}
+
+void
+BinaryTraceWriter::WriteText (const std::string &line)
+{
+  NS_LOG_FUNCTION (this << line);
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  Record record;
+  record.time = Simulator::Now ().GetTimeStep ();
+  record.uid = 0;
+  record.context = 0;
+  record.size = line.size ();
+  record.type = TEXT;
+  m_text.append (line);
+  Append (record);
+}
+
+std::ostream *
+BinaryTraceWriter::GetTextStream (void)
+{
+  return &m_textStream;
+}
+
+void
+BinaryTraceWriter::WriteBlock (void)
+{
+  NS_LOG_FUNCTION (this << m_records.size ());
+  std::string raw;
+  raw.reserve (m_records.size () * g_recordSize + m_text.size ());
+  if (m_layout == ROW)
+    {
+      for (std::vector<Record>::const_iterator i = m_records.begin (); i != m_records.end (); ++i)
+        {
+          PutLe (raw, i->time, 8);
+          PutLe (raw, i->uid, 8);
+          PutLe (raw, i->context, 4);
+          PutLe (raw, i->size, 4);
+          PutLe (raw, i->type, 1);
+        }
+    }
+  else
+    {
+      // the times are increasing: store their differences, which are
+      // small and compress well
+      int64_t last = 0;
+      for (std::vector<Record>::const_iterator i = m_records.begin (); i != m_records.end (); ++i)
+        {
+          PutLe (raw, i->time - last, 8);
+          last = i->time;
+        }
+      for (std::vector<Record>::const_iterator i = m_records.begin (); i != m_records.end (); ++i)
+        {
+          PutLe (raw, i->uid, 8);
+        }
+      for (std::vector<Record>::const_iterator i = m_records.begin (); i != m_records.end (); ++i)
+        {
+          PutLe (raw, i->context, 4);
+        }
+      for (std::vector<Record>::const_iterator i = m_records.begin (); i != m_records.end (); ++i)
+        {
+          PutLe (raw, i->size, 4);
+        }
+      for (std::vector<Record>::const_iterator i = m_records.begin (); i != m_records.end (); ++i)
+        {
+          PutLe (raw, i->type, 1);
+        }
+    }
+  raw.append (m_text);
+
+  const std::string *stored = &raw;
+  bool compressed = false;
+#ifdef HAVE_ZLIB
+  std::string deflated;
+  if (m_compress)
+    {
+      uLongf size = compressBound (raw.size ());
+      deflated.resize (size);
+      if (compress2 (reinterpret_cast<Bytef *> (&deflated[0]), &size,
+                     reinterpret_cast<const Bytef *> (raw.data ()), raw.size (),
+                     Z_BEST_SPEED) == Z_OK
+          && size < raw.size ())
+        {
+          deflated.resize (size);
+          stored = &deflated;
+          compressed = true;
+        }
+    }
+#endif
+
+  std::string chunk;
+  chunk.swap (m_contextChunks);
+  chunk.push_back (g_blockChunk);
+  PutLe (chunk, m_records.size (), 4);
+  PutLe (chunk, m_text.size (), 4);
+  PutLe (chunk, raw.size (), 4);
+  PutLe (chunk, stored->size (), 4);
+  PutLe (chunk, compressed, 1);
+  m_file.write (chunk.data (), chunk.size ());
+  m_file.write (stored->data (), stored->size ());
+
+  m_records.clear ();
+  m_text.clear ();
+}
+
+void
+BinaryTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  if (!m_records.empty ())
+    {
+      WriteBlock ();
+    }
+  m_file.flush ();
+}
+
+void
+BinaryTraceWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::UnregisterStream (&m_flushStream);
+  Flush ();
+  m_file.close ();
+}
+
+BinaryTraceReader::BinaryTraceReader (std::string filename)
+  : m_filename (filename),
+    m_next (0),
+    m_textOffset (0)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.open (filename.c_str (), std::ios::in | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "BinaryTraceReader: unable to open " << filename);
+
+  char header[sizeof (g_magic) + 6];
+  m_file.read (header, sizeof (header));
+  NS_ABORT_MSG_UNLESS (m_file && std::memcmp (header, g_magic, sizeof (g_magic)) == 0,
+                       "BinaryTraceReader: " << filename << " is not a binary trace file");
+  uint32_t version = GetLe (header + sizeof (g_magic), 4);
+  NS_ABORT_MSG_UNLESS (version == g_version,
+                       "BinaryTraceReader: unsupported version " << version << " of " << filename);
+  uint8_t layout = GetLe (header + sizeof (g_magic) + 4, 1);
+  uint8_t resolution = GetLe (header + sizeof (g_magic) + 5, 1);
+  NS_ABORT_MSG_UNLESS (layout <= BinaryTraceWriter::COLUMN && resolution < Time::LAST,
+                       "BinaryTraceReader: corrupted header in " << filename);
+  m_layout = static_cast<BinaryTraceWriter::Layout> (layout);
+  m_resolution = static_cast<Time::Unit> (resolution);
+  m_contexts.push_back ("");
+}
+
+BinaryTraceWriter::Layout
+BinaryTraceReader::GetLayout (void) const
+{
+  return m_layout;
+}
+
+const std::string &
+BinaryTraceReader::GetContext (uint32_t id) const
+{
+  NS_ABORT_MSG_UNLESS (id < m_contexts.size (),
+                       "BinaryTraceReader: undefined context " << id << " in " << m_filename);
+  return m_contexts[id];
+}
+
+double
+BinaryTraceReader::GetSeconds (int64_t time) const
+{
+  static const double seconds[Time::LAST] = {
+    365.0 * 24 * 3600, 24.0 * 3600, 3600.0, 60.0, 1.0, 1e-3, 1e-6, 1e-9, 1e-12, 1e-15
+  };
+  return time * seconds[m_resolution];
+}
+
+bool
+BinaryTraceReader::ReadBlock (void)
+{
+  NS_LOG_FUNCTION (this);
+  char type;
+  while (m_file.get (type))
+    {
+      if (type == g_contextChunk)
+        {
+          char buffer[8];
+          m_file.read (buffer, sizeof (buffer));
+          uint32_t id = GetLe (buffer, 4);
+          uint32_t size = GetLe (buffer + 4, 4);
+          std::string context (size, '\0');
+          m_file.read (&context[0], size);
+          NS_ABORT_MSG_UNLESS (m_file && id == m_contexts.size (),
+                               "BinaryTraceReader: corrupted context in " << m_filename);
+          m_contexts.push_back (context);
+          continue;
+        }
+      NS_ABORT_MSG_UNLESS (type == g_blockChunk,
+                           "BinaryTraceReader: unknown chunk in " << m_filename);
+
+      char buffer[17];
+      m_file.read (buffer, sizeof (buffer));
+      uint32_t nRecords = GetLe (buffer, 4);
+      uint32_t textSize = GetLe (buffer + 4, 4);
+      uint32_t rawSize = GetLe (buffer + 8, 4);
+      uint32_t storedSize = GetLe (buffer + 12, 4);
+      bool compressed = GetLe (buffer + 16, 1);
+      NS_ABORT_MSG_UNLESS (m_file && rawSize == nRecords * g_recordSize + textSize,
+                           "BinaryTraceReader: corrupted block in " << m_filename);
+      std::string stored (storedSize, '\0');
+      m_file.read (&stored[0], storedSize);
+      NS_ABORT_MSG_UNLESS (m_file, "BinaryTraceReader: truncated block in " << m_filename);
+
+      std::string raw;
+      if (compressed)
+        {
+#ifdef HAVE_ZLIB
+          raw.resize (rawSize);
+          uLongf size = rawSize;
+          NS_ABORT_MSG_UNLESS (uncompress (reinterpret_cast<Bytef *> (&raw[0]), &size,
+                                           reinterpret_cast<const Bytef *> (stored.data ()),
+                                           storedSize) == Z_OK && size == rawSize,
+                               "BinaryTraceReader: corrupted block in " << m_filename);
+#else
+          NS_FATAL_ERROR ("BinaryTraceReader: " << m_filename << " is compressed, "
+                          "and ns-3 is built without zlib");
+#endif
+        }
+      else
+        {
+          NS_ABORT_MSG_UNLESS (storedSize == rawSize,
+                               "BinaryTraceReader: corrupted block in " << m_filename);
+          raw.swap (stored);
+        }
+
+      m_records.resize (nRecords);
+      const char *data = raw.data ();
+      if (m_layout == BinaryTraceWriter::ROW)
+        {
+          for (uint32_t i = 0; i < nRecords; ++i, data += g_recordSize)
+            {
+              m_records[i].time = GetLe (data, 8);
+              m_records[i].uid = GetLe (data + 8, 8);
+              m_records[i].context = GetLe (data + 16, 4);
+              m_records[i].size = GetLe (data + 20, 4);
+              m_records[i].type = GetLe (data + 24, 1);
+            }
+        }
+      else
+        {
+          int64_t time = 0;
+          for (uint32_t i = 0; i < nRecords; ++i, data += 8)
+            {
+              time += GetLe (data, 8);
+              m_records[i].time = time;
+            }
+          for (uint32_t i = 0; i < nRecords; ++i, data += 8)
+            {
+              m_records[i].uid = GetLe (data, 8);
+            }
+          for (uint32_t i = 0; i < nRecords; ++i, data += 4)
+            {
+              m_records[i].context = GetLe (data, 4);
+            }
+          for (uint32_t i = 0; i < nRecords; ++i, data += 4)
+            {
+              m_records[i].size = GetLe (data, 4);
+            }
+          for (uint32_t i = 0; i < nRecords; ++i, data += 1)
+            {
+              m_records[i].type = GetLe (data, 1);
+            }
+        }
+      m_text.assign (data, textSize);
+      m_next = 0;
+      m_textOffset = 0;
+      return true;
+    }
+  return false;
+}
+
+bool
+BinaryTraceReader::Next (BinaryTraceWriter::Record &record, std::string &text)
+{
+  while (m_next == m_records.size ())
+    {
+      if (!ReadBlock ())
+        {
+          return false;
+        }
+    }
+  record = m_records[m_next++];
+  text.clear ();
+  if (record.type == BinaryTraceWriter::TEXT)
+    {
+      NS_ABORT_MSG_UNLESS (m_textOffset + record.size <= m_text.size (),
+                           "BinaryTraceReader: corrupted text in " << m_filename);
+      text.assign (m_text, m_textOffset, record.size);
+      m_textOffset += record.size;
+    }
+  NS_ABORT_MSG_UNLESS (record.context < m_contexts.size (),
+                       "BinaryTraceReader: undefined context " << record.context << " in " << m_filename);
+  return true;
+}
+
+} // namespace ns3
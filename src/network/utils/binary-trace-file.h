@@ -0,0 +1,280 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+
+#include <fstream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup network
+ *
+ * \brief Write the ascii trace events in a compact binary file.
+ *
+ * The default sinks of AsciiTraceHelper, and the ascii sinks of the
+ * IPv4, IPv6 and Wi-Fi PHY helpers, write one text line per event.
+ * When they are given an OutputStreamWrapper created by
+ * AsciiTraceHelper::CreateBinaryFileStream, they write instead a fixed
+ * width record holding the simulation time, the event type, the
+ * context, and the uid and size of the packet.  The contexts are
+ * dictionary encoded: each distinct context path is written once and
+ * the records refer to it by an id.  The text written to the stream by
+ * other sinks is kept as text records.
+ *
+ * The current block is written when the program aborts with
+ * NS_FATAL_ERROR, so the file holds the events up to the error.
+ *
+ * The records are buffered in blocks which are compressed with zlib,
+ * when ns-3 is built with it.  A block stores its records one after the
+ * other (ROW layout), or each field of all its records together, with
+ * the times delta encoded (COLUMN layout), which compresses better and
+ * suits the analysis of a few fields.
+ *
+ * The file starts with an 8-byte magic string, a version number, the
+ * layout and the time resolution, followed by a sequence of chunks:
+ * context chunks, which define the context of an id, and record blocks.
+ * All the integers are little endian.  BinaryTraceReader reads the
+ * file back, and the binary-trace-convert program converts it to text,
+ * CSV or one file per column.
+ */
+class BinaryTraceWriter : public SimpleRefCount<BinaryTraceWriter>
+{
+public:
+  /** The layout of the records in a block. */
+  enum Layout
+  {
+    ROW = 0,      //!< The records one after the other.
+    COLUMN = 1    //!< Each field of all the records together.
+  };
+
+  /** The type of a record. */
+  enum EventType
+  {
+    TEXT = 0,     //!< A line of text written to the stream.
+    ENQUEUE = 1,  //!< A packet enqueued, '+' in the ascii traces.
+    DEQUEUE = 2,  //!< A packet dequeued, '-' in the ascii traces.
+    DROP = 3,     //!< A packet dropped, 'd' in the ascii traces.
+    RECEIVE = 4,  //!< A packet received, 'r' in the ascii traces.
+    TRANSMIT = 5  //!< A packet transmitted, 't' in the ascii traces.
+  };
+
+  /** A trace record. */
+  struct Record
+  {
+    int64_t time;       //!< The simulation time, in time steps.
+    uint64_t uid;       //!< The uid of the packet.
+    uint32_t context;   //!< The id of the context, 0 if none.
+    uint32_t size;      //!< The size of the packet, or the length of the text.
+    uint8_t type;       //!< The EventType.
+  };
+
+  /**
+   * Open a binary trace file.
+   *
+   * \param [in] filename The name of the file.
+   * \param [in] layout The layout of the records in the blocks.
+   * \param [in] compress Whether to compress the blocks, if ns-3 is
+   *        built with zlib.
+   * \param [in] blockRecords The number of records in a block.
+   */
+  BinaryTraceWriter (std::string filename, Layout layout = COLUMN,
+                     bool compress = true, uint32_t blockRecords = 8192);
+  /** Write the last block and close the file. */
+  ~BinaryTraceWriter ();
+
+  /**
+   * Record a packet event at the current simulation time.
+   *
+   * \param [in] type The type of the event.
+   * \param [in] context The context of the trace source, may be empty.
+   * \param [in] p The packet.
+   */
+  void Write (EventType type, const std::string &context, Ptr<const Packet> p);
+  /**
+   * Record a line of text at the current simulation time.
+   *
+   * \param [in] line The text, without the end of line.
+   */
+  void WriteText (const std::string &line);
+  /**
+   * \returns A stream whose lines are recorded as text records.
+   */
+  std::ostream *GetTextStream (void);
+  /** Write the current block, even if it is not full. */
+  void Flush (void);
+  /** Write the last block and close the file; later records are ignored. */
+  void Close (void);
+
+  /**
+   * \returns true if the blocks can be compressed, i.e., if ns-3 is built
+   *          with zlib.
+   */
+  static bool IsCompressionSupported (void);
+
+private:
+  /** A stream buffer recording each line as a text record. */
+  class TextBuffer : public std::streambuf
+  {
+  public:
+    /**
+     * Constructor.
+     * \param [in] writer The writer of the text records.
+     */
+    TextBuffer (BinaryTraceWriter *writer);
+
+  protected:
+    virtual int_type overflow (int_type c);
+
+  private:
+    BinaryTraceWriter *m_writer;  //!< The writer of the text records.
+    std::string m_line;           //!< The current line.
+  };
+
+  /** A stream buffer writing the current block when it is synced. */
+  class FlushBuffer : public std::streambuf
+  {
+  public:
+    /**
+     * Constructor.
+     * \param [in] writer The writer of the blocks.
+     */
+    FlushBuffer (BinaryTraceWriter *writer);
+
+  protected:
+    virtual int sync (void);
+
+  private:
+    BinaryTraceWriter *m_writer;  //!< The writer of the blocks.
+  };
+
+  /**
+   * Get the id of a context, writing its definition the first time.
+   * \param [in] context The context.
+   * \returns The id of the context.
+   */
+  uint32_t GetContextId (const std::string &context);
+  /**
+   * Append a record to the current block.
+   * \param [in] record The record.
+   */
+  void Append (const Record &record);
+  /** Serialize, compress and write the current block. */
+  void WriteBlock (void);
+
+  std::ofstream m_file;                 //!< The file.
+  Layout m_layout;                      //!< The layout of the blocks.
+  bool m_compress;                      //!< Compress the blocks.
+  uint32_t m_blockRecords;              //!< The number of records in a full block.
+  std::vector<Record> m_records;        //!< The records of the current block.
+  std::string m_text;                   //!< The text of the current block.
+  std::string m_contextChunks;          //!< The contexts defined by the current block.
+  std::unordered_map<std::string, uint32_t> m_contexts;  //!< The ids of the contexts.
+  std::string m_lastContext;            //!< The last context looked up.
+  uint32_t m_lastContextId;             //!< The id of the last context looked up.
+  TextBuffer m_textBuffer;              //!< The buffer of the text stream.
+  std::ostream m_textStream;            //!< The text stream.
+  FlushBuffer m_flushBuffer;            //!< The buffer of the flush stream.
+  /**
+   * The stream registered with FatalImpl, which writes the current block
+   * when it is flushed.  The text stream cannot do it, since the sinks
+   * flush it after each line with std::endl.
+   */
+  std::ostream m_flushStream;
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Read a file written by BinaryTraceWriter.
+ *
+ * \code
+ *   BinaryTraceReader reader ("trace.btr");
+ *   BinaryTraceWriter::Record record;
+ *   std::string text;
+ *   while (reader.Next (record, text))
+ *     {
+ *       std::cout << reader.GetSeconds (record.time) << " "
+ *                 << reader.GetContext (record.context) << std::endl;
+ *     }
+ * \endcode
+ */
+class BinaryTraceReader
+{
+public:
+  /**
+   * Open a binary trace file.
+   * \param [in] filename The name of the file.
+   */
+  BinaryTraceReader (std::string filename);
+
+  /**
+   * Read the next record.
+   *
+   * \param [out] record The record.
+   * \param [out] text The text of a TEXT record, empty otherwise.
+   * \returns false at the end of the file.
+   */
+  bool Next (BinaryTraceWriter::Record &record, std::string &text);
+  /**
+   * \param [in] id The id of a context.
+   * \returns The context.
+   */
+  const std::string & GetContext (uint32_t id) const;
+  /**
+   * \param [in] time A time of a record, in time steps.
+   * \returns The time in seconds.
+   */
+  double GetSeconds (int64_t time) const;
+  /**
+   * \returns The layout of the blocks.
+   */
+  BinaryTraceWriter::Layout GetLayout (void) const;
+
+private:
+  /**
+   * Read the chunks up to the next block and decode it.
+   * \returns false at the end of the file.
+   */
+  bool ReadBlock (void);
+
+  std::string m_filename;                        //!< The name of the file.
+  std::ifstream m_file;                          //!< The file.
+  BinaryTraceWriter::Layout m_layout;            //!< The layout of the blocks.
+  Time::Unit m_resolution;                       //!< The time resolution of the records.
+  std::vector<std::string> m_contexts;           //!< The contexts, by id.
+  std::vector<BinaryTraceWriter::Record> m_records; //!< The records of the current block.
+  std::string m_text;                            //!< The text of the current block.
+  std::size_t m_next;                            //!< The next record of the block.
+  std::size_t m_textOffset;                      //!< The text of the next record.
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
@@ -26,6 +26,8 @@
 
 namespace ns3 {
 
+class BinaryTraceWriter;
+
 /**
  * @brief A class encapsulating an output stream.
  *
@@ -81,6 +83,15 @@ public:
    * \param os output stream
    */
   OutputStreamWrapper (std::ostream* os);
+  /**
+   * Constructor
+   *
+   * The default ascii trace sinks write binary records with the writer,
+   * and the text written to the stream is kept as text records.
+   *
+   * \param writer binary trace writer
+   */
+  OutputStreamWrapper (Ptr<BinaryTraceWriter> writer);
   ~OutputStreamWrapper ();
 
   /**
@@ -91,10 +102,15 @@ public:
    * \returns a pointer to the encapsulated std::ostream
    */
   std::ostream *GetStream (void);
+  /**
+   * \returns the binary trace writer set in the wrapper, or 0
+   */
+  Ptr<BinaryTraceWriter> GetBinaryTraceWriter (void) const;
 
 private:
   std::ostream *m_ostream; //!< The output stream
   bool m_destroyable; //!< Can be destroyed
+  Ptr<BinaryTraceWriter> m_writer; //!< The binary trace writer, if any
 };
 
 } // namespace ns3
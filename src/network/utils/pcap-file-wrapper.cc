@@ -46,6 +46,23 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("AsyncWrite",
+                   "Whether the files opened for writing are written by a background thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_async),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AsyncBufferSize",
+                   "The maximum size of each of the two buffers of the background thread, in bytes.",
+                   UintegerValue (4 << 20),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_asyncBufferSize),
+                   MakeUintegerChecker<uint32_t> (1024))
+    .AddAttribute ("Compress",
+                   "Whether the files written by a background thread are compressed with gzip "
+                   "and \".gz\" is appended to their names; without zlib, they are written "
+                   "uncompressed.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_compress),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -93,6 +110,23 @@ void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
+  if (m_async && (mode & std::ios::out) && !(mode & std::ios::in))
+    {
+      if (m_compress && AsyncFileWriter::IsCompressionSupported ())
+        {
+          m_file.OpenAsync (filename + ".gz", m_asyncBufferSize, true);
+        }
+      else
+        {
+          if (m_compress)
+            {
+              NS_LOG_WARN ("Cannot compress " << filename << ": ns-3 is built without zlib, "
+                           "the file is written uncompressed");
+            }
+          m_file.OpenAsync (filename, m_asyncBufferSize, false);
+        }
+      return;
+    }
   m_file.Open (filename, mode);
 }
 
@@ -74,6 +74,10 @@ public:
    *
    * \param mode String containing the access mode for the file.
    *
+   * If the AsyncWrite attribute is true and the file is only written, it
+   * is written by a background thread (see PcapFile::OpenAsync), and it
+   * is compressed with gzip if the Compress attribute is true and ns-3 is
+   * built with zlib, in which case ".gz" is appended to its name.
    */
   void Open (std::string const &filename, std::ios::openmode mode);
 
@@ -224,6 +228,9 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_async; //!< Write the file in a background thread
+  uint32_t m_asyncBufferSize; //!< Size of the buffers of the background thread
+  bool     m_compress; //!< Compress the file written in the background
 };
 
 } // namespace ns3
@@ -49,6 +49,8 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 
 PcapFile::PcapFile ()
   : m_file (),
+    m_asyncStream (&m_asyncWriter),
+    m_out (&m_file),
     m_swapMode (false),
     m_nanosecMode (false)
 {
@@ -68,7 +70,7 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_file.fail ();
+  return m_file.fail () || m_asyncStream.fail () || m_asyncWriter.Fail ();
 }
 bool 
 PcapFile::Eof (void) const
@@ -81,6 +83,7 @@ PcapFile::Clear (void)
 {
   NS_LOG_FUNCTION (this);
   m_file.clear ();
+  m_asyncStream.clear ();
 }
 
 
@@ -88,7 +91,15 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
-  m_file.close ();
+  if (m_out == &m_file)
+    {
+      m_file.close ();
+    }
+  else
+    {
+      m_asyncWriter.Close ();
+      m_out = &m_file;
+    }
 }
 
 uint32_t
@@ -206,7 +217,13 @@ PcapFile::WriteFileHeader (void)
   // If we're initializing the file, we need to write the pcap file header
   // at the start of the file.
   //
-  m_file.seekp (0, std::ios::beg);
+  // A file written in the background is initialized just after it is
+  // opened, and cannot seek.
+  //
+  if (m_out == &m_file)
+    {
+      m_file.seekp (0, std::ios::beg);
+    }
  
   //
   // We have the ability to write out the pcap file header in a foreign endian
@@ -234,13 +251,13 @@ PcapFile::WriteFileHeader (void)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
-  m_file.write ((const char *)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
-  m_file.write ((const char *)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
-  m_file.write ((const char *)&headerOut->m_zone, sizeof(headerOut->m_zone));
-  m_file.write ((const char *)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
-  m_file.write ((const char *)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
-  m_file.write ((const char *)&headerOut->m_type, sizeof(headerOut->m_type));
+  m_out->write ((const char *)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
+  m_out->write ((const char *)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
+  m_out->write ((const char *)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
+  m_out->write ((const char *)&headerOut->m_zone, sizeof(headerOut->m_zone));
+  m_out->write ((const char *)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
+  m_out->write ((const char *)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
+  m_out->write ((const char *)&headerOut->m_type, sizeof(headerOut->m_type));
 }
 
 void
@@ -341,6 +358,23 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
     }
 }
 
+void
+PcapFile::OpenAsync (std::string const &filename, uint32_t bufferSize, bool compress)
+{
+  NS_LOG_FUNCTION (this << filename << bufferSize << compress);
+  NS_ASSERT (!m_file.fail ());
+
+  m_filename = filename;
+  if (m_asyncWriter.Open (filename, bufferSize, compress))
+    {
+      m_out = &m_asyncStream;
+    }
+  else
+    {
+      m_file.setstate (std::ios::failbit);
+    }
+}
+
 void
 PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection, bool swapMode, bool nanosecMode)
 {
@@ -403,7 +437,7 @@ uint32_t
 PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
+  NS_ASSERT (m_out->good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
@@ -422,10 +456,10 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
+  m_out->write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
+  m_out->write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
+  m_out->write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
+  m_out->write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
   NS_BUILD_DEBUG(m_file.flush());
   return inclLen;
 }
@@ -435,7 +469,7 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
+  m_out->write ((const char *)data, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
 
@@ -444,7 +478,7 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
+  p->CopyData (m_out, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
 
@@ -460,9 +494,9 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
+  headerBuffer.CopyData (m_out, toCopy);
   inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  p->CopyData (m_out, inclLen);
 }
 
 void
@@ -25,6 +25,7 @@
 #include <fstream>
 #include <stdint.h>
 #include "ns3/ptr.h"
+#include "async-file-writer.h"
 
 namespace ns3 {
 
@@ -80,6 +81,21 @@ public:
    */
   void Open (std::string const &filename, std::ios::openmode mode);
 
+  /**
+   * Create a new pcap file written by a background thread.
+   *
+   * The records are copied in a buffer, which is written to the file by
+   * another thread when it is full, so the writes do not wait for the
+   * file system.  The file can only be written, and it is complete only
+   * when it is closed.
+   *
+   * \param filename String containing the name of the file.
+   * \param bufferSize The maximum size of each of the two buffers of the thread.
+   * \param compress Whether to compress the file with gzip, if ns-3 is
+   * built with zlib; otherwise the file is written uncompressed.
+   */
+  void OpenAsync (std::string const &filename, uint32_t bufferSize, bool compress = false);
+
   /**
    * Close the underlying file.
    */
@@ -368,6 +384,9 @@ private:
 
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
+  AsyncFileWriter m_asyncWriter; //!< background writer of the file, if open with OpenAsync
+  std::ostream   m_asyncStream; //!< stream of the background writer
+  std::ostream  *m_out;         //!< the stream the records are written to
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
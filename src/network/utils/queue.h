@@ -42,6 +42,17 @@ namespace ns3 {
  * \defgroup queue Queue
  */
 
+/**
+ * \ingroup queue
+ * \brief The group of the PacketsInQueue and BytesInQueue trace sources
+ * of QueueBase, stripped with <tt>waf configure --strip-trace-sources=queue</tt>.
+ */
+struct QueueTraceSources {};
+
+#ifdef NS3_STRIP_TRACE_SOURCES_QUEUE
+NS_TRACE_SOURCE_GROUP_STRIP (QueueTraceSources);
+#endif
+
 /**
  * \ingroup queue
  * \brief Abstract base class for packet Queues
@@ -204,9 +215,9 @@ public:
 #endif
 
 private:
-  TracedValue<uint32_t> m_nBytes;               //!< Number of bytes in the queue
+  StrippableTracedValue<uint32_t, QueueTraceSources> m_nBytes;   //!< Number of bytes in the queue
   uint32_t m_nTotalReceivedBytes;               //!< Total received bytes
-  TracedValue<uint32_t> m_nPackets;             //!< Number of packets in the queue
+  StrippableTracedValue<uint32_t, QueueTraceSources> m_nPackets; //!< Number of packets in the queue
   uint32_t m_nTotalReceivedPackets;             //!< Total received packets
   uint32_t m_nTotalDroppedBytes;                //!< Total dropped bytes
   uint32_t m_nTotalDroppedBytesBeforeEnqueue;   //!< Total dropped bytes before enqueue
@@ -418,6 +429,40 @@ protected:
    */
   void DropAfterDequeue (Ptr<Item> item);
 
+  /**
+   * \brief Check that an item fits in the queue
+   * \param item the item to enqueue
+   * \return true if the item fits, false if it has been dropped.
+   *
+   * Subclasses which store the items in a container of their own call this
+   * method before storing an item and NotifyEnqueued after storing it.
+   */
+  bool CheckEnqueue (Ptr<Item> item);
+
+  /**
+   * \brief Account for an item stored in the queue
+   * \param item the item enqueued
+   *
+   * Update the statistics and fire the Enqueue trace source.
+   */
+  void NotifyEnqueued (Ptr<Item> item);
+
+  /**
+   * \brief Account for an item taken out of the queue to be dequeued
+   * \param item the item dequeued
+   *
+   * Update the statistics and fire the Dequeue trace source.
+   */
+  void NotifyDequeued (Ptr<Item> item);
+
+  /**
+   * \brief Account for an item taken out of the queue to be dropped
+   * \param item the item removed
+   *
+   * Update the statistics and fire the Dequeue and then the drop trace sources.
+   */
+  void NotifyRemoved (Ptr<Item> item);
+
 private:
   std::list<Ptr<Item> > m_packets;          //!< the items in the queue
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
@@ -483,24 +528,13 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
 {
   NS_LOG_FUNCTION (this << item);
 
-  if (GetCurrentSize () + item > GetMaxSize ())
+  if (!CheckEnqueue (item))
     {
-      NS_LOG_LOGIC ("Queue full -- dropping pkt");
-      DropBeforeEnqueue (item);
       return false;
     }
 
   m_packets.insert (pos, item);
-
-  uint32_t size = item->GetSize ();
-  m_nBytes += size;
-  m_nTotalReceivedBytes += size;
-
-  m_nPackets++;
-  m_nTotalReceivedPackets++;
-
-  NS_LOG_LOGIC ("m_traceEnqueue (p)");
-  m_traceEnqueue (item);
+  NotifyEnqueued (item);
 
   return true;
 }
@@ -522,14 +556,7 @@ Queue<Item>::DoDequeue (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
-
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
-
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+      NotifyDequeued (item);
     }
   return item;
 }
@@ -551,17 +578,7 @@ Queue<Item>::DoRemove (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
-
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
-
-      // packets are first dequeued and then dropped
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
-
-      DropAfterDequeue (item);
+      NotifyRemoved (item);
     }
   return item;
 }
@@ -648,6 +665,57 @@ Queue<Item>::DropAfterDequeue (Ptr<Item> item)
   m_traceDropAfterDequeue (item);
 }
 
+template <typename Item>
+bool
+Queue<Item>::CheckEnqueue (Ptr<Item> item)
+{
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item);
+      return false;
+    }
+  return true;
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyEnqueued (Ptr<Item> item)
+{
+  uint32_t size = item->GetSize ();
+  m_nBytes += size;
+  m_nTotalReceivedBytes += size;
+
+  m_nPackets++;
+  m_nTotalReceivedPackets++;
+
+  NS_LOG_LOGIC ("m_traceEnqueue (p)");
+  m_traceEnqueue (item);
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyDequeued (Ptr<Item> item)
+{
+  NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
+  NS_ASSERT (m_nPackets.Get () > 0);
+
+  m_nBytes -= item->GetSize ();
+  m_nPackets--;
+
+  NS_LOG_LOGIC ("m_traceDequeue (p)");
+  m_traceDequeue (item);
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyRemoved (Ptr<Item> item)
+{
+  // packets are first dequeued and then dropped
+  NotifyDequeued (item);
+  DropAfterDequeue (item);
+}
+
 // The following explicit template instantiation declarations prevent all the
 // translation units including this header file to implicitly instantiate the
 // Queue<Packet> class and the Queue<QueueDiscItem> class. The unique instances
@@ -0,0 +1,258 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_QUEUE_H
+#define RING_BUFFER_QUEUE_H
+
+#include "ns3/queue.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A FIFO packet queue that drops tail-end packets on overflow,
+ * stored in a ring buffer
+ *
+ * This queue behaves like DropTailQueue and fires the same trace
+ * sources, but it stores the items in a circular array instead of a
+ * list, so that enqueuing and dequeuing an item does not allocate
+ * memory.  The array doubles its capacity when it is full, hence it
+ * stops growing once it holds \c MaxSize items.
+ *
+ * The items are not stored in the list of the Queue base class, so
+ * subclasses cannot browse them with Queue::begin and Queue::end.
+ *
+ * Devices can use it through their helper, e.g.:
+ * \code
+ *   PointToPointHelper p2p;
+ *   p2p.SetQueue ("ns3::RingBufferQueue", "MaxSize", StringValue ("1000p"));
+ * \endcode
+ */
+template <typename Item>
+class RingBufferQueue : public Queue<Item>
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief RingBufferQueue Constructor
+   *
+   * Creates a ring buffer queue with a maximum size of 100 packets by default
+   */
+  RingBufferQueue ();
+
+  virtual ~RingBufferQueue ();
+
+  virtual bool Enqueue (Ptr<Item> item);
+  virtual Ptr<Item> Dequeue (void);
+  virtual Ptr<Item> Remove (void);
+  virtual Ptr<const Item> Peek (void) const;
+
+  /**
+   * \return the number of items the ring buffer holds before it grows
+   */
+  uint32_t GetCapacity (void) const;
+
+private:
+  using Queue<Item>::CheckEnqueue;
+  using Queue<Item>::NotifyEnqueued;
+  using Queue<Item>::NotifyDequeued;
+  using Queue<Item>::NotifyRemoved;
+
+  /**
+   * Take the item at the head of the ring buffer out of it.
+   * \return the item, or 0 if the ring buffer is empty.
+   */
+  Ptr<Item> Pop (void);
+  /**
+   * Double the capacity of the ring buffer, keeping the items in order.
+   */
+  void Grow (void);
+
+  std::vector<Ptr<Item> > m_ring; //!< the ring buffer, its size is a power of two
+  uint32_t m_head;                //!< the index of the first item
+  uint32_t m_count;               //!< the number of items in the ring buffer
+
+  NS_LOG_TEMPLATE_DECLARE;        //!< redefinition of the log component
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename Item>
+TypeId
+RingBufferQueue<Item>::GetTypeId (void)
+{
+  static TypeId tid = TypeId (("ns3::RingBufferQueue<" + GetTypeParamName<RingBufferQueue<Item> > () + ">").c_str ())
+    .SetParent<Queue<Item> > ()
+    .SetGroupName ("Network")
+    .template AddConstructor<RingBufferQueue<Item> > ()
+    .AddAttribute ("MaxSize",
+                   "The max queue size",
+                   QueueSizeValue (QueueSize ("100p")),
+                   MakeQueueSizeAccessor (&QueueBase::SetMaxSize,
+                                          &QueueBase::GetMaxSize),
+                   MakeQueueSizeChecker ())
+  ;
+  return tid;
+}
+
+template <typename Item>
+RingBufferQueue<Item>::RingBufferQueue () :
+  Queue<Item> (),
+  m_head (0),
+  m_count (0),
+  NS_LOG_TEMPLATE_DEFINE ("RingBufferQueue")
+{
+  NS_LOG_FUNCTION (this);
+}
+
+template <typename Item>
+RingBufferQueue<Item>::~RingBufferQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+template <typename Item>
+bool
+RingBufferQueue<Item>::Enqueue (Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (!CheckEnqueue (item))
+    {
+      return false;
+    }
+
+  if (m_count == m_ring.size ())
+    {
+      Grow ();
+    }
+  m_ring[(m_head + m_count) & (m_ring.size () - 1)] = item;
+  m_count++;
+
+  NotifyEnqueued (item);
+  return true;
+}
+
+template <typename Item>
+Ptr<Item>
+RingBufferQueue<Item>::Dequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Item> item = Pop ();
+  if (item != 0)
+    {
+      NotifyDequeued (item);
+    }
+
+  NS_LOG_LOGIC ("Popped " << item);
+
+  return item;
+}
+
+template <typename Item>
+Ptr<Item>
+RingBufferQueue<Item>::Remove (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Item> item = Pop ();
+  if (item != 0)
+    {
+      NotifyRemoved (item);
+    }
+
+  NS_LOG_LOGIC ("Removed " << item);
+
+  return item;
+}
+
+template <typename Item>
+Ptr<const Item>
+RingBufferQueue<Item>::Peek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_count == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+  return m_ring[m_head];
+}
+
+template <typename Item>
+uint32_t
+RingBufferQueue<Item>::GetCapacity (void) const
+{
+  return m_ring.size ();
+}
+
+template <typename Item>
+Ptr<Item>
+RingBufferQueue<Item>::Pop (void)
+{
+  if (m_count == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Ptr<Item> item = m_ring[m_head];
+  // release the reference held by the ring buffer
+  m_ring[m_head] = 0;
+  m_head = (m_head + 1) & (m_ring.size () - 1);
+  m_count--;
+  return item;
+}
+
+template <typename Item>
+void
+RingBufferQueue<Item>::Grow (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::vector<Ptr<Item> > ring (m_ring.empty () ? 16 : 2 * m_ring.size ());
+  for (uint32_t i = 0; i < m_count; i++)
+    {
+      ring[i] = m_ring[(m_head + i) & (m_ring.size () - 1)];
+    }
+  m_ring.swap (ring);
+  m_head = 0;
+}
+
+// The following explicit template instantiation declarations prevent all the
+// translation units including this header file to implicitly instantiate the
+// RingBufferQueue<Packet> class and the RingBufferQueue<QueueDiscItem> class.
+// The unique instances of these classes are explicitly created through the
+// macros NS_OBJECT_TEMPLATE_CLASS_DEFINE (RingBufferQueue,Packet) and
+// NS_OBJECT_TEMPLATE_CLASS_DEFINE (RingBufferQueue,QueueDiscItem), which are
+// included in ring-buffer-queue.cc
+extern template class RingBufferQueue<Packet>;
+extern template class RingBufferQueue<QueueDiscItem>;
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_QUEUE_H */
@@ -20,6 +20,7 @@
 #include "point-to-point-net-device.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 
@@ -106,6 +107,35 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointChannel::TransmitBurst (
+  Ptr<const PacketBurst> burst,
+  const std::vector<Time> &txEnd,
+  Ptr<PointToPointNetDevice> src)
+{
+  NS_LOG_FUNCTION (this << burst << src);
+  NS_ASSERT (burst->GetNPackets () == txEnd.size ());
+
+  NS_ASSERT (m_link[0].m_state != INITIALIZING);
+  NS_ASSERT (m_link[1].m_state != INITIALIZING);
+
+  uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  uint32_t context = m_link[wire].m_dst->GetNode ()->GetId ();
+
+  // Each packet is received when its last bit arrives, as if it had been
+  // transmitted alone
+  std::vector<Time>::const_iterator end = txEnd.begin ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i, ++end)
+    {
+      Simulator::ScheduleWithContext (context, *end + m_delay, &PointToPointNetDevice::Receive,
+                                      m_link[wire].m_dst, (*i)->Copy ());
+
+      // Call the tx anim callback on the net device
+      m_txrxPointToPoint (*i, src, m_link[wire].m_dst, *end, *end + m_delay);
+    }
+  return true;
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_CHANNEL_H
 
 #include <list>
+#include <vector>
 #include "ns3/channel.h"
 #include "ns3/ptr.h"
 #include "ns3/nstime.h"
@@ -30,6 +31,7 @@ namespace ns3 {
 
 class PointToPointNetDevice;
 class Packet;
+class PacketBurst;
 
 /**
  * \ingroup point-to-point
@@ -80,6 +82,21 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+  /**
+   * \brief Transmit a burst of back-to-back packets over this channel
+   *
+   * Each packet of the burst is received by the peer device when its
+   * last bit arrives.
+   *
+   * \param burst Packets to transmit
+   * \param txEnd Time at which the last bit of each packet of the burst is
+   *        transmitted, relative to now
+   * \param src Source PointToPointNetDevice
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitBurst (Ptr<const PacketBurst> burst, const std::vector<Time> &txEnd,
+                              Ptr<PointToPointNetDevice> src);
+
   /**
    * \brief Get number of devices on this channel
    * \returns number of devices on this channel
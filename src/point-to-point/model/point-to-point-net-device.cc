@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/packet-burst.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -67,6 +68,13 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("MaxBurstSize",
+                   "The maximum number of queued packets sent back-to-back "
+                   "in a single transmission over the channel, dequeued when "
+                   "it starts; 1 sends the packets one at a time",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_maxBurstSize),
+                   MakeUintegerChecker<uint32_t> (1))
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -214,6 +222,7 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_currentBurst = 0;
   m_queue = 0;
   NetDevice::DoDispose ();
 }
@@ -249,6 +258,11 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   m_phyTxBeginTrace (m_currentPkt);
 
   Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  if (m_maxBurstSize > 1 && !m_queue->IsEmpty ())
+    {
+      return TransmitBurstStart (txTime);
+    }
+
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -262,6 +276,55 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   return result;
 }
 
+bool
+PointToPointNetDevice::TransmitBurstStart (Time txTime)
+{
+  NS_LOG_FUNCTION (this << txTime);
+
+  //
+  // The packets waiting in the queue follow the current one back-to-back,
+  // each after an interframe gap.  The channel is told when the last bit of
+  // each packet leaves the device, and a single event is scheduled for the
+  // end of the whole burst.
+  //
+  Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+  burst->AddPacket (m_currentPkt);
+  std::vector<Time> txEnd;
+  txEnd.push_back (txTime);
+  Time duration = txTime;
+  while (burst->GetNPackets () < m_maxBurstSize)
+    {
+      Ptr<Packet> p = m_queue->Dequeue ();
+      if (p == 0)
+        {
+          break;
+        }
+      m_snifferTrace (p);
+      m_promiscSnifferTrace (p);
+      m_phyTxBeginTrace (p);
+      burst->AddPacket (p);
+      duration += m_tInterframeGap + m_bps.CalculateBytesTxTime (p->GetSize ());
+      txEnd.push_back (duration);
+    }
+  m_currentBurst = burst;
+
+  Time txCompleteTime = duration + m_tInterframeGap;
+
+  NS_LOG_LOGIC ("Schedule TransmitCompleteEvent of a burst of " << burst->GetNPackets ()
+                << " packets in " << txCompleteTime.GetSeconds () << "sec");
+  Simulator::Schedule (txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
+
+  bool result = m_channel->TransmitBurst (burst, txEnd, this);
+  if (result == false)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+        {
+          m_phyTxDropTrace (*i);
+        }
+    }
+  return result;
+}
+
 void
 PointToPointNetDevice::TransmitComplete (void)
 {
@@ -278,7 +341,19 @@ PointToPointNetDevice::TransmitComplete (void)
 
   NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
 
-  m_phyTxEndTrace (m_currentPkt);
+  if (m_currentBurst != 0)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = m_currentBurst->Begin ();
+           i != m_currentBurst->End (); ++i)
+        {
+          m_phyTxEndTrace (*i);
+        }
+      m_currentBurst = 0;
+    }
+  else
+    {
+      m_phyTxEndTrace (m_currentPkt);
+    }
   m_currentPkt = 0;
 
   Ptr<Packet> p = m_queue->Dequeue ();
@@ -36,6 +36,7 @@ namespace ns3 {
 template <typename Item> class Queue;
 class PointToPointChannel;
 class ErrorModel;
+class PacketBurst;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -58,6 +59,16 @@ class ErrorModel;
  * Key parameters or objects that can be specified for this device 
  * include a queue, data rate, and interframe transmission gap (the 
  * propagation delay is set in the PointToPointChannel).
+ *
+ * When the \c MaxBurstSize attribute is greater than one, the device
+ * transmits the packets waiting in its queue in bursts: a single
+ * transmission carries up to \c MaxBurstSize back-to-back packets over
+ * the channel, with one transmit complete event per burst instead of
+ * one per packet.  The packets of a burst are dequeued, and their
+ * PhyTxBegin traces fired, at its start, and their PhyTxEnd traces are
+ * fired at its end, so the queue frees space earlier than without
+ * bursts; the peer device still receives each packet, in its own event,
+ * when its last bit arrives.
  */
 class PointToPointNetDevice : public NetDevice
 {
@@ -267,6 +278,19 @@ private:
    */
   bool TransmitStart (Ptr<Packet> p);
 
+  /**
+   * Send the packets waiting in the queue in the same burst as the current one.
+   *
+   * Called by TransmitStart when burst transmission is enabled, to dequeue
+   * up to \c MaxBurstSize packets, including the current one, and hand them
+   * over to the channel in a single transmission.
+   *
+   * \see PointToPointChannel::TransmitBurst ()
+   * \param txTime the transmission time of the current packet
+   * \returns true if success, false on failure
+   */
+  bool TransmitBurstStart (Time txTime);
+
   /**
    * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
    *
@@ -307,6 +331,12 @@ private:
    */
   Time           m_tInterframeGap;
 
+  /**
+   * The maximum number of packets sent in one burst over the channel,
+   * one to send the packets one at a time.
+   */
+  uint32_t       m_maxBurstSize;
+
   /**
    * The PointToPointChannel to which this PointToPointNetDevice has been
    * attached.
@@ -456,6 +486,7 @@ private:
   uint32_t m_mtu;
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
+  Ptr<PacketBurst> m_currentBurst; //!< Current burst processed, if any
 
   /**
    * \brief PPP to Ethernet protocol number mapping
@@ -23,6 +23,7 @@
 #include "point-to-point-remote-channel.h"
 #include "point-to-point-net-device.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/mpi-interface.h"
@@ -77,4 +78,32 @@ PointToPointRemoteChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointRemoteChannel::TransmitBurst (
+  Ptr<const PacketBurst> burst,
+  const std::vector<Time> &txEnd,
+  Ptr<PointToPointNetDevice> src)
+{
+  NS_LOG_FUNCTION (this << burst << src);
+  NS_ASSERT (burst->GetNPackets () == txEnd.size ());
+
+  IsInitialized ();
+
+  uint32_t wire = src == GetSource (0) ? 0 : 1;
+  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+
+#ifdef NS3_MPI
+  std::vector<Time>::const_iterator end = txEnd.begin ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i, ++end)
+    {
+      // Calculate the rxTime (absolute) of each packet
+      Time rxTime = Simulator::Now () + *end + GetDelay ();
+      MpiInterface::SendPacket ((*i)->Copy (), rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
+    }
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+  return true;
+}
+
 } // namespace ns3
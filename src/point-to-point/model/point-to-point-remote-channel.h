@@ -68,6 +68,21 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+  /**
+   * \brief Transmit a burst of packets
+   *
+   * Each packet is sent with its own receive time, so the remote device
+   * receives the packets of a burst one at a time.
+   *
+   * \param burst Packets to transmit
+   * \param txEnd Time at which the last bit of each packet of the burst is
+   *        transmitted, relative to now
+   * \param src Source PointToPointNetDevice
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitBurst (Ptr<const PacketBurst> burst, const std::vector<Time> &txEnd,
+                              Ptr<PointToPointNetDevice> src);
 };
 
 } // namespace ns3
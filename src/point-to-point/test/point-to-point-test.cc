@@ -24,6 +24,10 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -94,6 +98,133 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for the burst transmission of the PointToPoint model
+ *
+ * It sends a train of packets over a PointToPointChannel one at a time
+ * and then in bursts, and checks that the bursts deliver the same packets
+ * in order with fewer events, no earlier than their last bit arrives.
+ */
+class PointToPointBurstTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBurstTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a train of packets to the device specified
+   *
+   * \param device NetDevice to send to
+   */
+  void SendPackets (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Record a received packet
+   *
+   * \param device the receiving NetDevice
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Run the simulation
+   *
+   * \param maxBurstSize the MaxBurstSize attribute of the devices
+   * \returns the number of events executed
+   */
+  uint64_t RunSimulation (uint32_t maxBurstSize);
+
+  std::vector<uint32_t> m_sizes;  //!< The sizes of the packets received
+  std::vector<Time> m_times;      //!< The times the packets were received
+};
+
+PointToPointBurstTest::PointToPointBurstTest ()
+  : TestCase ("PointToPoint burst transmission")
+{
+}
+
+void
+PointToPointBurstTest::SendPackets (Ptr<PointToPointNetDevice> device)
+{
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      device->Send (Create<Packet> (100 + i), device->GetBroadcast (), 0x800);
+    }
+}
+
+bool
+PointToPointBurstTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_sizes.push_back (packet->GetSize ());
+  m_times.push_back (Simulator::Now ());
+  return true;
+}
+
+uint64_t
+PointToPointBurstTest::RunSimulation (uint32_t maxBurstSize)
+{
+  m_sizes.clear ();
+  m_times.clear ();
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devA->SetDataRate (DataRate ("1Mbps"));
+  devA->SetInterframeGap (MicroSeconds (10));
+  devA->SetAttribute ("MaxBurstSize", UintegerValue (maxBurstSize));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointBurstTest::Receive, this));
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointBurstTest::SendPackets, this, devA);
+
+  Simulator::Run ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return events;
+}
+
+void
+PointToPointBurstTest::DoRun (void)
+{
+  uint64_t events = RunSimulation (1);
+  std::vector<uint32_t> sizes = m_sizes;
+  std::vector<Time> times = m_times;
+  NS_TEST_ASSERT_MSG_EQ (sizes.size (), 50, "All the packets should be received");
+
+  uint64_t burstEvents = RunSimulation (10);
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 50, "All the packets of the bursts should be received");
+  // one transmit complete event per burst instead of one per packet
+  NS_TEST_EXPECT_MSG_LT (burstEvents, events * 3 / 5, "The bursts should cut the number of events");
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_sizes[i], sizes[i], "The packets should be received in order");
+      NS_TEST_EXPECT_MSG_EQ (m_times[i], times[i], "Packet " << i << " should be received when its last bit arrives");
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +241,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBurstTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -20,6 +20,7 @@
 
 #include <ns3/object.h>
 #include <ns3/simulator.h>
+#include <ns3/event-fan-out.h>
 #include <ns3/log.h>
 #include <ns3/packet.h>
 #include <ns3/packet-burst.h>
@@ -105,6 +106,8 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 
   Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
+  // the receptions with the same delay are scheduled as one batch
+  EventFanOut fanOut;
 
   for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
        rxPhyIterator != m_phyList.end ();
@@ -175,16 +178,18 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
             {
               // the receiver has a NetDevice, so we expect that it is attached to a Node
               uint32_t dstNode =  netDev->GetNode ()->GetId ();
-              Simulator::ScheduleWithContext (dstNode, delay, &SingleModelSpectrumChannel::StartRx, this, rxParams, *rxPhyIterator);
+              fanOut.Add (dstNode, delay, MakeEvent (&SingleModelSpectrumChannel::StartRx, this, rxParams, *rxPhyIterator));
             }
           else
             {
               // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-              Simulator::Schedule (delay, &SingleModelSpectrumChannel::StartRx, this,
-                                   rxParams, *rxPhyIterator);
+              fanOut.Add (Simulator::GetContext (), delay,
+                          MakeEvent (&SingleModelSpectrumChannel::StartRx, this,
+                                     rxParams, *rxPhyIterator));
             }
         }
     }
+  fanOut.Schedule ();
 }
 
 void
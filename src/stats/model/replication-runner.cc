@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "replication-runner.h"
+#include "ns3/simulator.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ReplicationRunner");
+
+ReplicationRunner::ReplicationRunner ()
+  : m_completed (0),
+    m_failed (0)
+{
+  NS_LOG_FUNCTION (this);
+  long processors = sysconf (_SC_NPROCESSORS_ONLN);
+  m_maxWorkers = processors > 0 ? processors : 1;
+  m_replications = m_maxWorkers;
+}
+
+void
+ReplicationRunner::SetReplications (uint32_t replications)
+{
+  NS_LOG_FUNCTION (this << replications);
+  m_replications = replications;
+}
+
+void
+ReplicationRunner::SetMaxWorkers (uint32_t workers)
+{
+  NS_LOG_FUNCTION (this << workers);
+  NS_ASSERT_MSG (workers > 0, "at least one worker is needed");
+  m_maxWorkers = workers;
+}
+
+void
+ReplicationRunner::AddMetric (std::string name, Callback<double> metric)
+{
+  NS_LOG_FUNCTION (this << name);
+  Metric m;
+  m.name = name;
+  m.callback = metric;
+  m_metrics.push_back (m);
+}
+
+void
+ReplicationRunner::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t firstRun = RngSeedManager::GetRun ();
+  // otherwise the workers would print the output buffered so far again
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+
+  std::deque<Worker> workers;
+  for (uint32_t i = 0; i < m_replications; ++i)
+    {
+      if (workers.size () == m_maxWorkers)
+        {
+          Collect (workers.front ());
+          workers.pop_front ();
+        }
+      int fds[2];
+      if (pipe (fds) != 0)
+        {
+          NS_FATAL_ERROR ("pipe failed: " << std::strerror (errno));
+        }
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("fork failed for replication " << i << ": " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          close (fds[0]);
+          RunWorker (firstRun + i, fds[1]);
+        }
+      NS_LOG_LOGIC ("replication " << i << " is process " << pid);
+      close (fds[1]);
+      Worker worker;
+      worker.pid = pid;
+      worker.fd = fds[0];
+      workers.push_back (worker);
+    }
+  while (!workers.empty ())
+    {
+      Collect (workers.front ());
+      workers.pop_front ();
+    }
+}
+
+void
+ReplicationRunner::RunWorker (uint64_t run, int fd)
+{
+  RngSeedManager::SetRun (run);
+  RandomVariableStream::ReseedAll ();
+  Simulator::Run ();
+
+  std::vector<double> values;
+  for (std::vector<Metric>::iterator i = m_metrics.begin (); i != m_metrics.end (); ++i)
+    {
+      values.push_back (i->callback ());
+    }
+  const char *buffer = reinterpret_cast<const char *> (values.data ());
+  size_t size = values.size () * sizeof (double);
+  while (size > 0)
+    {
+      ssize_t written = write (fd, buffer, size);
+      if (written < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (written <= 0)
+        {
+          _exit (1);
+        }
+      buffer += written;
+      size -= written;
+    }
+  close (fd);
+  // the static objects belong to the calling process, do not destroy
+  // them a second time
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+  _exit (0);
+}
+
+void
+ReplicationRunner::Collect (const Worker &worker)
+{
+  NS_LOG_FUNCTION (this << worker.pid);
+  std::vector<double> values (m_metrics.size ());
+  char *buffer = reinterpret_cast<char *> (values.data ());
+  size_t size = values.size () * sizeof (double);
+  while (size > 0)
+    {
+      ssize_t got = read (worker.fd, buffer, size);
+      if (got < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (got <= 0)
+        {
+          break;
+        }
+      buffer += got;
+      size -= got;
+    }
+  close (worker.fd);
+
+  int status;
+  pid_t pid;
+  do
+    {
+      pid = waitpid (worker.pid, &status, 0);
+    }
+  while (pid < 0 && errno == EINTR);
+  if (size != 0 || pid < 0 || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    {
+      NS_LOG_WARN ("replication process " << worker.pid << " failed");
+      m_failed++;
+      return;
+    }
+  for (uint32_t i = 0; i < values.size (); ++i)
+    {
+      m_metrics[i].average.Update (values[i]);
+    }
+  m_completed++;
+}
+
+uint32_t
+ReplicationRunner::GetCompleted (void) const
+{
+  return m_completed;
+}
+
+uint32_t
+ReplicationRunner::GetFailed (void) const
+{
+  return m_failed;
+}
+
+const Average<double> &
+ReplicationRunner::GetMetric (std::string name) const
+{
+  for (std::vector<Metric>::const_iterator i = m_metrics.begin (); i != m_metrics.end (); ++i)
+    {
+      if (i->name == name)
+        {
+          return i->average;
+        }
+    }
+  NS_FATAL_ERROR ("unknown metric " << name);
+  // quiet compiler.
+  static const Average<double> unknown;
+  return unknown;
+}
+
+void
+ReplicationRunner::Print (std::ostream &os) const
+{
+  for (std::vector<Metric>::const_iterator i = m_metrics.begin (); i != m_metrics.end (); ++i)
+    {
+      os << i->name << ": ";
+      if (i->average.Count () == 0)
+        {
+          os << "NA" << std::endl;
+          continue;
+        }
+      os << i->average.Mean () << " +- " << i->average.Error95 ()
+         << " (95% confidence, " << i->average.Count () << " replications)"
+         << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include "ns3/callback.h"
+#include "average.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ *
+ * \brief Run independent replications of a scenario built once.
+ *
+ * The scenario is built once by the calling process, then Run() forks
+ * one worker process per replication.  Each worker shares the pages of
+ * the built topology with the calling process until it modifies them,
+ * sets its own run number with RngSeedManager::SetRun(), restarts the
+ * existing random streams with RandomVariableStream::ReseedAll(), runs
+ * the simulation and sends the values of the metrics back through a
+ * pipe.  The calling process aggregates them, with one Average per
+ * metric, to give their mean and confidence interval.
+ *
+ * \code
+ *   // build the scenario
+ *   Simulator::Stop (Seconds (60));
+ *   ReplicationRunner runner;
+ *   runner.SetReplications (30);
+ *   runner.AddMetric ("throughput", MakeCallback (&GetThroughput));
+ *   runner.Run ();
+ *   runner.Print (std::cout);
+ *   Simulator::Destroy ();
+ * \endcode
+ *
+ * Replication \c i uses the run number of the calling process plus
+ * \c i.  The simulator must have a stop time or run out of events.
+ * Only the thread running the simulation is copied by the fork, so
+ * the runner cannot be used with a simulator implementation running
+ * events on several threads.
+ */
+class ReplicationRunner
+{
+public:
+  /** Create a runner with one replication per processor. */
+  ReplicationRunner ();
+
+  /**
+   * Set the number of replications.
+   * \param [in] replications The number of replications.
+   */
+  void SetReplications (uint32_t replications);
+  /**
+   * Set the maximum number of workers running at the same time.
+   * \param [in] workers The maximum number of workers, by default the
+   *             number of online processors.
+   */
+  void SetMaxWorkers (uint32_t workers);
+  /**
+   * Add a metric, evaluated by each worker at the end of its run.
+   * \param [in] name The name of the metric.
+   * \param [in] metric The callback returning the value of the metric.
+   */
+  void AddMetric (std::string name, Callback<double> metric);
+
+  /**
+   * Run the replications and aggregate their metrics.
+   *
+   * The state of the simulation in the calling process is left as
+   * built, and can still be destroyed with Simulator::Destroy().
+   */
+  void Run (void);
+
+  /**
+   * \returns The number of replications which completed.
+   */
+  uint32_t GetCompleted (void) const;
+  /**
+   * \returns The number of replications which failed.
+   */
+  uint32_t GetFailed (void) const;
+  /**
+   * Get the aggregated values of a metric.
+   * \param [in] name The name of the metric.
+   * \returns The statistics of the metric over the completed
+   *          replications.
+   */
+  const Average<double> & GetMetric (std::string name) const;
+  /**
+   * Print the mean and 95% confidence interval of each metric.
+   * \param [in,out] os The output stream.
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  /** A metric of the replications. */
+  struct Metric
+  {
+    std::string name;            //!< The name of the metric.
+    Callback<double> callback;   //!< The callback returning its value.
+    Average<double> average;     //!< The aggregated values.
+  };
+  /** A worker process. */
+  struct Worker
+  {
+    pid_t pid;                   //!< The process id.
+    int fd;                      //!< The read end of its pipe.
+  };
+
+  /**
+   * Run one replication in a worker process, and exit.
+   * \param [in] run The run number of the replication.
+   * \param [in] fd The write end of the pipe.
+   */
+  void RunWorker (uint64_t run, int fd);
+  /**
+   * Read the metrics of a worker and wait for its end.
+   * \param [in] worker The worker.
+   */
+  void Collect (const Worker &worker);
+
+  uint32_t m_replications;          //!< The number of replications.
+  uint32_t m_maxWorkers;            //!< The maximum number of workers.
+  uint32_t m_completed;             //!< The completed replications.
+  uint32_t m_failed;                //!< The failed replications.
+  std::vector<Metric> m_metrics;    //!< The metrics.
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_RUNNER_H */
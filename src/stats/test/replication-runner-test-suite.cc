@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/replication-runner.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+// ===========================================================================
+// Test case for the replications of a scenario built once.
+// ===========================================================================
+
+class ReplicationRunnerTestCase : public TestCase
+{
+public:
+  ReplicationRunnerTestCase ();
+  virtual ~ReplicationRunnerTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** Event of the scenario, drawing a random value. */
+  void Draw (void);
+  /** \returns The number of events run. */
+  double GetEvents (void);
+  /** \returns The sum of the random values drawn. */
+  double GetSum (void);
+
+  Ptr<UniformRandomVariable> m_random;   //!< Created before the fork.
+  uint32_t m_events;                     //!< The number of events run.
+  double m_sum;                          //!< The sum of the values drawn.
+};
+
+ReplicationRunnerTestCase::ReplicationRunnerTestCase ()
+  : TestCase ("Check the aggregated metrics of forked replications"),
+    m_events (0),
+    m_sum (0)
+{
+}
+
+ReplicationRunnerTestCase::~ReplicationRunnerTestCase ()
+{
+}
+
+void
+ReplicationRunnerTestCase::Draw (void)
+{
+  m_events++;
+  m_sum += m_random->GetValue ();
+}
+
+double
+ReplicationRunnerTestCase::GetEvents (void)
+{
+  return m_events;
+}
+
+double
+ReplicationRunnerTestCase::GetSum (void)
+{
+  return m_sum;
+}
+
+void
+ReplicationRunnerTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &ReplicationRunnerTestCase::Draw, this);
+    }
+
+  ReplicationRunner runner;
+  runner.SetReplications (5);
+  runner.SetMaxWorkers (2);
+  runner.AddMetric ("events", MakeCallback (&ReplicationRunnerTestCase::GetEvents, this));
+  runner.AddMetric ("sum", MakeCallback (&ReplicationRunnerTestCase::GetSum, this));
+  runner.Run ();
+
+  // the scenario of this process is left as built
+  NS_TEST_EXPECT_MSG_EQ (m_events, 0, "events run by the calling process");
+  Simulator::Destroy ();
+  m_random = 0;
+
+  NS_TEST_ASSERT_MSG_EQ (runner.GetCompleted (), 5, "replications missing");
+  NS_TEST_EXPECT_MSG_EQ (runner.GetFailed (), 0, "replications failed");
+  const Average<double> &events = runner.GetMetric ("events");
+  NS_TEST_EXPECT_MSG_EQ (events.Count (), 5, "wrong number of samples");
+  NS_TEST_EXPECT_MSG_EQ (events.Min (), 10, "wrong number of events");
+  NS_TEST_EXPECT_MSG_EQ (events.Max (), 10, "wrong number of events");
+  const Average<double> &sum = runner.GetMetric ("sum");
+  NS_TEST_EXPECT_MSG_EQ (sum.Count (), 5, "wrong number of samples");
+  NS_TEST_EXPECT_MSG_LT (sum.Min (), sum.Max (), "replications not independent");
+  NS_TEST_EXPECT_MSG_GT (sum.Error95 (), 0, "no confidence interval");
+}
+
+
+class ReplicationRunnerTestSuite : public TestSuite
+{
+public:
+  ReplicationRunnerTestSuite ();
+};
+
+ReplicationRunnerTestSuite::ReplicationRunnerTestSuite ()
+  : TestSuite ("replication-runner", UNIT)
+{
+  AddTestCase (new ReplicationRunnerTestCase, TestCase::QUICK);
+}
+
+static ReplicationRunnerTestSuite replicationRunnerTestSuite;
@@ -168,6 +168,12 @@ VisualSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, E
   m_simulator->ScheduleWithContext (context, delay, event);
 }
 
+void
+VisualSimulatorImpl::ScheduleWithContextBatch (Time const &delay, const Simulator::EventBatch &batch)
+{
+  m_simulator->ScheduleWithContextBatch (delay, batch);
+}
+
 EventId
 VisualSimulatorImpl::ScheduleNow (EventImpl *event)
 {
@@ -59,6 +59,7 @@ public:
   virtual void Stop (Time const &delay);
   virtual EventId Schedule (Time const &delay, EventImpl *event);
   virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContextBatch (Time const &delay, const Simulator::EventBatch &batch);
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
   virtual void Remove (const EventId &id);
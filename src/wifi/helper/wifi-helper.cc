@@ -39,6 +39,7 @@
 #include "ns3/he-configuration.h"
 #include "ns3/obss-pd-algorithm.h"
 #include "ns3/wifi-ack-policy-selector.h"
+#include "ns3/binary-trace-file.h"
 #include "wifi-helper.h"
 
 namespace ns3 {
@@ -64,6 +65,12 @@ AsciiPhyTransmitSinkWithContext (
   uint8_t txLevel)
 {
   NS_LOG_FUNCTION (stream << context << p << mode << preamble << txLevel);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::TRANSMIT, context, p);
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << " " << mode << " " << *p << std::endl;
 }
 
@@ -84,6 +91,12 @@ AsciiPhyTransmitSinkWithoutContext (
   uint8_t txLevel)
 {
   NS_LOG_FUNCTION (stream << p << mode << preamble << txLevel);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::TRANSMIT, "", p);
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << mode << " " << *p << std::endl;
 }
 
@@ -106,6 +119,12 @@ AsciiPhyReceiveSinkWithContext (
   WifiPreamble preamble)
 {
   NS_LOG_FUNCTION (stream << context << p << snr << mode << preamble);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::RECEIVE, context, p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << mode << "" << context << " " << *p << std::endl;
 }
 
@@ -126,6 +145,12 @@ AsciiPhyReceiveSinkWithoutContext (
   WifiPreamble preamble)
 {
   NS_LOG_FUNCTION (stream << p << snr << mode << preamble);
+  Ptr<BinaryTraceWriter> writer = stream->GetBinaryTraceWriter ();
+  if (writer)
+    {
+      writer->Write (BinaryTraceWriter::RECEIVE, "", p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << mode << " " << *p << std::endl;
 }
 
@@ -243,8 +268,9 @@ WifiPhyHelper::PcapSniffTxEvent (
       {
         Ptr<Packet> p = packet->Copy ();
         RadiotapHeader header = GetRadiotapHeader (p, channelFreqMhz, txVector, aMpdu);
-        p->AddHeader (header);
-        file->Write (Simulator::Now (), p);
+        // write the header before the packet without adding it, which
+        // would copy the whole packet: only the snap length is copied
+        file->Write (Simulator::Now (), header, p);
         return;
       }
     default:
@@ -278,8 +304,7 @@ WifiPhyHelper::PcapSniffRxEvent (
         RadiotapHeader header = GetRadiotapHeader (p, channelFreqMhz, txVector, aMpdu);
         header.SetAntennaSignalPower (signalNoise.signal);
         header.SetAntennaNoisePower (signalNoise.noise);
-        p->AddHeader (header);
-        file->Write (Simulator::Now (), p);
+        file->Write (Simulator::Now (), header, p);
         return;
       }
     default:
@@ -180,6 +180,7 @@ void
 WifiNetDevice::SetMac (const Ptr<WifiMac> mac)
 {
   m_mac = mac;
+  Object::NotifyGraphChange ();
   CompleteConfig ();
 }
 
@@ -187,6 +188,7 @@ void
 WifiNetDevice::SetPhy (const Ptr<WifiPhy> phy)
 {
   m_phy = phy;
+  Object::NotifyGraphChange ();
   CompleteConfig ();
 }
 
@@ -194,6 +196,7 @@ void
 WifiNetDevice::SetRemoteStationManager (const Ptr<WifiRemoteStationManager> manager)
 {
   m_stationManager = manager;
+  Object::NotifyGraphChange ();
   CompleteConfig ();
 }
 
@@ -2474,6 +2474,11 @@ void
 WifiPhy::NotifyMonitorSniffRx (Ptr<const WifiPsdu> psdu, uint16_t channelFreqMhz, WifiTxVector txVector,
                                SignalNoiseDbm signalNoise, std::vector<bool> statusPerMpdu)
 {
+  if (m_phyMonitorSniffRxTrace.IsEmpty ())
+    {
+      // do not build the packets if there is no sniffer
+      return;
+    }
   MpduInfo aMpdu;
   if (psdu->IsAggregate ())
     {
@@ -2504,6 +2509,10 @@ WifiPhy::NotifyMonitorSniffRx (Ptr<const WifiPsdu> psdu, uint16_t channelFreqMhz
 void
 WifiPhy::NotifyMonitorSniffTx (Ptr<const WifiPsdu> psdu, uint16_t channelFreqMhz, WifiTxVector txVector)
 {
+  if (m_phyMonitorSniffTxTrace.IsEmpty ())
+    {
+      return;
+    }
   MpduInfo aMpdu;
   if (psdu->IsAggregate ())
     {
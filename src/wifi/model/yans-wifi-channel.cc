@@ -19,6 +19,7 @@
  */
 
 #include "ns3/simulator.h"
+#include "ns3/event-fan-out.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/net-device.h"
@@ -88,6 +89,8 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double
   NS_LOG_FUNCTION (this << sender << ppdu << txPowerDbm);
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
+  // the receptions with the same delay are scheduled as one batch
+  EventFanOut fanOut;
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
     {
       if (sender != (*i))
@@ -115,11 +118,11 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double
               dstNode = dstNetDevice->GetNode ()->GetId ();
             }
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm);
+          fanOut.Add (dstNode, delay, MakeEvent (&YansWifiChannel::Receive,
+                                                 (*i), copy, rxPowerDbm));
         }
     }
+  fanOut.Schedule ();
 }
 
 void
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the resolution of Config paths in the setup
+// of a large topology: it connects a trace sink to the devices of each
+// node with one path per node, connects the devices of all the nodes
+// with wildcard paths, and sets an attribute of each node's devices.
+// With --invalidate, a new generation of the graph of objects is
+// started before each call, so that nothing is remembered between the
+// resolutions.
+// Sample usage:  ./waf --run 'bench-config --nodes=20000'
+//                ./waf --run 'bench-config --nodes=20000 --invalidate'
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+/**
+ * A trace sink which does nothing.
+ * \param [in] context The context of the trace source.
+ * \param [in] packet The packet dropped.
+ */
+static void
+PhyRxDrop (std::string context, Ptr<const Packet> packet)
+{
+}
+
+/**
+ * Connect, or set through, paths and report the time taken.
+ * \param [in] name The name of the step.
+ * \param [in] paths The paths.
+ * \param [in] set Set the PointToPointMode attribute, else connect the PhyRxDrop trace.
+ * \param [in] invalidate Start a new generation of the graph before each path.
+ */
+static void
+Bench (std::string name, const std::vector<std::string> &paths, bool set, bool invalidate)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  for (std::vector<std::string>::const_iterator i = paths.begin (); i != paths.end (); ++i)
+    {
+      if (invalidate)
+        {
+          Object::NotifyGraphChange ();
+        }
+      if (set)
+        {
+          Config::Set (*i + "/PointToPointMode", BooleanValue (true));
+        }
+      else
+        {
+          Config::Connect (*i + "/PhyRxDrop", MakeCallback (&PhyRxDrop));
+        }
+    }
+  double elapsed = time.End () / 1000.0;
+  LOG (std::left << std::setw (24) << name
+                 << std::setw (12) << paths.size ()
+                 << std::setw (12) << elapsed
+                 << std::setw (14) << paths.size () / elapsed);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nodes = 5000;
+  uint32_t devices = 2;
+  uint32_t wildcards = 10;
+  bool invalidate = false;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the resolution of Config paths in a large topology.");
+  cmd.AddValue ("nodes",      "number of nodes",                              nodes);
+  cmd.AddValue ("devices",    "number of devices per node",                   devices);
+  cmd.AddValue ("wildcards",  "number of connections of all the devices",     wildcards);
+  cmd.AddValue ("invalidate", "start a new generation of objects before each path", invalidate);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  LOGME ("nodes: " << nodes);
+  LOGME ("devices per node: " << devices);
+  LOGME ("wildcard connections: " << wildcards);
+  LOGME ("invalidate: " << invalidate);
+
+  NodeContainer container;
+  container.Create (nodes);
+  for (uint32_t i = 0; i < nodes; ++i)
+    {
+      for (uint32_t j = 0; j < devices; ++j)
+        {
+          container.Get (i)->AddDevice (CreateObject<SimpleNetDevice> ());
+        }
+    }
+
+  std::vector<std::string> perNode;
+  for (uint32_t i = 0; i < nodes; ++i)
+    {
+      std::ostringstream oss;
+      oss << "/NodeList/" << i << "/DeviceList/*/$ns3::SimpleNetDevice";
+      perNode.push_back (oss.str ());
+    }
+  std::vector<std::string> all (wildcards, "/NodeList/*/DeviceList/*/$ns3::SimpleNetDevice");
+
+  LOG ("");
+  LOG (std::left << std::setw (24) << "Step"
+                 << std::setw (12) << "Paths"
+                 << std::setw (12) << "Time (s)"
+                 << std::setw (14) << "Rate (paths/s)");
+  Bench ("connect per node", perNode, false, invalidate);
+  Bench ("connect all nodes", all, false, invalidate);
+  Bench ("set per node", perNode, true, invalidate);
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the lookups of the TypeIds and of their
+// attributes by name, and the creation of objects configured with
+// attributes by an ObjectFactory, as the helpers do for each device
+// and queue they install.
+// Sample usage:  ./waf --run 'bench-factory --objects=1000000'
+
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+/**
+ * Report the time taken by a step.
+ * \param [in] name The name of the step.
+ * \param [in] count The number of operations.
+ * \param [in] time The timer started before the step.
+ */
+static void
+Report (std::string name, uint64_t count, SystemWallClockMs &time)
+{
+  double elapsed = time.End () / 1000.0;
+  LOG (std::left << std::setw (20) << name
+                 << std::setw (12) << count
+                 << std::setw (12) << elapsed
+                 << std::setw (14) << (count > 0 ? 1e9 * elapsed / count : 0));
+}
+
+/**
+ * Look up all the registered TypeIds by name, repeatedly.
+ * \param [in] lookups The number of lookups.
+ */
+static void
+BenchTypeId (uint64_t lookups)
+{
+  std::vector<std::string> names;
+  for (uint16_t i = 0; i < TypeId::GetRegisteredN (); i++)
+    {
+      names.push_back (TypeId::GetRegistered (i).GetName ());
+    }
+  SystemWallClockMs time;
+  time.Start ();
+  uint64_t found = 0;
+  for (uint64_t i = 0; i < lookups; i++)
+    {
+      TypeId tid;
+      found += TypeId::LookupByNameFailSafe (names[i % names.size ()], &tid);
+    }
+  NS_ABORT_UNLESS (found == lookups);
+  Report ("lookup type", lookups, time);
+}
+
+/**
+ * Look up all the attributes of all the registered TypeIds by name,
+ * including the attributes of their parents, repeatedly.
+ * \param [in] lookups The number of lookups.
+ */
+static void
+BenchAttribute (uint64_t lookups)
+{
+  std::vector<std::pair<TypeId, std::string> > names;
+  for (uint16_t i = 0; i < TypeId::GetRegisteredN (); i++)
+    {
+      TypeId tid = TypeId::GetRegistered (i);
+      for (TypeId parent = tid; ; parent = parent.GetParent ())
+        {
+          for (std::size_t j = 0; j < parent.GetAttributeN (); j++)
+            {
+              struct TypeId::AttributeInformation info = parent.GetAttribute (j);
+              if (info.supportLevel == TypeId::SUPPORTED)
+                {
+                  names.push_back (std::make_pair (tid, info.name));
+                }
+            }
+          if (parent.GetParent () == parent)
+            {
+              break;
+            }
+        }
+    }
+  SystemWallClockMs time;
+  time.Start ();
+  uint64_t found = 0;
+  for (uint64_t i = 0; i < lookups; i++)
+    {
+      const std::pair<TypeId, std::string> &name = names[i % names.size ()];
+      struct TypeId::AttributeInformation info;
+      found += name.first.LookupAttributeByName (name.second, &info);
+    }
+  NS_ABORT_UNLESS (found == lookups);
+  Report ("lookup attribute", lookups, time);
+}
+
+/**
+ * Create objects with a factory, repeatedly.
+ * \param [in] name The name of the step.
+ * \param [in] objects The number of objects.
+ * \param [in] factory The factory.
+ */
+static void
+BenchCreate (std::string name, uint64_t objects, const ObjectFactory &factory)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint64_t i = 0; i < objects; i++)
+    {
+      factory.Create ();
+    }
+  Report (name, objects, time);
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t lookups = 10000000;
+  uint64_t objects = 1000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the lookups by name and the creation of configured objects.");
+  cmd.AddValue ("lookups", "number of lookups per step", lookups);
+  cmd.AddValue ("objects", "number of objects created per step", objects);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  LOGME ("registered TypeIds: " << TypeId::GetRegisteredN ());
+  LOGME ("lookups: " << lookups);
+  LOGME ("objects: " << objects);
+
+  ObjectFactory device ("ns3::SimpleNetDevice");
+  device.Set ("DataRate", StringValue ("5Mbps"));
+  device.Set ("PointToPointMode", StringValue ("true"));
+  ObjectFactory queue ("ns3::DropTailQueue<Packet>");
+  queue.Set ("MaxSize", StringValue ("100p"));
+
+  LOG ("");
+  LOG (std::left << std::setw (20) << "Step"
+                 << std::setw (12) << "Count"
+                 << std::setw (12) << "Time (s)"
+                 << std::setw (14) << "Time (ns/op)");
+  BenchTypeId (lookups);
+  BenchAttribute (lookups);
+  BenchCreate ("create device", objects, device);
+  BenchCreate ("create queue", objects, queue);
+
+  return 0;
+}
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+/**
+ * Measure the rate at which events scheduled by foreign threads, as
+ * done by the FdNetDevice and TapBridge reader threads, are received
+ * by the simulator.
+ */
+class Injector
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] producers The number of producer threads.
+   * \param [in] events The number of events injected by each producer.
+   * \param [in] poll Flag to keep the simulator busy while waiting for
+   *             the events, needed if Run() returns when no event is
+   *             pending.
+   */
+  Injector (uint32_t producers, uint32_t events, bool poll)
+    : m_producers (producers),
+      m_events (events),
+      m_poll (poll),
+      m_received (0)
+  {
+  }
+
+  /**
+   * Run the producers until all their events have been executed.
+   * \returns The elapsed time, in seconds.
+   */
+  double RunBench (void);
+
+private:
+  /** Producer thread body. */
+  void Produce (void);
+  /** Event injected by the producers. */
+  void Received (void);
+  /** Keep the event list non-empty. */
+  void Poll (void);
+
+  uint32_t m_producers;  ///< The number of producer threads.
+  uint32_t m_events;     ///< The number of events per producer.
+  bool m_poll;           ///< Keep the simulator busy.
+  uint64_t m_received;   ///< The number of events received.
+};
+
+void
+Injector::Produce (void)
+{
+  for (uint32_t i = 0; i < m_events; ++i)
+    {
+      Simulator::ScheduleWithContext (i % 16, Time (0), &Injector::Received, this);
+    }
+}
+
+void
+Injector::Received (void)
+{
+  m_received++;
+  if (m_received == static_cast<uint64_t> (m_producers) * m_events)
+    {
+      Simulator::Stop ();
+    }
+}
+
+void
+Injector::Poll (void)
+{
+  Simulator::Schedule (NanoSeconds (1), &Injector::Poll, this);
+}
+
+double
+Injector::RunBench (void)
+{
+  m_received = 0;
+  if (m_poll)
+    {
+      Simulator::Schedule (NanoSeconds (1), &Injector::Poll, this);
+    }
+  // create the simulator before the producers use it
+  Simulator::Now ();
+
+  SystemWallClockMs time;
+  time.Start ();
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < m_producers; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&Injector::Produce, this)));
+      threads.back ()->Start ();
+    }
+  Simulator::Run ();
+  double elapsed = time.End () / 1000.0;
+  for (uint32_t i = 0; i < m_producers; ++i)
+    {
+      threads[i]->Join ();
+    }
+  Simulator::Destroy ();
+  return elapsed;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t producers = 4;
+  uint32_t events = 250000;
+  uint32_t runs = 1;
+  bool realtime = false;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the injection of events by foreign threads.\n"
+             "\n"
+             "Each producer thread schedules events with ScheduleWithContext,\n"
+             "while the simulator runs in the main thread.");
+  cmd.AddValue ("producers", "number of producer threads",             producers);
+  cmd.AddValue ("events",    "number of events injected per producer", events);
+  cmd.AddValue ("runs",      "number of runs",                         runs);
+  cmd.AddValue ("realtime",  "use RealtimeSimulatorImpl",              realtime);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  if (realtime)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::RealtimeSimulatorImpl"));
+    }
+
+  LOGME ("simulator: " << (realtime ? "ns3::RealtimeSimulatorImpl" : "ns3::DefaultSimulatorImpl"));
+  LOGME ("producers: " << producers);
+  LOGME ("events per producer: " << events);
+  LOGME ("runs: " << runs);
+  LOG ("");
+  LOG (std::left << std::setw (12) << "Run"
+                 << std::setw (12) << "Time (s)"
+                 << std::setw (12) << "Rate (ev/s)"
+                 << std::setw (12) << "Per (s/ev)");
+  LOG (std::setfill ('-')
+       << std::setw (12) << " "
+       << std::setw (12) << " "
+       << std::setw (12) << " "
+       << std::setw (12) << " "
+       << std::setfill (' '));
+
+  Injector injector (producers, events, !realtime);
+  double total = static_cast<double> (producers) * events;
+  for (uint32_t i = 0; i < runs; ++i)
+    {
+      double elapsed = injector.RunBench ();
+      LOG (std::left << std::setw (12) << i
+                     << std::setw (12) << elapsed
+                     << std::setw (12) << total / elapsed
+                     << std::setw (12) << elapsed / total);
+    }
+  return 0;
+}
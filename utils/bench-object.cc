@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks Object::GetObject on an aggregation of many
+// objects, like a node with its protocols, routing, mobility and energy
+// models: it looks up each of the aggregated objects in turn, then the
+// first one only, and a type which is not aggregated.
+// Sample usage:  ./waf --run 'bench-object --aggregates=20 --lookups=10000000'
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+/** The maximum number of aggregated objects. */
+static const uint32_t MAX_AGGREGATES = 32;
+
+/**
+ * An object of a distinct type for each value of \p N.
+ * \tparam N The number of the type.
+ */
+template <uint32_t N>
+class Aggregate : public Object
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static std::string name = "ns3::BenchObjectAggregate" + std::to_string (N);
+    static TypeId tid = TypeId (name.c_str ())
+      .SetParent<Object> ()
+      .SetGroupName ("Core")
+      .HideFromDocumentation ()
+      .AddConstructor<Aggregate<N> > ();
+    return tid;
+  }
+};
+
+/** An object which is never aggregated. */
+typedef Aggregate<MAX_AGGREGATES> Missing;
+
+/**
+ * Aggregate the objects of types 1 to \p N to an object, if \p N is
+ * at most \p count.
+ * \tparam N The number of the last type.
+ */
+template <uint32_t N>
+struct Aggregator
+{
+  /**
+   * \param [in] object The object of type 0.
+   * \param [in] count The number of aggregated objects.
+   */
+  static void Aggregate (Ptr<Object> object, uint32_t count)
+  {
+    Aggregator<N - 1>::Aggregate (object, count);
+    if (N < count)
+      {
+        object->AggregateObject (CreateObject< ::Aggregate<N> > ());
+      }
+  }
+  /**
+   * Look up the objects of types 0 to \p N.
+   * \param [in] object The object of type 0.
+   * \param [in] count The number of aggregated objects.
+   * \returns The number of objects found.
+   */
+  static uint32_t Lookup (Ptr<Object> object, uint32_t count)
+  {
+    uint32_t found = Aggregator<N - 1>::Lookup (object, count);
+    if (N < count && object->GetObject< ::Aggregate<N> > () != 0)
+      {
+        found++;
+      }
+    return found;
+  }
+};
+
+/** Stop the recursion of Aggregator. */
+template <>
+struct Aggregator<0>
+{
+  /**
+   * \param [in] object The object of type 0.
+   * \param [in] count The number of aggregated objects.
+   */
+  static void Aggregate (Ptr<Object> object, uint32_t count)
+  {
+  }
+  /**
+   * \param [in] object The object of type 0.
+   * \param [in] count The number of aggregated objects.
+   * \returns 1 if the object of type 0 is found.
+   */
+  static uint32_t Lookup (Ptr<Object> object, uint32_t count)
+  {
+    return object->GetObject< ::Aggregate<0> > () != 0 ? 1 : 0;
+  }
+};
+
+/**
+ * Run a lookup repeatedly and report the time taken.
+ * \param [in] name The name of the lookup.
+ * \param [in] lookups The number of lookups.
+ * \param [in] perCall The number of lookups per call of \p lookup.
+ * \param [in] lookup The lookup, returning the number of objects found.
+ */
+static void
+Bench (std::string name, uint64_t lookups, uint32_t perCall, Callback<uint32_t> lookup)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  uint64_t found = 0;
+  for (uint64_t i = 0; i < lookups / perCall; i++)
+    {
+      found += lookup ();
+    }
+  double elapsed = time.End () / 1000.0;
+  LOG (std::left << std::setw (16) << name
+                 << std::setw (12) << found
+                 << std::setw (12) << elapsed
+                 << std::setw (14) << (elapsed > 0 ? 1e9 * elapsed / lookups : 0));
+}
+
+/**
+ * Look up the object of a type.
+ * \tparam T The type.
+ * \param [in] object The object looked up.
+ * \returns 1 if it is found.
+ */
+template <typename T>
+static uint32_t
+LookupOne (Ptr<Object> object)
+{
+  return object->GetObject<T> () != 0 ? 1 : 0;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t aggregates = 16;
+  uint64_t lookups = 10000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark GetObject on an aggregation of many objects.");
+  cmd.AddValue ("aggregates", "number of aggregated objects", aggregates);
+  cmd.AddValue ("lookups",    "number of lookups per step",   lookups);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  NS_ABORT_MSG_UNLESS (aggregates >= 1 && aggregates <= MAX_AGGREGATES,
+                       "The number of aggregated objects is between 1 and " << MAX_AGGREGATES);
+  LOGME ("aggregates: " << aggregates);
+  LOGME ("lookups: " << lookups);
+
+  Ptr<Object> object = CreateObject<Aggregate<0> > ();
+  Aggregator<MAX_AGGREGATES - 1>::Aggregate (object, aggregates);
+
+  LOG ("");
+  LOG (std::left << std::setw (16) << "Lookup"
+                 << std::setw (12) << "Found"
+                 << std::setw (12) << "Time (s)"
+                 << std::setw (14) << "Time (ns/lookup)");
+  Bench ("all in turn", lookups, aggregates,
+         MakeBoundCallback (&Aggregator<MAX_AGGREGATES - 1>::Lookup, object, aggregates));
+  Bench ("first", lookups, 1, MakeBoundCallback (&LookupOne<Aggregate<0> >, object));
+  Bench ("missing", lookups, 1, MakeBoundCallback (&LookupOne<Missing>, object));
+
+  return 0;
+}
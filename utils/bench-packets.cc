@@ -328,6 +328,38 @@ benchByteTags (uint32_t n)
     }
 }
 
+static void
+benchPacketTags (uint32_t n)
+{
+  BenchTag<4> flowId;
+  BenchTag<1> priority;
+  BenchTag<9> packetInfo;
+  BenchTag<13> bearer;
+  BenchTag<2> tos;
+  BenchTag<3> missing;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (2000);
+      p->AddPacketTag (flowId);
+      p->AddPacketTag (priority);
+      p->AddPacketTag (packetInfo);
+      p->AddPacketTag (bearer);
+      p->AddPacketTag (tos);
+
+      // as a trace sink and the next hop would
+      Ptr<Packet> o = p->Copy ();
+      o->PeekPacketTag (flowId);
+      o->PeekPacketTag (missing);
+      o->RemovePacketTag (priority);
+      o->ReplacePacketTag (bearer);
+      o->PeekPacketTag (packetInfo);
+      o->RemovePacketTag (tos);
+      p->PeekPacketTag (missing);
+      p->RemovePacketTag (packetInfo);
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -385,6 +417,7 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchPacketTags, n, minIterations, "Benchmark packet tags");
 
   return 0;
 }
@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the device queues on a saturated dumbbell:
+// the left leaves send packets at the rate of their access links to
+// the left router, which forwards them over the bottleneck link to the
+// right router and then to the right leaves.  The routers forward the
+// packets with protocol handlers, without an internet stack, so that
+// the run time is dominated by the devices and their queues.
+// Sample usage:  ./waf --run 'bench-queue --queue=ns3::RingBufferQueue'
+//                ./waf --run 'bench-queue --maxBurstSize=16'
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+/**
+ * The nodes of the dumbbell and the traffic they exchange.
+ */
+class Dumbbell
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] queue The type of the device queues.
+   * \param [in] maxSize The maximum size of the device queues.
+   * \param [in] leaves The number of leaves on each side.
+   * \param [in] packetSize The size of the packets sent.
+   * \param [in] maxBurstSize The maximum number of packets per transmission.
+   */
+  Dumbbell (std::string queue, std::string maxSize, uint32_t leaves, uint32_t packetSize,
+            uint32_t maxBurstSize);
+
+  /**
+   * Run the simulation.
+   * \param [in] stop The simulation time.
+   * \returns The elapsed time, in seconds.
+   */
+  double RunBench (Time stop);
+
+  uint64_t m_sent;        ///< The packets sent by the left leaves.
+  uint64_t m_received;    ///< The packets received by the right leaves.
+  uint64_t m_dropped;     ///< The packets dropped by the queues.
+  uint64_t m_events;      ///< The events executed.
+
+private:
+  /**
+   * Send a packet from a left leaf and schedule the next one.
+   * \param [in] device The device of the left leaf.
+   */
+  void Send (Ptr<NetDevice> device);
+  /**
+   * Forward a packet received by a router.
+   * \param [in] device The device which received the packet.
+   * \param [in] packet The packet.
+   * \param [in] protocol The protocol number.
+   * \param [in] from The sender address.
+   * \param [in] to The destination address.
+   * \param [in] type The packet type.
+   */
+  void Forward (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType type);
+  /**
+   * Count a packet received by a right leaf.
+   * \param [in] device The device which received the packet.
+   * \param [in] packet The packet.
+   * \param [in] protocol The protocol number.
+   * \param [in] from The sender address.
+   * \param [in] to The destination address.
+   * \param [in] type The packet type.
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType type);
+  /**
+   * Count a packet dropped by a queue.
+   * \param [in] packet The packet.
+   */
+  void Drop (Ptr<const Packet> packet);
+
+  std::string m_queue;                 ///< The type of the device queues.
+  std::string m_maxSize;               ///< The maximum size of the device queues.
+  uint32_t m_leaves;                   ///< The number of leaves on each side.
+  uint32_t m_packetSize;               ///< The size of the packets.
+  uint32_t m_maxBurstSize;             ///< The maximum number of packets per transmission.
+  Time m_interval;                     ///< The interval between two packets of a leaf.
+  Ptr<NetDevice> m_leftBottleneck;     ///< The bottleneck device of the left router.
+  NetDeviceContainer m_rightLeaves;    ///< The devices of the right router to the leaves.
+};
+
+Dumbbell::Dumbbell (std::string queue, std::string maxSize, uint32_t leaves, uint32_t packetSize,
+                    uint32_t maxBurstSize)
+  : m_sent (0),
+    m_received (0),
+    m_dropped (0),
+    m_events (0),
+    m_queue (queue),
+    m_maxSize (maxSize),
+    m_leaves (leaves),
+    m_packetSize (packetSize),
+    m_maxBurstSize (maxBurstSize)
+{
+}
+
+void
+Dumbbell::Send (Ptr<NetDevice> device)
+{
+  device->Send (Create<Packet> (m_packetSize), device->GetBroadcast (), 0x0800);
+  m_sent++;
+  Simulator::Schedule (m_interval, &Dumbbell::Send, this, device);
+}
+
+void
+Dumbbell::Forward (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                   const Address &from, const Address &to, NetDevice::PacketType type)
+{
+  Ptr<NetDevice> next;
+  if (device->GetNode () == m_leftBottleneck->GetNode ())
+    {
+      next = m_leftBottleneck;
+    }
+  else
+    {
+      next = m_rightLeaves.Get (packet->GetUid () % m_leaves);
+    }
+  next->Send (packet->Copy (), next->GetBroadcast (), protocol);
+}
+
+void
+Dumbbell::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                   const Address &from, const Address &to, NetDevice::PacketType type)
+{
+  m_received++;
+}
+
+void
+Dumbbell::Drop (Ptr<const Packet> packet)
+{
+  m_dropped++;
+}
+
+double
+Dumbbell::RunBench (Time stop)
+{
+  PointToPointHelper access;
+  access.SetQueue (m_queue, "MaxSize", StringValue (m_maxSize));
+  access.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  access.SetDeviceAttribute ("MaxBurstSize", UintegerValue (m_maxBurstSize));
+  PointToPointHelper bottleneck;
+  bottleneck.SetQueue (m_queue, "MaxSize", StringValue (m_maxSize));
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  bottleneck.SetDeviceAttribute ("MaxBurstSize", UintegerValue (m_maxBurstSize));
+
+  NodeContainer routers;
+  routers.Create (2);
+  NetDeviceContainer link = bottleneck.Install (routers);
+  m_leftBottleneck = link.Get (0);
+  NetDeviceContainer leftLeaves;
+  for (uint32_t i = 0; i < m_leaves; ++i)
+    {
+      Ptr<Node> left = CreateObject<Node> ();
+      NetDeviceContainer devices = access.Install (left, routers.Get (0));
+      leftLeaves.Add (devices.Get (0));
+      routers.Get (0)->RegisterProtocolHandler (MakeCallback (&Dumbbell::Forward, this), 0, devices.Get (1));
+
+      Ptr<Node> right = CreateObject<Node> ();
+      devices = access.Install (routers.Get (1), right);
+      m_rightLeaves.Add (devices.Get (0));
+      right->RegisterProtocolHandler (MakeCallback (&Dumbbell::Receive, this), 0, devices.Get (1));
+    }
+  routers.Get (1)->RegisterProtocolHandler (MakeCallback (&Dumbbell::Forward, this), 0, link.Get (1));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/TxQueue/Drop",
+                                 MakeCallback (&Dumbbell::Drop, this));
+
+  // the leaves saturate their access links, and the bottleneck
+  m_interval = Seconds ((m_packetSize + 2) * 8 / 100e6);
+  for (uint32_t i = 0; i < m_leaves; ++i)
+    {
+      Simulator::Schedule (NanoSeconds (i), &Dumbbell::Send, this, leftLeaves.Get (i));
+    }
+
+  Simulator::Stop (stop);
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  double elapsed = time.End () / 1000.0;
+  m_events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return elapsed;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string queue = "ns3::DropTailQueue";
+  std::string maxSize = "100p";
+  uint32_t leaves = 8;
+  uint32_t packetSize = 1000;
+  uint32_t maxBurstSize = 1;
+  double stop = 10;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the device queues on a saturated dumbbell.");
+  cmd.AddValue ("queue",        "type of the device queues",        queue);
+  cmd.AddValue ("maxSize",      "maximum size of the queues",       maxSize);
+  cmd.AddValue ("leaves",       "number of leaves on each side",    leaves);
+  cmd.AddValue ("packetSize",   "size of the packets",              packetSize);
+  cmd.AddValue ("maxBurstSize", "maximum packets per transmission", maxBurstSize);
+  cmd.AddValue ("stop",         "simulation time, in seconds",      stop);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  LOGME ("queue: " << queue);
+  LOGME ("max size: " << maxSize);
+  LOGME ("leaves: " << leaves);
+  LOGME ("packet size: " << packetSize);
+  LOGME ("max burst size: " << maxBurstSize);
+  LOGME ("simulation time: " << stop << " s");
+
+  Dumbbell dumbbell (queue, maxSize, leaves, packetSize, maxBurstSize);
+  double elapsed = dumbbell.RunBench (Seconds (stop));
+  uint64_t packets = dumbbell.m_sent;
+  LOG ("");
+  LOG (std::left << std::setw (12) << "Time (s)"
+                 << std::setw (12) << "Sent"
+                 << std::setw (12) << "Received"
+                 << std::setw (12) << "Dropped"
+                 << std::setw (12) << "Events"
+                 << std::setw (14) << "Rate (pkt/s)");
+  LOG (std::left << std::setw (12) << elapsed
+                 << std::setw (12) << packets
+                 << std::setw (12) << dumbbell.m_received
+                 << std::setw (12) << dumbbell.m_dropped
+                 << std::setw (12) << dumbbell.m_events
+                 << std::setw (14) << packets / elapsed);
+  return 0;
+}
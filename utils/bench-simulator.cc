@@ -146,17 +146,41 @@ Bench::Cb (void)
 
 
 Ptr<RandomVariableStream>
-GetRandomStream (std::string filename)
+GetRandomStream (std::string filename, std::string dist)
 {
   Ptr<RandomVariableStream> stream = 0;
 
-  if (filename == "")
+  if (filename == "" && dist == "exp")
     {
       LOGME ("using default exponential distribution");
       Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
       erv->SetAttribute ("Mean", DoubleValue (100));
       stream = erv;
     }
+  else if (filename == "" && dist == "uniform")
+    {
+      LOGME ("using uniform distribution");
+      Ptr<UniformRandomVariable> urv = CreateObject<UniformRandomVariable> ();
+      urv->SetAttribute ("Min", DoubleValue (0));
+      urv->SetAttribute ("Max", DoubleValue (200));
+      stream = urv;
+    }
+  else if (filename == "" && dist == "bimodal")
+    {
+      // 90% of the events within 200 ns, 10% around 100 us,
+      // like packet trains mixed with protocol timers
+      LOGME ("using bimodal distribution");
+      Ptr<EmpiricalRandomVariable> erv = CreateObject<EmpiricalRandomVariable> ();
+      erv->CDF (0, 0.0);
+      erv->CDF (200, 0.9);
+      erv->CDF (100000, 0.9);
+      erv->CDF (110000, 1.0);
+      stream = erv;
+    }
+  else if (filename == "")
+    {
+      NS_FATAL_ERROR ("unknown distribution " << dist);
+    }
   else
     {
       std::istream *input;
@@ -207,17 +231,23 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
+  bool schedPacked = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  std::string dist = "exp";
 
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
              "\n"
              "Event intervals are taken from one of:\n"
              "  an exponential distribution, with mean 100 ns,\n"
+             "  a uniform distribution between 0 and 200 ns (--dist=uniform),\n"
+             "  a bimodal distribution, 90% below 200 ns and 10% around\n"
+             "    100 us (--dist=bimodal),\n"
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
@@ -226,11 +256,14 @@ int main (int argc, char *argv[])
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("packed", "use PackedHeapScheduler",      schedPacked);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("dist",  "event time distribution: exp, uniform or bimodal", dist);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
@@ -249,6 +282,14 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::ListScheduler");
     }
+  if (schedLadder)
+    {
+      factory.SetTypeId ("ns3::LadderScheduler");
+    }
+  if (schedPacked)
+    {
+      factory.SetTypeId ("ns3::PackedHeapScheduler");
+    }
   Simulator::SetScheduler (factory);
 
   LOGME (std::setprecision (g_fwidth - 6));
@@ -260,7 +301,7 @@ int main (int argc, char *argv[])
   LOGME ("runs: " << runs);
 
   Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  bench->SetRandomStream (GetRandomStream (filename, dist));
 
   // table header
   LOG ("");
@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the trace sources fired on the packet paths:
+// a TracedCallback with no sink, one sink and several sinks, and the
+// assignment of a TracedValue with no sink and with one sink.
+// Sample usage:  ./waf --run 'bench-trace --calls=100000000'
+
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+/** The number of calls of the trace sinks. */
+static uint64_t g_sinkCalls = 0;
+
+/**
+ * A trace sink counting its calls.
+ * \param [in] value The traced value.
+ */
+static void
+Sink (uint32_t value)
+{
+  g_sinkCalls++;
+}
+
+/**
+ * A trace sink of a TracedValue counting its calls.
+ * \param [in] oldValue The previous value.
+ * \param [in] newValue The new value.
+ */
+static void
+ValueSink (uint32_t oldValue, uint32_t newValue)
+{
+  g_sinkCalls++;
+}
+
+/**
+ * Report the time taken by a step.
+ * \param [in] name The name of the step.
+ * \param [in] calls The number of calls.
+ * \param [in] time The timer started before the step.
+ */
+static void
+Report (std::string name, uint64_t calls, SystemWallClockMs &time)
+{
+  double elapsed = time.End () / 1000.0;
+  LOG (std::left << std::setw (20) << name
+                 << std::setw (14) << g_sinkCalls
+                 << std::setw (12) << elapsed
+                 << std::setw (14) << 1e9 * elapsed / calls);
+  g_sinkCalls = 0;
+}
+
+/**
+ * Fire a TracedCallback repeatedly.
+ * \param [in] name The name of the step.
+ * \param [in] calls The number of calls.
+ * \param [in] sinks The number of sinks connected.
+ */
+static void
+BenchCallback (std::string name, uint64_t calls, uint32_t sinks)
+{
+  TracedCallback<uint32_t> trace;
+  for (uint32_t i = 0; i < sinks; i++)
+    {
+      trace.ConnectWithoutContext (MakeCallback (&Sink));
+    }
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint64_t i = 0; i < calls; i++)
+    {
+      trace (i);
+    }
+  Report (name, calls, time);
+}
+
+/**
+ * Assign a TracedValue repeatedly.
+ * \param [in] name The name of the step.
+ * \param [in] calls The number of calls.
+ * \param [in] sinks The number of sinks connected.
+ */
+static void
+BenchValue (std::string name, uint64_t calls, uint32_t sinks)
+{
+  TracedValue<uint32_t> value;
+  for (uint32_t i = 0; i < sinks; i++)
+    {
+      value.ConnectWithoutContext (MakeCallback (&ValueSink));
+    }
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint64_t i = 0; i < calls; i++)
+    {
+      value = i;
+    }
+  Report (name, calls, time);
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t calls = 100000000;
+  uint32_t sinks = 4;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the trace sources with no, one and several sinks.");
+  cmd.AddValue ("calls", "number of calls per step",                 calls);
+  cmd.AddValue ("sinks", "number of sinks of the several sinks step", sinks);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  LOGME ("calls: " << calls);
+
+  LOG ("");
+  LOG (std::left << std::setw (20) << "Step"
+                 << std::setw (14) << "Sink calls"
+                 << std::setw (12) << "Time (s)"
+                 << std::setw (14) << "Time (ns/call)");
+  BenchCallback ("callback, no sink", calls, 0);
+  BenchCallback ("callback, one sink", calls, 1);
+  BenchCallback ("callback, sinks", calls, sinks);
+  BenchValue ("value, no sink", calls, 0);
+  BenchValue ("value, one sink", calls, 1);
+
+  return 0;
+}
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program converts a binary trace file, written by the ascii trace
+// helpers with a stream created by AsciiTraceHelper::CreateBinaryFileStream,
+// to a CSV file, or to one file per column for analysis tools: the
+// columns are arrays of native numbers (time.f64, type.u8, context.u32,
+// uid.u64, size.u32) which numpy.fromfile and similar functions read
+// directly, and contexts.csv maps the context ids to the context paths.
+// Sample usage:
+//   ./waf --run 'binary-trace-convert --input=trace.btr --output=trace.csv'
+//   ./waf --run 'binary-trace-convert --input=trace.btr --format=columns --output=trace'
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+#include "ns3/core-module.h"
+#include "ns3/binary-trace-file.h"
+
+using namespace ns3;
+
+/**
+ * \param [in] type The type of a record.
+ * \returns The character of the type in the ascii traces.
+ */
+static char
+GetTypeName (uint8_t type)
+{
+  switch (type)
+    {
+    case BinaryTraceWriter::ENQUEUE:
+      return '+';
+    case BinaryTraceWriter::DEQUEUE:
+      return '-';
+    case BinaryTraceWriter::DROP:
+      return 'd';
+    case BinaryTraceWriter::RECEIVE:
+      return 'r';
+    case BinaryTraceWriter::TRANSMIT:
+      return 't';
+    default:
+      return 't';
+    }
+}
+
+/**
+ * Quote a CSV field.
+ * \param [in] field The field.
+ * \returns The quoted field.
+ */
+static std::string
+Quote (const std::string &field)
+{
+  std::string quoted = "\"";
+  for (std::string::const_iterator i = field.begin (); i != field.end (); ++i)
+    {
+      if (*i == '"')
+        {
+          quoted += '"';
+        }
+      quoted += *i;
+    }
+  return quoted + "\"";
+}
+
+/**
+ * Write the records as CSV.
+ * \param [in] reader The reader of the binary trace.
+ * \param [in] os The output stream.
+ * \returns The number of records.
+ */
+static uint64_t
+WriteCsv (BinaryTraceReader &reader, std::ostream &os)
+{
+  os << std::setprecision (std::numeric_limits<double>::digits10);
+  os << "time,type,context,uid,size,text" << std::endl;
+  BinaryTraceWriter::Record record;
+  std::string text;
+  uint64_t records = 0;
+  while (reader.Next (record, text))
+    {
+      os << reader.GetSeconds (record.time) << "," << GetTypeName (record.type) << ","
+         << Quote (reader.GetContext (record.context)) << ",";
+      if (record.type == BinaryTraceWriter::TEXT)
+        {
+          os << ",," << Quote (text) << "\n";
+        }
+      else
+        {
+          os << record.uid << "," << record.size << ",\n";
+        }
+      records++;
+    }
+  return records;
+}
+
+/**
+ * Append a value to a column file.
+ * \param [in] os The column file.
+ * \param [in] value The value.
+ */
+template <typename T>
+static void
+Put (std::ofstream &os, T value)
+{
+  os.write (reinterpret_cast<const char *> (&value), sizeof (value));
+}
+
+/**
+ * Write the records in one file per column.
+ * \param [in] reader The reader of the binary trace.
+ * \param [in] prefix The prefix of the names of the column files.
+ * \returns The number of records.
+ */
+static uint64_t
+WriteColumns (BinaryTraceReader &reader, std::string prefix)
+{
+  const char *names[] = { "time.f64", "type.u8", "context.u32", "uid.u64", "size.u32" };
+  std::ofstream columns[5];
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      std::string filename = prefix + "-" + names[i];
+      columns[i].open (filename.c_str (), std::ios::out | std::ios::binary);
+      NS_ABORT_MSG_UNLESS (columns[i].is_open (), "Unable to open " << filename);
+    }
+
+  BinaryTraceWriter::Record record;
+  std::string text;
+  uint64_t records = 0;
+  uint32_t contexts = 0;
+  while (reader.Next (record, text))
+    {
+      Put (columns[0], reader.GetSeconds (record.time));
+      Put (columns[1], record.type);
+      Put (columns[2], record.context);
+      Put (columns[3], record.uid);
+      Put (columns[4], record.size);
+      contexts = std::max (contexts, record.context + 1);
+      records++;
+    }
+
+  std::string filename = prefix + "-contexts.csv";
+  std::ofstream os (filename.c_str ());
+  NS_ABORT_MSG_UNLESS (os.is_open (), "Unable to open " << filename);
+  os << "id,context" << std::endl;
+  for (uint32_t i = 0; i < contexts; ++i)
+    {
+      os << i << "," << Quote (reader.GetContext (i)) << std::endl;
+    }
+  return records;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string format = "csv";
+  std::string output;
+
+  CommandLine cmd;
+  cmd.Usage ("Convert a binary trace file to CSV or to one file per column.\n"
+             "The text records are kept only in the CSV format.");
+  cmd.AddValue ("input",  "binary trace file",                                input);
+  cmd.AddValue ("format", "output format: csv or columns",                    format);
+  cmd.AddValue ("output", "output file (csv, default stdout) or prefix (columns)", output);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_UNLESS (input.size (), "No input file; use --input=<file>");
+  BinaryTraceReader reader (input);
+
+  uint64_t records;
+  if (format == "csv")
+    {
+      if (output.empty ())
+        {
+          records = WriteCsv (reader, std::cout);
+        }
+      else
+        {
+          std::ofstream os (output.c_str ());
+          NS_ABORT_MSG_UNLESS (os.is_open (), "Unable to open " << output);
+          records = WriteCsv (reader, os);
+        }
+    }
+  else if (format == "columns")
+    {
+      NS_ABORT_MSG_UNLESS (output.size (), "No output prefix; use --output=<prefix>");
+      records = WriteColumns (reader, output);
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown format " << format << "; use csv or columns");
+    }
+
+  std::cerr << cmd.GetName () << ": " << records << " records converted" << std::endl;
+  return 0;
+}